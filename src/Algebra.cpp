@@ -7,35 +7,28 @@ ModelPoolDelta Algebra::substract(const ModelPoolDelta& a,
 {
     ModelPoolDelta delta;
 
+    // Merge both sorted maps in a single pass, so that entries can be
+    // appended to the result
     ModelPoolDelta::const_iterator ait = a.begin();
-    for(; ait != a.end(); ++ait)
-    {
-        owlapi::model::IRI model = ait->first;
-        size_t modelCount = ait->second;
-
-        ModelPoolDelta::const_iterator bit = b.find(model);
-        if(bit != b.end())
-        {
-            delta[model] = bit->second - modelCount;
-        } else
-        {
-            delta[model] = 0 - modelCount;
-        }
-    }
-
     ModelPoolDelta::const_iterator bit = b.begin();
-    for(; bit != b.end(); ++bit)
+    while(ait != a.end() || bit != b.end())
     {
-        owlapi::model::IRI model = bit->first;
-        size_t modelCount = bit->second;
-
-        ModelPoolDelta::const_iterator ait = a.find(model);
-        if(ait != a.end())
+        if(bit == b.end() || (ait != a.end() && ait->first < bit->first))
         {
-            // already handled
+            delta.insert(delta.end(),
+                         ModelPoolDelta::value_type(ait->first, -ait->second));
+            ++ait;
+        } else if(ait == a.end() || bit->first < ait->first)
+        {
+            delta.insert(delta.end(), *bit);
+            ++bit;
         } else
         {
-            delta[model] = modelCount;
+            delta.insert(delta.end(),
+                         ModelPoolDelta::value_type(ait->first,
+                                                    bit->second - ait->second));
+            ++ait;
+            ++bit;
         }
     }
 
@@ -233,8 +226,26 @@ ModelPool::Set Algebra::maxCompositions(const ModelPool::Set& a,
 
 bool Algebra::isSubset(const ModelPool& a, const ModelPool& b)
 {
-    // a-b
-    return !Algebra::delta(a, b).isNegative();
+    // equivalent to !delta(a,b).isNegative(), but without creating the delta
+    ModelPool::const_iterator bit = b.begin();
+    for(const ModelPool::value_type& v : a)
+    {
+        while(bit != b.end() && bit->first < v.first)
+        {
+            ++bit;
+        }
+
+        size_t available = 0;
+        if(bit != b.end() && bit->first == v.first)
+        {
+            available = bit->second;
+        }
+        if(v.second > available)
+        {
+            return false;
+        }
+    }
+    return true;
 }
 
 bool Algebra::isSuperset(const ModelPool& a, const ModelPool& b)
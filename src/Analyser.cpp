@@ -1,11 +1,109 @@
 #include "Analyser.hpp"
+#include "utils/Parallel.hpp"
 #include <algorithm>
+#include <cmath>
 #include <functional>
 
 using namespace std::placeholders;
 
 namespace moreorg {
 
+namespace {
+
+/**
+ * Export a sample table, where each time step contributes one row per
+ * subject (e.g. an agent)
+ * \param functions Function per column
+ * \param getSubjects Get the subjects of a time step
+ * \param getLabel Get the label of a row's subject, empty for unlabelled rows
+ */
+template <typename Subject>
+void exportSampleTable(
+    io::SampleWriter& writer,
+    const std::vector<std::string>& columns,
+    const std::vector<std::function<double(size_t, const Subject&)>>&
+        functions,
+    const std::function<std::vector<Subject>(size_t)>& getSubjects,
+    const std::function<std::string(const Subject&)>& getLabel,
+    size_t fromTime,
+    size_t toTime,
+    size_t numberOfThreads,
+    size_t blockSize)
+{
+    if(toTime < fromTime)
+    {
+        throw std::invalid_argument("moreorg::Analyser::exportSamples: "
+                                    "toTime lies before fromTime");
+    }
+    if(blockSize == 0)
+    {
+        throw std::invalid_argument("moreorg::Analyser::exportSamples: "
+                                    "block size must be greater than 0");
+    }
+
+    writer.writeHeader(columns, static_cast<bool>(getLabel));
+
+    size_t numberOfTimeSteps = toTime - fromTime + 1;
+    std::vector<std::vector<Subject>> subjects;
+    std::vector<size_t> offsets;
+    io::SampleBlock block;
+    for(size_t first = 0; first < numberOfTimeSteps; first += blockSize)
+    {
+        size_t steps = std::min(blockSize, numberOfTimeSteps - first);
+        size_t blockTime = fromTime + first;
+
+        subjects.assign(steps, std::vector<Subject>());
+        utils::Parallel::forEach(
+            steps,
+            [&](size_t i) { subjects[i] = getSubjects(blockTime + i); },
+            numberOfThreads);
+
+        // Rows of a time step are stored consecutively starting at its offset
+        offsets.assign(steps + 1, 0);
+        for(size_t i = 0; i < steps; ++i)
+        {
+            offsets[i + 1] = offsets[i] + subjects[i].size();
+        }
+
+        size_t rows = offsets[steps];
+        block.times.resize(rows);
+        block.labels.clear();
+        for(size_t i = 0; i < steps; ++i)
+        {
+            std::fill(block.times.begin() + offsets[i],
+                      block.times.begin() + offsets[i + 1],
+                      blockTime + i);
+            if(getLabel)
+            {
+                for(const Subject& subject : subjects[i])
+                {
+                    block.labels.push_back(getLabel(subject));
+                }
+            }
+        }
+        block.values.resize(columns.size() * rows);
+
+        utils::Parallel::forEach(
+            steps,
+            [&](size_t i) {
+                size_t time = blockTime + i;
+                for(size_t c = 0; c < functions.size(); ++c)
+                {
+                    for(size_t j = 0; j < subjects[i].size(); ++j)
+                    {
+                        block.at(c, offsets[i] + j) =
+                            functions[c](time, subjects[i][j]);
+                    }
+                }
+            },
+            numberOfThreads);
+
+        writer.writeBlock(block);
+    }
+}
+
+} // end anonymous namespace
+
 std::map<Analyser::AtomicAgentSampleType, std::string>
     Analyser::AtomicAgentSampleTypeTxt = {
         {AA_EnergyReductionAbsolute, "EnergyReductionAbsolute"},
@@ -96,16 +194,14 @@ void Analyser::add(const RequirementSample& sample)
 
 void Analyser::createIndex()
 {
-    // Index sample by time
-    mTimeIndexedStatusSamples = StatusSampleIndex(mStatusMaxTime + 1);
+    // Index sample by time interval
+    mTimeIndexedStatusSamples.clear();
+    mAtomicAgentIndexedSamples.clear();
     for(const StatusSample& statusSample : mStatusSamples)
     {
-        for(size_t i = statusSample.getFromTime();
-            i <= statusSample.getToTime();
-            ++i)
-        {
-            mTimeIndexedStatusSamples[i].push_back(&statusSample);
-        }
+        mTimeIndexedStatusSamples.add(statusSample.getFromTime(),
+                                      statusSample.getToTime(),
+                                      &statusSample);
 
         for(const AtomicAgent& agent :
             statusSample.getAgent().getAtomicAgents())
@@ -113,29 +209,42 @@ void Analyser::createIndex()
             mAtomicAgentIndexedSamples[agent].push_back(&statusSample);
         }
     }
+    mTimeIndexedStatusSamples.build();
+
+    for(std::pair<const AtomicAgent, StatusSample::ConstRawPtrList>& p :
+        mAtomicAgentIndexedSamples)
+    {
+        std::stable_sort(p.second.begin(),
+                         p.second.end(),
+                         [](const StatusSample* a, const StatusSample* b) {
+                             return a->getFromTime() < b->getFromTime();
+                         });
+    }
 
-    mTimeIndexedRequirementSamples = RequirementSampleIndex(mStatusMaxTime + 1);
+    mTimeIndexedRequirementSamples.clear();
     for(const RequirementSample& sample : mRequirementSamples)
     {
-        for(size_t i = sample.getFromTime(); i <= sample.getToTime(); ++i)
-        {
-            mTimeIndexedRequirementSamples[i].push_back(&sample);
-        }
+        mTimeIndexedRequirementSamples.add(sample.getFromTime(),
+                                           sample.getToTime(),
+                                           &sample);
     }
+    mTimeIndexedRequirementSamples.build();
+
+    mSampleEstimates = mHeuristics.computeEstimates(mStatusSamples);
 }
 
 StatusSample::ConstRawPtrList Analyser::statusSamplesAt(size_t time) const
 {
-    return mTimeIndexedStatusSamples[time];
+    return mTimeIndexedStatusSamples.at(time);
 }
 
 RequirementSample::ConstRawPtrList
 Analyser::requirementSamplesAt(size_t time) const
 {
-    return mTimeIndexedRequirementSamples[time];
+    return mTimeIndexedRequirementSamples.at(time);
 }
 
-StatusSample::ConstRawPtrList
+const StatusSample::ConstRawPtrList&
 Analyser::statusSamplesFor(const AtomicAgent& atomicAgent) const
 {
     std::map<AtomicAgent, StatusSample::ConstRawPtrList>::const_iterator cit =
@@ -343,11 +452,138 @@ std::vector<double> Analyser::getSampleO(size_t time) const
     return row;
 }
 
+void Analyser::exportSamplesAA(io::SampleWriter& writer,
+                               size_t fromTime,
+                               size_t toTime,
+                               size_t numberOfThreads,
+                               size_t blockSize) const
+{
+    typedef const AtomicAgent* Subject;
+
+    std::vector<std::string> columns;
+    std::vector<std::function<double(size_t, const Subject&)>> functions;
+    for(size_t i = 0; i < mAtomicAgentSampleTypes.size(); ++i)
+    {
+        columns.push_back(AtomicAgentSampleTypeTxt[mAtomicAgentSampleTypes[i]]);
+        AtomicAgentSampleFunc f = mAtomicAgentSampleFunctions[i];
+        functions.push_back([f](size_t time, const Subject& atomicAgent) {
+            return f(time, *atomicAgent);
+        });
+    }
+
+    std::vector<Subject> atomicAgents;
+    for(const std::pair<const AtomicAgent, StatusSample::ConstRawPtrList>& p :
+        mAtomicAgentIndexedSamples)
+    {
+        atomicAgents.push_back(&p.first);
+    }
+
+    exportSampleTable<Subject>(
+        writer,
+        columns,
+        functions,
+        [&atomicAgents](size_t) { return atomicAgents; },
+        [](const Subject& atomicAgent) { return atomicAgent->getName(); },
+        fromTime,
+        toTime,
+        numberOfThreads,
+        blockSize);
+}
+
+void Analyser::exportSamplesA(io::SampleWriter& writer,
+                              size_t fromTime,
+                              size_t toTime,
+                              size_t numberOfThreads,
+                              size_t blockSize) const
+{
+    std::vector<std::string> columns;
+    for(AgentSampleType t : mAgentSampleTypes)
+    {
+        columns.push_back(AgentSampleTypeTxt[t]);
+    }
+    std::vector<std::function<double(size_t, const Agent&)>> functions(
+        mAgentSampleFunctions.begin(),
+        mAgentSampleFunctions.end());
+
+    exportSampleTable<Agent>(
+        writer,
+        columns,
+        functions,
+        [this](size_t time) { return getCoalitionStructure(time); },
+        [](const Agent& agent) {
+            std::string label;
+            for(const AtomicAgent& atomicAgent : agent.getAtomicAgents())
+            {
+                if(!label.empty())
+                {
+                    label += "+";
+                }
+                label += atomicAgent.getName();
+            }
+            return label;
+        },
+        fromTime,
+        toTime,
+        numberOfThreads,
+        blockSize);
+}
+
+void Analyser::exportSamplesO(io::SampleWriter& writer,
+                              size_t fromTime,
+                              size_t toTime,
+                              size_t numberOfThreads,
+                              size_t blockSize) const
+{
+    // The organization is the only subject of each time step
+    typedef size_t Subject;
+
+    std::vector<std::string> columns;
+    std::vector<std::function<double(size_t, const Subject&)>> functions;
+    for(size_t i = 0; i < mOrganizationSampleTypes.size(); ++i)
+    {
+        columns.push_back(
+            OrganizationSampleTypeTxt[mOrganizationSampleTypes[i]]);
+        OrganizationSampleFunc f = mOrganizationSampleFunctions[i];
+        functions.push_back(
+            [f](size_t time, const Subject&) { return f(time); });
+    }
+
+    exportSampleTable<Subject>(
+        writer,
+        columns,
+        functions,
+        [](size_t) { return std::vector<Subject>(1, 0); },
+        std::function<std::string(const Subject&)>(),
+        fromTime,
+        toTime,
+        numberOfThreads,
+        blockSize);
+}
+
 double Analyser::getEnergyReductionAbsolute(const StatusSample* sample,
                                             const AtomicAgent& atomicAgent,
                                             size_t fromTime,
                                             size_t toTime) const
 {
+    // Use the precomputed estimate for samples of this analyser
+    std::less<const StatusSample*> before;
+    const StatusSample* first = mStatusSamples.data();
+    if(!before(sample, first) &&
+       before(sample, first + mSampleEstimates.size()))
+    {
+        double energyReduction =
+            mSampleEstimates.getEnergyReduction(sample - first,
+                                                atomicAgent.getModel());
+        if(!std::isnan(energyReduction))
+        {
+            // use linear model to estimate consumption
+            return energyReduction * (toTime - fromTime) /
+                   sample->getAvailableTime();
+        }
+    }
+
+    // Report the error or estimate an unknown sample
+    boost::unique_lock<boost::recursive_mutex> lock = lockOntology();
     return mHeuristics.getEnergyReductionAbsolute(sample,
                                                   atomicAgent,
                                                   fromTime,
@@ -359,7 +595,8 @@ Analyser::getEnergyReductionAbsolute(size_t time,
                                      const AtomicAgent& atomicAgent) const
 {
     double energy = 0;
-    StatusSample::ConstRawPtrList samples = statusSamplesFor(atomicAgent);
+    const StatusSample::ConstRawPtrList& samples =
+        statusSamplesFor(atomicAgent);
     for(const StatusSample* sample : samples)
     {
         // stop with get from time
@@ -400,7 +637,11 @@ double Analyser::getEnergyReductionAbsolute(size_t time,
 double Analyser::getEnergyAvailableAbsolute(size_t time,
                                             const Agent& agent) const
 {
-    double fullCapacity = agent.getFacade(mAsk).getEnergyCapacity();
+    double fullCapacity = 0;
+    {
+        boost::unique_lock<boost::recursive_mutex> lock = lockOntology();
+        fullCapacity = agent.getFacade(mAsk).getEnergyCapacity();
+    }
     return fullCapacity - getEnergyReductionAbsolute(time, agent);
 }
 
@@ -433,7 +674,11 @@ double
 Analyser::getEnergyReductionRelative(size_t time,
                                      const AtomicAgent& atomicAgent) const
 {
-    double fullEnergyCapacity = atomicAgent.getFacade(mAsk).getEnergyCapacity();
+    double fullEnergyCapacity = 0;
+    {
+        boost::unique_lock<boost::recursive_mutex> lock = lockOntology();
+        fullEnergyCapacity = atomicAgent.getFacade(mAsk).getEnergyCapacity();
+    }
     double energyReduction = getEnergyReductionAbsolute(time, atomicAgent);
 
     if(energyReduction == 0)
@@ -448,7 +693,11 @@ Analyser::getEnergyReductionRelative(size_t time,
 double Analyser::getEnergyReductionRelative(size_t time,
                                             const Agent& agent) const
 {
-    double fullEnergyCapacity = agent.getFacade(mAsk).getEnergyCapacity();
+    double fullEnergyCapacity = 0;
+    {
+        boost::unique_lock<boost::recursive_mutex> lock = lockOntology();
+        fullEnergyCapacity = agent.getFacade(mAsk).getEnergyCapacity();
+    }
     return getEnergyReductionAbsolute(time, agent) / fullEnergyCapacity;
 }
 
@@ -468,6 +717,7 @@ std::vector<double> Analyser::getMetric(size_t time,
 {
     std::vector<double> values;
 
+    boost::unique_lock<boost::recursive_mutex> lock = lockOntology();
     Metric::Ptr metric = Metric::getInstance(metricType, mAsk);
 
     Agent::List agents = getCoalitionStructure(time);
@@ -489,6 +739,12 @@ std::vector<double> Analyser::getMetric(size_t time,
     return values;
 }
 
+boost::unique_lock<boost::recursive_mutex> Analyser::lockOntology() const
+{
+    return boost::unique_lock<boost::recursive_mutex>(
+        mAsk.getOrganizationModel()->getOntologyMutex());
+}
+
 double Analyser::getMedian(std::vector<double> values)
 {
     if(values.empty())
@@ -6,6 +6,8 @@
 #include "OrganizationModelAsk.hpp"
 #include "RequirementSample.hpp"
 #include "StatusSample.hpp"
+#include "io/SampleWriter.hpp"
+#include "utils/IntervalIndex.hpp"
 #include <numeric/Stats.hpp>
 
 namespace moreorg {
@@ -24,8 +26,8 @@ namespace moreorg {
 class Analyser
 {
 public:
-    using StatusSampleIndex = std::vector<StatusSample::ConstRawPtrList>;
-    typedef std::vector<RequirementSample::ConstRawPtrList>
+    using StatusSampleIndex = utils::IntervalIndex<const StatusSample*>;
+    typedef utils::IntervalIndex<const RequirementSample*>
         RequirementSampleIndex;
 
     typedef std::function<double(size_t, const AtomicAgent&)>
@@ -101,8 +103,9 @@ public:
 
     /**
      * Retrieve all samples for a given atomic agent
+     * \return samples sorted by their start time
      */
-    StatusSample::ConstRawPtrList
+    const StatusSample::ConstRawPtrList&
     statusSamplesFor(const AtomicAgent& atomicAgent) const;
 
     /**
@@ -226,6 +229,53 @@ public:
      */
     std::vector<double> getSampleO(size_t time) const;
 
+    /**
+     * Export the samples of the selected atomic agent columns for all atomic
+     * agents and all time steps in [fromTime, toTime]
+     *
+     * The time range is processed in blocks of \p blockSize time steps: the
+     * rows of a block are evaluated in parallel, stored column by column and
+     * then passed to the writer
+     * \param writer Writer for the sample table, where rows are labelled with
+     * the name of the atomic agent
+     * \param fromTime Start of the time range
+     * \param toTime End of the time range (inclusive)
+     * \param numberOfThreads Number of worker threads, \see utils::Parallel;
+     * queries of facades and metrics to the ontology are serialised
+     * \param blockSize Number of time steps per block
+     * \see setSampleColumnsAA
+     */
+    void exportSamplesAA(io::SampleWriter& writer,
+                         size_t fromTime,
+                         size_t toTime,
+                         size_t numberOfThreads = 0,
+                         size_t blockSize = 256) const;
+
+    /**
+     * Export the samples of the selected agent columns for the coalition
+     * structure of each time step in [fromTime, toTime]
+     * \param writer Writer for the sample table, where rows are labelled with
+     * the names of the agent's atomic agents joined by '+'
+     * \see exportSamplesAA, setSampleColumnsA
+     */
+    void exportSamplesA(io::SampleWriter& writer,
+                        size_t fromTime,
+                        size_t toTime,
+                        size_t numberOfThreads = 0,
+                        size_t blockSize = 256) const;
+
+    /**
+     * Export the samples of the selected organization columns for each time
+     * step in [fromTime, toTime]
+     * \param writer Writer for the (unlabelled) sample table
+     * \see exportSamplesAA, setSampleColumnsO
+     */
+    void exportSamplesO(io::SampleWriter& writer,
+                        size_t fromTime,
+                        size_t toTime,
+                        size_t numberOfThreads = 0,
+                        size_t blockSize = 256) const;
+
     /**
      * Get the energy reduction for an individual agent, when assuming the given
      * sample and associated time interval
@@ -483,6 +533,13 @@ public:
     const Heuristics& getHeuristics() const { return mHeuristics; }
 
 private:
+    /**
+     * Lock the ontology -- facades and metrics query the ontology, which
+     * needs to be serialised when samples are exported in parallel
+     * \return lock of the ontology mutex
+     */
+    boost::unique_lock<boost::recursive_mutex> lockOntology() const;
+
     /// Resources
     OrganizationModelAsk mAsk;
     Heuristics mHeuristics;
@@ -499,13 +556,16 @@ private:
     size_t mRequirementMinTime;
     size_t mRequirementMaxTime;
 
-    /// StatusSample
+    /// Samples indexed by their time interval
     StatusSampleIndex mTimeIndexedStatusSamples;
     RequirementSampleIndex mTimeIndexedRequirementSamples;
     /// Map of atomic agents to related samples -- since no parallel activities
-    /// are possible a sample list can be used
+    /// are possible a sample list sorted by start time can be used
     std::map<AtomicAgent, StatusSample::ConstRawPtrList>
         mAtomicAgentIndexedSamples;
+    /// Estimates of the status samples indexed by their position in
+    /// mStatusSamples
+    Heuristics::SampleEstimates mSampleEstimates;
 
     /// Sampling function depending on the sample time
     std::map<AtomicAgentSampleType, AtomicAgentSampleFunc>
@@ -106,9 +106,11 @@ runModelPoolTest(const OrganizationModel::Ptr& om,
     for(size_t i = 0; i < epochs; ++i)
     {
         BaseGraph::Ptr baseGraph;
+        algebra::Connectivity::Statistics statistics;
         bool feasible = algebra::Connectivity::isFeasible(modelPool,
                                                           ask,
                                                           baseGraph,
+                                                          statistics,
                                                           timeoutInS * 1000,
                                                           minFeasible);
         if(baseGraph)
@@ -127,7 +129,7 @@ runModelPoolTest(const OrganizationModel::Ptr& om,
                 graph_analysis::representation::GRAPHVIZ);
         }
 
-        stats.push_back(algebra::Connectivity::getStatistics());
+        stats.push_back(statistics);
 
         if(!feasible)
         {
@@ -180,8 +182,9 @@ runFunctionalSaturationBoundTest(OrganizationModel::Ptr om,
     numeric::Stats<double> numberOfAgentsWithoutSatBound;
     for(size_t i = 0; i < epochs; ++i)
     {
+        // Each ask creates its own feasibility cache, so resetting the
+        // organization model's cache is sufficient
         om->resetQueryCache();
-        algebra::Connectivity::resetQueryCache();
 
         std::cout << "Epoch #" << i << std::endl;
         double duration;
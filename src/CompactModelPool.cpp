@@ -0,0 +1,235 @@
+#include "CompactModelPool.hpp"
+#include <algorithm>
+#include <boost/functional/hash.hpp>
+
+namespace moreorg {
+
+namespace {
+bool idLess(const CompactModelPool::value_type& entry, ModelRegistry::Id id)
+{
+    return entry.first < id;
+}
+} // end anonymous namespace
+
+CompactModelPool::CompactModelPool(const ModelPool& modelPool,
+                                   ModelRegistry& registry)
+{
+    mEntries.reserve(modelPool.size());
+    for(const ModelPool::value_type& v : modelPool)
+    {
+        mEntries.push_back(value_type(registry.getId(v.first), v.second));
+    }
+    std::sort(mEntries.begin(), mEntries.end());
+}
+
+ModelPool CompactModelPool::toModelPool(const ModelRegistry& registry) const
+{
+    ModelPool modelPool;
+    for(const value_type& v : mEntries)
+    {
+        modelPool[registry.getIRI(v.first)] = v.second;
+    }
+    return modelPool;
+}
+
+void CompactModelPool::setResourceCount(ModelRegistry::Id model, size_t count)
+{
+    std::vector<value_type>::iterator it =
+        std::lower_bound(mEntries.begin(), mEntries.end(), model, idLess);
+    if(it != mEntries.end() && it->first == model)
+    {
+        it->second = count;
+    } else
+    {
+        mEntries.insert(it, value_type(model, count));
+    }
+}
+
+size_t CompactModelPool::getValue(ModelRegistry::Id model,
+                                  size_t defaultVal) const
+{
+    const_iterator cit =
+        std::lower_bound(mEntries.begin(), mEntries.end(), model, idLess);
+    if(cit != mEntries.end() && cit->first == model)
+    {
+        return cit->second;
+    }
+    return defaultVal;
+}
+
+size_t CompactModelPool::numberOfInstances() const
+{
+    size_t instances = 0;
+    for(const value_type& v : mEntries)
+    {
+        instances += v.second;
+    }
+    return instances;
+}
+
+CompactModelPool
+CompactModelPool::applyUpperBound(const CompactModelPool& upperBounds) const
+{
+    CompactModelPool modelPool;
+    const_iterator ait = begin();
+    const_iterator bit = upperBounds.begin();
+    while(ait != end() && bit != upperBounds.end())
+    {
+        if(ait->first < bit->first)
+        {
+            ++ait;
+        } else if(bit->first < ait->first)
+        {
+            ++bit;
+        } else
+        {
+            modelPool.mEntries.push_back(
+                value_type(ait->first, std::min(ait->second, bit->second)));
+            ++ait;
+            ++bit;
+        }
+    }
+    return modelPool;
+}
+
+bool CompactModelPool::isWithinUpperBound(
+    const CompactModelPool& upperBound) const
+{
+    const_iterator ait = begin();
+    const_iterator bit = upperBound.begin();
+    while(ait != end() && bit != upperBound.end())
+    {
+        if(ait->first < bit->first)
+        {
+            ++ait;
+        } else if(bit->first < ait->first)
+        {
+            ++bit;
+        } else
+        {
+            if(ait->second > bit->second)
+            {
+                return false;
+            }
+            ++ait;
+            ++bit;
+        }
+    }
+    return true;
+}
+
+CompactModelPool CompactModelPool::compact() const
+{
+    CompactModelPool modelPool;
+    for(const value_type& v : mEntries)
+    {
+        if(v.second != 0)
+        {
+            modelPool.mEntries.push_back(v);
+        }
+    }
+    return modelPool;
+}
+
+bool CompactModelPool::isNull() const
+{
+    for(const value_type& v : mEntries)
+    {
+        if(v.second != 0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool CompactModelPool::isSubset(const CompactModelPool& a,
+                                const CompactModelPool& b)
+{
+    const_iterator bit = b.begin();
+    for(const_iterator ait = a.begin(); ait != a.end(); ++ait)
+    {
+        while(bit != b.end() && bit->first < ait->first)
+        {
+            ++bit;
+        }
+
+        size_t available = 0;
+        if(bit != b.end() && bit->first == ait->first)
+        {
+            available = bit->second;
+        }
+        if(ait->second > available)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+CompactModelPool CompactModelPool::max(const CompactModelPool& a,
+                                       const CompactModelPool& b)
+{
+    CompactModelPool modelPool;
+    modelPool.mEntries.reserve(a.size() + b.size());
+    const_iterator ait = a.begin();
+    const_iterator bit = b.begin();
+    while(ait != a.end() || bit != b.end())
+    {
+        if(bit == b.end() || (ait != a.end() && ait->first < bit->first))
+        {
+            modelPool.mEntries.push_back(*ait++);
+        } else if(ait == a.end() || bit->first < ait->first)
+        {
+            modelPool.mEntries.push_back(*bit++);
+        } else
+        {
+            modelPool.mEntries.push_back(
+                value_type(ait->first, std::max(ait->second, bit->second)));
+            ++ait;
+            ++bit;
+        }
+    }
+    return modelPool;
+}
+
+CompactModelPool CompactModelPool::min(const CompactModelPool& a,
+                                       const CompactModelPool& b)
+{
+    CompactModelPool modelPool;
+    modelPool.mEntries.reserve(a.size() + b.size());
+    const_iterator ait = a.begin();
+    const_iterator bit = b.begin();
+    while(ait != a.end() || bit != b.end())
+    {
+        // if only one pool contains the entry, then use the only existing
+        // (min) requirement
+        if(bit == b.end() || (ait != a.end() && ait->first < bit->first))
+        {
+            modelPool.mEntries.push_back(*ait++);
+        } else if(ait == a.end() || bit->first < ait->first)
+        {
+            modelPool.mEntries.push_back(*bit++);
+        } else
+        {
+            modelPool.mEntries.push_back(
+                value_type(ait->first, std::min(ait->second, bit->second)));
+            ++ait;
+            ++bit;
+        }
+    }
+    return modelPool;
+}
+
+size_t CompactModelPool::hash() const
+{
+    size_t seed = 0;
+    for(const value_type& v : mEntries)
+    {
+        boost::hash_combine(seed, v.first);
+        boost::hash_combine(seed, v.second);
+    }
+    return seed;
+}
+
+} // end namespace moreorg
@@ -0,0 +1,157 @@
+#ifndef ORGANIZATION_MODEL_COMPACT_MODEL_POOL_HPP
+#define ORGANIZATION_MODEL_COMPACT_MODEL_POOL_HPP
+
+#include <vector>
+
+#include "ModelPool.hpp"
+#include "ModelRegistry.hpp"
+
+namespace moreorg {
+
+/**
+ * \class CompactModelPool
+ * \brief Flat representation of a ModelPool, which uses the interned model
+ * ids of a ModelRegistry instead of IRIs
+ *
+ * \details
+ * Entries are kept in a vector sorted by model id, so that comparison,
+ * hashing and the bounding operations are linear merges over integers and do
+ * not require string comparison or node allocation. A CompactModelPool is
+ * only meaningful in combination with the registry it has been created with.
+ */
+class CompactModelPool
+{
+public:
+    typedef std::pair<ModelRegistry::Id, size_t> value_type;
+    typedef std::vector<value_type>::const_iterator const_iterator;
+    using List = std::vector<CompactModelPool>;
+
+    /**
+     * Default constructor
+     */
+    CompactModelPool() = default;
+
+    /**
+     * Create compact model pool from a ModelPool
+     * \param modelPool Model pool to convert
+     * \param registry Registry to intern the models of the pool with
+     */
+    CompactModelPool(const ModelPool& modelPool, ModelRegistry& registry);
+
+    /**
+     * Convert to a ModelPool
+     * \param registry Registry that has been used to create this pool
+     * \return ModelPool
+     */
+    ModelPool toModelPool(const ModelRegistry& registry) const;
+
+    /**
+     * Set the count of a given resource (model)
+     * \param model Id of the model
+     * \param count Number of instances that are available of this model
+     */
+    void setResourceCount(ModelRegistry::Id model, size_t count);
+
+    /**
+     * Get the cardinality of a resource
+     * \param defaultVal Return this default value if the model entry does
+     * not exist
+     */
+    size_t getValue(ModelRegistry::Id model, size_t defaultVal) const;
+
+    /**
+     * Return the number of instances that are defined by this pool
+     * \return number of instances
+     */
+    size_t numberOfInstances() const;
+
+    /**
+     * Applies an upper bound to the current model pool
+     * \see ModelPool::applyUpperBound
+     * \return model bound after applying the upper bound
+     */
+    CompactModelPool applyUpperBound(const CompactModelPool& upperBounds) const;
+
+    /**
+     * Check if the current model pool lies within the bound given by
+     * the upper bound
+     */
+    bool isWithinUpperBound(const CompactModelPool& upperBound) const;
+
+    /**
+     * Get a model pool with all cardinalities unequal to zero
+     * \return model pool without zero cardinalities
+     */
+    CompactModelPool compact() const;
+
+    /**
+     * Check if pool assignment is null, i.e. contains only 0 cardinalities or
+     * is overall empty
+     * \return True if pool assignment is null
+     */
+    bool isNull() const;
+
+    /**
+     * Check if a is a subset of b
+     * \see Algebra::isSubset
+     */
+    static bool isSubset(const CompactModelPool& a, const CompactModelPool& b);
+
+    /**
+     * Compute the elementwise maximum of two pools
+     * \see Algebra::max
+     */
+    static CompactModelPool max(const CompactModelPool& a,
+                                const CompactModelPool& b);
+
+    /**
+     * Compute the elementwise minimum of two pools
+     * \see Algebra::min
+     */
+    static CompactModelPool min(const CompactModelPool& a,
+                                const CompactModelPool& b);
+
+    /**
+     * Compute the hash value of this pool
+     */
+    size_t hash() const;
+
+    const_iterator begin() const { return mEntries.begin(); }
+    const_iterator end() const { return mEntries.end(); }
+    size_t size() const { return mEntries.size(); }
+    bool empty() const { return mEntries.empty(); }
+
+    bool operator==(const CompactModelPool& other) const
+    {
+        return mEntries == other.mEntries;
+    }
+
+    bool operator!=(const CompactModelPool& other) const
+    {
+        return !(*this == other);
+    }
+
+    bool operator<(const CompactModelPool& other) const
+    {
+        return mEntries < other.mEntries;
+    }
+
+private:
+    /// Entries sorted by model id
+    std::vector<value_type> mEntries;
+};
+
+} // end namespace moreorg
+
+// Enable usage of CompactModelPool as key in unordered maps
+namespace std {
+template <> struct hash<moreorg::CompactModelPool>
+{
+    size_t operator()(const moreorg::CompactModelPool& modelPool) const
+    {
+        return modelPool.hash();
+    }
+};
+} // end namespace std
+
+#endif // ORGANIZATION_MODEL_COMPACT_MODEL_POOL_HPP
@@ -90,6 +90,17 @@ void FunctionalityMapping::add(const ModelPool& modelPool,
     }
 }
 
+void FunctionalityMapping::merge(const FunctionalityMapping& other)
+{
+    for(const Function2PoolMap::value_type& p : other.mFunction2Pool)
+    {
+        for(const ModelPool& modelPool : p.second)
+        {
+            add(modelPool, p.first);
+        }
+    }
+}
+
 FunctionalityMapping FunctionalityMapping::fromFile(const std::string& filename)
 {
     using namespace owlapi::model;
@@ -21,6 +21,8 @@ typedef std::map<owlapi::model::IRI, ModelPool::Set> Function2PoolMap;
  */
 class FunctionalityMapping
 {
+    friend class FunctionalityMappingCache;
+
     /// The resources that are available
     ModelPool mModelPool;
     /// The list of known functionalities
@@ -120,6 +122,12 @@ public:
     void add(const ModelPool& modelPool,
              const owlapi::model::IRIList& functionModels);
 
+    /**
+     * Add all supporting model pools of another functionality mapping
+     * \param other FunctionalityMapping to merge into this one
+     */
+    void merge(const FunctionalityMapping& other);
+
     /**
      * Stringify object
      * \param indent Indentation in number of spaces
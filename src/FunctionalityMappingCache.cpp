@@ -0,0 +1,383 @@
+#include "FunctionalityMappingCache.hpp"
+#include <base-logging/Logging.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <unistd.h>
+
+using namespace owlapi::model;
+
+namespace moreorg {
+
+namespace {
+
+const char MAGIC[4] = {'M', 'O', 'F', 'M'};
+
+/// Sequential writer of fixed width values in native byte order
+class BinaryWriter
+{
+public:
+    BinaryWriter(std::ostream& stream)
+        : mStream(stream)
+    {
+    }
+
+    void writeUInt32(uint32_t value)
+    {
+        mStream.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    void writeUInt64(uint64_t value)
+    {
+        mStream.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    void writeString(const std::string& value)
+    {
+        writeUInt32(value.size());
+        mStream.write(value.data(), value.size());
+    }
+
+private:
+    std::ostream& mStream;
+};
+
+/// Bounds checked reader on a memory region
+class BinaryReader
+{
+public:
+    BinaryReader(const char* data, size_t size)
+        : mData(data)
+        , mSize(size)
+        , mPosition(0)
+    {
+    }
+
+    const char* read(size_t size)
+    {
+        if(mPosition + size > mSize)
+        {
+            throw std::runtime_error(
+                "moreorg::FunctionalityMappingCache: unexpected end of file");
+        }
+        const char* data = mData + mPosition;
+        mPosition += size;
+        return data;
+    }
+
+    uint32_t readUInt32()
+    {
+        uint32_t value;
+        std::memcpy(&value, read(sizeof(value)), sizeof(value));
+        return value;
+    }
+
+    uint64_t readUInt64()
+    {
+        uint64_t value;
+        std::memcpy(&value, read(sizeof(value)), sizeof(value));
+        return value;
+    }
+
+    std::string readString()
+    {
+        uint32_t size = readUInt32();
+        return std::string(read(size), size);
+    }
+
+private:
+    const char* mData;
+    size_t mSize;
+    size_t mPosition;
+};
+
+typedef std::map<IRI, uint32_t> IRIIndex;
+
+void writePool(BinaryWriter& writer,
+               const ModelPool& modelPool,
+               const IRIIndex& index)
+{
+    writer.writeUInt32(modelPool.size());
+    for(const ModelPool::value_type& v : modelPool)
+    {
+        writer.writeUInt32(index.at(v.first));
+        writer.writeUInt64(v.second);
+    }
+}
+
+ModelPool readPool(BinaryReader& reader, const std::vector<IRI>& iris)
+{
+    ModelPool modelPool;
+    uint32_t numberOfEntries = reader.readUInt32();
+    for(uint32_t i = 0; i < numberOfEntries; ++i)
+    {
+        uint32_t idx = reader.readUInt32();
+        uint64_t count = reader.readUInt64();
+        // Indexes are assigned in IRI order, so that entries can be appended
+        modelPool.insert(modelPool.end(),
+                         ModelPool::value_type(iris.at(idx), count));
+    }
+    return modelPool;
+}
+
+void indexPool(IRIIndex& index, const ModelPool& modelPool)
+{
+    for(const ModelPool::value_type& v : modelPool)
+    {
+        index[v.first] = 0;
+    }
+}
+
+} // end anonymous namespace
+
+FunctionalityMappingCache::Key::Key()
+    : contentHash(0)
+    , applyFunctionalSaturationBound(false)
+    , structuralNeighbourhood(0)
+    , feasibilityCheckTimeoutInMs(0)
+{
+}
+
+std::string FunctionalityMappingCache::Key::toString() const
+{
+    std::stringstream ss;
+    ss.precision(17);
+    ss << "ontology: " << ontology.toString() << std::endl;
+    ss << "content hash: " << contentHash << std::endl;
+    ss << "functional saturation bound: " << applyFunctionalSaturationBound
+       << std::endl;
+    ss << "structural neighbourhood: " << structuralNeighbourhood << std::endl;
+    ss << "feasibility check timeout in ms: " << feasibilityCheckTimeoutInMs
+       << std::endl;
+    ss << "interface base class: " << interfaceBaseClass.toString()
+       << std::endl;
+    ss << "model pool:" << std::endl;
+    for(const ModelPool::value_type& v : modelPool)
+    {
+        ss << "    " << v.first.toString() << " " << v.second << std::endl;
+    }
+    return ss.str();
+}
+
+FunctionalityMappingCache::FunctionalityMappingCache(
+    const std::string& directory)
+    : mDirectory(directory)
+{
+}
+
+std::string FunctionalityMappingCache::getDefaultDirectory()
+{
+    const char* directory = getenv("MOREORG_CACHE_DIR");
+    if(directory)
+    {
+        return std::string(directory);
+    }
+    return "/tmp/moreorg-cache";
+}
+
+std::string FunctionalityMappingCache::getFilename(const Key& key) const
+{
+    std::stringstream ss;
+    ss << mDirectory << "/functionality-mapping-v" << FORMAT_VERSION << "-"
+       << std::hex << std::hash<std::string>()(key.toString()) << ".bin";
+    return ss.str();
+}
+
+bool FunctionalityMappingCache::load(const Key& key,
+                                     FunctionalityMapping& mapping) const
+{
+    if(!isEnabled())
+    {
+        return false;
+    }
+
+    std::string filename = getFilename(key);
+    try
+    {
+        return read(filename, key, mapping);
+    } catch(const std::exception& e)
+    {
+        LOG_WARN_S << "moreorg::FunctionalityMappingCache::load: ignoring "
+                   << "invalid cache file '" << filename << "' -- "
+                   << e.what();
+    }
+    return false;
+}
+
+void FunctionalityMappingCache::store(const Key& key,
+                                      const FunctionalityMapping& mapping) const
+{
+    if(!isEnabled())
+    {
+        return;
+    }
+
+    std::string filename = getFilename(key);
+    try
+    {
+        boost::filesystem::create_directories(mDirectory);
+
+        // write to a process specific file first, so that the cache file
+        // is replaced atomically
+        std::stringstream ss;
+        ss << filename << ".tmp-" << getpid();
+        std::string tmpFilename = ss.str();
+        write(tmpFilename, key, mapping);
+        boost::filesystem::rename(tmpFilename, filename);
+    } catch(const std::exception& e)
+    {
+        LOG_WARN_S << "moreorg::FunctionalityMappingCache::store: failed to "
+                   << "write cache file '" << filename << "' -- " << e.what();
+    }
+}
+
+void FunctionalityMappingCache::write(const std::string& filename,
+                                      const Key& key,
+                                      const FunctionalityMapping& mapping)
+{
+    std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+    if(!file.is_open())
+    {
+        throw std::runtime_error("moreorg::FunctionalityMappingCache::write: "
+                                 "failed to open '" +
+                                 filename + "'");
+    }
+
+    // Collect all IRIs and assign indexes in IRI order
+    IRIIndex index;
+    indexPool(index, mapping.mModelPool);
+    indexPool(index, mapping.mFunctionalSaturationBound);
+    for(const IRI& functionality : mapping.mFunctionalities)
+    {
+        index[functionality] = 0;
+    }
+    for(const Function2PoolMap::value_type& p : mapping.mFunction2Pool)
+    {
+        index[p.first] = 0;
+        for(const ModelPool& modelPool : p.second)
+        {
+            indexPool(index, modelPool);
+        }
+    }
+    uint32_t idx = 0;
+    for(IRIIndex::value_type& v : index)
+    {
+        v.second = idx++;
+    }
+
+    BinaryWriter writer(file);
+    file.write(MAGIC, sizeof(MAGIC));
+    writer.writeUInt32(FORMAT_VERSION);
+    writer.writeString(key.toString());
+
+    writer.writeUInt32(index.size());
+    for(const IRIIndex::value_type& v : index)
+    {
+        writer.writeString(v.first.toString());
+    }
+
+    writePool(writer, mapping.mModelPool, index);
+    writePool(writer, mapping.mFunctionalSaturationBound, index);
+
+    writer.writeUInt32(mapping.mFunctionalities.size());
+    for(const IRI& functionality : mapping.mFunctionalities)
+    {
+        writer.writeUInt32(index.at(functionality));
+    }
+
+    writer.writeUInt32(mapping.mFunction2Pool.size());
+    for(const Function2PoolMap::value_type& p : mapping.mFunction2Pool)
+    {
+        writer.writeUInt32(index.at(p.first));
+        writer.writeUInt32(p.second.size());
+        for(const ModelPool& modelPool : p.second)
+        {
+            writePool(writer, modelPool, index);
+        }
+    }
+
+    if(!file.good())
+    {
+        throw std::runtime_error("moreorg::FunctionalityMappingCache::write: "
+                                 "failed to write '" +
+                                 filename + "'");
+    }
+}
+
+bool FunctionalityMappingCache::read(const std::string& filename,
+                                     const Key& key,
+                                     FunctionalityMapping& mapping)
+{
+    namespace bip = boost::interprocess;
+
+    if(!boost::filesystem::exists(filename) ||
+       boost::filesystem::file_size(filename) == 0)
+    {
+        return false;
+    }
+
+    bip::file_mapping file(filename.c_str(), bip::read_only);
+    bip::mapped_region region(file, bip::read_only);
+    BinaryReader reader(static_cast<const char*>(region.get_address()),
+                        region.get_size());
+
+    if(std::memcmp(reader.read(sizeof(MAGIC)), MAGIC, sizeof(MAGIC)) != 0)
+    {
+        throw std::runtime_error("moreorg::FunctionalityMappingCache::read: '" +
+                                 filename +
+                                 "' is not a functionality mapping file");
+    }
+    if(reader.readUInt32() != FORMAT_VERSION)
+    {
+        LOG_INFO_S << "moreorg::FunctionalityMappingCache::read: '"
+                   << filename << "' has an outdated format version";
+        return false;
+    }
+    if(reader.readString() != key.toString())
+    {
+        LOG_INFO_S << "moreorg::FunctionalityMappingCache::read: '"
+                   << filename << "' has been created for a different key";
+        return false;
+    }
+
+    uint32_t numberOfIRIs = reader.readUInt32();
+    std::vector<IRI> iris;
+    iris.reserve(numberOfIRIs);
+    for(uint32_t i = 0; i < numberOfIRIs; ++i)
+    {
+        iris.push_back(IRI(reader.readString()));
+    }
+
+    FunctionalityMapping result;
+    result.mModelPool = readPool(reader, iris);
+    result.mFunctionalSaturationBound = readPool(reader, iris);
+
+    uint32_t numberOfFunctionalities = reader.readUInt32();
+    for(uint32_t i = 0; i < numberOfFunctionalities; ++i)
+    {
+        result.mFunctionalities.push_back(iris.at(reader.readUInt32()));
+    }
+
+    uint32_t numberOfFunctionEntries = reader.readUInt32();
+    for(uint32_t i = 0; i < numberOfFunctionEntries; ++i)
+    {
+        const IRI& functionality = iris.at(reader.readUInt32());
+        // Keep entries for functionalities without any supporting pool
+        result.mFunction2Pool[functionality];
+
+        uint32_t numberOfPools = reader.readUInt32();
+        for(uint32_t p = 0; p < numberOfPools; ++p)
+        {
+            result.add(readPool(reader, iris), functionality);
+        }
+    }
+
+    mapping = result;
+    return true;
+}
+
+} // end namespace moreorg
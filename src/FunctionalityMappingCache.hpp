@@ -0,0 +1,125 @@
+#ifndef ORGANIZATION_MODEL_FUNCTIONALITY_MAPPING_CACHE_HPP
+#define ORGANIZATION_MODEL_FUNCTIONALITY_MAPPING_CACHE_HPP
+
+#include "FunctionalityMapping.hpp"
+#include <stdint.h>
+
+namespace moreorg {
+
+/**
+ * \class FunctionalityMappingCache
+ * \brief Persistent cache for FunctionalityMapping instances using a compact,
+ * versioned binary format
+ *
+ * \details
+ * A cache file starts with a magic number, the format version and the
+ * complete cache key, so that a file is only reused if all inputs of the
+ * mapping computation match. IRIs are stored once in a string table and model
+ * pools refer to them by index. Cache files are read through a memory
+ * mapping and written to a temporary file first, which is then renamed, so
+ * that concurrent processes never see partially written files.
+ */
+class FunctionalityMappingCache
+{
+public:
+    /// Version of the binary format, increase on any format change
+    static const uint32_t FORMAT_VERSION = 1;
+
+    /**
+     * \class Key
+     * \brief All inputs which determine a functionality mapping
+     */
+    struct Key
+    {
+        Key();
+
+        owlapi::model::IRI ontology;
+        /// Hash of the ontology's content
+        uint64_t contentHash;
+        ModelPool modelPool;
+        bool applyFunctionalSaturationBound;
+        size_t structuralNeighbourhood;
+        double feasibilityCheckTimeoutInMs;
+        owlapi::model::IRI interfaceBaseClass;
+
+        /**
+         * Stringify the key, which serves as unique identification in the
+         * cache file
+         */
+        std::string toString() const;
+    };
+
+    /**
+     * Create cache which operates on a given directory
+     * \param directory Cache directory, which will be created if it does not
+     * exist; an empty directory disables the cache
+     */
+    FunctionalityMappingCache(const std::string& directory =
+                                  getDefaultDirectory());
+
+    /**
+     * Get the default cache directory, i.e. the value of the environment
+     * variable MOREORG_CACHE_DIR if set, /tmp/moreorg-cache otherwise
+     */
+    static std::string getDefaultDirectory();
+
+    /**
+     * Get the cache directory
+     */
+    const std::string& getDirectory() const { return mDirectory; }
+
+    /**
+     * Check if caching is enabled
+     */
+    bool isEnabled() const { return !mDirectory.empty(); }
+
+    /**
+     * Get the name of the cache file for a given key
+     */
+    std::string getFilename(const Key& key) const;
+
+    /**
+     * Load a mapping from the cache
+     * \param key Key of the mapping
+     * \param mapping Will be set to the cached mapping if available
+     * \return True if a valid cache entry exists, false otherwise
+     */
+    bool load(const Key& key, FunctionalityMapping& mapping) const;
+
+    /**
+     * Store a mapping in the cache
+     * \param key Key of the mapping
+     * \param mapping Mapping to store
+     */
+    void store(const Key& key, const FunctionalityMapping& mapping) const;
+
+    /**
+     * Write a mapping in binary format
+     * \param filename Name of the file
+     * \param key Key that will be stored as part of the header
+     * \param mapping Mapping to write
+     * \throws std::runtime_error if the file cannot be written
+     */
+    static void write(const std::string& filename,
+                      const Key& key,
+                      const FunctionalityMapping& mapping);
+
+    /**
+     * Read a mapping in binary format
+     * \param filename Name of the file
+     * \param key Expected key
+     * \param mapping Will be set to the mapping read from the file
+     * \return True if the file exists, has a matching version and key, false
+     * otherwise
+     * \throws std::runtime_error if the file is corrupted
+     */
+    static bool read(const std::string& filename,
+                     const Key& key,
+                     FunctionalityMapping& mapping);
+
+private:
+    std::string mDirectory;
+};
+
+} // end namespace moreorg
+#endif // ORGANIZATION_MODEL_FUNCTIONALITY_MAPPING_CACHE_HPP
@@ -3,11 +3,30 @@
 #include "facades/Robot.hpp"
 #include "pddl_planner/Planning.hpp"
 #include "policies/DistributionPolicy.hpp"
+#include <limits>
 
 namespace moreorg {
 
+double
+Heuristics::SampleEstimates::getEnergyReduction(size_t sampleId,
+                                                const owlapi::model::IRI& model)
+    const
+{
+    for(size_t i = energyReductionOffsets.at(sampleId);
+        i < energyReductionOffsets.at(sampleId + 1);
+        ++i)
+    {
+        if(energyReductionModels[i] == model)
+        {
+            return energyReduction[i];
+        }
+    }
+    return std::numeric_limits<double>::quiet_NaN();
+}
+
 Heuristics::Heuristics(const OrganizationModelAsk& ask)
     : mAsk(ask)
+    , mpCache(make_shared<Cache>())
 {
 }
 
@@ -47,16 +66,22 @@ double Heuristics::travelTime(const Agent& agent,
 
 double Heuristics::travelTime(const StatusSample* sample) const
 {
-    StatusSample::RawPtr2Double::const_iterator cit = mTravelTime.find(sample);
-    if(cit != mTravelTime.end())
     {
-        return cit->second;
+        boost::unique_lock<boost::mutex> lock(mpCache->mutex);
+        std::unordered_map<const StatusSample*, double>::const_iterator cit =
+            mpCache->travelTime.find(sample);
+        if(cit != mpCache->travelTime.end())
+        {
+            return cit->second;
+        }
     }
 
     double time = travelTime(sample->getAgent(),
                              sample->getFromLocation(),
                              sample->getToLocation());
-    mTravelTime[sample] = time;
+
+    boost::unique_lock<boost::mutex> lock(mpCache->mutex);
+    mpCache->travelTime[sample] = time;
     return time;
 }
 
@@ -75,11 +100,14 @@ double Heuristics::waitTime(const StatusSample* sample) const
 
 double Heuristics::getEnergyConsumption(const StatusSample* sample) const
 {
-    StatusSample::RawPtr2Double::const_iterator cit =
-        mEnergyConsumption.find(sample);
-    if(cit != mEnergyConsumption.end())
     {
-        return cit->second;
+        boost::unique_lock<boost::mutex> lock(mpCache->mutex);
+        std::unordered_map<const StatusSample*, double>::const_iterator cit =
+            mpCache->energyConsumption.find(sample);
+        if(cit != mpCache->energyConsumption.end())
+        {
+            return cit->second;
+        }
     }
 
     double requiredTravelTime = travelTime(sample);
@@ -89,7 +117,8 @@ double Heuristics::getEnergyConsumption(const StatusSample* sample) const
         sample->getAgent().getFacade(mAsk).estimatedEnergyCostFromTime(
             requiredTravelTime + requiredWaitTime);
 
-    mEnergyConsumption[sample] = energyConsumption;
+    boost::unique_lock<boost::mutex> lock(mpCache->mutex);
+    mpCache->energyConsumption[sample] = energyConsumption;
     return energyConsumption;
 }
 
@@ -121,6 +150,89 @@ double Heuristics::getEnergyReductionAbsolute(const StatusSample* sample,
     }
 }
 
+Heuristics::SampleEstimates
+Heuristics::computeEstimates(const StatusSample::List& samples) const
+{
+    /// Properties of an agent type
+    struct AgentTypeProperties
+    {
+        bool valid;
+        double nominalVelocity;
+        /// Energy cost per second
+        double powerConsumption;
+        policies::Distribution energyDistribution;
+    };
+    std::map<ModelPool, AgentTypeProperties> agentTypes;
+
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    SampleEstimates estimates;
+    estimates.travelTime.reserve(samples.size());
+    estimates.waitTime.reserve(samples.size());
+    estimates.energyConsumption.reserve(samples.size());
+    estimates.energyReductionOffsets.reserve(samples.size() + 1);
+    estimates.energyReductionOffsets.push_back(0);
+
+    for(const StatusSample& sample : samples)
+    {
+        ModelPool agentType = sample.getAgent().getType();
+        std::map<ModelPool, AgentTypeProperties>::iterator it =
+            agentTypes.find(agentType);
+        if(it == agentTypes.end())
+        {
+            AgentTypeProperties properties;
+            try
+            {
+                facades::Robot robot =
+                    facades::Robot::getInstance(agentType, mAsk);
+                properties.nominalVelocity = robot.getNominalVelocity();
+                properties.powerConsumption =
+                    robot.estimatedEnergyCostFromTime(1.0);
+                properties.energyDistribution = robot.getDistribution(
+                    vocabulary::OM::DistributionPolicy_EnergyProvider());
+                properties.valid = true;
+            } catch(const std::exception& e)
+            {
+                // Queries for this type will report the error
+                properties.valid = false;
+            }
+            it = agentTypes.emplace(agentType, properties).first;
+        }
+
+        const AgentTypeProperties& properties = it->second;
+        if(!properties.valid)
+        {
+            estimates.travelTime.push_back(nan);
+            estimates.waitTime.push_back(nan);
+            estimates.energyConsumption.push_back(nan);
+            estimates.energyReductionOffsets.push_back(
+                estimates.energyReduction.size());
+            continue;
+        }
+
+        // s = v*t
+        base::Vector3d direction =
+            sample.getToLocation() - sample.getFromLocation();
+        double travelTime = direction.norm() / properties.nominalVelocity;
+        double waitTime = sample.getAvailableTime() - travelTime;
+        double energyConsumption =
+            properties.powerConsumption * (travelTime + waitTime);
+
+        estimates.travelTime.push_back(travelTime);
+        estimates.waitTime.push_back(waitTime);
+        estimates.energyConsumption.push_back(energyConsumption);
+        for(const std::pair<const owlapi::model::IRI, double>& share :
+            properties.energyDistribution.shares)
+        {
+            estimates.energyReductionModels.push_back(share.first);
+            estimates.energyReduction.push_back(energyConsumption *
+                                                share.second);
+        }
+        estimates.energyReductionOffsets.push_back(
+            estimates.energyReduction.size());
+    }
+    return estimates;
+}
+
 double
 Heuristics::getReconfigurationCost(const Agent::Set& _from,
                                    const Agent::Set& _to,
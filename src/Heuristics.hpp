@@ -4,6 +4,8 @@
 #include "OrganizationModelAsk.hpp"
 #include "StatusSample.hpp"
 #include <base/Pose.hpp>
+#include <boost/thread/mutex.hpp>
+#include <unordered_map>
 
 namespace moreorg {
 
@@ -15,6 +17,37 @@ namespace moreorg {
 class Heuristics
 {
 public:
+    /**
+     * \class SampleEstimates
+     * \brief Estimates for a list of status samples, which are stored in flat
+     * arrays indexed by the position (id) of a sample in this list
+     * \details Values which could not be estimated are NaN
+     */
+    struct SampleEstimates
+    {
+        std::vector<double> travelTime;
+        std::vector<double> waitTime;
+        std::vector<double> energyConsumption;
+
+        /// Energy reduction of the atomic agent models over the full sample
+        /// interval -- the entries of sample i are stored in the range
+        /// [energyReductionOffsets[i], energyReductionOffsets[i+1])
+        std::vector<size_t> energyReductionOffsets;
+        std::vector<owlapi::model::IRI> energyReductionModels;
+        std::vector<double> energyReduction;
+
+        /// Get the number of samples
+        size_t size() const { return travelTime.size(); }
+
+        /**
+         * Get the energy reduction of an atomic agent model for the full
+         * interval of a sample
+         * \return energy reduction, NaN if it is not available
+         */
+        double getEnergyReduction(size_t sampleId,
+                                  const owlapi::model::IRI& model) const;
+    };
+
     /**
      * Default constructor
      * \param ask OrganizationModelAsk which contains the available model pool
@@ -87,6 +120,15 @@ public:
                                       size_t fromTime,
                                       size_t toTime) const;
 
+    /**
+     * Compute the estimates for all samples in one pass, where the agent
+     * properties (nominal velocity, power consumption and energy distribution)
+     * are retrieved once per agent type
+     * \param samples List of samples, which defines the sample ids
+     * \return estimates indexed by sample id
+     */
+    SampleEstimates computeEstimates(const StatusSample::List& samples) const;
+
     /**
      * Compute the reconfiguration cost from a set of agents to another set of
      * agents, based on each target agent and involved source agents
@@ -125,9 +167,15 @@ public:
 private:
     OrganizationModelAsk mAsk;
 
-    // Cached data
-    mutable StatusSample::RawPtr2Double mEnergyConsumption;
-    mutable StatusSample::RawPtr2Double mTravelTime;
+    /// Cached data per sample, which is thread-safe and shared between
+    /// copies of this object
+    struct Cache
+    {
+        boost::mutex mutex;
+        std::unordered_map<const StatusSample*, double> energyConsumption;
+        std::unordered_map<const StatusSample*, double> travelTime;
+    };
+    shared_ptr<Cache> mpCache;
 };
 
 } // end namespace moreorg
@@ -1,5 +1,6 @@
 #include "InferenceRule.hpp"
 #include "Agent.hpp"
+#include "ModelPoolCombinationIterator.hpp"
 #include "facades/Robot.hpp"
 #include "inference_rules/AtomicAgentRule.hpp"
 #include "inference_rules/CompositeAgentRule.hpp"
@@ -7,6 +8,7 @@
 #include "vocabularies/OM.hpp"
 #include <base-logging/Logging.hpp>
 #include <base/Time.hpp>
+#include <muParser.h>
 
 using namespace owlapi::model;
 
@@ -25,12 +27,17 @@ std::string OPArgument::toString() const
     return ss.str();
 }
 
+OPCall::OPCall()
+    : mpCache(make_shared<Cache>())
+{
+}
+
 OPCall::OPCall(const std::string& op_name,
                const std::vector<OPArgument>& arguments)
     : mOPName(op_name)
     , mArguments(arguments)
     , mRandomNumberGenerator(std::random_device()())
-
+    , mpCache(make_shared<Cache>())
 {
     base::Time time = base::Time::now();
     mRandomNumberGenerator.seed(time.microseconds);
@@ -51,18 +58,8 @@ double OPCall::evalComposite(const Agent& agent,
     owlapi::model::IRI selectionPolicyName = mArguments[0].value;
     owlapi::model::IRI dataPropertyName = mArguments[1].value;
 
-    std::set<ModelPool> combinations = agent.getType().allCombinations();
-    Agent::Set agents;
-    for(const ModelPool& pool : combinations)
-    {
-        agents.insert(pool);
-    }
-
-    Policy::Ptr policy = Policy::getInstance(selectionPolicyName, ask);
-    policies::SelectionPolicy::Ptr selectionPolicy =
-        dynamic_pointer_cast<policies::SelectionPolicy>(policy);
-
-    policies::Selection selection = selectionPolicy->apply(agents, ask);
+    ModelPool::List selection =
+        select(agent.getType(), selectionPolicyName, ask);
     if(selection.empty())
     {
         // default value
@@ -71,23 +68,23 @@ double OPCall::evalComposite(const Agent& agent,
 
     // Requires only one agent as argument so pick one randomly if there
     // are multiple
-    Agent::List selectedAgents(selection.begin(), selection.end());
-    std::uniform_int_distribution<size_t> dist(0, selectedAgents.size() - 1);
-    Agent selectedAgent = selectedAgents[dist(mRandomNumberGenerator)];
+    std::uniform_int_distribution<size_t> dist(0, selection.size() - 1);
+    ModelPool selectedAgentType = selection[dist(mRandomNumberGenerator)];
 
     if(mArguments[0].inverse)
     {
         ModelPoolDelta delta =
-            Algebra::delta(selectedAgent.getType(), agent.getType());
-        selectedAgent = Agent(delta.toModelPool());
+            Algebra::delta(selectedAgentType, agent.getType());
+        selectedAgentType = delta.toModelPool();
     }
 
     if(mOPName == "SUM")
     {
-        return sum(selectedAgent, dataPropertyName, ask);
+        return aggregate(selectedAgentType, dataPropertyName, ask);
     } else if(mOPName == "MEAN")
     {
-        return mean(selectedAgent, dataPropertyName, ask);
+        double total = aggregate(selectedAgentType, dataPropertyName, ask);
+        return total / (1.0 * selectedAgentType.numberOfInstances());
     }
 
     throw std::runtime_error("moreorg::OPCall::eval: operation '" + mOPName +
@@ -110,7 +107,7 @@ double OPCall::evalAtomic(const Agent& agent,
 
     if(mOPName == "VALUE")
     {
-        return sum(agent, dataPropertyName, ask);
+        return aggregate(agent.getType(), dataPropertyName, ask);
     }
 
     throw std::runtime_error("moreorg::OPCall::eval: operation '" + mOPName +
@@ -138,6 +135,86 @@ double OPCall::mean(const Agent& agent,
     return total / (1.0 * agent.size());
 }
 
+void OPCall::Cache::synchronise(uint64_t revision)
+{
+    if(this->revision != revision)
+    {
+        values.clear();
+        selections.clear();
+        this->revision = revision;
+    }
+}
+
+double OPCall::aggregate(const ModelPool& agentType,
+                         const IRI& dataproperty,
+                         const OrganizationModelAsk& ask) const
+{
+    uint64_t revision = ask.getOrganizationModel()->getRevision();
+    {
+        boost::unique_lock<boost::mutex> lock(mpCache->mutex);
+        mpCache->synchronise(revision);
+        std::map<ModelPool, double>::const_iterator cit =
+            mpCache->values.find(agentType);
+        if(cit != mpCache->values.end())
+        {
+            return cit->second;
+        }
+    }
+
+    // Compute without holding the lock, since the data property value might
+    // be inferred by a rule that uses this very call
+    double value = sum(Agent(agentType), dataproperty, ask);
+
+    boost::unique_lock<boost::mutex> lock(mpCache->mutex);
+    if(mpCache->revision == revision)
+    {
+        mpCache->values[agentType] = value;
+    }
+    return value;
+}
+
+ModelPool::List OPCall::select(const ModelPool& agentType,
+                               const IRI& selectionPolicyName,
+                               const OrganizationModelAsk& ask) const
+{
+    uint64_t revision = ask.getOrganizationModel()->getRevision();
+    {
+        boost::unique_lock<boost::mutex> lock(mpCache->mutex);
+        mpCache->synchronise(revision);
+        std::map<ModelPool, ModelPool::List>::const_iterator cit =
+            mpCache->selections.find(agentType);
+        if(cit != mpCache->selections.end())
+        {
+            return cit->second;
+        }
+    }
+
+    Agent::Set agents;
+    ModelPoolCombinationIterator combinations(agentType);
+    while(combinations.next())
+    {
+        agents.insert(combinations.current());
+    }
+
+    Policy::Ptr policy = Policy::getInstance(selectionPolicyName, ask);
+    policies::SelectionPolicy::Ptr selectionPolicy =
+        dynamic_pointer_cast<policies::SelectionPolicy>(policy);
+
+    policies::Selection selection = selectionPolicy->apply(agents, ask);
+    ModelPool::List agentTypes;
+    for(const Agent& selectedAgent : selection)
+    {
+        agentTypes.push_back(selectedAgent.getType());
+    }
+
+    boost::unique_lock<boost::mutex> lock(mpCache->mutex);
+    if(mpCache->revision == revision)
+    {
+        mpCache->selections[agentType] = agentTypes;
+    }
+    return agentTypes;
+}
+
 std::string OPCall::toString(size_t indent) const
 {
     std::stringstream ss;
@@ -150,6 +227,35 @@ std::string OPCall::toString(size_t indent) const
     return ss.str();
 }
 
+class InferenceRule::Evaluator
+{
+public:
+    Evaluator(const std::string& expression,
+              const std::vector<std::string>& variables)
+        : mValues(variables.size(), 0.0)
+    {
+        // The values are bound by address, so mValues must not be resized
+        // hereafter
+        for(size_t i = 0; i < variables.size(); ++i)
+        {
+            mParser.DefineVar(variables[i], &mValues[i]);
+        }
+        mParser.SetExpr(expression);
+    }
+
+    double eval(const std::vector<double>& values)
+    {
+        boost::unique_lock<boost::mutex> lock(mMutex);
+        std::copy(values.begin(), values.end(), mValues.begin());
+        return mParser.Eval();
+    }
+
+private:
+    boost::mutex mMutex;
+    mu::Parser mParser;
+    std::vector<double> mValues;
+};
+
 std::map<IRI, InferenceRule::Ptr> InferenceRule::mPropertyCompositeAgentRules;
 std::map<IRI, InferenceRule::Ptr> InferenceRule::mPropertyAtomicAgentRules;
 
@@ -391,6 +497,51 @@ void InferenceRule::prepare()
     LOG_DEBUG_S << "Prepared rule: " << rule << " with #" << mOPCalls.size()
                 << " operation calls";
     mPreparedRule = rule;
+
+    std::vector<std::string> variables;
+    for(const std::pair<const std::string, OPCall>& p : mOPCalls)
+    {
+        variables.push_back(p.first);
+    }
+    mpEvaluator = make_shared<Evaluator>(mPreparedRule, variables);
+}
+
+double InferenceRule::apply(const facades::Robot& robot) const
+{
+    const ModelPool& agentType = robot.getModelPool();
+    validate(agentType);
+    return evaluate(agentType);
+}
+
+std::vector<double>
+InferenceRule::applyAll(const ModelPool::List& agentTypes) const
+{
+    std::vector<double> values;
+    values.reserve(agentTypes.size());
+    for(const ModelPool& agentType : agentTypes)
+    {
+        validate(agentType);
+        values.push_back(evaluate(agentType));
+    }
+    return values;
+}
+
+double InferenceRule::evaluate(const ModelPool& agentType) const
+{
+    if(!mpEvaluator)
+    {
+        throw std::runtime_error("moreorg::InferenceRule::evaluate: rule '" +
+                                 mRule + "' has not been prepared");
+    }
+
+    Agent agent(agentType);
+    std::vector<double> values;
+    values.reserve(mOPCalls.size());
+    for(const std::pair<const std::string, OPCall>& p : mOPCalls)
+    {
+        values.push_back(evalOPCall(p.second, agent));
+    }
+    return mpEvaluator->eval(values);
 }
 
 std::string InferenceRule::toString() const
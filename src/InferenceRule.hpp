@@ -3,6 +3,7 @@
 
 #include "OrganizationModelAsk.hpp"
 #include "SharedPtr.hpp"
+#include <boost/thread/mutex.hpp>
 #include <owlapi/model/IRI.hpp>
 #include <random>
 
@@ -26,10 +27,21 @@ struct OPArgument
     std::string toString() const;
 };
 
+/**
+ * \class OPCall
+ * \brief Call of an inbuilt operation within an inference rule
+ *
+ * \details
+ * Results of an operation are memoised per agent type, i.e., for the data
+ * property the call refers to. A call is expected to be evaluated against a
+ * single organization model, which is guaranteed when it is evaluated as part
+ * of an InferenceRule. Copies of a call share the memoised results, which are
+ * dropped once the revision of the organization model changes.
+ */
 class OPCall
 {
 public:
-    OPCall() = default;
+    OPCall();
 
     OPCall(const std::string& op_name,
            const std::vector<OPArgument>& arguments);
@@ -53,10 +65,54 @@ public:
     std::string toString(size_t indent = 0) const;
 
 protected:
+    /**
+     * Memoised results of this operation call
+     */
+    struct Cache
+    {
+        Cache()
+            : revision(0)
+        {
+        }
+
+        /**
+         * Drop the memoised results if they have been computed for another
+         * revision of the organization model -- requires the mutex to be
+         * locked
+         */
+        void synchronise(uint64_t revision);
+
+        boost::mutex mutex;
+        /// Revision of the organization model the results refer to
+        uint64_t revision;
+        /// Aggregated data property values by agent type
+        std::map<ModelPool, double> values;
+        /// Agent types selected by the selection policy by agent type
+        std::map<ModelPool, ModelPool::List> selections;
+    };
+
+    /**
+     * Get the (memoised) aggregated value of the data property for the given
+     * agent type
+     */
+    double aggregate(const ModelPool& agentType,
+                     const owlapi::model::IRI& dataproperty,
+                     const OrganizationModelAsk& ask) const;
+
+    /**
+     * Get the (memoised) agent types which result from applying the
+     * selection policy to all combinations of the given agent type
+     */
+    ModelPool::List select(const ModelPool& agentType,
+                           const owlapi::model::IRI& selectionPolicyName,
+                           const OrganizationModelAsk& ask) const;
+
     std::string mOPName;
     std::vector<OPArgument> mArguments;
 
     mutable std::mt19937 mRandomNumberGenerator;
+
+    shared_ptr<Cache> mpCache;
 };
 
 class InferenceRule
@@ -114,7 +170,13 @@ public:
      * Apply the rule to a particular robot, either being atomic or composite
      * agent
      */
-    virtual double apply(const facades::Robot& robot) const = 0;
+    virtual double apply(const facades::Robot& robot) const;
+
+    /**
+     * Apply the rule to a list of agent types at once
+     * \return values in the order of the given agent types
+     */
+    std::vector<double> applyAll(const ModelPool::List& agentTypes) const;
 
     void addBinding(const owlapi::model::IRI& placeholder,
                     const owlapi::model::IRI& name)
@@ -127,12 +189,36 @@ public:
     std::string toString() const;
 
 protected:
+    /**
+     * Evaluator for the prepared rule, which is compiled once and then
+     * evaluated with the values of the operation calls bound to variables
+     */
+    class Evaluator;
+
+    /**
+     * Check whether the rule can be applied to the given agent type
+     * \throws std::runtime_error if the rule does not apply
+     */
+    virtual void validate(const ModelPool& agentType) const = 0;
+
+    /**
+     * Evaluate an operation call of this rule for the given agent
+     */
+    virtual double evalOPCall(const OPCall& opcall,
+                              const Agent& agent) const = 0;
+
+    /**
+     * Evaluate the rule for a validated agent type
+     */
+    double evaluate(const ModelPool& agentType) const;
+
     OrganizationModelAsk mAsk;
     std::string mRule;
     std::map<owlapi::model::IRI, owlapi::model::IRI> mBindings;
 
     std::string mPreparedRule;
     std::map<std::string, OPCall> mOPCalls;
+    shared_ptr<Evaluator> mpEvaluator;
 
     static std::map<owlapi::model::IRI, InferenceRule::Ptr>
         mPropertyCompositeAgentRules;
@@ -9,6 +9,7 @@
 namespace moreorg {
 
 std::map<metrics::Type, Metric::Ptr> Metric::msMetrics;
+boost::mutex Metric::msMetricsMutex;
 
 Metric::Metric(metrics::Type type,
                const OrganizationModelAsk& organization,
@@ -164,6 +165,7 @@ Metric::computeExclusiveUse(const owlapi::model::IRISet& functions,
 Metric::Ptr Metric::getInstance(metrics::Type type,
                                 const OrganizationModelAsk& organization)
 {
+    boost::unique_lock<boost::mutex> lock(msMetricsMutex);
     std::map<metrics::Type, Metric::Ptr>::const_iterator cit =
         msMetrics.find(type);
     if(cit != msMetrics.end())
@@ -6,6 +6,7 @@
 #include "ResourceInstance.hpp"
 #include "reasoning/ModelBound.hpp"
 #include "vocabularies/OM.hpp"
+#include <boost/thread/mutex.hpp>
 #include <owlapi/model/OWLCardinalityRestriction.hpp>
 #include <random>
 #include <stdexcept>
@@ -186,6 +187,8 @@ protected:
     metrics::Type mType;
     owlapi::model::IRI mProperty;
     static std::map<metrics::Type, Metric::Ptr> msMetrics;
+    /// Guards msMetrics
+    static boost::mutex msMetricsMutex;
     ResourceInstance::PtrList mResourceInstanceAssignments;
 };
 
@@ -1,7 +1,7 @@
 #include "ModelPool.hpp"
 #include "Algebra.hpp"
+#include "ModelPoolCombinationIterator.hpp"
 #include "OrganizationModel.hpp"
-#include <numeric/LimitedCombination.hpp>
 #include <sstream>
 
 namespace moreorg {
@@ -40,14 +40,26 @@ ModelPool ModelPool::applyUpperBound(const ModelPool& upperBounds) const
 {
     ModelPool modelPool;
 
+    // Both pools are sorted, so that a single merge pass suffices and
+    // the result can be filled by appending at the end
     ModelPool::const_iterator cit = this->begin();
-    for(; cit != this->end(); ++cit)
+    ModelPool::const_iterator bit = upperBounds.begin();
+    while(cit != this->end() && bit != upperBounds.end())
     {
-        const owlapi::model::IRI& model = cit->first;
-        ModelPool::const_iterator bit = upperBounds.find(model);
-        if(bit != upperBounds.end())
+        if(cit->first < bit->first)
+        {
+            ++cit;
+        } else if(bit->first < cit->first)
         {
-            modelPool[model] = std::min(cit->second, bit->second);
+            ++bit;
+        } else
+        {
+            modelPool.insert(
+                modelPool.end(),
+                ModelPool::value_type(cit->first,
+                                      std::min(cit->second, bit->second)));
+            ++cit;
+            ++bit;
         }
     }
     return modelPool;
@@ -192,15 +204,24 @@ ModelPool::expandToLowerBound(const ModelCombinationSet& combinations,
 
 bool ModelPool::isWithinUpperBound(const ModelPool& upperBound) const
 {
-    for(const ModelPool::value_type& v : upperBound)
+    ModelPool::const_iterator cit = this->begin();
+    ModelPool::const_iterator bit = upperBound.begin();
+    while(cit != this->end() && bit != upperBound.end())
     {
-        ModelPool::const_iterator cit = this->find(v.first);
-        if(cit != this->end())
+        if(cit->first < bit->first)
         {
-            if(cit->second > v.second)
+            ++cit;
+        } else if(bit->first < cit->first)
+        {
+            ++bit;
+        } else
+        {
+            if(cit->second > bit->second)
             {
                 return false;
             }
+            ++cit;
+            ++bit;
         }
     }
     return true;
@@ -247,31 +268,22 @@ ModelPool::Set ModelPool::allCombinations(size_t maxSize) const
 {
     ModelPool::Set allCombinations;
 
-    ModelCombination modelCombinationBound = toModelCombination();
-
-    // Account for the maximum size of the combination
-    size_t sizeOfCombination =
-        numeric::LimitedCombination<owlapi::model::IRI>::totalNumberOfAtoms(
-            *this);
-    if(maxSize > 0)
+    ModelPoolCombinationIterator combinations(*this, maxSize);
+    while(combinations.next())
     {
-        sizeOfCombination = std::min(maxSize, sizeOfCombination);
+        allCombinations.insert(combinations.current());
     }
+    return allCombinations;
+}
 
-    numeric::LimitedCombination<owlapi::model::IRI> combinations(
-        *this,
-        sizeOfCombination,
-        numeric::MAX);
-
-    do
+uint32_t ModelPool::numberOfInstances() const
+{
+    uint32_t instances = 0;
+    for(const ModelPool::value_type& v : *this)
     {
-        owlapi::model::IRIList combination = combinations.current();
-        ModelPool modelPool =
-            OrganizationModel::combination2ModelPool(combination);
-        allCombinations.insert(modelPool);
-    } while(combinations.next());
-
-    return allCombinations;
+        instances += v.second;
+    }
+    return instances;
 }
 
 const owlapi::model::IRI& ModelPool::getAtomic() const
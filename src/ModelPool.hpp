@@ -172,7 +172,7 @@ public:
      * Return the number of instances that are defined by this pool
      * \return number of instances
      */
-    uint32_t numberOfInstances() const { return toModelCombination().size(); }
+    uint32_t numberOfInstances() const;
 
     /**
      * Get the cardinality of a resource
@@ -0,0 +1,193 @@
+#include "ModelPoolCombinationIterator.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+namespace moreorg {
+
+ModelPoolCombinationIterator::Cursor::Cursor()
+    : size(0)
+    , initialized(false)
+{
+}
+
+ModelPoolCombinationIterator::ModelPoolCombinationIterator(
+    const ModelPool& bound,
+    size_t maxSize,
+    size_t minSize)
+    : mMinSize(std::max(minSize, static_cast<size_t>(1)))
+    , mMaxSize(0)
+    , mCurrentValid(false)
+{
+    size_t totalSize = 0;
+    for(const ModelPool::value_type& v : bound)
+    {
+        if(v.second > 0)
+        {
+            mModels.push_back(v.first);
+            mBounds.push_back(v.second);
+            totalSize += v.second;
+        }
+    }
+
+    mMaxSize = totalSize;
+    if(maxSize > 0)
+    {
+        mMaxSize = std::min(maxSize, totalSize);
+    }
+    reset();
+}
+
+void ModelPoolCombinationIterator::reset()
+{
+    mCursor = Cursor();
+    mCursor.counts.assign(mModels.size(), 0);
+    mCurrentValid = false;
+}
+
+bool ModelPoolCombinationIterator::first(size_t size)
+{
+    mCursor.size = size;
+    size_t remaining = size;
+    for(size_t i = 0; i < mBounds.size(); ++i)
+    {
+        mCursor.counts[i] = std::min(mBounds[i], remaining);
+        remaining -= mCursor.counts[i];
+    }
+    return remaining == 0;
+}
+
+bool ModelPoolCombinationIterator::advance()
+{
+    // Find the rightmost model whose cardinality can be decremented, such
+    // that the freed instance fits into the models to its right
+    size_t freeCapacity = 0;
+    size_t assigned = 0;
+    for(size_t i = mBounds.size(); i-- > 0;)
+    {
+        if(mCursor.counts[i] > 0 && freeCapacity > 0)
+        {
+            --mCursor.counts[i];
+            // Refill the models to the right with the largest possible
+            // cardinalities
+            size_t remaining = assigned + 1;
+            for(size_t j = i + 1; j < mBounds.size(); ++j)
+            {
+                mCursor.counts[j] = std::min(mBounds[j], remaining);
+                remaining -= mCursor.counts[j];
+            }
+            return true;
+        }
+        freeCapacity += mBounds[i] - mCursor.counts[i];
+        assigned += mCursor.counts[i];
+    }
+    return false;
+}
+
+bool ModelPoolCombinationIterator::next()
+{
+    mCurrentValid = false;
+
+    size_t size = mMinSize;
+    if(mCursor.initialized)
+    {
+        if(advance())
+        {
+            return true;
+        }
+        size = mCursor.size + 1;
+    }
+    mCursor.initialized = true;
+
+    for(; size <= mMaxSize; ++size)
+    {
+        if(first(size))
+        {
+            return true;
+        }
+    }
+
+    // Mark as exhausted
+    mCursor.size = mMaxSize + 1;
+    std::fill(mCursor.counts.begin(), mCursor.counts.end(), 0);
+    return false;
+}
+
+const ModelPool& ModelPoolCombinationIterator::current() const
+{
+    if(!mCurrentValid)
+    {
+        mCurrent.clear();
+        for(size_t i = 0; i < mModels.size(); ++i)
+        {
+            if(mCursor.counts[i] > 0)
+            {
+                mCurrent.insert(mCurrent.end(),
+                                ModelPool::value_type(mModels[i],
+                                                      mCursor.counts[i]));
+            }
+        }
+        mCurrentValid = true;
+    }
+    return mCurrent;
+}
+
+bool ModelPoolCombinationIterator::nextChunk(ModelPool::List& chunk,
+                                             size_t maxChunkSize)
+{
+    chunk.clear();
+    while(chunk.size() < maxChunkSize && next())
+    {
+        chunk.push_back(current());
+    }
+    return !chunk.empty();
+}
+
+void ModelPoolCombinationIterator::setCursor(const Cursor& cursor)
+{
+    if(cursor.counts.size() != mModels.size())
+    {
+        throw std::invalid_argument(
+            "moreorg::ModelPoolCombinationIterator::setCursor: cursor does "
+            "not match the bound of this iterator");
+    }
+    for(size_t i = 0; i < mModels.size(); ++i)
+    {
+        if(cursor.counts[i] > mBounds[i])
+        {
+            throw std::invalid_argument(
+                "moreorg::ModelPoolCombinationIterator::setCursor: cursor "
+                "exceeds the bound of this iterator");
+        }
+    }
+    mCursor = cursor;
+    mCurrentValid = false;
+}
+
+uint64_t ModelPoolCombinationIterator::numberOfCombinations() const
+{
+    // numberOfSolutions[s]: number of combinations with s instances using the
+    // models processed so far
+    std::vector<uint64_t> numberOfSolutions(mMaxSize + 1, 0);
+    numberOfSolutions[0] = 1;
+    for(size_t bound : mBounds)
+    {
+        std::vector<uint64_t> updated(mMaxSize + 1, 0);
+        for(size_t s = 0; s <= mMaxSize; ++s)
+        {
+            for(size_t c = 0; c <= bound && c <= s; ++c)
+            {
+                updated[s] += numberOfSolutions[s - c];
+            }
+        }
+        numberOfSolutions.swap(updated);
+    }
+
+    uint64_t total = 0;
+    for(size_t s = mMinSize; s <= mMaxSize; ++s)
+    {
+        total += numberOfSolutions[s];
+    }
+    return total;
+}
+
+} // end namespace moreorg
@@ -0,0 +1,142 @@
+#ifndef ORGANIZATION_MODEL_MODEL_POOL_COMBINATION_ITERATOR_HPP
+#define ORGANIZATION_MODEL_MODEL_POOL_COMBINATION_ITERATOR_HPP
+
+#include "ModelPool.hpp"
+#include <stdint.h>
+#include <vector>
+
+namespace moreorg {
+
+/**
+ * \class ModelPoolCombinationIterator
+ * \brief Lazily enumerate all (non-empty) combinations that can be generated
+ * from a model pool, i.e., all model pools which are bounded by the given one
+ *
+ * \details
+ * Combinations are generated in a canonical order: by increasing number of
+ * instances and for the same number of instances by lexicographically
+ * decreasing cardinalities (following the model order of the bounding pool).
+ * Advancing the iterator does not allocate; the model pool representation of
+ * the current combination is only created on request.
+ *
+ \verbatim
+ ModelPoolCombinationIterator it(modelPool);
+ while(it.next())
+ {
+     const ModelPool& combination = it.current();
+     ...
+ }
+ \endverbatim
+ */
+class ModelPoolCombinationIterator
+{
+public:
+    /**
+     * Position of an iterator, which allows to resume the iteration
+     */
+    struct Cursor
+    {
+        Cursor();
+
+        /// Cardinalities of the current combination
+        std::vector<size_t> counts;
+        /// Number of instances of the current combination
+        size_t size;
+        bool initialized;
+    };
+
+    /**
+     * Constructor of the iterator
+     * \param bound Model pool which defines the available resources
+     * \param maxSize If maxSize > 0, then this is the maximum number of
+     * instances in a combination
+     * \param minSize Minimum number of instances in a combination
+     */
+    ModelPoolCombinationIterator(const ModelPool& bound,
+                                 size_t maxSize = 0,
+                                 size_t minSize = 1);
+
+    /**
+     * Advance to the next combination
+     * \return False if all combinations have been enumerated
+     */
+    bool next();
+
+    /**
+     * Get the current combination as model pool (without zero cardinalities)
+     */
+    const ModelPool& current() const;
+
+    /**
+     * Get the cardinalities of the current combination, which correspond
+     * to getModels()
+     */
+    const std::vector<size_t>& getCounts() const { return mCursor.counts; }
+
+    /**
+     * Get the models of the bounding model pool
+     */
+    const owlapi::model::IRIList& getModels() const { return mModels; }
+
+    /**
+     * Get the number of instances of the current combination
+     */
+    size_t getSize() const { return mCursor.size; }
+
+    /**
+     * Collect the next combinations, e.g., to distribute them in chunks
+     * across parallel workers
+     * \param chunk List which will be set to the next combinations
+     * \param maxChunkSize Maximum number of combinations in a chunk
+     * \return False if no combination is left, true otherwise
+     */
+    bool nextChunk(ModelPool::List& chunk, size_t maxChunkSize);
+
+    /**
+     * Get the current position of the iterator
+     */
+    const Cursor& getCursor() const { return mCursor; }
+
+    /**
+     * Resume the iteration from a position that has been retrieved from an
+     * iterator with the same bound
+     * \throws std::invalid_argument if the cursor does not match the bound
+     */
+    void setCursor(const Cursor& cursor);
+
+    /**
+     * Restart the iteration
+     */
+    void reset();
+
+    /**
+     * Compute the number of combinations without enumerating them
+     */
+    uint64_t numberOfCombinations() const;
+
+private:
+    /**
+     * Set the lexicographically largest combination of the given size
+     * \return False if no combination of this size exists
+     */
+    bool first(size_t size);
+
+    /**
+     * Advance to the next combination with the same size
+     * \return False if no further combination of this size exists
+     */
+    bool advance();
+
+    owlapi::model::IRIList mModels;
+    std::vector<size_t> mBounds;
+    size_t mMinSize;
+    size_t mMaxSize;
+
+    Cursor mCursor;
+
+    mutable ModelPool mCurrent;
+    mutable bool mCurrentValid;
+};
+
+} // end namespace moreorg
+#endif // ORGANIZATION_MODEL_MODEL_POOL_COMBINATION_ITERATOR_HPP
@@ -0,0 +1,60 @@
+#include "ModelRegistry.hpp"
+#include <stdexcept>
+
+namespace moreorg {
+
+ModelRegistry::Id ModelRegistry::getId(const owlapi::model::IRI& model)
+{
+    Id id;
+    if(findId(model, id))
+    {
+        return id;
+    }
+
+    boost::unique_lock<boost::shared_mutex> lock(mMutex);
+    // The model might have been registered while waiting for the lock
+    std::unordered_map<owlapi::model::IRI, Id>::const_iterator cit =
+        mIds.find(model);
+    if(cit != mIds.end())
+    {
+        return cit->second;
+    }
+
+    id = static_cast<Id>(mIRIs.size());
+    mIRIs.push_back(model);
+    mIds[model] = id;
+    return id;
+}
+
+bool ModelRegistry::findId(const owlapi::model::IRI& model, Id& id) const
+{
+    boost::shared_lock<boost::shared_mutex> lock(mMutex);
+    std::unordered_map<owlapi::model::IRI, Id>::const_iterator cit =
+        mIds.find(model);
+    if(cit != mIds.end())
+    {
+        id = cit->second;
+        return true;
+    }
+    return false;
+}
+
+const owlapi::model::IRI& ModelRegistry::getIRI(Id id) const
+{
+    boost::shared_lock<boost::shared_mutex> lock(mMutex);
+    if(id >= mIRIs.size())
+    {
+        throw std::out_of_range(
+            "moreorg::ModelRegistry::getIRI: unknown model id " +
+            std::to_string(id));
+    }
+    return mIRIs[id];
+}
+
+size_t ModelRegistry::size() const
+{
+    boost::shared_lock<boost::shared_mutex> lock(mMutex);
+    return mIRIs.size();
+}
+
+} // end namespace moreorg
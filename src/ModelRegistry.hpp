@@ -0,0 +1,71 @@
+#ifndef ORGANIZATION_MODEL_MODEL_REGISTRY_HPP
+#define ORGANIZATION_MODEL_MODEL_REGISTRY_HPP
+
+#include <boost/thread/shared_mutex.hpp>
+#include <deque>
+#include <owlapi/model/IRI.hpp>
+#include <stdint.h>
+#include <unordered_map>
+
+#include "SharedPtr.hpp"
+
+namespace moreorg {
+
+/**
+ * \class ModelRegistry
+ * \brief Interning table which maps model IRIs to dense integer ids
+ *
+ * \details
+ * Ids are assigned in order of registration starting from 0 and remain valid
+ * for the lifetime of the registry, so that they can be used as index into
+ * flat arrays. All methods are thread-safe: lookups of known models share a
+ * read lock, and only the registration of a new model requires exclusive
+ * access.
+ */
+class ModelRegistry
+{
+public:
+    using Ptr = shared_ptr<ModelRegistry>;
+    typedef uint32_t Id;
+
+    ModelRegistry() = default;
+
+    ModelRegistry(const ModelRegistry&) = delete;
+    ModelRegistry& operator=(const ModelRegistry&) = delete;
+
+    /**
+     * Get the id of a model and register the model if it is not yet known
+     * \param model IRI of the model
+     * \return id of the model
+     */
+    Id getId(const owlapi::model::IRI& model);
+
+    /**
+     * Lookup the id of a model without registering it
+     * \param model IRI of the model
+     * \param id Will be set to the model's id if the model is known
+     * \return True if the model is known, false otherwise
+     */
+    bool findId(const owlapi::model::IRI& model, Id& id) const;
+
+    /**
+     * Get the IRI of a registered model
+     * \throws std::out_of_range if the id is unknown
+     * \return IRI of the model
+     */
+    const owlapi::model::IRI& getIRI(Id id) const;
+
+    /**
+     * Get the number of registered models
+     */
+    size_t size() const;
+
+private:
+    mutable boost::shared_mutex mMutex;
+    std::unordered_map<owlapi::model::IRI, Id> mIds;
+    /// Deque to keep references stable when registering further models
+    std::deque<owlapi::model::IRI> mIRIs;
+};
+
+} // end namespace moreorg
+#endif // ORGANIZATION_MODEL_MODEL_REGISTRY_HPP
@@ -1,30 +1,80 @@
 #include "OrganizationModel.hpp"
 #include "OrganizationModelAsk.hpp"
 #include "OrganizationModelTell.hpp"
+#include <algorithm>
+#include <boost/functional/hash.hpp>
 #include <owlapi/io/OWLOntologyIO.hpp>
+#include <sstream>
 
 using namespace owlapi::model;
 
 namespace moreorg {
 
 OrganizationModel::OrganizationModel(const owlapi::model::IRI& iri)
+    : mpOntologyMutex(make_shared<boost::recursive_mutex>())
+    , mpModelRegistry(make_shared<ModelRegistry>())
+    , mContentHash(0)
+    , mpRevision(make_shared<std::atomic<uint64_t>>(0))
+    , mpQueryCache(make_shared<QueryCache>(mpModelRegistry))
 {
     mpOntology = owlapi::io::OWLOntologyIO::load(iri);
+    mContentHash = computeContentHash();
 }
 
 OrganizationModel::OrganizationModel(const std::string& filename)
     : mpOntology(new OWLOntology())
+    , mpOntologyMutex(make_shared<boost::recursive_mutex>())
+    , mpModelRegistry(make_shared<ModelRegistry>())
+    , mContentHash(0)
+    , mpRevision(make_shared<std::atomic<uint64_t>>(0))
+    , mpQueryCache(make_shared<QueryCache>(mpModelRegistry))
 {
     if(!filename.empty())
     {
         mpOntology = owlapi::io::OWLOntologyIO::fromFile(filename);
+        mContentHash = computeContentHash();
     }
 }
 
+uint64_t OrganizationModel::computeContentHash() const
+{
+    boost::unique_lock<boost::recursive_mutex> lock(*mpOntologyMutex);
+    // The ontology holds the axioms of all imported ontologies as well --
+    // sort them, so that the hash does not depend on the loading order
+    std::vector<std::string> axioms;
+    for(const OWLAxiom::Ptr& axiom : mpOntology->getAxioms())
+    {
+        axioms.push_back(axiom->toString());
+    }
+    std::sort(axioms.begin(), axioms.end());
+
+    size_t seed = 0;
+    for(const std::string& axiom : axioms)
+    {
+        boost::hash_combine(seed, axiom);
+    }
+    return seed;
+}
+
+bool OrganizationModel::isModified() const
+{
+    return mContentHash == 0 || computeContentHash() != mContentHash;
+}
+
+void OrganizationModel::resetQueryCache()
+{
+    boost::unique_lock<boost::recursive_mutex> lock(*mpOntologyMutex);
+    mpQueryCache->clear();
+    ++(*mpRevision);
+}
+
 OrganizationModel OrganizationModel::copy() const
 {
     OrganizationModel om;
     om.mpOntology = make_shared<OWLOntology>(*ontology().get());
+    // The copy is meant to be modified, so it must not be identified with
+    // the loaded ontology
+    om.mContentHash = 0;
     return om;
 }
 
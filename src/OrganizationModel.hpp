@@ -2,8 +2,11 @@
 #define ORGANIZATION_MODEL_ORGANIZATION_MODEL_HPP
 
 #include "FunctionalityMapping.hpp"
+#include "ModelRegistry.hpp"
 #include "QueryCache.hpp"
 #include "Service.hpp"
+#include <atomic>
+#include <boost/thread/recursive_mutex.hpp>
 #include <moreorg/SharedPtr.hpp>
 #include <owlapi/model/OWLOntology.hpp>
 #include <stdint.h>
@@ -94,15 +97,84 @@ public:
 
     /**
      * Reset / Clear the query cache
+     * This also increments the revision, so that results which have been
+     * derived from the ontology are invalidated
+     *
+     * Invalidation is manual: modifications through OWLOntologyTell are not
+     * tracked, so call this function after the ontology has been modified
      */
-    void resetQueryCache() { mQueryCache.clear(); }
+    void resetQueryCache();
+
+    /**
+     * Get the revision of the ontology, which changes whenever the query cache
+     * is reset -- the revision is shared by all copies which refer to the same
+     * ontology and can be read without holding the ontology mutex
+     * \see resetQueryCache
+     */
+    uint64_t getRevision() const { return mpRevision->load(); }
+
+    /**
+     * Get the mutex which serializes the access to the ontology (and the
+     * query cache), when the organization model is queried from multiple
+     * threads
+     */
+    boost::recursive_mutex& getOntologyMutex() const
+    {
+        return *mpOntologyMutex;
+    }
+
+    /**
+     * Get the interning table for the models of this organization model, to
+     * allow for a compact, id based representation of model pools
+     * \see CompactModelPool
+     */
+    ModelRegistry& getModelRegistry() const { return *mpModelRegistry; }
+
+    /**
+     * Get the hash of the axioms, including imported ones, which have been
+     * loaded into this organization model
+     * \return hash value, or 0 if the model has not been loaded or is a copy
+     */
+    uint64_t getContentHash() const { return mContentHash; }
+
+    /**
+     * Compute the hash of the current axioms of the ontology, including the
+     * axioms of imported ontologies
+     * \return hash value
+     */
+    uint64_t computeContentHash() const;
+
+    /**
+     * Check if the ontology might differ from the one which has been loaded,
+     * i.e., if it has been modified after loading, is a copy, or has not been
+     * loaded at all
+     * \return true if the ontology might have been modified
+     */
+    bool isModified() const;
+
+    /**
+     * Get the cache for ontology query results, e.g., to retrieve its
+     * statistics
+     */
+    QueryCache& getQueryCache() const { return *mpQueryCache; }
 
 private:
     /// Ontology that serves as basis for this organization model
     owlapi::model::OWLOntology::Ptr mpOntology;
+    /// Mutex shared by all copies which refer to the same ontology
+    shared_ptr<boost::recursive_mutex> mpOntologyMutex;
+    /// Model ids shared by all copies which refer to the same ontology
+    ModelRegistry::Ptr mpModelRegistry;
+    /// Hash of the axioms at loading time
+    uint64_t mContentHash;
+    /// Revision of the ontology shared by all copies which refer to the same
+    /// ontology
+    shared_ptr<std::atomic<uint64_t>> mpRevision;
 
 protected:
-    QueryCache mQueryCache;
+    /// Cache of ontology query results shared by all copies which refer to
+    /// the same ontology
+    QueryCache::Ptr mpQueryCache;
 };
 
 } // end namespace moreorg
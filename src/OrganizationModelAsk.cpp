@@ -1,21 +1,28 @@
 #include "OrganizationModelAsk.hpp"
 #include "Agent.hpp"
 #include "Algebra.hpp"
+#include "FunctionalityMappingCache.hpp"
+#include "ModelPoolCombinationIterator.hpp"
 #include "PropertyConstraintSolver.hpp"
 #include "Resource.hpp"
 #include "ResourceInstance.hpp"
 #include "algebra/Connectivity.hpp"
+#include "facades/RobotCache.hpp"
 #include "reasoning/ResourceMatch.hpp"
 #include "utils/OrganizationStructureGeneration.hpp"
+#include "utils/Parallel.hpp"
 #include "vocabularies/OM.hpp"
 #include <base-logging/Logging.hpp>
 #include <base/Time.hpp>
+#include <boost/functional/hash.hpp>
+#include <boost/thread/mutex.hpp>
 #include <fstream>
-#include <numeric/LimitedCombination.hpp>
+#include <future>
 #include <owlapi/Vocabulary.hpp>
 #include <owlapi/model/OWLOntologyAsk.hpp>
 #include <owlapi/model/OWLOntologyTell.hpp>
 #include <sstream>
+#include <tuple>
 #include <unordered_map>
 
 using namespace owlapi::model;
@@ -23,10 +30,114 @@ using namespace owlapi::vocabulary;
 
 namespace moreorg {
 
-std::vector<OrganizationModelAsk> OrganizationModelAsk::msOrganizationModelAsk;
+/**
+ * Hashed registry of shared OrganizationModelAsk instances, keyed on the
+ * organization model, the model pool and the options which affect the
+ * results of queries
+ */
+class OrganizationModelAsk::InstanceRegistry
+{
+public:
+    struct Key
+    {
+        Key(const OrganizationModel::Ptr& om,
+            const ModelPool& modelPool,
+            bool applyFunctionalSaturationBound,
+            double feasibilityCheckTimeoutInMs,
+            const owlapi::model::IRI& interfaceBaseClass,
+            size_t neighbourHood)
+            : organizationModel(om)
+            , modelPool(modelPool)
+            , applyFunctionalSaturationBound(applyFunctionalSaturationBound)
+            , feasibilityCheckTimeoutInMs(feasibilityCheckTimeoutInMs)
+            , interfaceBaseClass(interfaceBaseClass)
+            , neighbourHood(neighbourHood)
+            , hash(std::hash<ModelPool>()(modelPool))
+        {
+            boost::hash_combine(hash, organizationModel.get());
+            boost::hash_combine(hash, applyFunctionalSaturationBound);
+            boost::hash_combine(hash, feasibilityCheckTimeoutInMs);
+            boost::hash_combine(hash,
+                                std::hash<owlapi::model::IRI>()(
+                                    interfaceBaseClass));
+            boost::hash_combine(hash, neighbourHood);
+        }
+
+        bool operator==(const Key& other) const
+        {
+            return hash == other.hash &&
+                   organizationModel == other.organizationModel &&
+                   applyFunctionalSaturationBound ==
+                       other.applyFunctionalSaturationBound &&
+                   feasibilityCheckTimeoutInMs ==
+                       other.feasibilityCheckTimeoutInMs &&
+                   neighbourHood == other.neighbourHood &&
+                   interfaceBaseClass == other.interfaceBaseClass &&
+                   modelPool == other.modelPool;
+        }
+
+        OrganizationModel::Ptr organizationModel;
+        ModelPool modelPool;
+        bool applyFunctionalSaturationBound;
+        double feasibilityCheckTimeoutInMs;
+        owlapi::model::IRI interfaceBaseClass;
+        size_t neighbourHood;
+        size_t hash;
+    };
+
+    struct KeyHash
+    {
+        size_t operator()(const Key& key) const { return key.hash; }
+    };
+
+    struct Entry
+    {
+        /// The instance is available once its construction has been
+        /// completed
+        std::shared_future<OrganizationModelAsk::Ptr> instance;
+        /// Identifies the construction which created this entry
+        uint64_t generation;
+    };
+
+    /// Instances by key
+    typedef std::unordered_map<Key, Entry, KeyHash> Entries;
+
+    InstanceRegistry()
+        : generation(0)
+    {
+    }
+
+    boost::mutex mutex;
+    Entries entries;
+    /// Generation of the most recently created entry
+    uint64_t generation;
+};
+
+OrganizationModelAsk::InstanceRegistry
+    OrganizationModelAsk::msInstanceRegistry;
+
+OrganizationModelAsk::Core::Core(const OrganizationModel::Ptr& om)
+    : organizationModel(om)
+    , ontologyAsk(om ? om->ontology() : OWLOntology::Ptr())
+    , applyFunctionalSaturationBound(false)
+    , feasibilityCheckTimeoutInMs(20000)
+    , structuralNeighbourhood(3)
+    , numberOfThreads(1)
+    , feasibilityCache(make_shared<algebra::FeasibilityCache>())
+    , cacheDirectory(FunctionalityMappingCache::getDefaultDirectory())
+    , robotCache(make_shared<facades::RobotCache>(om))
+    , saturationBoundCache(make_shared<SaturationBoundCache>())
+    , supportPoolCache(make_shared<SupportPoolCache>())
+    , relatedResourceCache(make_shared<RelatedResourceCache>())
+{
+    if(om)
+    {
+        subclassClosure = algebra::SubclassClosure::getInstance(om);
+    }
+}
 
 OrganizationModelAsk::OrganizationModelAsk()
-    : mOntologyAsk(OWLOntology::Ptr())
+    : mpCore(make_shared<Core>(OrganizationModel::Ptr()))
 {
 }
 
@@ -36,23 +147,25 @@ OrganizationModelAsk::OrganizationModelAsk(
     bool applyFunctionalSaturationBound,
     double feasibilityCheckTimeoutInMs,
     const owlapi::model::IRI& interfaceBaseClass,
-    size_t neighbourHood)
-    : mpOrganizationModel(om)
-    , mOntologyAsk(om->ontology())
-    , mApplyFunctionalSaturationBound(applyFunctionalSaturationBound)
-    , mFeasibilityCheckTimeoutInMs(feasibilityCheckTimeoutInMs)
-    , mStructuralNeighbourhood(neighbourHood)
-    , mInterfaceBaseClass(interfaceBaseClass)
+    size_t neighbourHood,
+    size_t numberOfThreads)
+    : mpCore(make_shared<Core>(om))
 {
+    mpCore->applyFunctionalSaturationBound = applyFunctionalSaturationBound;
+    mpCore->feasibilityCheckTimeoutInMs = feasibilityCheckTimeoutInMs;
+    mpCore->structuralNeighbourhood = neighbourHood;
+    mpCore->interfaceBaseClass = interfaceBaseClass;
+    mpCore->numberOfThreads = numberOfThreads;
+
     if(!modelPool.empty())
     {
-        if(!mApplyFunctionalSaturationBound)
+        if(!mpCore->applyFunctionalSaturationBound)
         {
             LOG_INFO_S
                 << "No functional saturation bound requested: this might take "
                    "some time to prepare the functionality mappings";
         }
-        prepare(modelPool, mApplyFunctionalSaturationBound);
+        prepare(modelPool, mpCore->applyFunctionalSaturationBound);
     } else
     {
         LOG_INFO_S
@@ -60,80 +173,141 @@ OrganizationModelAsk::OrganizationModelAsk(
     }
 }
 
-const OrganizationModelAsk&
+OrganizationModelAsk::Ptr
 OrganizationModelAsk::getInstance(const OrganizationModel::Ptr& om,
                                   const ModelPool& modelPool,
                                   bool applyFunctionalSaturationBound,
                                   double feasibilityCheckTimeoutInMs,
                                   const owlapi::model::IRI& interfaceBaseClass,
-                                  size_t neighbourHood)
-{
-    std::vector<OrganizationModelAsk>::const_iterator it =
-        std::find_if(msOrganizationModelAsk.begin(),
-                     msOrganizationModelAsk.end(),
-                     [om,
-                      modelPool,
-                      applyFunctionalSaturationBound,
-                      feasibilityCheckTimeoutInMs,
-                      interfaceBaseClass](const OrganizationModelAsk& other) {
-                         if(om == other.mpOrganizationModel &&
-                            applyFunctionalSaturationBound ==
-                                other.mApplyFunctionalSaturationBound &&
-                            feasibilityCheckTimeoutInMs ==
-                                other.mFeasibilityCheckTimeoutInMs &&
-                            modelPool == other.mModelPool &&
-                            interfaceBaseClass == other.mInterfaceBaseClass)
-                         {
-                             return true;
-                         } else
-                         {
-                             return false;
-                         }
-                     });
-    if(it != msOrganizationModelAsk.end())
+                                  size_t neighbourHood,
+                                  size_t numberOfThreads)
+{
+    InstanceRegistry::Key key(om,
+                              modelPool,
+                              applyFunctionalSaturationBound,
+                              feasibilityCheckTimeoutInMs,
+                              interfaceBaseClass,
+                              neighbourHood);
+
+    std::promise<Ptr> promise;
+    uint64_t generation;
+    {
+        boost::unique_lock<boost::mutex> lock(msInstanceRegistry.mutex);
+        InstanceRegistry::Entries::const_iterator cit =
+            msInstanceRegistry.entries.find(key);
+        if(cit != msInstanceRegistry.entries.end())
+        {
+            std::shared_future<Ptr> instance = cit->second.instance;
+            lock.unlock();
+            // Wait for a construction which is still ongoing
+            return instance.get();
+        }
+        generation = ++msInstanceRegistry.generation;
+        InstanceRegistry::Entry entry{promise.get_future().share(), generation};
+        msInstanceRegistry.entries.emplace(key, entry);
+    }
+
+    // Construct (and prepare) outside of the lock, so that other keys can be
+    // served meanwhile
+    try
     {
-        return *it;
-    } else
+        Ptr ask = make_shared<OrganizationModelAsk>(
+            om,
+            modelPool,
+            applyFunctionalSaturationBound,
+            feasibilityCheckTimeoutInMs,
+            interfaceBaseClass,
+            neighbourHood,
+            numberOfThreads);
+        promise.set_value(ask);
+        return ask;
+    } catch(...)
+    {
+        // Allow later requests to retry -- unless the entry has been evicted
+        // meanwhile and another request has already created a new one
+        {
+            boost::unique_lock<boost::mutex> lock(msInstanceRegistry.mutex);
+            InstanceRegistry::Entries::const_iterator cit =
+                msInstanceRegistry.entries.find(key);
+            if(cit != msInstanceRegistry.entries.end() &&
+               cit->second.generation == generation)
+            {
+                msInstanceRegistry.entries.erase(cit);
+            }
+        }
+        promise.set_exception(std::current_exception());
+        throw;
+    }
+}
+
+size_t OrganizationModelAsk::evictInstances(const OrganizationModel::Ptr& om)
+{
+    boost::unique_lock<boost::mutex> lock(msInstanceRegistry.mutex);
+    size_t numberOfEvictions = 0;
+    InstanceRegistry::Entries& entries = msInstanceRegistry.entries;
+    for(InstanceRegistry::Entries::iterator it = entries.begin();
+        it != entries.end();)
     {
-        OrganizationModelAsk ask(om,
-                                 modelPool,
-                                 applyFunctionalSaturationBound,
-                                 feasibilityCheckTimeoutInMs,
-                                 interfaceBaseClass,
-                                 neighbourHood);
-        msOrganizationModelAsk.push_back(ask);
-        return msOrganizationModelAsk.back();
+        if(!om || it->first.organizationModel == om)
+        {
+            it = entries.erase(it);
+            ++numberOfEvictions;
+        } else
+        {
+            ++it;
+        }
     }
+    return numberOfEvictions;
+}
+
+size_t OrganizationModelAsk::getNumberOfInstances()
+{
+    boost::unique_lock<boost::mutex> lock(msInstanceRegistry.mutex);
+    return msInstanceRegistry.entries.size();
 }
 
 void OrganizationModelAsk::prepare(const ModelPool& modelPool,
                                    bool applyFunctionalSaturationBound)
 {
-    mModelPool = allowSubclasses(modelPool, vocabulary::OM::Actor());
-    mModelPool = mModelPool.compact();
-    mFunctionalityMapping =
-        computeFunctionalityMapping(mModelPool, applyFunctionalSaturationBound);
+    Core& core = getMutableCore();
+    core.modelPool = allowSubclasses(modelPool, vocabulary::OM::Actor());
+    core.modelPool = core.modelPool.compact();
+    core.functionalityMapping = computeFunctionalityMapping(
+        core.modelPool, applyFunctionalSaturationBound);
+    // Support pools refer to the previous functionality mapping
+    core.supportPoolCache = make_shared<SupportPoolCache>();
+}
+
+OrganizationModelAsk::Core& OrganizationModelAsk::getMutableCore()
+{
+    if(!mpCore.unique())
+    {
+        mpCore = make_shared<Core>(*mpCore);
+    }
+    return *mpCore;
 }
 
 owlapi::model::IRIList OrganizationModelAsk::getAgentModels() const
 {
     bool directSubclassOnly = false;
-    IRIList subclasses = mOntologyAsk.allSubClassesOf(vocabulary::OM::Agent(),
-                                                      directSubclassOnly);
+    IRIList subclasses =
+        mpCore->ontologyAsk.allSubClassesOf(vocabulary::OM::Agent(),
+                                            directSubclassOnly);
     return subclasses;
 }
 
 owlapi::model::IRIList
 OrganizationModelAsk::getAgentProperties(const IRI& model) const
 {
-    return mOntologyAsk.getDataPropertiesForDomain(model);
+    return mpCore->ontologyAsk.getDataPropertiesForDomain(model);
 }
 
 owlapi::model::IRIList OrganizationModelAsk::getServiceModels() const
 {
     bool directSubclassOnly = false;
-    IRIList subclasses = mOntologyAsk.allSubClassesOf(vocabulary::OM::Service(),
-                                                      directSubclassOnly);
+    IRIList subclasses =
+        mpCore->ontologyAsk.allSubClassesOf(vocabulary::OM::Service(),
+                                            directSubclassOnly);
     return subclasses;
 }
 
@@ -141,8 +315,8 @@ owlapi::model::IRIList OrganizationModelAsk::getFunctionalities() const
 {
     bool directSubclassOnly = false;
     IRIList subclasses =
-        mOntologyAsk.allSubClassesOf(vocabulary::OM::Functionality(),
-                                     directSubclassOnly);
+        mpCore->ontologyAsk.allSubClassesOf(vocabulary::OM::Functionality(),
+                                            directSubclassOnly);
     IRIList blacklist = {vocabulary::OM::Service(),
                          vocabulary::OM::Capability()};
     for(const owlapi::model::IRI& label : blacklist)
@@ -162,14 +336,14 @@ owlapi::model::IRIList OrganizationModelAsk::getFunctionalities() const
 owlapi::model::IRIList
 OrganizationModelAsk::getSupportedFunctionalities(const ModelPool& model) const
 {
-    return mFunctionalityMapping.getFunctionalities(model);
+    return mpCore->functionalityMapping.getFunctionalities(model);
 }
 
 ModelPool OrganizationModelAsk::getSupportedFunctionalities() const
 {
     ModelPool modelPool;
     owlapi::model::IRISet mSupportedFunctionalities =
-        mFunctionalityMapping.getSupportedFunctionalities();
+        mpCore->functionalityMapping.getSupportedFunctionalities();
     owlapi::model::IRISet::const_iterator cit =
         mSupportedFunctionalities.begin();
     for(; cit != mSupportedFunctionalities.end(); ++cit)
@@ -201,22 +375,28 @@ FunctionalityMapping OrganizationModelAsk::computeFunctionalityMapping(
 
     FunctionalityMapping functionalityMapping;
 
-    size_t hashPool = std::hash<std::string>{}(modelPool.toString(0));
-    std::stringstream ss;
-    ss << "/tmp/moreorg-om-cache-" << hashPool;
-    if(applyFunctionalSaturationBound)
-    {
-        ss << "-with-sat-bound";
-    }
-    std::string cacheFilename = ss.str();
-
-    std::ifstream cacheFile(cacheFilename);
-    if(cacheFile.is_open())
-    {
-        cacheFile.close();
-
-        functionalityMapping = FunctionalityMapping::fromFile(cacheFilename);
-        return functionalityMapping;
+    FunctionalityMappingCache cache(mpCore->cacheDirectory);
+    FunctionalityMappingCache::Key key;
+    // A modified ontology cannot be reliably identified by its content hash,
+    // so its mappings are neither loaded nor persisted
+    bool persist =
+        cache.isEnabled() && !mpCore->organizationModel->isModified();
+    if(persist)
+    {
+        key.ontology = mpCore->ontologyAsk.getOntology()->getIRI();
+        key.contentHash = getOntologyContentHash();
+        key.modelPool = modelPool;
+        key.applyFunctionalSaturationBound = applyFunctionalSaturationBound;
+        key.structuralNeighbourhood = mpCore->structuralNeighbourhood;
+        key.feasibilityCheckTimeoutInMs = mpCore->feasibilityCheckTimeoutInMs;
+        key.interfaceBaseClass = mpCore->interfaceBaseClass;
+
+        if(cache.load(key, functionalityMapping))
+        {
+            LOG_INFO_S << "Loaded functionality mapping from cache: "
+                       << cache.getFilename(key);
+            return functionalityMapping;
+        }
     }
 
     if(applyFunctionalSaturationBound)
@@ -230,11 +410,46 @@ FunctionalityMapping OrganizationModelAsk::computeFunctionalityMapping(
                                                  functionalityModels);
     }
 
-    functionalityMapping.save(cacheFilename);
+    if(persist)
+    {
+        cache.store(key, functionalityMapping);
+    }
 
     return functionalityMapping;
 }
 
+uint64_t OrganizationModelAsk::getOntologyContentHash() const
+{
+    size_t seed = 0;
+    for(const IRI& model : getAgentModels())
+    {
+        boost::hash_combine(seed, model.toString());
+    }
+    for(const IRI& model : getFunctionalities())
+    {
+        boost::hash_combine(seed, model.toString());
+    }
+
+    boost::hash_combine(seed, mpCore->organizationModel->getRevision());
+    uint64_t contentHash = mpCore->organizationModel->getContentHash();
+    if(contentHash != 0)
+    {
+        boost::hash_combine(seed, contentHash);
+    } else
+    {
+        // No file content available, so fall back to the model definitions
+        for(const IRI& model : getAgentModels())
+        {
+            ModelPool modelPool;
+            modelPool[model] = 1;
+            boost::hash_combine(seed,
+                                OWLCardinalityRestriction::toString(
+                                    getCardinalityRestrictions(modelPool)));
+        }
+    }
+    return seed;
+}
+
 FunctionalityMapping OrganizationModelAsk::computeBoundedFunctionalityMapping(
     const ModelPool& modelPool,
     const IRIList& functionalityModels) const
@@ -282,6 +497,15 @@ FunctionalityMapping OrganizationModelAsk::computeBoundedFunctionalityMapping(
     FunctionalityMapping functionalityMapping(modelPool,
                                               functionalityModels,
                                               functionalSaturationBound);
+
+    // In parallel mode, the combinations are collected first and then
+    // distributed across the workers
+    bool parallel =
+        utils::Parallel::getNumberOfThreads(mpCore->numberOfThreads) > 1;
+    typedef std::tuple<ModelPool, ModelPool, owlapi::model::IRI>
+        CombinationCheck;
+    std::vector<CombinationCheck> combinationChecks;
+
     Resource::Set::const_iterator fit = functionalities.begin();
     for(; fit != functionalities.end(); ++fit)
     {
@@ -294,81 +518,118 @@ FunctionalityMapping OrganizationModelAsk::computeBoundedFunctionalityMapping(
             continue;
         }
 
-        uint32_t numberOfAtoms =
-            numeric::LimitedCombination<owlapi::model::IRI>::totalNumberOfAtoms(
-                boundedModelPool);
-        if(numberOfAtoms == 0)
+        if(boundedModelPool.numberOfInstances() == 0)
         {
             LOG_INFO_S << "No support for " << functionality.toString();
             continue;
         }
 
-        numeric::LimitedCombination<owlapi::model::IRI> limitedCombination(
-            boundedModelPool,
-            numberOfAtoms,
-            numeric::MAX);
-        size_t count = 0;
-        do
+        ModelPoolCombinationIterator combinations(boundedModelPool);
+        while(combinations.next())
         {
-            IRIList combination = limitedCombination.current();
-            ModelPool combinationModelPool =
-                OrganizationModel::combination2ModelPool(combination);
+            const ModelPool& combinationModelPool = combinations.current();
 
-            LOG_INFO_S << "CHECK COMBINATION: " << count++ << std::endl
-                       << combinationModelPool.toString(4);
-            base::Time start = base::Time::now();
-            bool isFeasiblePool = isFeasible(combinationModelPool);
-
-            base::Time end = base::Time::now();
-            if(isFeasiblePool)
+            if(parallel)
             {
-                LOG_INFO_S << "Is feasible: " << (end - start).toSeconds();
+                combinationChecks.push_back(
+                    CombinationCheck(combinationModelPool,
+                                     boundedModelPool,
+                                     functionality.getModel()));
             } else
             {
-                LOG_INFO_S << "Is not feasible" << (end - start).toSeconds();
+                exploreCombination(functionalityMapping,
+                                   combinationModelPool,
+                                   boundedModelPool,
+                                   functionality.getModel());
             }
+        }
+
+    } // end for functionalities
+
+    if(!combinationChecks.empty())
+    {
+        LOG_INFO_S << "Checking " << combinationChecks.size()
+                   << " combinations using "
+                   << utils::Parallel::getNumberOfThreads(
+                          mpCore->numberOfThreads)
+                   << " threads";
+
+        std::vector<FunctionalityMapping> partialMappings(
+            combinationChecks.size());
+        utils::Parallel::forEach(
+            combinationChecks.size(),
+            [this, &combinationChecks, &partialMappings](size_t i) {
+                const CombinationCheck& check = combinationChecks[i];
+                exploreCombination(partialMappings[i],
+                                   std::get<0>(check),
+                                   std::get<1>(check),
+                                   std::get<2>(check));
+            },
+            mpCore->numberOfThreads);
+
+        for(const FunctionalityMapping& partialMapping : partialMappings)
+        {
+            functionalityMapping.merge(partialMapping);
+        }
+    }
+
+    return functionalityMapping;
+}
+
+void OrganizationModelAsk::exploreCombination(
+    FunctionalityMapping& functionalityMapping,
+    const ModelPool& combinationModelPool,
+    const ModelPool& boundedModelPool,
+    const owlapi::model::IRI& functionality) const
+{
+    LOG_INFO_S << "CHECK COMBINATION: " << std::endl
+               << combinationModelPool.toString(4);
+    base::Time start = base::Time::now();
+    bool isFeasiblePool = isFeasible(combinationModelPool);
+
+    base::Time end = base::Time::now();
+    if(isFeasiblePool)
+    {
+        LOG_INFO_S << "Is feasible: " << (end - start).toSeconds();
+    } else
+    {
+        LOG_INFO_S << "Is not feasible" << (end - start).toSeconds();
+    }
 
-            // identify the potential additions
-            ModelPool explorePool;
-            if(mStructuralNeighbourhood > 0)
+    // identify the potential additions
+    ModelPool explorePool;
+    if(mpCore->structuralNeighbourhood > 0)
+    {
+        // Handle a bound that represents only structurally infeasible
+        // systems
+        if(!combinationModelPool.isNull() && !isFeasiblePool)
+        {
+            for(const ModelPool::value_type& v : mpCore->modelPool)
             {
-                // Handle a bound that represents only structurally infeasible
-                // systems
-                if(!combinationModelPool.isNull() &&
-                   !isFeasible(combinationModelPool))
+                size_t currentModelCardinality =
+                    boundedModelPool.getValue(v.first, 0);
+                if(currentModelCardinality == 0 && v.second > 0)
                 {
-                    for(const ModelPool::value_type& v : mModelPool)
+                    explorePool[v.first] = v.second;
+                } else
+                {
+                    // check for types that are funtionally bounded
+                    // (but can still contribute structurally)
+                    size_t remaining = v.second - currentModelCardinality;
+                    if(remaining > 0)
                     {
-                        size_t currentModelCardinality =
-                            boundedModelPool[v.first];
-                        if(currentModelCardinality == 0 && v.second > 0)
-                        {
-                            explorePool[v.first] = v.second;
-                        } else
-                        {
-                            // check for types that are funtionally bounded
-                            // (but can still contribute structurally)
-                            size_t remaining =
-                                v.second - currentModelCardinality;
-                            if(remaining > 0)
-                            {
-                                explorePool[v.first] = remaining;
-                            }
-                        }
+                        explorePool[v.first] = remaining;
                     }
                 }
             }
+        }
+    }
 
-            exploreNeighbourhood(functionalityMapping,
-                                 combinationModelPool,
-                                 explorePool,
-                                 functionality.getModel(),
-                                 mStructuralNeighbourhood);
-        } while(limitedCombination.next());
-
-    } // end for functionalities
-
-    return functionalityMapping;
+    exploreNeighbourhood(functionalityMapping,
+                         combinationModelPool,
+                         explorePool,
+                         functionality,
+                         mpCore->structuralNeighbourhood);
 }
 
 bool OrganizationModelAsk::addFunctionalityMapping(
@@ -390,11 +651,8 @@ bool OrganizationModelAsk::addFunctionalityMapping(
         LOG_DEBUG_S << "combination is minimal for " << functionality.toString()
                     << std::endl
                     << combinationModelPool.toString(4);
-        if(algebra::Connectivity::isFeasible(combinationModelPool,
-                                             *this,
-                                             mFeasibilityCheckTimeoutInMs,
-                                             1, // minFeasible
-                                             mInterfaceBaseClass))
+        if(isFeasible(combinationModelPool,
+                      mpCore->feasibilityCheckTimeoutInMs))
         {
             LOG_DEBUG_S << "combination is feasible " << std::endl
                         << combinationModelPool.toString(4);
@@ -418,74 +676,118 @@ FunctionalityMapping OrganizationModelAsk::computeUnboundedFunctionalityMapping(
         functionalityMapping.getFunctionalSaturationBound();
 
     // Compute now all feasible combinations (which have been bounded by the
-    // functionality saturation bound)
-    numeric::LimitedCombination<owlapi::model::IRI> limitedCombination(
-        boundedModelPool,
-        numeric::LimitedCombination<owlapi::model::IRI>::totalNumberOfAtoms(
-            boundedModelPool),
-        numeric::MAX);
+    // functionality saturation bound) -- the support of the combinations is
+    // checked in chunks
+    const size_t chunkSize = 1024;
+    ModelPoolCombinationIterator combinations(boundedModelPool);
 
     uint32_t count = 0;
-    do
-    {
-        // Get the current model combination
-        IRIList combination = limitedCombination.current();
-        // Make sure we have a consistent ordering
-        LOG_INFO_S << "Sort";
-        {
-            base::Time startTime = base::Time::now();
-            std::sort(combination.begin(), combination.end());
-            base::Time stopTime = base::Time::now();
-            LOG_INFO_S << "   | --> required time: "
-                       << (stopTime - startTime).toSeconds();
-        }
-
-        LOG_DEBUG_S << "Check combination #" << ++count << std::endl
-                    << "   | --> combination:             " << combination
-                    << std::endl
+    ModelPool::List combinationModelPools;
+    while(combinations.nextChunk(combinationModelPools, chunkSize))
+    {
+        count += combinationModelPools.size();
+        LOG_DEBUG_S << "Check combinations #" << count << std::endl
                     << "   | --> possible functionality models: "
                     << functionalityModels << std::endl;
 
-        ModelPool combinationModelPool =
-            OrganizationModel::combination2ModelPool(combination);
+        addSupportedFunctionalities(functionalityMapping,
+                                    combinationModelPools,
+                                    functionalityModels);
+    }
+
+    return functionalityMapping;
+}
 
-        // system that already provides full support for this functionality
-        owlapi::model::IRIList::const_iterator cit =
-            functionalityModels.begin();
-        for(; cit != functionalityModels.end(); ++cit)
+void OrganizationModelAsk::addSupportedFunctionalities(
+    FunctionalityMapping& functionalityMapping,
+    const ModelPool::List& combinationModelPools,
+    const IRIList& functionalityModels) const
+{
+    // Collect the combinations that already provide full support for a
+    // functionality
+    typedef std::pair<const ModelPool*, owlapi::model::IRI> Candidate;
+    std::vector<Candidate> candidates;
+    owlapi::model::IRIList::const_iterator cit = functionalityModels.begin();
+    for(; cit != functionalityModels.end(); ++cit)
+    {
+        Resource::Set functionalities;
+        functionalities.insert(Resource(*cit));
+        std::vector<algebra::SupportType> supportTypes =
+            getSupportTypes(functionalities, combinationModelPools);
+        for(size_t i = 0; i < supportTypes.size(); ++i)
         {
-            Resource functionality(*cit);
-            algebra::SupportType supportType =
-                getSupportType(functionality, combinationModelPool);
-            if(algebra::FULL_SUPPORT == supportType)
+            if(algebra::FULL_SUPPORT == supportTypes[i])
             {
-                if(!addFunctionalityMapping(functionalityMapping,
-                                            combinationModelPool,
-                                            functionality.getModel(),
-                                            false))
-                {
-                    LOG_DEBUG_S
-                        << "Failed to add to functionality mapping:"
+                candidates.push_back(
+                    Candidate(&combinationModelPools[i], *cit));
+            }
+        }
+    }
+
+    auto addCandidate = [this](FunctionalityMapping& mapping,
+                               const Candidate& candidate) {
+        if(!addFunctionalityMapping(mapping,
+                                    *candidate.first,
+                                    candidate.second,
+                                    false))
+        {
+            LOG_DEBUG_S << "Failed to add to functionality mapping:"
                         << std::endl
                         << "    functionality: "
-                        << functionality.getModel().toString() << std::endl
+                        << candidate.second.toString() << std::endl
                         << "    combination: \n"
-                        << combinationModelPool.toString(8) << std::endl;
-                }
-            }
+                        << candidate.first->toString(8) << std::endl;
         }
-    } while(limitedCombination.next());
-
-    return functionalityMapping;
+    };
+
+    bool parallel =
+        utils::Parallel::getNumberOfThreads(mpCore->numberOfThreads) > 1;
+    if(parallel && candidates.size() > 1)
+    {
+        LOG_INFO_S << "Checking " << candidates.size()
+                   << " combinations using "
+                   << utils::Parallel::getNumberOfThreads(
+                          mpCore->numberOfThreads)
+                   << " threads";
+
+        std::vector<FunctionalityMapping> partialMappings(candidates.size());
+        utils::Parallel::forEach(
+            candidates.size(),
+            [&addCandidate, &candidates, &partialMappings](size_t i) {
+                addCandidate(partialMappings[i], candidates[i]);
+            },
+            mpCore->numberOfThreads);
+
+        for(const FunctionalityMapping& partialMapping : partialMappings)
+        {
+            functionalityMapping.merge(partialMapping);
+        }
+    } else
+    {
+        for(const Candidate& candidate : candidates)
+        {
+            addCandidate(functionalityMapping, candidate);
+        }
+    }
 }
 
 bool OrganizationModelAsk::isMinimal(const ModelPool& modelPool,
                                      const Resource::Set& functionalities) const
 {
-    // Check overall support
-    algebra::SupportType supportType =
-        getSupportType(functionalities, modelPool);
-    if(algebra::FULL_SUPPORT != supportType)
+    // Check overall support and the support of the individual models at once
+    ModelPool::List modelPools;
+    modelPools.push_back(modelPool);
+    ModelPool::const_iterator mit = modelPool.begin();
+    for(; mit != modelPool.end(); ++mit)
+    {
+        ModelPool singleModelPool;
+        singleModelPool.insert(*mit);
+        modelPools.push_back(singleModelPool);
+    }
+    std::vector<algebra::SupportType> supportTypes =
+        getSupportTypes(functionalities, modelPools);
+
+    if(algebra::FULL_SUPPORT != supportTypes[0])
     {
         LOG_INFO_S << "No full support for "
                    << Resource::toString(functionalities) << " by " << std::endl
@@ -500,11 +802,10 @@ bool OrganizationModelAsk::isMinimal(const ModelPool& modelPool,
     bool hasSingleModelPartialSupport = false;
     // gather all models that provide only partial support
     ModelPool partialSupport;
-    ModelPool::const_iterator mit = modelPool.begin();
-    for(; mit != modelPool.end(); ++mit)
+    mit = modelPool.begin();
+    for(size_t i = 1; mit != modelPool.end(); ++mit, ++i)
     {
-        algebra::SupportType type =
-            getSupportType(functionalities, mit->first, mit->second);
+        algebra::SupportType type = supportTypes[i];
         LOG_DEBUG_S << "Support from: #" << mit->second << " of type "
                     << mit->first << " is: " << algebra::SupportTypeTxt[type];
         switch(type)
@@ -551,14 +852,19 @@ bool OrganizationModelAsk::isMinimal(const ModelPool& modelPool,
         // has partial support, thus check that for that particular
         // combination that it contains no redundancies, i.e. we cannot
         // remove any model instance to provide full support
+        ModelPool::List reducedModelPools;
         ModelPool::const_iterator pit = partialSupport.begin();
         for(; pit != partialSupport.end(); ++pit)
         {
             ModelPool reduced = partialSupport;
             --reduced[pit->first];
+            reducedModelPools.push_back(reduced);
+        }
 
-            algebra::SupportType reducedSupport =
-                getSupportType(functionalities, reduced);
+        std::vector<algebra::SupportType> reducedSupportTypes =
+            getSupportTypes(functionalities, reducedModelPools);
+        for(algebra::SupportType reducedSupport : reducedSupportTypes)
+        {
             // Is reduced, but still has full support, i.e. must be exceeding
             // saturation
             if(reducedSupport == algebra::FULL_SUPPORT)
@@ -660,11 +966,17 @@ OrganizationModelAsk::getCardinalityRestrictions(
     owlapi::model::OWLCardinalityRestriction::OperationType operationType,
     bool max2Min) const
 {
+    boost::unique_lock<boost::recursive_mutex> lock(
+        mpCore->organizationModel->getOntologyMutex());
+    QueryCache& queryCache = *mpCore->organizationModel->mpQueryCache;
+    // Intern the pool once for both lookup and insertion
+    CompactModelPool compactModelPool(modelPool,
+                                      queryCache.getModelRegistry());
     std::pair<owlapi::model::OWLCardinalityRestriction::PtrList, bool> result =
-        mpOrganizationModel->mQueryCache.getCachedResult(modelPool,
-                                                         objectProperty,
-                                                         operationType,
-                                                         max2Min);
+        queryCache.getCachedResult(compactModelPool,
+                                   objectProperty,
+                                   operationType,
+                                   max2Min);
 
     if(result.second)
     {
@@ -684,9 +996,10 @@ OrganizationModelAsk::getCardinalityRestrictions(
         uint32_t modelCount = mit->second;
 
         OWLCardinalityRestriction::PtrList availableResources =
-            mOntologyAsk.getCardinalityRestrictions(model,
-                                                    objectProperty,
-                                                    true /*includeAncestors*/);
+            mpCore->ontologyAsk.getCardinalityRestrictions(
+                model,
+                objectProperty,
+                true /*includeAncestors*/);
 
         // This is not a meta constraint, but a direct representation of an
         // atomic resource, so add the exact availability of the given high
@@ -694,7 +1007,7 @@ OrganizationModelAsk::getCardinalityRestrictions(
         if(availableResources.empty())
         {
             OWLClassExpression::Ptr klass =
-                mOntologyAsk.getOWLClassExpression(mit->first);
+                mpCore->ontologyAsk.getOWLClassExpression(mit->first);
 
             OWLCardinalityRestriction::Ptr highlevelModelMaxConstraint =
                 OWLCardinalityRestriction::getInstance(
@@ -730,8 +1043,8 @@ OrganizationModelAsk::getCardinalityRestrictions(
                               OWLCardinalityRestriction::MAX)
             {
                 OWLClassExpression::Ptr klass =
-                    mOntologyAsk.getOWLClassExpression(
-                        restriction->getQualification());
+                    mpCore->ontologyAsk.getOWLClassExpression(
+                               restriction->getQualification());
 
                 OWLCardinalityRestriction::Ptr converted =
                     OWLCardinalityRestriction::getInstance(
@@ -754,11 +1067,11 @@ OrganizationModelAsk::getCardinalityRestrictions(
                                                operationType);
     }
 
-    mpOrganizationModel->mQueryCache.cacheResult(modelPool,
-                                                 objectProperty,
-                                                 operationType,
-                                                 max2Min,
-                                                 allAvailableResources);
+    queryCache.cacheResult(compactModelPool,
+                           objectProperty,
+                           operationType,
+                           max2Min,
+                           allAvailableResources);
 
     return allAvailableResources;
 }
@@ -802,21 +1115,36 @@ OrganizationModelAsk::getRelated(const owlapi::model::IRI& model,
                                  const owlapi::model::IRI& objectProperty,
                                  bool includeFunctionalities) const
 {
-    std::map<IRI, ResourceInstance::PtrList>::const_iterator cit =
-        mRelatedResourceCache.find(model);
-    if(mRelatedResourceCache.end() != cit)
+    boost::unique_lock<boost::recursive_mutex> lock(
+        mpCore->organizationModel->getOntologyMutex());
+    RelatedResourceCache& cache = *mpCore->relatedResourceCache;
+    uint64_t revision = mpCore->organizationModel->getRevision();
+    if(cache.revision != revision)
+    {
+        cache.instances.clear();
+        cache.revision = revision;
+    }
+
+    RelatedResourceCache::Key key = std::make_tuple(
+        model, qualification, objectProperty, includeFunctionalities);
+    std::map<RelatedResourceCache::Key,
+             ResourceInstance::PtrList>::const_iterator cit =
+        cache.instances.find(key);
+    if(cache.instances.end() != cit)
     {
         return cit->second;
     }
 
     ResourceInstance::PtrList resourceInstances;
     IRIList relatedInstances =
-        mOntologyAsk.allRelatedInstances(model, objectProperty, qualification);
+        mpCore->ontologyAsk.allRelatedInstances(model,
+                                                objectProperty,
+                                                qualification);
     for(const IRI& relatedInstance : relatedInstances)
     {
         bool direct = true;
         IRIList relatedInstanceModels =
-            mOntologyAsk.allTypesOf(relatedInstance, direct);
+            mpCore->ontologyAsk.allTypesOf(relatedInstance, direct);
         ResourceInstance::Ptr r =
             make_shared<ResourceInstance>(relatedInstance,
                                           relatedInstanceModels.front());
@@ -824,10 +1152,11 @@ OrganizationModelAsk::getRelated(const owlapi::model::IRI& model,
     }
     if(includeFunctionalities)
     {
-        IRIList types = mOntologyAsk.allTypesOf(model);
+        IRIList types = mpCore->ontologyAsk.allTypesOf(model);
         for(const IRI& type : types)
         {
-            if(mOntologyAsk.isSubClassOf(type, vocabulary::OM::Functionality()))
+            if(mpCore->ontologyAsk.isSubClassOf(
+                   type, vocabulary::OM::Functionality()))
             {
                 ResourceInstance::Ptr r =
                     make_shared<ResourceInstance>(type, type);
@@ -836,7 +1165,7 @@ OrganizationModelAsk::getRelated(const owlapi::model::IRI& model,
         }
     }
 
-    mRelatedResourceCache[model] = resourceInstances;
+    cache.instances[key] = resourceInstances;
     return resourceInstances;
 }
 
@@ -864,14 +1193,14 @@ OrganizationModelAsk::getResourceSupport(const Resource& resource) const
     // If there are no property constraints
     if(resource.getPropertyConstraints().empty())
     {
-        return mFunctionalityMapping.getModelPools(functionalityModel);
+        return mpCore->functionalityMapping.getModelPools(functionalityModel);
     }
 
     try
     {
         // Computing all model combination that support this functionality
         ModelPool::Set modelPoolSet =
-            mFunctionalityMapping.getModelPools(functionalityModel);
+            mpCore->functionalityMapping.getModelPools(functionalityModel);
         ModelPool::Set supportPool;
 
         std::vector<double> scalingFactors =
@@ -897,7 +1226,7 @@ OrganizationModelAsk::getResourceSupport(const Resource& resource) const
 
         ModelPool::Set boundedSupportPool;
         // Check if the scaled variant lies within general resource bounds
-        if(mModelPool.empty())
+        if(mpCore->modelPool.empty())
         {
             LOG_WARN_S
                 << "moreorg::OrganizationModelAsk::getResourceSupport: could "
@@ -906,7 +1235,7 @@ OrganizationModelAsk::getResourceSupport(const Resource& resource) const
             return supportPool;
         } else
         {
-            return ModelPool::applyUpperBound(supportPool, mModelPool);
+            return ModelPool::applyUpperBound(supportPool, mpCore->modelPool);
         }
     } catch(const std::invalid_argument& e)
     {
@@ -981,6 +1310,9 @@ algebra::SupportType
 OrganizationModelAsk::getSupportType(const Resource::Set& functionalities,
                                      const ModelPool& modelPool) const
 {
+    // The ontology is locked only by getSupportVector, when querying the
+    // cardinality restrictions, so that support checks of parallel workers
+    // do not serialise on the ontology mutex
     IRIList functionalityModels;
     Resource::Set::const_iterator fit = functionalities.begin();
     for(; fit != functionalities.end(); ++fit)
@@ -1029,12 +1361,215 @@ OrganizationModelAsk::getSupportType(const Resource& functionality,
     return getSupportType(functionalities, modelPool);
 }
 
+std::vector<algebra::SupportType>
+OrganizationModelAsk::getSupportTypes(const Resource::Set& functionalities,
+                                      const ModelPool::List& modelPools) const
+{
+    std::vector<algebra::SupportType> supportTypes(modelPools.size(),
+                                                   algebra::NO_SUPPORT);
+    if(modelPools.empty())
+    {
+        return supportTypes;
+    }
+
+    IRIList functionalityModels;
+    Resource::Set::const_iterator fit = functionalities.begin();
+    for(; fit != functionalities.end(); ++fit)
+    {
+        functionalityModels.push_back(fit->getModel());
+    }
+
+    // Define what is required
+    algebra::ResourceSupportVector functionalitySupportVector =
+        getSupportVector(functionalityModels,
+                         IRIList() /*filter labels*/,
+                         false /*useMaxCardinality*/);
+    const IRIList& labels = functionalitySupportVector.getLabels();
+
+    // Index the models of all pools
+    std::map<IRI, size_t> modelIndex;
+    IRIList models;
+    for(const ModelPool& modelPool : modelPools)
+    {
+        for(const ModelPool::value_type& v : modelPool)
+        {
+            if(modelIndex.insert(std::make_pair(v.first, models.size())).second)
+            {
+                models.push_back(v.first);
+            }
+        }
+    }
+
+    // Gather what is available per model: one column per model, one row per
+    // label
+    base::MatrixXd modelSupport = base::MatrixXd::Zero(labels.size(),
+                                                       models.size());
+    std::vector<bool> hasLabels(models.size(), true);
+    for(size_t m = 0; m < models.size(); ++m)
+    {
+        algebra::ResourceSupportVector support =
+            getSupportVector(models[m], labels, true);
+        if(support.getLabels() == labels)
+        {
+            modelSupport.col(m) = support.getSizes();
+        } else if(support.getSizes().norm() != 0)
+        {
+            // Support vector does not map to the required labels -- leave
+            // handling to the single pool version
+            hasLabels[m] = false;
+        }
+    }
+
+    base::MatrixXd counts = base::MatrixXd::Zero(models.size(),
+                                                 modelPools.size());
+    std::vector<bool> requiresSingleCheck(modelPools.size(), labels.empty());
+    for(size_t p = 0; p < modelPools.size(); ++p)
+    {
+        for(const ModelPool::value_type& v : modelPools[p])
+        {
+            size_t m = modelIndex[v.first];
+            counts(m, p) = static_cast<double>(v.second);
+            if(v.second != 0 && !hasLabels[m])
+            {
+                requiresSingleCheck[p] = true;
+            }
+        }
+    }
+
+    // Expand the support to account for subclasses, which is a linear
+    // transformation, so it can be applied to the per model support and to
+    // the requirement once
+    algebra::ResourceSupportVector::embedClassRelationship(labels,
+                                                           modelSupport,
+                                                           *this);
+    base::MatrixXd required = functionalitySupportVector.getSizes();
+    algebra::ResourceSupportVector::embedClassRelationship(labels,
+                                                           required,
+                                                           *this);
+
+    // Support of all pools in a single product
+    base::MatrixXd available = modelSupport * counts;
+    for(size_t p = 0; p < modelPools.size(); ++p)
+    {
+        if(requiresSingleCheck[p])
+        {
+            supportTypes[p] = getSupportType(functionalities, modelPools[p]);
+        } else if((available.col(p).array() >= required.col(0).array()).all())
+        {
+            supportTypes[p] = algebra::FULL_SUPPORT;
+        } else if(available.col(p).dot(required.col(0)) != 0)
+        {
+            supportTypes[p] = algebra::PARTIAL_SUPPORT;
+        }
+    }
+    return supportTypes;
+}
+
 uint32_t OrganizationModelAsk::getFunctionalSaturationBound(
     const owlapi::model::IRI& requirementModel,
     const owlapi::model::IRI& model) const
 {
+    boost::unique_lock<boost::recursive_mutex> lock(
+        mpCore->organizationModel->getOntologyMutex());
+    std::map<std::pair<IRI, IRI>, uint32_t>& bounds =
+        getSaturationBoundCache();
+    std::pair<IRI, IRI> key(requirementModel, model);
+    std::map<std::pair<IRI, IRI>, uint32_t>::const_iterator cit =
+        bounds.find(key);
+    if(cit != bounds.end())
+    {
+        return cit->second;
+    }
+
     LOG_DEBUG_S << "Get functional saturation bound for " << requirementModel
                 << " for model '" << model << "'";
+    algebra::ResourceSupportVector requirementSupportVector =
+        getRequirementSupportVector(requirementModel);
+    uint32_t bound = computeFunctionalSaturationBound(
+        requirementSupportVector,
+        requirementSupportVector.embedClassRelationship(*this),
+        model);
+    bounds[key] = bound;
+    return bound;
+}
+
+std::map<owlapi::model::IRI, ModelPool>
+OrganizationModelAsk::getFunctionalSaturationBounds() const
+{
+    IRIList models;
+    for(const ModelPool::value_type& pair : mpCore->modelPool)
+    {
+        models.push_back(pair.first);
+    }
+    return getFunctionalSaturationBounds(getFunctionalities(), models);
+}
+
+std::map<owlapi::model::IRI, ModelPool>
+OrganizationModelAsk::getFunctionalSaturationBounds(
+    const owlapi::model::IRIList& requirementModels,
+    const owlapi::model::IRIList& models) const
+{
+    boost::unique_lock<boost::recursive_mutex> lock(
+        mpCore->organizationModel->getOntologyMutex());
+    std::map<std::pair<IRI, IRI>, uint32_t>& bounds =
+        getSaturationBoundCache();
+
+    std::map<IRI, ModelPool> saturationBounds;
+    for(const IRI& requirementModel : requirementModels)
+    {
+        ModelPool& modelBounds = saturationBounds[requirementModel];
+
+        // The requirement is computed only once, and only if any bound is
+        // missing
+        algebra::ResourceSupportVector requirementSupportVector;
+        algebra::ResourceSupportVector embeddedRequirementSupportVector;
+        bool hasRequirement = false;
+        for(const IRI& model : models)
+        {
+            std::pair<IRI, IRI> key(requirementModel, model);
+            std::map<std::pair<IRI, IRI>, uint32_t>::const_iterator cit =
+                bounds.find(key);
+            if(cit != bounds.end())
+            {
+                modelBounds[model] = cit->second;
+                continue;
+            }
+
+            if(!hasRequirement)
+            {
+                requirementSupportVector =
+                    getRequirementSupportVector(requirementModel);
+                embeddedRequirementSupportVector =
+                    requirementSupportVector.embedClassRelationship(*this);
+                hasRequirement = true;
+            }
+            uint32_t bound = computeFunctionalSaturationBound(
+                requirementSupportVector,
+                embeddedRequirementSupportVector,
+                model);
+            bounds[key] = bound;
+            modelBounds[model] = bound;
+        }
+    }
+    return saturationBounds;
+}
+
+std::map<std::pair<owlapi::model::IRI, owlapi::model::IRI>, uint32_t>&
+OrganizationModelAsk::getSaturationBoundCache() const
+{
+    uint64_t revision = mpCore->organizationModel->getRevision();
+    if(mpCore->saturationBoundCache->revision != revision)
+    {
+        mpCore->saturationBoundCache->bounds.clear();
+        mpCore->saturationBoundCache->revision = revision;
+    }
+    return mpCore->saturationBoundCache->bounds;
+}
+
+algebra::ResourceSupportVector
+OrganizationModelAsk::getRequirementSupportVector(
+    const owlapi::model::IRI& requirementModel) const
+{
     // Collect requirements, i.e., max cardinalities
     algebra::ResourceSupportVector requirementSupportVector =
         getSupportVector(requirementModel,
@@ -1050,10 +1585,15 @@ uint32_t OrganizationModelAsk::getFunctionalSaturationBound(
             algebra::ResourceSupportVector(required, labels);
         LOG_DEBUG_S << "functionality support vector is null : using "
                     << requirementSupportVector.toString();
-    } else
-    {
-        LOG_DEBUG_S << "Get model support vector";
     }
+    return requirementSupportVector;
+}
+
+uint32_t OrganizationModelAsk::computeFunctionalSaturationBound(
+    const algebra::ResourceSupportVector& requirementSupportVector,
+    const algebra::ResourceSupportVector& embeddedRequirementSupportVector,
+    const owlapi::model::IRI& model) const
+{
     // Collect available resources -- and limit to the required ones
     // (getSupportVector will accumulate all (subclass) models)
     algebra::ResourceSupportVector modelSupportVector =
@@ -1065,16 +1605,14 @@ uint32_t OrganizationModelAsk::getFunctionalSaturationBound(
 
     // Expand the support vectors to account for subclasses within the required
     // scope
-    requirementSupportVector =
-        requirementSupportVector.embedClassRelationship(*this);
     modelSupportVector = modelSupportVector.embedClassRelationship(*this);
 
     // Compute the support ratios
     algebra::ResourceSupportVector ratios =
-        requirementSupportVector.getRatios(modelSupportVector);
+        embeddedRequirementSupportVector.getRatios(modelSupportVector);
 
     LOG_DEBUG_S << "Requirement: " << std::endl
-                << requirementSupportVector.toString(4);
+                << embeddedRequirementSupportVector.toString(4);
     LOG_DEBUG_S << "Provider: " << std::endl << modelSupportVector.toString(4);
     LOG_DEBUG_S << "Ratios: " << std::endl << ratios.toString(4);
 
@@ -1098,7 +1636,7 @@ uint32_t OrganizationModelAsk::getFunctionalSaturationBound(
 ModelPool OrganizationModelAsk::getFunctionalSaturationBound(
     const Resource& resource) const
 {
-    if(mModelPool.empty())
+    if(mpCore->modelPool.empty())
     {
         throw std::invalid_argument(
             "moreorg::OrganizationModelAsk::getFunctionalSaturationBound:"
@@ -1108,7 +1646,7 @@ ModelPool OrganizationModelAsk::getFunctionalSaturationBound(
     }
 
     ModelPool upperBounds;
-    for(const ModelPool::value_type& pair : mModelPool)
+    for(const ModelPool::value_type& pair : mpCore->modelPool)
     {
         const owlapi::model::IRI& modelName = pair.first;
 
@@ -1142,23 +1680,20 @@ ModelPool OrganizationModelAsk::getFunctionalSaturationBound(
 ModelPool OrganizationModelAsk::getFunctionalSaturationBound(
     const Resource::Set& functionalities) const
 {
-    ModelPool upperBounds;
+    ModelRegistry& registry = mpCore->organizationModel->getModelRegistry();
+    CompactModelPool upperBounds;
     Resource::Set::const_iterator cit = functionalities.begin();
     for(; cit != functionalities.end(); ++cit)
     {
         // Return the functional saturation for this functionality
-        ModelPool saturation = getFunctionalSaturationBound(*cit);
+        CompactModelPool saturation(getFunctionalSaturationBound(*cit),
+                                    registry);
 
         // the maximum required value for a functionality sets the functional
         // saturation bound
-        ModelPool::const_iterator mit = saturation.begin();
-        for(; mit != saturation.end(); ++mit)
-        {
-            upperBounds[mit->first] =
-                std::max(upperBounds[mit->first], saturation[mit->first]);
-        }
+        upperBounds = CompactModelPool::max(upperBounds, saturation);
     }
-    return upperBounds;
+    return upperBounds.toModelPool(registry);
 }
 
 bool OrganizationModelAsk::canBeDistinct(const ModelCombination& a,
@@ -1168,7 +1703,7 @@ bool OrganizationModelAsk::canBeDistinct(const ModelCombination& a,
     ModelPool poolB = OrganizationModel::combination2ModelPool(b);
 
     ModelPoolDelta totalRequirements = Algebra::sum(poolA, poolB);
-    ModelPoolDelta delta = Algebra::delta(totalRequirements, mModelPool);
+    ModelPoolDelta delta = Algebra::delta(totalRequirements, mpCore->modelPool);
 
     return delta.isNegative();
 }
@@ -1186,7 +1721,8 @@ ModelPool::Set OrganizationModelAsk::getIntersection(
         try
         {
             const ModelPool::Set& modelPools =
-                mFunctionalityMapping.getModelPools(functionality.getModel());
+                mpCore->functionalityMapping.getModelPools(
+                    functionality.getModel());
 
             if(init)
             {
@@ -1209,7 +1745,7 @@ ModelPool::Set OrganizationModelAsk::getIntersection(
             LOG_WARN_S << "Could not find functionality: "
                        << functionality.getModel().toString() << std::endl
                        << "current functionality mappping: " << std::endl
-                       << mFunctionalityMapping.toString(4);
+                       << mpCore->functionalityMapping.toString(4);
 
             throw std::runtime_error(
                 "moreorg::OrganizationModelAsk::isSupporting"
@@ -1226,7 +1762,11 @@ bool OrganizationModelAsk::isSupporting(
     double feasibilityCheckTimeoutInMs) const
 {
 
-    ModelPool::Set supportPools = getIntersection(resources);
+    shared_ptr<const CompactModelPool::List> supportPools =
+        getSupportPools(resources);
+    CompactModelPool compactModelPool(
+        modelPool,
+        mpCore->organizationModel->getModelRegistry());
 
     // Any of the support models is assumed to be a minimal subset, e.g. with
     // functional saturation
@@ -1235,34 +1775,63 @@ bool OrganizationModelAsk::isSupporting(
     // coalition is large and for example mass constraints prevent it from
     // functioning -- find a general way for representation:
     // by sat bound limited agents + negative effects
-    ModelPool::Set::const_iterator pit =
-        std::find_if(supportPools.begin(),
-                     supportPools.end(),
-                     [modelPool](const ModelPool& other) {
+    CompactModelPool::List::const_iterator pit =
+        std::find_if(supportPools->begin(),
+                     supportPools->end(),
+                     [&compactModelPool](const CompactModelPool& other) {
                          // check if other is a subset of the given model pool
-                         return Algebra::isSubset(other, modelPool);
+                         return CompactModelPool::isSubset(other,
+                                                           compactModelPool);
                      });
 
-    if(pit != supportPools.end())
+    if(pit != supportPools->end())
     {
         // what is left to be checked is whether this pool is actually feasible
         return algebra::Connectivity::isFeasible(modelPool,
                                                  *this,
                                                  feasibilityCheckTimeoutInMs,
                                                  1, // minFeasible
-                                                 mInterfaceBaseClass);
+                                                 mpCore->interfaceBaseClass);
     } else
     {
         return false;
     }
 }
 
+shared_ptr<const CompactModelPool::List>
+OrganizationModelAsk::getSupportPools(const Resource::Set& resources) const
+{
+    SupportPoolCache& cache = *mpCore->supportPoolCache;
+    {
+        boost::unique_lock<boost::mutex> lock(cache.mutex);
+        std::map<Resource::Set,
+                 shared_ptr<const CompactModelPool::List>>::const_iterator cit =
+            cache.pools.find(resources);
+        if(cit != cache.pools.end())
+        {
+            return cit->second;
+        }
+    }
+
+    ModelRegistry& registry = mpCore->organizationModel->getModelRegistry();
+    shared_ptr<CompactModelPool::List> pools =
+        make_shared<CompactModelPool::List>();
+    for(const ModelPool& pool : getIntersection(resources))
+    {
+        pools->push_back(CompactModelPool(pool, registry));
+    }
+
+    boost::unique_lock<boost::mutex> lock(cache.mutex);
+    // Keep the pools of a concurrent computation, which has been stored first
+    return cache.pools.emplace(resources, pools).first->second;
+}
+
 bool OrganizationModelAsk::isSupporting(const ModelPool& pool,
                                         const Resource& resource) const
 {
     Resource::Set resources;
     resources.insert(resource);
-    return isSupporting(pool, resources, mFeasibilityCheckTimeoutInMs);
+    return isSupporting(pool, resources, mpCore->feasibilityCheckTimeoutInMs);
 }
 
 bool OrganizationModelAsk::isSupporting(const owlapi::model::IRI& model,
@@ -1273,7 +1842,7 @@ bool OrganizationModelAsk::isSupporting(const owlapi::model::IRI& model,
 
     Resource::Set resources;
     resources.insert(resource);
-    if(isSupporting(modelPool, resources, mFeasibilityCheckTimeoutInMs))
+    if(isSupporting(modelPool, resources, mpCore->feasibilityCheckTimeoutInMs))
     {
         LOG_DEBUG_S << "model '" << model << "' supports '"
                     << resource.getModel() << "'";
@@ -1292,11 +1861,15 @@ algebra::ResourceSupportVector OrganizationModelAsk::getSupportVector(
     bool useMaxCardinality) const
 {
     using namespace owlapi::model;
-    std::vector<OWLCardinalityRestriction::Ptr> restrictions =
-        mOntologyAsk.getCardinalityRestrictions(
+    std::vector<OWLCardinalityRestriction::Ptr> restrictions;
+    {
+        boost::unique_lock<boost::recursive_mutex> lock(
+            mpCore->organizationModel->getOntologyMutex());
+        restrictions = mpCore->ontologyAsk.getCardinalityRestrictions(
             models,
             vocabulary::OM::has(),
             OWLCardinalityRestriction::MAX_OP);
+    }
 
     if(restrictions.empty())
     {
@@ -1399,20 +1972,34 @@ algebra::ResourceSupportVector OrganizationModelAsk::getSupportVector(
 
     vector = base::VectorXd::Zero(labels.size());
 
+    // Intern all classes first, so that the subclass checks below do not
+    // need to query the reasoner
+    IRIList models;
+    for(const std::pair<const IRI, OWLCardinalityRestriction::MinMax>& b :
+        modelBounds)
+    {
+        models.push_back(b.first);
+    }
+    algebra::SubclassClosure::ClassIdList modelIds =
+        mpCore->subclassClosure->getIds(models);
+    algebra::SubclassClosure::ClassIdList labelIds =
+        mpCore->subclassClosure->getIds(labels);
+    algebra::SubclassClosure::Matrix::Ptr closure =
+        mpCore->subclassClosure->getMatrix();
+
     std::vector<IRI>::const_iterator cit = labels.begin();
     uint32_t dimension = 0;
     for(; cit != labels.end(); ++cit)
     {
         const IRI& dimensionLabel = *cit;
+        algebra::SubclassClosure::ClassId labelId = labelIds[dimension];
         std::map<IRI, OWLCardinalityRestriction::MinMax>::const_iterator mit =
             modelBounds.begin();
         bool supportFound = false;
-        for(; mit != modelBounds.end(); ++mit)
+        for(size_t m = 0; mit != modelBounds.end(); ++mit, ++m)
         {
-            const IRI& modelDimensionLabel = mit->first;
             // Sum the requirement/availability of this model type
-            if((dimensionLabel == modelDimensionLabel) ||
-               mOntologyAsk.isSubClassOf(modelDimensionLabel, dimensionLabel))
+            if(closure->isSubClassOf(modelIds[m], labelId))
             {
                 if(useMaxCardinality)
                 {
@@ -1447,9 +2034,9 @@ std::string OrganizationModelAsk::toString() const
 {
     std::stringstream ss;
     ss << "FunctionalityMapping:" << std::endl;
-    ss << mFunctionalityMapping.toString() << std::endl;
+    ss << mpCore->functionalityMapping.toString() << std::endl;
 
-    ModelPoolDelta mp(mModelPool);
+    ModelPoolDelta mp(mpCore->modelPool);
     ss << mp.toString() << std::endl;
     return ss.str();
 }
@@ -1595,9 +2182,7 @@ void OrganizationModelAsk::exploreNeighbourhood(
     const IRI& functionality,
     size_t maxAddedInstances) const
 {
-    size_t numberOfAtoms =
-        numeric::LimitedCombination<owlapi::model::IRI>::totalNumberOfAtoms(
-            maxDelta);
+    size_t numberOfAtoms = maxDelta.numberOfInstances();
     if(numberOfAtoms > maxAddedInstances)
     {
         // Maximum # of indirection for connecting or consideration of
@@ -1626,15 +2211,10 @@ void OrganizationModelAsk::exploreNeighbourhood(
     }
 
     // Explore the neighbourhood, but limiting the compositions in size
-    numeric::LimitedCombination<owlapi::model::IRI> limitedCombination(
-        maxDelta,
-        numberOfAtoms,
-        numeric::MAX);
-    do
-    {
-        IRIList combination = limitedCombination.current();
-        ModelPool combinationModelPool =
-            OrganizationModel::combination2ModelPool(combination);
+    ModelPoolCombinationIterator combinations(maxDelta, numberOfAtoms);
+    while(combinations.next())
+    {
+        const ModelPool& combinationModelPool = combinations.current();
         ModelPool pool =
             Algebra::sum(basePool, combinationModelPool).toModelPool();
 
@@ -1647,7 +2227,7 @@ void OrganizationModelAsk::exploreNeighbourhood(
                         << combinationModelPool.toString(4);
             combinationModelPool.toString(4);
         }
-    } while(limitedCombination.next());
+    }
 }
 
 ModelPool
@@ -1657,7 +2237,7 @@ OrganizationModelAsk::allowSubclasses(const ModelPool& modelPool,
     ModelPool filteredModelPool;
     for(const ModelPool::value_type& p : modelPool)
     {
-        if(mOntologyAsk.isSubClassOf(p.first, parent))
+        if(mpCore->ontologyAsk.isSubClassOf(p.first, parent))
         {
             filteredModelPool.insert(p);
         }
@@ -1668,11 +2248,18 @@ OrganizationModelAsk::allowSubclasses(const ModelPool& modelPool,
 bool OrganizationModelAsk::isFeasible(const ModelPool& modelPool,
                                       double feasibilityCheckTimeoutInMs) const
 {
-    return algebra::Connectivity::isFeasible(modelPool,
-                                             *this,
-                                             feasibilityCheckTimeoutInMs,
-                                             1, // minFeasible
-                                             mInterfaceBaseClass);
+    // Pools are typically grown by single agents, so try to extend the
+    // connection graph of a feasible sub-pool first
+    graph_analysis::BaseGraph::Ptr baseGraph;
+    algebra::Connectivity::Statistics statistics;
+    return algebra::Connectivity::isFeasibleIncremental(
+        modelPool,
+        *this,
+        baseGraph,
+        statistics,
+        feasibilityCheckTimeoutInMs,
+        1, // minFeasible
+        mpCore->interfaceBaseClass);
 }
 
 ModelPool::List OrganizationModelAsk::findFeasibleCoalitionStructure(
@@ -1680,9 +2267,12 @@ ModelPool::List OrganizationModelAsk::findFeasibleCoalitionStructure(
     const Resource::Set& resourceSet,
     double feasibilityCheckTimeoutInMs)
 {
+    QueryCache& queryCache = *mpCore->organizationModel->mpQueryCache;
+    // Intern the pool once for both lookup and insertion
+    CompactModelPool compactModelPool(modelPool,
+                                      queryCache.getModelRegistry());
     std::pair<ModelPool::List, bool> result =
-        mpOrganizationModel->mQueryCache.getCachedResult(modelPool,
-                                                         resourceSet);
+        queryCache.getCachedResult(compactModelPool, resourceSet);
     if(result.second)
     {
         return result.first;
@@ -1726,9 +2316,7 @@ ModelPool::List OrganizationModelAsk::findFeasibleCoalitionStructure(
         }
     }
 
-    mpOrganizationModel->mQueryCache.cacheResult(modelPool,
-                                                 resourceSet,
-                                                 coalitionStructure);
+    queryCache.cacheResult(compactModelPool, resourceSet, coalitionStructure);
     return coalitionStructure;
 }
 
@@ -1742,17 +2330,19 @@ OrganizationModelAsk::getPropertyValues(
     std::map<IRI, std::map<IRI, double>> propertyValues;
 
     IRIList instances =
-        mOntologyAsk.allRelatedInstances(agent, relation, componentKlass);
+        mpCore->ontologyAsk.allRelatedInstances(agent,
+                                                relation,
+                                                componentKlass);
     for(const IRI& instance : instances)
     {
         IRISet relatedDataProperties =
-            mOntologyAsk.getRelatedDataProperties(instance);
+            mpCore->ontologyAsk.getRelatedDataProperties(instance);
         for(const IRI& dataProperty : relatedDataProperties)
         {
             try
             {
                 OWLLiteral::Ptr literal =
-                    mOntologyAsk.getDataValue(instance, dataProperty);
+                    mpCore->ontologyAsk.getDataValue(instance, dataProperty);
                 double value = literal->getDouble();
                 propertyValues[instance][dataProperty] = value;
             } catch(const std::exception& e)
@@ -1,13 +1,18 @@
 #ifndef ORGANIZATION_MODEL_ASK_HPP
 #define ORGANIZATION_MODEL_ASK_HPP
 
+#include <boost/thread/mutex.hpp>
 #include <owlapi/model/OWLCardinalityRestriction.hpp>
 #include <owlapi/model/OWLOntologyAsk.hpp>
+#include <tuple>
 
 #include "Algebra.hpp"
+#include "CompactModelPool.hpp"
 #include "OrganizationModel.hpp"
 #include "SharedPtr.hpp"
+#include "algebra/FeasibilityCache.hpp"
 #include "algebra/ResourceSupportVector.hpp"
+#include "algebra/SubclassClosure.hpp"
 #include "vocabularies/OM.hpp"
 
 namespace moreorg {
@@ -15,6 +20,10 @@ namespace moreorg {
 class Agent;
 class ResourceInstance;
 
+namespace facades {
+class RobotCache;
+}
+
 /**
  * \class OrganizationModelAsk
  * \brief This class allows to create query object to reason about and retrieve
@@ -46,6 +55,8 @@ public:
      * \param feasibilityCheckTimeoutInMs Allow to limit the time for
      * reduce computed combinations to the functional saturation bound --
      * otherwise all feasible combinations are computed
+     * \param numberOfThreads Number of worker threads to use for computing
+     * the functionality mapping, 0 to use all available hardware threads
      */
     explicit OrganizationModelAsk(
         const OrganizationModel::Ptr& om,
@@ -54,16 +65,45 @@ public:
         double feasibilityCheckTimeoutInMs = 20000,
         const owlapi::model::IRI& interfaceBaseClass =
             vocabulary::OM::resolve("ElectroMechanicalInterface"),
-        size_t neighbourHood = 3);
+        size_t neighbourHood = 3,
+        size_t numberOfThreads = 1);
 
-    static const OrganizationModelAsk&
+    /**
+     * Get a shared instance of the organization model ask for the given
+     * organization model and options
+     *
+     * Instances are kept in a registry, so that the functionality mapping
+     * for the same organization model, model pool and options is computed
+     * only once -- concurrent requests for the same key wait for the
+     * construction in the first requesting thread
+     * \see OrganizationModelAsk::OrganizationModelAsk for the parameters
+     * \return shared instance
+     */
+    static Ptr
     getInstance(const OrganizationModel::Ptr& om,
                 const ModelPool& modelPool = ModelPool(),
                 bool applyFunctionalSaturationBound = false,
                 double feasibilityCheckTimeoutInMs = 20000,
                 const owlapi::model::IRI& interfaceBaseClass =
                     vocabulary::OM::resolve("ElectroMechanicalInterface"),
-                size_t neighbourHood = 3);
+                size_t neighbourHood = 3,
+                size_t numberOfThreads = 1);
+
+    /**
+     * Remove the registered instances of an organization model from the
+     * registry used by getInstance -- registered instances are kept until
+     * they are evicted, while instances which have already been retrieved
+     * remain valid
+     * \param om Organization model, or all organization models if not set
+     * \return number of removed instances
+     */
+    static size_t
+    evictInstances(const OrganizationModel::Ptr& om = OrganizationModel::Ptr());
+
+    /**
+     * Get the number of instances in the registry used by getInstance
+     */
+    static size_t getNumberOfInstances();
 
     /**
      * Retrieve the list of all known agent models
@@ -113,13 +153,22 @@ public:
      * A currently set model pool is required for most queries to the
      * organization model
      */
-    void setModelPool(const ModelPool& modelPool) { mModelPool = modelPool; }
+    void setModelPool(const ModelPool& modelPool)
+    {
+        getMutableCore().modelPool = modelPool;
+    }
 
     /**
      * Get the model pool associated with this ask object
      * \return model pool
      */
-    const ModelPool& getModelPool() const { return mModelPool; }
+    const ModelPool& getModelPool() const { return mpCore->modelPool; }
+
+    /**
+     * Get the cache for the property values of robot facades created for this
+     * ask
+     */
+    facades::RobotCache& getRobotCache() const { return *mpCore->robotCache; }
 
     /**
      * Compute the functionality mapping for currently set model pool
@@ -128,6 +177,14 @@ public:
         const ModelPool& pool,
         bool applyFunctionalSaturationBound = false) const;
 
+    /**
+     * Compute a hash which identifies the content of the underlying ontology
+     * and its revision, so that persisted results of an outdated ontology are
+     * not reused
+     * \return hash value
+     */
+    uint64_t getOntologyContentHash() const;
+
     /*
      * Get the set of resources that support a given collection of
      * functionalities while accounting for the resource requirements
@@ -205,6 +262,21 @@ public:
     algebra::SupportType getSupportType(const Resource& resource,
                                         const ModelPool& models) const;
 
+    /**
+     * Check how a set of resources (functionalities) is supported by each of
+     * the given model pools
+     *
+     * The support matrix (labels x models) is built once for all pools, so
+     * that the available support of all pools results from a single matrix
+     * product
+     * \param resources Set of resources to be available
+     * \param modelPools List of model pools to check
+     * \return type of support for each model pool (same order as modelPools)
+     */
+    std::vector<algebra::SupportType>
+    getSupportTypes(const Resource::Set& resources,
+                    const ModelPool::List& modelPools) const;
+
     /**
      *  Depending on the contribution of a model to the service the functional
      *  saturation point can be interpreted differently:
@@ -222,6 +294,25 @@ public:
     getFunctionalSaturationBound(const owlapi::model::IRI& requirementModel,
                                  const owlapi::model::IRI& model) const;
 
+    /**
+     * Compute the functional saturation bounds of all functionalities for
+     * all models of the current model pool
+     * \return bounds by functionality \see getFunctionalSaturationBound
+     */
+    std::map<owlapi::model::IRI, ModelPool>
+    getFunctionalSaturationBounds() const;
+
+    /**
+     * Compute the functional saturation bounds for each combination of
+     * requirement model and (provider) model in one pass
+     * \param requirementModels models that define the requirements
+     * \param models Provider models
+     * \return bounds by requirement model \see getFunctionalSaturationBound
+     */
+    std::map<owlapi::model::IRI, ModelPool> getFunctionalSaturationBounds(
+        const owlapi::model::IRIList& requirementModels,
+        const owlapi::model::IRIList& models) const;
+
     /**
      * Compute the upper bound for the cardinality of each resource model
      * for a given service
@@ -327,11 +418,78 @@ public:
     void prepare(const ModelPool& modelPool,
                  bool applyFunctionalSaturationBound = false);
 
+    /**
+     * Set the number of worker threads that are used to compute the
+     * functionality mapping in prepare
+     * \param numberOfThreads Number of threads, 1 for a serial computation,
+     * 0 to use all available hardware threads
+     */
+    void setNumberOfThreads(size_t numberOfThreads)
+    {
+        getMutableCore().numberOfThreads = numberOfThreads;
+    }
+
+    /**
+     * Get the number of worker threads that are used to compute the
+     * functionality mapping
+     */
+    size_t getNumberOfThreads() const { return mpCore->numberOfThreads; }
+
+    /**
+     * Set the directory for persisting functionality mappings
+     * \param directory Cache directory, an empty string disables persisting
+     * \see FunctionalityMappingCache::getDefaultDirectory
+     */
+    void setCacheDirectory(const std::string& directory)
+    {
+        getMutableCore().cacheDirectory = directory;
+    }
+
+    /**
+     * Get the directory for persisting functionality mappings
+     */
+    const std::string& getCacheDirectory() const
+    {
+        return mpCore->cacheDirectory;
+    }
+
+    /**
+     * Get the cache for the results of connectivity feasibility checks
+     * \details The cache is shared between copies of this object
+     */
+    const algebra::FeasibilityCache::Ptr& getFeasibilityCache() const
+    {
+        return mpCore->feasibilityCache;
+    }
+
+    /**
+     * Set the cache for the results of connectivity feasibility checks, e.g.,
+     * to share a single cache between multiple ask objects
+     * \param cache Cache to use, or an empty pointer to disable caching
+     */
+    void setFeasibilityCache(const algebra::FeasibilityCache::Ptr& cache)
+    {
+        getMutableCore().feasibilityCache = cache;
+    }
+
+    /**
+     * Get the subclass closure of the underlying organization model
+     * \details The closure is shared between all ask objects of the same
+     * organization model
+     */
+    const algebra::SubclassClosure::Ptr& getSubclassClosure() const
+    {
+        return mpCore->subclassClosure;
+    }
+
     /**
      * Return ontology that relates to this Ask object
      * \return underlying OWLOntologyAsk object
      */
-    owlapi::model::OWLOntologyAsk ontology() const { return mOntologyAsk; }
+    owlapi::model::OWLOntologyAsk ontology() const
+    {
+        return mpCore->ontologyAsk;
+    }
 
     /**
      * Return organization model that relates to this ask object
@@ -339,7 +497,7 @@ public:
      */
     OrganizationModel::Ptr getOrganizationModel() const
     {
-        return mpOrganizationModel;
+        return mpCore->organizationModel;
     }
 
     /**
@@ -348,7 +506,7 @@ public:
      */
     const FunctionalityMapping& getFunctionalityMapping()
     {
-        return mFunctionalityMapping;
+        return mpCore->functionalityMapping;
     }
 
     /**
@@ -445,6 +603,9 @@ public:
 
     /**
      * Check feasibility of a given model pool
+     * The connection graph of a cached feasible sub-pool will be extended if
+     * possible
+     * \see algebra::Connectivity::isFeasibleIncremental
      */
     bool isFeasible(const ModelPool& modelPool,
                     double feasibilityCheckTimeoutInMs = 0.0) const;
@@ -528,6 +689,67 @@ protected:
         const ModelPool& pool,
         const owlapi::model::IRIList& functionalityModels) const;
 
+    /**
+     * Check the structural feasibility of a combination from the bounded
+     * model pool and explore its neighbourhood
+     * \param functionalityMapping Mapping to add the supporting combinations
+     * to
+     * \param combinationModelPool The combination to check
+     * \param boundedModelPool The model pool bounded by the functional
+     * saturation bound of the functionality
+     * \param functionality The functionality to check the support for
+     */
+    void exploreCombination(FunctionalityMapping& functionalityMapping,
+                            const ModelPool& combinationModelPool,
+                            const ModelPool& boundedModelPool,
+                            const owlapi::model::IRI& functionality) const;
+
+    /**
+     * Add all functionalities with full support by one of the combinations
+     * (and a feasible structure) to the functionality mapping
+     */
+    void addSupportedFunctionalities(
+        FunctionalityMapping& functionalityMapping,
+        const ModelPool::List& combinationModelPools,
+        const owlapi::model::IRIList& functionalityModels) const;
+
+    /**
+     * Get the requirement support vector for the saturation bound of a
+     * requirement model
+     */
+    algebra::ResourceSupportVector getRequirementSupportVector(
+        const owlapi::model::IRI& requirementModel) const;
+
+    /**
+     * Compute the functional saturation bound of a model
+     * \param requirementSupportVector Requirement as returned by
+     * getRequirementSupportVector
+     * \param embeddedRequirementSupportVector Requirement with embedded class
+     * relationship
+     * \param model Provider model
+     */
+    uint32_t computeFunctionalSaturationBound(
+        const algebra::ResourceSupportVector& requirementSupportVector,
+        const algebra::ResourceSupportVector& embeddedRequirementSupportVector,
+        const owlapi::model::IRI& model) const;
+
+    /**
+     * Get the memoised saturation bounds, which are dropped if the revision
+     * of the ontology has changed
+     * Requires the ontology to be locked
+     */
+    std::map<std::pair<owlapi::model::IRI, owlapi::model::IRI>, uint32_t>&
+    getSaturationBoundCache() const;
+
+    /**
+     * Get the intersection of model pools for a given set of resources in
+     * the compact representation -- the result is memoised for the current
+     * functionality mapping
+     * \see getIntersection
+     */
+    shared_ptr<const CompactModelPool::List>
+    getSupportPools(const Resource::Set& resources) const;
+
     ModelPool::Set filterNonMinimal(const ModelPool::Set& modelPoolSet,
                                     const Resource::Set& resources) const;
 
@@ -584,32 +806,112 @@ protected:
      */
     const owlapi::model::IRI& getInterfaceBaseClass() const
     {
-        return mInterfaceBaseClass;
+        return mpCore->interfaceBaseClass;
     }
 
 private:
-    OrganizationModel::Ptr mpOrganizationModel;
-    owlapi::model::OWLOntologyAsk mOntologyAsk;
-    bool mApplyFunctionalSaturationBound;
-
-    /// Maps a combination to its supported functionality and vice versa
-    FunctionalityMapping mFunctionalityMapping;
-
-    /// Current pool of models, i.e.
-    /// how many instances of type X,Y
-    /// to be considered
-    ModelPool mModelPool;
-
-    double mFeasibilityCheckTimeoutInMs;
-    /// Size of the neighbourhood for the exploration of structurally feasible
-    /// compositions, starting from the functional saturation bound
-    size_t mStructuralNeighbourhood;
-    owlapi::model::IRI mInterfaceBaseClass;
-    static std::vector<OrganizationModelAsk> msOrganizationModelAsk;
-
-    mutable std::map<owlapi::model::IRI,
-                     std::vector<shared_ptr<ResourceInstance>>>
-        mRelatedResourceCache;
+    /// Memoised functional saturation bounds by (requirement model, model) --
+    /// guarded by the ontology mutex and shared between copies of this object
+    struct SaturationBoundCache
+    {
+        SaturationBoundCache()
+            : revision(0)
+        {
+        }
+
+        uint64_t revision;
+        std::map<std::pair<owlapi::model::IRI, owlapi::model::IRI>, uint32_t>
+            bounds;
+    };
+
+    /// Memoised intersections of the support pools by set of resources --
+    /// shared between copies of this object with the same functionality
+    /// mapping
+    struct SupportPoolCache
+    {
+        boost::mutex mutex;
+        std::map<Resource::Set, shared_ptr<const CompactModelPool::List>>
+            pools;
+    };
+
+    /// Memoised related resource instances by (model, qualification, object
+    /// property, inclusion of functionalities) -- guarded by the ontology
+    /// mutex and shared between copies of this object
+    struct RelatedResourceCache
+    {
+        typedef std::tuple<owlapi::model::IRI,
+                           owlapi::model::IRI,
+                           owlapi::model::IRI,
+                           bool>
+            Key;
+
+        RelatedResourceCache()
+            : revision(0)
+        {
+        }
+
+        uint64_t revision;
+        std::map<Key, std::vector<shared_ptr<ResourceInstance>>> instances;
+    };
+
+    /**
+     * \class Core
+     * \brief Prepared state of an ask object
+     * \details Copies of an ask object share a single core, so that copying an
+     * ask object is cheap and the functionality mapping, the precomputed tables
+     * and the caches exist only once. The core is treated as immutable: it is
+     * cloned before one of the sharing objects is modified, see
+     * getMutableCore. Caches which are filled by const queries are held by
+     * pointer and synchronised on their own, so that cloning the core does
+     * not read their content
+     */
+    struct Core
+    {
+        Core(const OrganizationModel::Ptr& om);
+
+        OrganizationModel::Ptr organizationModel;
+        owlapi::model::OWLOntologyAsk ontologyAsk;
+        bool applyFunctionalSaturationBound;
+
+        /// Maps a combination to its supported functionality and vice versa
+        FunctionalityMapping functionalityMapping;
+
+        /// Current pool of models, i.e.
+        /// how many instances of type X,Y
+        /// to be considered
+        ModelPool modelPool;
+
+        double feasibilityCheckTimeoutInMs;
+        /// Size of the neighbourhood for the exploration of structurally
+        /// feasible compositions, starting from the functional saturation bound
+        size_t structuralNeighbourhood;
+        owlapi::model::IRI interfaceBaseClass;
+        /// Number of threads to compute the functionality mapping
+        size_t numberOfThreads;
+        /// Cache for the results of connectivity feasibility checks
+        algebra::FeasibilityCache::Ptr feasibilityCache;
+        /// Directory to persist functionality mappings
+        std::string cacheDirectory;
+        /// Subclass closure of the organization model
+        algebra::SubclassClosure::Ptr subclassClosure;
+        /// Property tables of robot facades
+        shared_ptr<facades::RobotCache> robotCache;
+        shared_ptr<SaturationBoundCache> saturationBoundCache;
+        shared_ptr<SupportPoolCache> supportPoolCache;
+        shared_ptr<RelatedResourceCache> relatedResourceCache;
+    };
+
+    /**
+     * Get the core for modification, i.e., clone the core first if it is
+     * shared with other ask objects
+     */
+    Core& getMutableCore();
+
+    shared_ptr<Core> mpCore;
+
+    /// Registry of the instances returned by getInstance
+    class InstanceRegistry;
+    static InstanceRegistry msInstanceRegistry;
 };
 
 } // end namespace moreorg
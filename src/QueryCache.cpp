@@ -1,57 +1,307 @@
 #include "QueryCache.hpp"
+#include <algorithm>
+#include <boost/functional/hash.hpp>
+#include <sstream>
+#include <stdexcept>
+
+using namespace owlapi::model;
 
 namespace moreorg {
 
-std::pair<owlapi::model::OWLCardinalityRestriction::PtrList, bool>
-QueryCache::getCachedResult(
-    const ModelPool& modelPool,
-    const owlapi::model::IRI& objectProperty,
-    owlapi::model::OWLCardinalityRestriction::OperationType operationType,
-    bool max2Min) const
+/// Approximate overhead of a node in a std::list, std::map or an unordered
+/// map bucket
+static const size_t NODE_OVERHEAD = 4 * sizeof(void*);
+
+QueryCache::Statistics::Statistics()
+    : hits(0)
+    , misses(0)
+    , evictions(0)
+    , size(0)
+    , bytes(0)
+{
+}
+
+std::string QueryCache::Statistics::toString(size_t indent) const
+{
+    std::stringstream ss;
+    std::string hspace(indent, ' ');
+    ss << hspace << "QueryCache:" << std::endl;
+    ss << hspace << "    # hits: " << hits << std::endl;
+    ss << hspace << "    # misses: " << misses << std::endl;
+    ss << hspace << "    # evictions: " << evictions << std::endl;
+    ss << hspace << "    # entries: " << size << std::endl;
+    ss << hspace << "    # bytes: " << bytes << std::endl;
+    return ss.str();
+}
+
+QueryCache::CRQuery::CRQuery(
+    const CompactModelPool& modelPool,
+    const IRI& objectProperty,
+    OWLCardinalityRestriction::OperationType operationType,
+    bool max2Min)
+    : modelPool(modelPool)
+    , objectProperty(objectProperty)
+    , operationType(operationType)
+    , max2Min(max2Min)
+    , hash(modelPool.hash())
+{
+    boost::hash_combine(hash, std::hash<IRI>()(objectProperty));
+    boost::hash_combine(hash, static_cast<int>(operationType));
+    boost::hash_combine(hash, max2Min);
+}
+
+bool QueryCache::CRQuery::operator==(const CRQuery& other) const
+{
+    return hash == other.hash && max2Min == other.max2Min &&
+           operationType == other.operationType &&
+           modelPool == other.modelPool &&
+           objectProperty == other.objectProperty;
+}
+
+QueryCache::CSQuery::CSQuery(const CompactModelPool& modelPool,
+                             const Resource::Set& resources)
+    : modelPool(modelPool)
+    , resources(resources)
+    , hash(modelPool.hash())
+{
+    for(const Resource& r : resources)
+    {
+        boost::hash_combine(hash, std::hash<IRI>()(r.getModel()));
+    }
+}
+
+bool QueryCache::CSQuery::operator==(const CSQuery& other) const
+{
+    return hash == other.hash && modelPool == other.modelPool &&
+           resources == other.resources;
+}
+
+template <typename Query, typename Result>
+QueryCache::Table<Query, Result>::Table(QueryCache& cache,
+                                        size_t numberOfStripes)
+    : mCache(cache)
+{
+    for(size_t i = 0; i < numberOfStripes; ++i)
+    {
+        mStripes.push_back(std::unique_ptr<Stripe>(new Stripe()));
+    }
+}
+
+template <typename Query, typename Result>
+typename QueryCache::Table<Query, Result>::Stripe&
+QueryCache::Table<Query, Result>::getStripe(size_t hash)
+{
+    // Use the upper bits, since the lower bits select the bucket within the
+    // stripe
+    return *mStripes[(hash >> 16) % mStripes.size()];
+}
+
+template <typename Query, typename Result>
+bool QueryCache::Table<Query, Result>::lookup(const Query& query,
+                                              Result& result)
+{
+    Stripe& stripe = getStripe(query.hash);
+
+    boost::unique_lock<boost::mutex> lock(stripe.mutex);
+    auto it = stripe.index.find(query);
+    if(it == stripe.index.end())
+    {
+        ++mCache.mMisses;
+        return false;
+    }
+
+    stripe.entries.splice(stripe.entries.begin(), stripe.entries, it->second);
+    result = it->second->result;
+    ++mCache.mHits;
+    return true;
+}
+
+template <typename Query, typename Result>
+void QueryCache::Table<Query, Result>::insert(const Query& query,
+                                              const Result& result,
+                                              size_t bytes)
+{
+    size_t budget = mCache.mMemoryBudgetPerStripe;
+    if(budget != 0 && bytes > budget)
+    {
+        // Entry would evict the complete stripe, so do not cache it at all
+        return;
+    }
+
+    Stripe& stripe = getStripe(query.hash);
+
+    boost::unique_lock<boost::mutex> lock(stripe.mutex);
+    auto it = stripe.index.find(query);
+    if(it != stripe.index.end())
+    {
+        typename EntryList::iterator entryIt = it->second;
+        stripe.bytes -= entryIt->bytes;
+        stripe.index.erase(it);
+        stripe.entries.erase(entryIt);
+    }
+
+    while(budget != 0 && !stripe.entries.empty() &&
+          stripe.bytes + bytes > budget)
+    {
+        const Entry& entry = stripe.entries.back();
+        stripe.bytes -= entry.bytes;
+        stripe.index.erase(entry.query);
+        stripe.entries.pop_back();
+        ++mCache.mEvictions;
+    }
+
+    stripe.entries.push_front(Entry{query, result, bytes});
+    stripe.index[query] = stripe.entries.begin();
+    stripe.bytes += bytes;
+}
+
+template <typename Query, typename Result>
+void QueryCache::Table<Query, Result>::clear()
+{
+    for(const std::unique_ptr<Stripe>& stripe : mStripes)
+    {
+        boost::unique_lock<boost::mutex> lock(stripe->mutex);
+        stripe->index.clear();
+        stripe->entries.clear();
+        stripe->bytes = 0;
+    }
+}
+
+template <typename Query, typename Result>
+void QueryCache::Table<Query, Result>::getUsage(size_t& size,
+                                                size_t& bytes) const
+{
+    for(const std::unique_ptr<Stripe>& stripe : mStripes)
+    {
+        boost::unique_lock<boost::mutex> lock(stripe->mutex);
+        size += stripe->entries.size();
+        bytes += stripe->bytes;
+    }
+}
+
+QueryCache::QueryCache(const ModelRegistry::Ptr& registry,
+                       size_t memoryBudget,
+                       size_t numberOfStripes)
+    : mpModelRegistry(registry)
+    , mMemoryBudget(memoryBudget)
+    , mMemoryBudgetPerStripe(0)
+    , mHits(0)
+    , mMisses(0)
+    , mEvictions(0)
+    , mCRQueryResults(*this, std::max<size_t>(numberOfStripes, 1))
+    , mCSQueryResults(*this, std::max<size_t>(numberOfStripes, 1))
 {
-    using namespace owlapi::model;
-    std::pair<owlapi::model::OWLCardinalityRestriction::PtrList, bool> result;
-    CRQuery query =
-        std::make_tuple(modelPool, objectProperty, operationType, max2Min);
-    CRQueryResults::const_iterator cit = mQueryResults.find(query);
-    if(cit == mQueryResults.end())
+    if(!mpModelRegistry)
+    {
+        throw std::invalid_argument("moreorg::QueryCache: model registry is "
+                                    "not set");
+    }
+    if(numberOfStripes == 0)
     {
-        result.second = false;
-    } else
+        throw std::invalid_argument("moreorg::QueryCache: number of stripes "
+                                    "must be greater than 0");
+    }
+
+    if(mMemoryBudget != 0)
+    {
+        // Both tables share the memory budget
+        mMemoryBudgetPerStripe =
+            std::max<size_t>(mMemoryBudget / (2 * numberOfStripes), 1);
+    }
+}
+
+size_t QueryCache::estimateSize(const CRQuery& query,
+                                const OWLCardinalityRestriction::PtrList& list)
+{
+    size_t bytes = sizeof(CRQuery) + sizeof(list) + 3 * NODE_OVERHEAD;
+    bytes += query.modelPool.size() * sizeof(CompactModelPool::value_type);
+    bytes += query.objectProperty.toString().size();
+    bytes += list.size() *
+             (sizeof(OWLCardinalityRestriction::Ptr) +
+              sizeof(OWLCardinalityRestriction) + NODE_OVERHEAD);
+    return bytes;
+}
+
+size_t QueryCache::estimateSize(const CSQuery& query,
+                                const ModelPool::List& list)
+{
+    size_t bytes = sizeof(CSQuery) + sizeof(list) + 3 * NODE_OVERHEAD;
+    bytes += query.modelPool.size() * sizeof(CompactModelPool::value_type);
+    bytes += query.resources.size() * (sizeof(Resource) + NODE_OVERHEAD);
+    for(const ModelPool& modelPool : list)
     {
-        result.first = cit->second;
-        result.second = true;
+        bytes += sizeof(ModelPool) +
+                 modelPool.size() *
+                     (sizeof(ModelPool::value_type) + NODE_OVERHEAD);
     }
+    return bytes;
+}
+
+std::pair<OWLCardinalityRestriction::PtrList, bool>
+QueryCache::getCachedResult(
+    const ModelPool& modelPool,
+    const IRI& objectProperty,
+    OWLCardinalityRestriction::OperationType operationType,
+    bool max2Min) const
+{
+    return getCachedResult(CompactModelPool(modelPool, *mpModelRegistry),
+                           objectProperty,
+                           operationType,
+                           max2Min);
+}
+
+std::pair<OWLCardinalityRestriction::PtrList, bool>
+QueryCache::getCachedResult(
+    const CompactModelPool& modelPool,
+    const IRI& objectProperty,
+    OWLCardinalityRestriction::OperationType operationType,
+    bool max2Min) const
+{
+    std::pair<OWLCardinalityRestriction::PtrList, bool> result;
+    CRQuery query(modelPool, objectProperty, operationType, max2Min);
+    result.second = mCRQueryResults.lookup(query, result.first);
     return result;
 }
 
 void QueryCache::cacheResult(
     const ModelPool& modelPool,
-    const owlapi::model::IRI& objectProperty,
-    owlapi::model::OWLCardinalityRestriction::OperationType operationType,
+    const IRI& objectProperty,
+    OWLCardinalityRestriction::OperationType operationType,
+    bool max2Min,
+    const OWLCardinalityRestriction::PtrList& list)
+{
+    cacheResult(CompactModelPool(modelPool, *mpModelRegistry),
+                objectProperty,
+                operationType,
+                max2Min,
+                list);
+}
+
+void QueryCache::cacheResult(
+    const CompactModelPool& modelPool,
+    const IRI& objectProperty,
+    OWLCardinalityRestriction::OperationType operationType,
     bool max2Min,
-    const owlapi::model::OWLCardinalityRestriction::PtrList& list)
+    const OWLCardinalityRestriction::PtrList& list)
 {
-    CRQuery query =
-        std::make_tuple(modelPool, objectProperty, operationType, max2Min);
-    mQueryResults.emplace(query, list);
+    CRQuery query(modelPool, objectProperty, operationType, max2Min);
+    mCRQueryResults.insert(query, list, estimateSize(query, list));
 }
 
 std::pair<ModelPool::List, bool>
 QueryCache::getCachedResult(const ModelPool& modelPool,
                             const Resource::Set& r) const
+{
+    return getCachedResult(CompactModelPool(modelPool, *mpModelRegistry), r);
+}
+
+std::pair<ModelPool::List, bool>
+QueryCache::getCachedResult(const CompactModelPool& modelPool,
+                            const Resource::Set& r) const
 {
     std::pair<ModelPool::List, bool> result;
-    CoalitionStructureQuery query = std::make_tuple(modelPool, r);
-    CSQueryResults::const_iterator cit = mCSQueryResults.find(query);
-    if(cit == mCSQueryResults.end())
-    {
-        result.second = false;
-    } else
-    {
-        result.first = cit->second;
-        result.second = true;
-    }
+    CSQuery query(modelPool, r);
+    result.second = mCSQueryResults.lookup(query, result.first);
     return result;
 }
 
@@ -59,14 +309,39 @@ void QueryCache::cacheResult(const ModelPool& modelPool,
                              const Resource::Set& r,
                              const ModelPool::List& list)
 {
-    CoalitionStructureQuery query = std::make_tuple(modelPool, r);
-    mCSQueryResults.emplace(query, list);
+    cacheResult(CompactModelPool(modelPool, *mpModelRegistry), r, list);
+}
+
+void QueryCache::cacheResult(const CompactModelPool& modelPool,
+                             const Resource::Set& r,
+                             const ModelPool::List& list)
+{
+    CSQuery query(modelPool, r);
+    mCSQueryResults.insert(query, list, estimateSize(query, list));
 }
 
 void QueryCache::clear()
 {
-    mQueryResults.clear();
+    mCRQueryResults.clear();
     mCSQueryResults.clear();
 }
 
+void QueryCache::resetStatistics()
+{
+    mHits = 0;
+    mMisses = 0;
+    mEvictions = 0;
+}
+
+QueryCache::Statistics QueryCache::getStatistics() const
+{
+    Statistics statistics;
+    statistics.hits = mHits;
+    statistics.misses = mMisses;
+    statistics.evictions = mEvictions;
+    mCRQueryResults.getUsage(statistics.size, statistics.bytes);
+    mCSQueryResults.getUsage(statistics.size, statistics.bytes);
+    return statistics;
+}
+
 } // end namespace moreorg
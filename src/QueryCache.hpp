@@ -1,79 +1,67 @@
 #ifndef ORGANIZATION_MODEL_QUERY_CACHE_HPP
 #define ORGANIZATION_MODEL_QUERY_CACHE_HPP
 
-#include "ModelPool.hpp"
-#include "Resource.hpp"
-#include <boost/functional/hash.hpp>
-#include <functional>
+#include <atomic>
+#include <boost/thread/mutex.hpp>
+#include <list>
+#include <memory>
 #include <owlapi/OWLApi.hpp>
-#include <tuple>
 #include <unordered_map>
+#include <vector>
 
-namespace std {
-using namespace owlapi::model;
-using namespace moreorg;
-template <>
-struct hash<
-    tuple<ModelPool, IRI, OWLCardinalityRestriction::OperationType, bool>>
-{
-    size_t operator()(const tuple<ModelPool,
-                                  IRI,
-                                  OWLCardinalityRestriction::OperationType,
-                                  bool>& tpl) const
-    {
-        size_t seed = 0;
-        for(const ModelPool::value_type& v : get<0>(tpl))
-        {
-            boost::hash_combine(seed, v.first.toString());
-            boost::hash_combine(seed, v.second);
-        }
-        boost::hash_combine(seed, get<1>(tpl).toString());
-        boost::hash_combine(seed, get<2>(tpl));
-        boost::hash_combine(seed, get<3>(tpl));
-        return seed;
-    }
-};
-
-template <> struct hash<tuple<ModelPool, Resource::Set>>
-{
-    size_t operator()(const tuple<ModelPool, Resource::Set>& tpl) const
-    {
-        size_t seed = 0;
-        for(const ModelPool::value_type& v : get<0>(tpl))
-        {
-            boost::hash_combine(seed, v.first.toString());
-            boost::hash_combine(seed, v.second);
-        }
-        for(const Resource& r : get<1>(tpl))
-        {
-            boost::hash_combine(seed, r.getModel().toString());
-        }
-        return seed;
-    }
-};
-} // end namespace std
+#include "CompactModelPool.hpp"
+#include "ModelPool.hpp"
+#include "ModelRegistry.hpp"
+#include "Resource.hpp"
+#include "SharedPtr.hpp"
 
 namespace moreorg {
 
+/**
+ * \class QueryCache
+ * \brief Thread-safe and memory bounded cache for the results of ontology
+ * queries of an OrganizationModel
+ *
+ * \details
+ * Model pools are stored as CompactModelPool, and the hash value of a query
+ * is computed once when the query is created. Entries are distributed over a
+ * number of stripes, each protected by its own mutex. Each stripe evicts its
+ * least recently used entries once the estimated memory usage exceeds its
+ * share of the memory budget.
+ */
 class QueryCache
 {
 public:
-    typedef std::tuple<ModelPool,
-                       owlapi::model::IRI,
-                       owlapi::model::OWLCardinalityRestriction::OperationType,
-                       bool>
-        CRQuery;
-
-    typedef std::tuple<ModelPool, Resource::Set> CoalitionStructureQuery;
-
-    /// Cardinality Restriction Query Results
-    typedef std::unordered_map<
-        CRQuery,
-        owlapi::model::OWLCardinalityRestriction::PtrList>
-        CRQueryResults;
-    /// Coalition Structure Query Results
-    typedef std::unordered_map<CoalitionStructureQuery, ModelPool::List>
-        CSQueryResults;
+    using Ptr = shared_ptr<QueryCache>;
+
+    struct Statistics
+    {
+        Statistics();
+
+        uint64_t hits;
+        uint64_t misses;
+        uint64_t evictions;
+        /// Number of currently cached entries
+        size_t size;
+        /// Estimated memory usage of the cached entries in bytes
+        size_t bytes;
+
+        std::string toString(size_t indent = 0) const;
+    };
+
+    /**
+     * Constructor for the cache
+     * \param registry Registry to intern the models of queried pools with
+     * \param memoryBudget Maximum estimated memory usage in bytes, 0 for an
+     * unbounded cache
+     * \param numberOfStripes Number of independently locked partitions
+     */
+    QueryCache(const ModelRegistry::Ptr& registry,
+               size_t memoryBudget = 64 * 1024 * 1024,
+               size_t numberOfStripes = 16);
+
+    QueryCache(const QueryCache&) = delete;
+    QueryCache& operator=(const QueryCache&) = delete;
 
     std::pair<owlapi::model::OWLCardinalityRestriction::PtrList, bool>
     getCachedResult(
@@ -82,6 +70,18 @@ public:
         owlapi::model::OWLCardinalityRestriction::OperationType operationType,
         bool max2Min) const;
 
+    /**
+     * Lookup a cardinality restriction query for a model pool, which has
+     * already been interned with the registry of this cache -- use this
+     * variant to intern a pool only once for lookup and insertion
+     */
+    std::pair<owlapi::model::OWLCardinalityRestriction::PtrList, bool>
+    getCachedResult(
+        const CompactModelPool& modelPool,
+        const owlapi::model::IRI& objectProperty,
+        owlapi::model::OWLCardinalityRestriction::OperationType operationType,
+        bool max2Min) const;
+
     void cacheResult(
         const ModelPool& modelPool,
         const owlapi::model::IRI& objectProperty,
@@ -89,19 +89,165 @@ public:
         bool max2Min,
         const owlapi::model::OWLCardinalityRestriction::PtrList& list);
 
+    void cacheResult(
+        const CompactModelPool& modelPool,
+        const owlapi::model::IRI& objectProperty,
+        owlapi::model::OWLCardinalityRestriction::OperationType operationType,
+        bool max2Min,
+        const owlapi::model::OWLCardinalityRestriction::PtrList& list);
+
     std::pair<ModelPool::List, bool>
     getCachedResult(const ModelPool& modelPool, const Resource::Set& r) const;
 
+    /**
+     * Lookup a coalition structure query for an interned model pool
+     */
+    std::pair<ModelPool::List, bool>
+    getCachedResult(const CompactModelPool& modelPool,
+                    const Resource::Set& r) const;
+
     void cacheResult(const ModelPool& modelPool,
                      const Resource::Set& r,
                      const ModelPool::List& list);
 
+    void cacheResult(const CompactModelPool& modelPool,
+                     const Resource::Set& r,
+                     const ModelPool::List& list);
+
+    /**
+     * Get the registry which is used to intern the models of queried pools
+     */
+    ModelRegistry& getModelRegistry() const { return *mpModelRegistry; }
+
+    /**
+     * Remove all entries -- counters are kept
+     */
     void clear();
 
-protected:
-    // From propery key
-    CRQueryResults mQueryResults;
-    CSQueryResults mCSQueryResults;
+    /**
+     * Reset the hit, miss and eviction counters
+     */
+    void resetStatistics();
+
+    /**
+     * Get the current hit / miss / eviction statistics and memory usage
+     */
+    Statistics getStatistics() const;
+
+    /**
+     * Get the memory budget of this cache in bytes, 0 if unbounded
+     */
+    size_t getMemoryBudget() const { return mMemoryBudget; }
+
+private:
+    /// Cardinality restriction query
+    struct CRQuery
+    {
+        CRQuery(const CompactModelPool& modelPool,
+                const owlapi::model::IRI& objectProperty,
+                owlapi::model::OWLCardinalityRestriction::OperationType
+                    operationType,
+                bool max2Min);
+
+        bool operator==(const CRQuery& other) const;
+
+        CompactModelPool modelPool;
+        owlapi::model::IRI objectProperty;
+        owlapi::model::OWLCardinalityRestriction::OperationType operationType;
+        bool max2Min;
+        size_t hash;
+    };
+
+    /// Coalition structure query
+    struct CSQuery
+    {
+        CSQuery(const CompactModelPool& modelPool,
+                const Resource::Set& resources);
+
+        bool operator==(const CSQuery& other) const;
+
+        CompactModelPool modelPool;
+        Resource::Set resources;
+        size_t hash;
+    };
+
+    /// Precomputed hash of a query
+    struct QueryHash
+    {
+        template <typename Query> size_t operator()(const Query& query) const
+        {
+            return query.hash;
+        }
+    };
+
+    /**
+     * \class Table
+     * \brief Striped LRU table for one type of query
+     */
+    template <typename Query, typename Result> class Table
+    {
+    public:
+        Table(QueryCache& cache, size_t numberOfStripes);
+
+        bool lookup(const Query& query, Result& result);
+        void insert(const Query& query, const Result& result, size_t bytes);
+        void clear();
+
+        /// Get the number of entries and their estimated size
+        void getUsage(size_t& size, size_t& bytes) const;
+
+    private:
+        struct Entry
+        {
+            Query query;
+            Result result;
+            size_t bytes;
+        };
+
+        /// Entries in order of their use, most recently used first
+        typedef std::list<Entry> EntryList;
+
+        struct Stripe
+        {
+            Stripe()
+                : bytes(0)
+            {
+            }
+
+            mutable boost::mutex mutex;
+            EntryList entries;
+            std::unordered_map<Query, typename EntryList::iterator, QueryHash>
+                index;
+            size_t bytes;
+        };
+
+        Stripe& getStripe(size_t hash);
+
+        QueryCache& mCache;
+        std::vector<std::unique_ptr<Stripe>> mStripes;
+    };
+
+    /**
+     * Estimate the memory usage of the given entries
+     */
+    static size_t
+    estimateSize(const CRQuery& query,
+                 const owlapi::model::OWLCardinalityRestriction::PtrList& list);
+    static size_t estimateSize(const CSQuery& query,
+                               const ModelPool::List& list);
+
+    ModelRegistry::Ptr mpModelRegistry;
+    size_t mMemoryBudget;
+    size_t mMemoryBudgetPerStripe;
+
+    std::atomic<uint64_t> mHits;
+    std::atomic<uint64_t> mMisses;
+    std::atomic<uint64_t> mEvictions;
+
+    /// Query results are mutable, so that lookups can update the usage order
+    mutable Table<CRQuery, owlapi::model::OWLCardinalityRestriction::PtrList>
+        mCRQueryResults;
+    mutable Table<CSQuery, ModelPool::List> mCSQueryResults;
 };
 
 } // end namespace moreorg
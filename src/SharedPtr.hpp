@@ -9,6 +9,7 @@
 #include <boost/function.hpp>
 #include <boost/make_shared.hpp>
 #include <boost/shared_ptr.hpp>
+#include <boost/weak_ptr.hpp>
 #else
 #include <functional>
 #include <memory>
@@ -22,6 +23,7 @@ using ::boost::function1;
 using ::boost::make_shared;
 using ::boost::shared_ptr;
 using ::boost::static_pointer_cast;
+using ::boost::weak_ptr;
 namespace placeholder = ::boost;
 #else
 using ::std::bind;
@@ -30,6 +32,7 @@ using ::std::function;
 using ::std::make_shared;
 using ::std::shared_ptr;
 using ::std::static_pointer_cast;
+using ::std::weak_ptr;
 namespace placeholder = ::std::placeholders;
 template <class T, class U> using function1 = ::std::function<T(U)>;
 #endif
@@ -53,7 +53,7 @@ double CompositionFunction::min(const ModelPool& modelPool,
 double CompositionFunction::max(const ModelPool& modelPool,
                                 const IRIValueMap& valueMap)
 {
-    double value = std::numeric_limits<double>::min();
+    double value = std::numeric_limits<double>::lowest();
     for(const ModelPool::value_type& p : modelPool)
     {
         IRIValueMap::const_iterator cit = valueMap.find(p.first);
@@ -1,5 +1,7 @@
 #include "Connectivity.hpp"
 #include <base/Time.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/thread/thread.hpp>
 #include <gecode/int.hh>
 #include <gecode/minimodel.hh>
 #include <gecode/search.hh>
@@ -7,7 +9,9 @@
 #include <iostream>
 #include <numeric/Combinatorics.hpp>
 
+#include "../Algebra.hpp"
 #include "../utils/GecodeUtils.hpp"
+#include "StructuralFilter.hpp"
 #include "../vocabularies/OM.hpp"
 
 using namespace owlapi::model;
@@ -15,14 +19,83 @@ using namespace owlapi::model;
 namespace moreorg {
 namespace algebra {
 
-QueryCache Connectivity::msQueryCache;
-
-Connectivity::Statistics Connectivity::msStatistics;
-graph_analysis::BaseGraph::Ptr Connectivity::msConnectionGraph;
 qxcfg::Configuration Connectivity::msConfiguration;
 
+namespace {
+
+/// Stop the search when the timeout is reached or the search has been
+/// cancelled, e.g., since another member of the portfolio succeeded
+class CancelableStop : public Gecode::Search::Stop
+{
+public:
+    CancelableStop(double timeoutInMs, const std::atomic<bool>* cancelled)
+        : mTimeoutInMs(timeoutInMs)
+        , mCancelled(cancelled)
+        , mStartTime(base::Time::now())
+    {
+    }
+
+    virtual bool stop(const Gecode::Search::Statistics& s,
+                      const Gecode::Search::Options& o)
+    {
+        if(mCancelled && *mCancelled)
+        {
+            return true;
+        }
+        return mTimeoutInMs > 0 &&
+               (base::Time::now() - mStartTime).toMilliseconds() >
+                   mTimeoutInMs;
+    }
+
+private:
+    double mTimeoutInMs;
+    const std::atomic<bool>* mCancelled;
+    base::Time mStartTime;
+};
+
+FeasibilityQuery createQuery(const ModelPool& modelPool,
+                             const OrganizationModelAsk& ask,
+                             const IRI& interfaceBaseClass,
+                             size_t minFeasible)
+{
+    return std::make_tuple(modelPool,
+                           ask.ontology().getOntology()->getIRI(),
+                           interfaceBaseClass,
+                           minFeasible,
+                           ask.getOrganizationModel()->getRevision());
+}
+
+/// Check if two agents can be linked by the given interfaces, where the
+/// compatibility is checked in the same orientation as in the csp: agents
+/// are ordered by their model, so that the interface of the lesser model
+/// comes first, while two agents of the same model can be linked in either
+/// orientation
+bool isLinkCompatible(const InterfaceTable::CompatibilityMatrix& compatibility,
+                      const IRI& model0,
+                      InterfaceTable::InterfaceId interface0,
+                      const IRI& model1,
+                      InterfaceTable::InterfaceId interface1)
+{
+    if(model0 < model1)
+    {
+        return compatibility.isCompatible(interface0, interface1);
+    } else if(model1 < model0)
+    {
+        return compatibility.isCompatible(interface1, interface0);
+    }
+    return compatibility.isCompatible(interface0, interface1) ||
+           compatibility.isCompatible(interface1, interface0);
+}
+
+} // end anonymous namespace
+
 Connectivity::Statistics::Statistics()
     : evaluations(0)
+    , timeInS(0.0)
+    , stopped(0)
+    , cached(false)
+    , extended(false)
+    , pruned(false)
 {
 }
 
@@ -35,6 +108,9 @@ std::string Connectivity::Statistics::toString(size_t indent) const
        << std::endl;
     ss << hspace << "    time in s: " << timeInS << std::endl;
     ss << hspace << "    stopped: " << stopped << std::endl;
+    ss << hspace << "    cached: " << cached << std::endl;
+    ss << hspace << "    extended: " << extended << std::endl;
+    ss << hspace << "    pruned: " << pruned << std::endl;
     ss << hspace << "    # propagator executions: " << csp.propagate
        << std::endl;
     ss << hspace << "    # failed nodes: " << csp.fail << std::endl;
@@ -106,14 +182,75 @@ std::string Connectivity::Statistics::toString(
     return ss.str();
 }
 
+Connectivity::Branching::Branching()
+    : variableSelection("MERIT_MIN")
+    , valueSelection("MAX")
+    , seed(0)
+{
+}
+
+Connectivity::Branching Connectivity::Branching::fromConfiguration()
+{
+    Branching branching;
+    branching.variableSelection =
+        msConfiguration.getValue("connectivity/branching/variable-selection",
+                                 branching.variableSelection);
+    branching.valueSelection =
+        msConfiguration.getValue("connectivity/branching/value-selection",
+                                 branching.valueSelection);
+    return branching;
+}
+
+Connectivity::Branching Connectivity::Branching::forPortfolio(size_t index)
+{
+    Branching branching = fromConfiguration();
+
+    // Diversify the portfolio by alternating the variable selection
+    if(index % 2 == 1)
+    {
+        branching.variableSelection = msConfiguration.getValue(
+            "connectivity/portfolio/variable-selection",
+            "RND");
+    }
+
+    unsigned int seed = boost::lexical_cast<unsigned int>(
+        msConfiguration.getValue("connectivity/portfolio/seed", "0"));
+    if(seed != 0)
+    {
+        branching.seed = seed + index;
+    }
+    return branching;
+}
+
+size_t Connectivity::getPortfolioSize()
+{
+    size_t portfolioSize = boost::lexical_cast<size_t>(
+        msConfiguration.getValue("connectivity/portfolio/size", "1"));
+    return std::max(portfolioSize, static_cast<size_t>(1));
+}
+
+size_t Connectivity::getNumberOfSearchThreads()
+{
+    return boost::lexical_cast<size_t>(
+        msConfiguration.getValue("connectivity/search/threads", "1"));
+}
+
+bool Connectivity::isStructuralFilterEnabled()
+{
+    return boost::lexical_cast<bool>(msConfiguration.getValue(
+        "connectivity/structural-filter/enabled", "1"));
+}
+
 Connectivity::Connectivity(const ModelPool& modelPool,
                            const OrganizationModelAsk& ask,
                            const owlapi::model::IRI& interfaceBaseClass,
-                           const owlapi::model::IRI& property)
+                           const owlapi::model::IRI& property,
+                           const Branching& branching)
     : mModelPool(modelPool.compact())
-    , mAsk(ask.ontology())
     , mInterfaceBaseClass(interfaceBaseClass)
     , mProperty(property)
+    , mpInterfaceTable(
+          InterfaceTable::getInstance(ask, interfaceBaseClass, property))
     , mModelCombination(mModelPool.toModelCombination())
     , mExistingConnections(*this,
                            mModelCombination.size(),
@@ -131,7 +268,13 @@ Connectivity::Connectivity(const ModelPool& modelPool,
     // whilw time seem to be rather low resolution it seems now the better
     // option
     // mRnd.time();
-    mRnd.hw();
+    if(branching.seed == 0)
+    {
+        mRnd.hw();
+    } else
+    {
+        mRnd.seed(branching.seed);
+    }
     identifyInterfaces();
 
     Gecode::IntVarArray connections(*this,
@@ -154,9 +297,7 @@ Connectivity::Connectivity(const ModelPool& modelPool,
     //
     Gecode::Symmetries symmetries = identifySymmetries(connections);
 
-    std::string valueSelection =
-        msConfiguration.getValue("connectivity/branching/value-selection",
-                                 "MAX");
+    const std::string& valueSelection = branching.valueSelection;
     Gecode::IntValBranch::Select valSelect =
         utils::GecodeUtils::getIntValSelect(valueSelection);
     Gecode::IntValBranch* valBranch = 0;
@@ -168,9 +309,7 @@ Connectivity::Connectivity(const ModelPool& modelPool,
         valBranch = new Gecode::IntValBranch(valSelect);
     }
 
-    std::string variableSelection =
-        msConfiguration.getValue("connectivity/branching/variable-selection",
-                                 "MERIT_MIN");
+    const std::string& variableSelection = branching.variableSelection;
     Gecode::IntVarBranch::Select varSelect =
         utils::GecodeUtils::getIntVarSelect(variableSelection);
     Gecode::IntVarBranch* varBranch = 0;
@@ -218,9 +357,11 @@ Connectivity::Connectivity(const ModelPool& modelPool,
 Connectivity::Connectivity(Connectivity& other)
     : Gecode::Space(other)
     , mModelPool(other.mModelPool)
-    , mAsk(other.mAsk)
+    , mpInterfaceTable(other.mpInterfaceTable)
+    , mpCompatibilityMatrix(other.mpCompatibilityMatrix)
     , mModelCombination(other.mModelCombination)
     , mInterfaces(other.mInterfaces)
+    , mInterfaceIds(other.mInterfaceIds)
     , mInterfaceMapping(other.mInterfaceMapping)
     , mInterfaceIndexRanges(other.mInterfaceIndexRanges)
     , mIdx2Agents(other.mIdx2Agents)
@@ -232,6 +373,45 @@ Connectivity::Connectivity(Connectivity& other)
     mExistingConnections.update(*this, other.mExistingConnections);
 }
 
+owlapi::model::IRIList
+Connectivity::getInterfaces(owlapi::model::OWLOntologyAsk ask,
+                            const owlapi::model::IRI& model,
+                            const owlapi::model::IRI& property,
+                            const owlapi::model::IRI& interfaceBaseClass)
+{
+    std::vector<OWLCardinalityRestriction::Ptr> restrictions =
+        ask.getCardinalityRestrictions(model, property, interfaceBaseClass);
+
+    owlapi::model::IRIList interfaces;
+    for(const OWLCardinalityRestriction::Ptr& r : restrictions)
+    {
+        const OWLObjectCardinalityRestriction::Ptr& restriction =
+            dynamic_pointer_cast<OWLObjectCardinalityRestriction>(r);
+        if(!restriction)
+        {
+            throw std::runtime_error(
+                "moreorg::algebra::Connectivity::getInterfaces:"
+                " expected OWLObjectCardinalityRestriction");
+        }
+
+        if(restriction->getCardinalityRestrictionType() ==
+           OWLCardinalityRestriction::MAX)
+        {
+            for(size_t i = 0; i < restriction->getCardinality(); ++i)
+            {
+                interfaces.push_back(restriction->getQualification());
+            }
+        } else
+        {
+            LOG_INFO_S << "Found a minimum cardinality restriction "
+                       << restriction->getQualification() << " on model "
+                       << model
+                       << " -- was expecting a max cardinality constraint";
+        }
+    }
+    return interfaces;
+}
+
 void Connectivity::identifyInterfaces()
 {
     assert(!mModelCombination.empty());
@@ -240,40 +420,10 @@ void Connectivity::identifyInterfaces()
     for(; mit != mModelCombination.end(); ++mit)
     {
         const IRI& model = *mit;
-        std::vector<OWLCardinalityRestriction::Ptr> restrictions =
-            mAsk.getCardinalityRestrictions(model,
-                                            mProperty,
-                                            mInterfaceBaseClass);
+        InterfaceTable::InterfaceIdListPtr interfaceIds =
+            mpInterfaceTable->getInterfaces(model);
 
-        owlapi::model::IRIList interfaces;
-        for(const OWLCardinalityRestriction::Ptr& r : restrictions)
-        {
-            const OWLObjectCardinalityRestriction::Ptr& restriction =
-                dynamic_pointer_cast<OWLObjectCardinalityRestriction>(r);
-            if(!restriction)
-            {
-                throw std::runtime_error(
-                    "moreorg::algebra::Connectivity::identifyInterfaces:"
-                    " expected OWLObjectCardinalityRestriction");
-            }
-
-            if(restriction->getCardinalityRestrictionType() ==
-               OWLCardinalityRestriction::MAX)
-            {
-                for(size_t i = 0; i < restriction->getCardinality(); ++i)
-                {
-                    interfaces.push_back(restriction->getQualification());
-                }
-            } else
-            {
-                LOG_INFO_S << "Found a minimum cardinality restriction "
-                           << restriction->getQualification() << " on model "
-                           << model
-                           << " -- was expecting a max cardinality constraint";
-            }
-        }
-
-        if(interfaces.empty())
+        if(interfaceIds->empty())
         {
             throw NoConnectionInterfaces(
                 "moreorg::algebra::Connecticity:"
@@ -283,11 +433,20 @@ void Connectivity::identifyInterfaces()
                 mInterfaceBaseClass.toString());
         }
 
+        owlapi::model::IRIList interfaces;
+        for(InterfaceTable::InterfaceId id : *interfaceIds)
+        {
+            interfaces.push_back(mpInterfaceTable->getInterfaceType(id));
+        }
+
         std::pair<IRI, IRIList> interfacesOfModel(model, interfaces);
         uint32_t startRange = mInterfaces.size();
         mInterfaces.insert(mInterfaces.end(),
                            interfaces.begin(),
                            interfaces.end());
+        mInterfaceIds.insert(mInterfaceIds.end(),
+                             interfaceIds->begin(),
+                             interfaceIds->end());
         uint32_t endRange = mInterfaces.size() - 1;
 
         // for each model register start + end index so that we can define the
@@ -296,36 +455,28 @@ void Connectivity::identifyInterfaces()
         mInterfaceMapping.push_back(interfacesOfModel);
     }
 
-    for(size_t idx = 0; idx < mInterfaces.size() * mInterfaces.size(); ++idx)
-    {
-        size_t a1Idx = idx % mInterfaces.size();
-        size_t a0Idx = (idx - a1Idx) / mInterfaces.size();
-
-        IndexRange idxRange0;
-        IndexRange idxRange1;
+    // All interface types are registered now, so that the snapshot covers
+    // them
+    mpCompatibilityMatrix = mpInterfaceTable->getCompatibilityMatrix();
 
-        for(IndexRange range : mInterfaceIndexRanges)
+    // Map each interface to its agent
+    std::vector<size_t> interface2Agent(mInterfaces.size());
+    for(size_t agent = 0; agent < mInterfaceIndexRanges.size(); ++agent)
+    {
+        const IndexRange& range = mInterfaceIndexRanges[agent];
+        for(size_t i = range.first; i <= range.second; ++i)
         {
-            if(a0Idx >= range.first && a0Idx <= range.second)
-            {
-                idxRange0 = range;
-            }
-            if(a1Idx >= range.first && a1Idx <= range.second)
-            {
-                idxRange1 = range;
-            }
+            interface2Agent[i] = agent;
         }
+    }
 
-        size_t agent0 = std::distance(mInterfaceIndexRanges.begin(),
-                                      std::find(mInterfaceIndexRanges.begin(),
-                                                mInterfaceIndexRanges.end(),
-                                                idxRange0));
-        size_t agent1 = std::distance(mInterfaceIndexRanges.begin(),
-                                      std::find(mInterfaceIndexRanges.begin(),
-                                                mInterfaceIndexRanges.end(),
-                                                idxRange1));
+    for(size_t idx = 0; idx < mInterfaces.size() * mInterfaces.size(); ++idx)
+    {
+        size_t a1Idx = idx % mInterfaces.size();
+        size_t a0Idx = (idx - a1Idx) / mInterfaces.size();
 
-        mIdx2Agents.push_back(std::pair<size_t, size_t>(agent0, agent1));
+        mIdx2Agents.push_back(std::pair<size_t, size_t>(
+            interface2Agent[a0Idx], interface2Agent[a1Idx]));
     }
 }
 
@@ -419,21 +570,8 @@ void Connectivity::applyCompatibilityConstraints(
                         rel(*this, v, Gecode::IRT_EQ, 0);
                     } else
                     {
-                        bool hasRelation = false;
-                        try
-                        {
-                            hasRelation = mAsk.isRelatedTo(
-                                interfaceModel0,
-                                vocabulary::OM::compatibleWith(),
-                                interfaceModel1);
-                        } catch(const std::invalid_argument& e)
-                        {
-                            LOG_INFO_S << "No relation found between "
-                                       << interfaceModel0 << " and "
-                                       << interfaceModel1 << " -- " << e.what();
-                            // seems there is not even an individual for this
-                            // interface type
-                        }
+                        bool hasRelation = mpCompatibilityMatrix->isCompatible(
+                            mInterfaceIds[i0], mInterfaceIds[i1]);
 
                         if(hasRelation)
                         {
@@ -526,8 +664,10 @@ bool Connectivity::isComplete() const
     mpBaseGraph = BaseGraph::getInstance(BaseGraph::LEMON_DIRECTED_GRAPH);
     for(size_t i = 0; i < mInterfaceMapping.size(); ++i)
     {
+        // Label with the full IRI, since fragments can collide across
+        // namespaces
         Vertex::Ptr v =
-            make_shared<Vertex>(mInterfaceMapping[i].first.getFragment());
+            make_shared<Vertex>(mInterfaceMapping[i].first.toString());
         mpBaseGraph->addVertex(v);
 
         vertices.push_back(v);
@@ -572,10 +712,10 @@ bool Connectivity::isComplete() const
                         connectionFound = true;
                         Edge::Ptr e0 =
                             make_shared<Edge>(vertices[a0], vertices[a1]);
-                        e0->setLabel(interfaceModel0.getFragment());
+                        e0->setLabel(interfaceModel0.toString());
                         Edge::Ptr e1 =
                             make_shared<Edge>(vertices[a1], vertices[a0]);
-                        e1->setLabel(interfaceModel1.getFragment());
+                        e1->setLabel(interfaceModel1.toString());
                         mpBaseGraph->addEdge(e0);
                         mpBaseGraph->addEdge(e1);
                         break;
@@ -605,10 +745,27 @@ bool Connectivity::isFeasible(const ModelPool& modelPool,
                               size_t minFeasible,
                               const owlapi::model::IRI& interfaceBaseClass)
 {
-    msConnectionGraph.reset();
+    graph_analysis::BaseGraph::Ptr connectionGraph;
+    return Connectivity::isFeasible(modelPool,
+                                    ask,
+                                    connectionGraph,
+                                    timeoutInMs,
+                                    minFeasible,
+                                    interfaceBaseClass);
+}
+
+bool Connectivity::isFeasible(const ModelPool& modelPool,
+                              const OrganizationModelAsk& ask,
+                              graph_analysis::BaseGraph::Ptr& baseGraph,
+                              double timeoutInMs,
+                              size_t minFeasible,
+                              const owlapi::model::IRI& interfaceBaseClass)
+{
+    Connectivity::Statistics statistics;
     return Connectivity::isFeasible(modelPool,
                                     ask,
-                                    msConnectionGraph,
+                                    baseGraph,
+                                    statistics,
                                     timeoutInMs,
                                     minFeasible,
                                     interfaceBaseClass);
@@ -617,26 +774,348 @@ bool Connectivity::isFeasible(const ModelPool& modelPool,
 bool Connectivity::isFeasible(const ModelPool& modelPool,
                               const OrganizationModelAsk& ask,
                               graph_analysis::BaseGraph::Ptr& baseGraph,
+                              Connectivity::Statistics& statistics,
                               double timeoutInMs,
                               size_t minFeasible,
                               const owlapi::model::IRI& interfaceBaseClass)
 {
+    statistics = Connectivity::Statistics();
+
+    const FeasibilityCache::Ptr& cache = ask.getFeasibilityCache();
     FeasibilityQuery query =
-        std::make_tuple(modelPool,
-                        ask.ontology().getOntology()->getIRI(),
-                        interfaceBaseClass,
-                        timeoutInMs,
-                        minFeasible);
+        createQuery(modelPool, ask, interfaceBaseClass, minFeasible);
 
-    QueryCache::const_iterator cit = msQueryCache.find(query);
-    if(cit != msQueryCache.end())
+    FeasibilityCache::Result cachedResult;
+    if(cache && cache->lookup(query, cachedResult, timeoutInMs))
     {
-        std::pair<graph_analysis::BaseGraph::Ptr, bool> cachedResult =
-            cit->second;
+        statistics.cached = true;
         baseGraph = cachedResult.first;
         return cachedResult.second;
     }
 
+    return checkFeasibility(modelPool,
+                            ask,
+                            baseGraph,
+                            statistics,
+                            timeoutInMs,
+                            minFeasible,
+                            interfaceBaseClass);
+}
+
+bool Connectivity::isFeasibleExtension(
+    const ModelPool& basePool,
+    const graph_analysis::BaseGraph::Ptr& baseGraph,
+    const ModelPool& addedPool,
+    const OrganizationModelAsk& ask,
+    graph_analysis::BaseGraph::Ptr& graph,
+    Connectivity::Statistics& statistics,
+    double timeoutInMs,
+    size_t minFeasible,
+    const owlapi::model::IRI& interfaceBaseClass)
+{
+    statistics = Connectivity::Statistics();
+
+    ModelPool modelPool = Algebra::sum(basePool, addedPool).toModelPool();
+    const FeasibilityCache::Ptr& cache = ask.getFeasibilityCache();
+    FeasibilityQuery query =
+        createQuery(modelPool, ask, interfaceBaseClass, minFeasible);
+
+    FeasibilityCache::Result cachedResult;
+    if(cache && cache->lookup(query, cachedResult, timeoutInMs))
+    {
+        statistics.cached = true;
+        graph = cachedResult.first;
+        return cachedResult.second;
+    }
+
+    // An extension yields a single solution only
+    if(minFeasible == 1 && !addedPool.isNull())
+    {
+        base::Time startTime = base::Time::now();
+        if(extendConnectionGraph(basePool,
+                                 baseGraph,
+                                 addedPool,
+                                 ask,
+                                 interfaceBaseClass,
+                                 graph))
+        {
+            statistics.extended = true;
+            statistics.timeInS = (base::Time::now() - startTime).toSeconds();
+            if(cache)
+            {
+                cache->insert(query, std::make_pair(graph, true));
+            }
+            return true;
+        }
+    }
+
+    return checkFeasibility(modelPool,
+                            ask,
+                            graph,
+                            statistics,
+                            timeoutInMs,
+                            minFeasible,
+                            interfaceBaseClass);
+}
+
+bool Connectivity::isFeasibleIncremental(
+    const ModelPool& modelPool,
+    const OrganizationModelAsk& ask,
+    graph_analysis::BaseGraph::Ptr& baseGraph,
+    Connectivity::Statistics& statistics,
+    double timeoutInMs,
+    size_t minFeasible,
+    const owlapi::model::IRI& interfaceBaseClass)
+{
+    statistics = Connectivity::Statistics();
+
+    const FeasibilityCache::Ptr& cache = ask.getFeasibilityCache();
+    FeasibilityQuery query =
+        createQuery(modelPool, ask, interfaceBaseClass, minFeasible);
+
+    FeasibilityCache::Result cachedResult;
+    if(cache && cache->lookup(query, cachedResult, timeoutInMs))
+    {
+        statistics.cached = true;
+        baseGraph = cachedResult.first;
+        return cachedResult.second;
+    }
+
+    ModelPool compactPool = modelPool.compact();
+    if(minFeasible == 1 && compactPool.numberOfInstances() > 1)
+    {
+        base::Time startTime = base::Time::now();
+        // Find a feasible sub-pool, which lacks a single agent
+        for(const ModelPool::value_type& v : compactPool)
+        {
+            ModelPool subPool = compactPool;
+            subPool[v.first] -= 1;
+            subPool = subPool.compact();
+
+            graph_analysis::BaseGraph::Ptr subGraph;
+            // An atomic agent is always feasible and comes without a graph
+            if(subPool.numberOfInstances() > 1)
+            {
+                FeasibilityCache::Result subResult;
+                FeasibilityQuery subQuery =
+                    createQuery(subPool, ask, interfaceBaseClass, minFeasible);
+                if(!cache || !cache->lookup(subQuery, subResult, timeoutInMs) ||
+                   !subResult.second || !subResult.first)
+                {
+                    continue;
+                }
+                subGraph = subResult.first;
+            }
+
+            ModelPool addedPool;
+            addedPool[v.first] = 1;
+            if(extendConnectionGraph(subPool,
+                                     subGraph,
+                                     addedPool,
+                                     ask,
+                                     interfaceBaseClass,
+                                     baseGraph))
+            {
+                statistics.extended = true;
+                statistics.timeInS =
+                    (base::Time::now() - startTime).toSeconds();
+                if(cache)
+                {
+                    cache->insert(query, std::make_pair(baseGraph, true));
+                }
+                return true;
+            }
+        }
+    }
+
+    return checkFeasibility(modelPool,
+                            ask,
+                            baseGraph,
+                            statistics,
+                            timeoutInMs,
+                            minFeasible,
+                            interfaceBaseClass);
+}
+
+bool Connectivity::extendConnectionGraph(
+    const ModelPool& basePool,
+    const graph_analysis::BaseGraph::Ptr& baseGraph,
+    const ModelPool& addedPool,
+    const OrganizationModelAsk& ask,
+    const owlapi::model::IRI& interfaceBaseClass,
+    graph_analysis::BaseGraph::Ptr& graph)
+{
+    using namespace graph_analysis;
+
+    ModelPool compactBasePool = basePool.compact();
+    if(compactBasePool.empty())
+    {
+        return false;
+    }
+
+    InterfaceTable::Ptr interfaceTable =
+        InterfaceTable::getInstance(ask, interfaceBaseClass);
+
+    // The connected agents, their models and their remaining free interfaces
+    std::vector<Vertex::Ptr> agents;
+    std::vector<IRI> agentModels;
+    std::vector<InterfaceTable::InterfaceIdList> freeInterfaces;
+
+    if(!baseGraph)
+    {
+        if(compactBasePool.numberOfInstances() != 1)
+        {
+            return false;
+        }
+
+        const IRI& model = compactBasePool.begin()->first;
+        graph = BaseGraph::getInstance(BaseGraph::LEMON_DIRECTED_GRAPH);
+        Vertex::Ptr vertex = make_shared<Vertex>(model.toString());
+        graph->addVertex(vertex);
+        agents.push_back(vertex);
+        agentModels.push_back(model);
+        freeInterfaces.push_back(*interfaceTable->getInterfaces(model));
+    } else
+    {
+        graph = baseGraph->clone();
+
+        // Vertices are labelled with the IRI of the agent model
+        std::map<std::string, IRI> label2Model;
+        for(const ModelPool::value_type& v : compactBasePool)
+        {
+            label2Model[v.first.toString()] = v.first;
+        }
+
+        std::vector<Vertex::Ptr> vertices = graph->getAllVertices();
+        if(vertices.size() != compactBasePool.numberOfInstances())
+        {
+            LOG_DEBUG_S << "Connection graph does not match the base pool";
+            return false;
+        }
+
+        std::map<Vertex::Ptr, size_t> vertexIndex;
+        for(const Vertex::Ptr& vertex : vertices)
+        {
+            std::map<std::string, IRI>::const_iterator mit =
+                label2Model.find(vertex->getLabel());
+            if(mit == label2Model.end())
+            {
+                LOG_DEBUG_S << "Connection graph does not match the base pool";
+                return false;
+            }
+            vertexIndex[vertex] = agents.size();
+            agents.push_back(vertex);
+            agentModels.push_back(mit->second);
+            freeInterfaces.push_back(
+                *interfaceTable->getInterfaces(mit->second));
+        }
+
+        // Each link is represented by two directed edges, which are labelled
+        // with the interface of their source agent
+        for(const Edge::Ptr& edge : graph->getAllEdges())
+        {
+            InterfaceTable::InterfaceIdList& interfaces =
+                freeInterfaces[vertexIndex.at(edge->getSourceVertex())];
+            InterfaceTable::InterfaceIdList::iterator iit = interfaces.begin();
+            for(; iit != interfaces.end(); ++iit)
+            {
+                if(interfaceTable->getInterfaceType(*iit).toString() ==
+                   edge->getLabel())
+                {
+                    break;
+                }
+            }
+            if(iit == interfaces.end())
+            {
+                LOG_DEBUG_S << "Connection graph does not match the base pool";
+                return false;
+            }
+            interfaces.erase(iit);
+        }
+    }
+
+    // Attach each added agent with a single link, so that the graph remains a
+    // connected tree
+    ModelCombination addedAgents = addedPool.compact().toModelCombination();
+    for(const IRI& model : addedAgents)
+    {
+        interfaceTable->getInterfaces(model);
+    }
+    // All interface types are registered now, so that the snapshot covers
+    // them
+    InterfaceTable::CompatibilityMatrix::Ptr compatibility =
+        interfaceTable->getCompatibilityMatrix();
+
+    for(const IRI& model : addedAgents)
+    {
+        InterfaceTable::InterfaceIdList interfaces =
+            *interfaceTable->getInterfaces(model);
+        bool attached = false;
+        for(size_t a = 0; a < agents.size() && !attached; ++a)
+        {
+            InterfaceTable::InterfaceIdList& agentInterfaces =
+                freeInterfaces[a];
+            for(size_t i0 = 0; i0 < agentInterfaces.size() && !attached; ++i0)
+            {
+                for(size_t i1 = 0; i1 < interfaces.size(); ++i1)
+                {
+                    if(!isLinkCompatible(*compatibility,
+                                         agentModels[a],
+                                         agentInterfaces[i0],
+                                         model,
+                                         interfaces[i1]))
+                    {
+                        continue;
+                    }
+
+                    Vertex::Ptr vertex = make_shared<Vertex>(model.toString());
+                    graph->addVertex(vertex);
+
+                    Edge::Ptr e0 = make_shared<Edge>(agents[a], vertex);
+                    e0->setLabel(
+                        interfaceTable->getInterfaceType(agentInterfaces[i0])
+                            .toString());
+                    Edge::Ptr e1 = make_shared<Edge>(vertex, agents[a]);
+                    e1->setLabel(
+                        interfaceTable->getInterfaceType(interfaces[i1])
+                            .toString());
+                    graph->addEdge(e0);
+                    graph->addEdge(e1);
+
+                    agentInterfaces.erase(agentInterfaces.begin() + i0);
+                    interfaces.erase(interfaces.begin() + i1);
+                    agents.push_back(vertex);
+                    agentModels.push_back(model);
+                    freeInterfaces.push_back(interfaces);
+                    attached = true;
+                    break;
+                }
+            }
+        }
+
+        if(!attached)
+        {
+            LOG_DEBUG_S << "Failed to attach " << model
+                        << " to the existing connection graph";
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Connectivity::checkFeasibility(
+    const ModelPool& modelPool,
+    const OrganizationModelAsk& ask,
+    graph_analysis::BaseGraph::Ptr& baseGraph,
+    Connectivity::Statistics& statistics,
+    double timeoutInMs,
+    size_t minFeasible,
+    const owlapi::model::IRI& interfaceBaseClass)
+{
+    const FeasibilityCache::Ptr& cache = ask.getFeasibilityCache();
+    FeasibilityQuery query =
+        createQuery(modelPool, ask, interfaceBaseClass, minFeasible);
+
     // For a single system this check is trivially true
     size_t numberOfInstances = modelPool.numberOfInstances();
     if(numberOfInstances == 0)
@@ -650,25 +1129,137 @@ bool Connectivity::isFeasible(const ModelPool& modelPool,
         return true;
     }
 
-    msStatistics.evaluations = 0;
+    if(isStructuralFilterEnabled() &&
+       !StructuralFilter::getInstance(ask, interfaceBaseClass)
+            ->isPotentiallyFeasible(modelPool))
+    {
+        statistics.pruned = true;
+        baseGraph = graph_analysis::BaseGraph::Ptr();
+        if(cache)
+        {
+            cache->insert(query, std::make_pair(baseGraph, false));
+        }
+        return false;
+    }
 
-    Connectivity* last = NULL;
-    Connectivity* connectivity = NULL;
+    // The ontology is shared, so that only the search itself runs without
+    // holding the lock
+    boost::recursive_mutex& mutex =
+        ask.getOrganizationModel()->getOntologyMutex();
+    boost::unique_lock<boost::recursive_mutex> lock(mutex);
+
+    size_t portfolioSize = getPortfolioSize();
+    size_t numberOfThreads = getNumberOfSearchThreads();
+
+    std::vector<Connectivity*> portfolio;
     try
     {
-        connectivity = new Connectivity(modelPool, ask, interfaceBaseClass);
+        for(size_t i = 0; i < portfolioSize; ++i)
+        {
+            portfolio.push_back(new Connectivity(modelPool,
+                                                 ask,
+                                                 interfaceBaseClass,
+                                                 vocabulary::OM::has(),
+                                                 Branching::forPortfolio(i)));
+        }
     } catch(const NoConnectionInterfaces& e)
     {
+        for(Connectivity* connectivity : portfolio)
+        {
+            delete connectivity;
+        }
         LOG_INFO_S << "No connection interfaces of type '" << interfaceBaseClass
                    << "' found on " << modelPool.toString(4);
         return false;
     }
+    lock.unlock();
+
+    bool isComplete = false;
+    if(portfolio.size() == 1)
+    {
+        isComplete = search(portfolio.front(),
+                            timeoutInMs,
+                            minFeasible,
+                            numberOfThreads,
+                            mutex,
+                            NULL,
+                            baseGraph,
+                            statistics);
+    } else
+    {
+        // Run all members of the portfolio concurrently, the first one which
+        // finds the required number of solutions cancels the others
+        std::atomic<bool> solved(false);
+        std::vector<graph_analysis::BaseGraph::Ptr> graphs(portfolio.size());
+        std::vector<Connectivity::Statistics> portfolioStatistics(
+            portfolio.size());
+        std::vector<char> complete(portfolio.size(), false);
+        std::atomic<int> winner(-1);
+
+        boost::thread_group workers;
+        for(size_t i = 0; i < portfolio.size(); ++i)
+        {
+            workers.create_thread([&, i]() {
+                complete[i] = search(portfolio[i],
+                                     timeoutInMs,
+                                     minFeasible,
+                                     numberOfThreads,
+                                     mutex,
+                                     &solved,
+                                     graphs[i],
+                                     portfolioStatistics[i]);
+                int none = -1;
+                if(complete[i] &&
+                   winner.compare_exchange_strong(none, static_cast<int>(i)))
+                {
+                    solved = true;
+                }
+            });
+        }
+        workers.join_all();
+
+        size_t selected = winner >= 0 ? winner : 0;
+        isComplete = complete[selected];
+        baseGraph = graphs[selected];
+        statistics = portfolioStatistics[selected];
+    }
+
+    lock.lock();
+    for(Connectivity* connectivity : portfolio)
+    {
+        delete connectivity;
+    }
+    lock.unlock();
+
+    // A check which has been stopped by the timeout is only valid for this
+    // timeout, whereas a found solution remains valid
+    if(cache)
+    {
+        cache->insert(query,
+                      std::make_pair(baseGraph, isComplete),
+                      !isComplete && statistics.stopped ? timeoutInMs : 0);
+    }
+    return isComplete;
+}
+
+bool Connectivity::search(Connectivity* connectivity,
+                          double timeoutInMs,
+                          size_t minFeasible,
+                          size_t numberOfThreads,
+                          boost::recursive_mutex& mutex,
+                          const std::atomic<bool>* cancelled,
+                          graph_analysis::BaseGraph::Ptr& baseGraph,
+                          Connectivity::Statistics& statistics)
+{
+    // The stop object has to outlive the search engine
+    CancelableStop stop(timeoutInMs, cancelled);
 
     Gecode::Search::Options options;
-    if(timeoutInMs > 0)
+    if(timeoutInMs > 0 || cancelled)
     {
-        options.stop = Gecode::Search::Stop::time(timeoutInMs);
+        options.stop = &stop;
     }
+    options.threads = numberOfThreads;
     options.nogoods_limit = 1024;
     // Gecode::Search::Cutoff * c = Gecode::Search::Cutoff::geometric(10,2);
     Gecode::Search::Cutoff* c = Gecode::Search::Cutoff::constant(10);
@@ -682,16 +1273,20 @@ bool Connectivity::isFeasible(const ModelPool& modelPool,
 
     bool isComplete = false;
     size_t feasibleSolutions = 0;
+    Connectivity* last = NULL;
     Connectivity* current = NULL;
     base::Time startTime = base::Time::now();
     try
     {
         while((current = searchEngine.next()))
         {
-            ++msStatistics.evaluations;
+            ++statistics.evaluations;
 
-            isComplete = current->isComplete();
-            baseGraph = current->mpBaseGraph->clone();
+            {
+                boost::unique_lock<boost::recursive_mutex> graphLock(mutex);
+                isComplete = current->isComplete();
+                baseGraph = current->mpBaseGraph->clone();
+            }
             delete last;
             last = NULL;
 
@@ -717,15 +1312,13 @@ bool Connectivity::isFeasible(const ModelPool& modelPool,
         LOG_WARN_S << e.what();
     }
 
-    msStatistics.timeInS = (base::Time::now() - startTime).toSeconds();
-    msStatistics.stopped = searchEngine.stopped();
-    msStatistics.csp = searchEngine.statistics();
+    statistics.timeInS = (base::Time::now() - startTime).toSeconds();
+    statistics.stopped = searchEngine.stopped();
+    statistics.csp = searchEngine.statistics();
 
+    boost::unique_lock<boost::recursive_mutex> lock(mutex);
     delete last;
     delete current;
-    delete connectivity;
-
-    msQueryCache[query] = std::make_pair(baseGraph, isComplete);
     return isComplete;
 }
 
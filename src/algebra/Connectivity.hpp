@@ -1,14 +1,16 @@
 #ifndef ORGANIZATION_MODEL_ALGEBRA_CONNECTIVITY_HPP
 #define ORGANIZATION_MODEL_ALGEBRA_CONNECTIVITY_HPP
 
+#include <atomic>
 #include <base/Time.hpp>
 #include <functional>
 #include <gecode/search.hh>
 #include <gecode/set.hh>
 #include <tuple>
-#include <unordered_map>
 
 #include "../OrganizationModelAsk.hpp"
+#include "FeasibilityCache.hpp"
+#include "InterfaceTable.hpp"
 #include "../vocabularies/OM.hpp"
 #include <graph_analysis/BaseGraph.hpp>
 #include <numeric/Stats.hpp>
@@ -17,41 +19,6 @@
 namespace moreorg {
 namespace algebra {
 
-typedef std::
-    tuple<ModelPool, owlapi::model::IRI, owlapi::model::IRI, double, size_t>
-        FeasibilityQuery;
-
-typedef std::unordered_map<FeasibilityQuery,
-                           std::pair<graph_analysis::BaseGraph::Ptr, bool>>
-    QueryCache;
-} // end namespace algebra
-} // end namespace moreorg
-
-namespace std {
-using namespace owlapi::model;
-using namespace moreorg::algebra;
-template <> struct hash<FeasibilityQuery>
-{
-    size_t operator()(const FeasibilityQuery& query) const
-    {
-        size_t seed = 0;
-        for(const ModelPool::value_type& v : get<0>(query))
-        {
-            boost::hash_combine(seed, v.first.toString());
-            boost::hash_combine(seed, v.second);
-        }
-        boost::hash_combine(seed, get<1>(query).toString());
-        boost::hash_combine(seed, get<2>(query).toString());
-        boost::hash_combine(seed, get<3>(query));
-        boost::hash_combine(seed, get<4>(query));
-        return seed;
-    }
-};
-} // end namespace std
-
-namespace moreorg {
-namespace algebra {
-
 /**
  * \class Connectivity
  * \brief Allow to check the feasibility of interfacing, i.e., whether or not
@@ -61,16 +28,23 @@ class Connectivity : public Gecode::Space
 {
     /// Model pool which has to be checked for its connectivity
     ModelPool mModelPool;
-    /// The organization model
-    owlapi::model::OWLOntologyAsk mAsk;
 
     owlapi::model::IRI mInterfaceBaseClass;
     owlapi::model::IRI mProperty;
 
+    /// Interfaces of the agent models and their compatibility, shared for
+    /// the ontology
+    InterfaceTable::Ptr mpInterfaceTable;
+    /// Snapshot of the compatibility matrix which covers all interfaces in
+    /// mInterfaceIds
+    InterfaceTable::CompatibilityMatrix::Ptr mpCompatibilityMatrix;
+
     // Explicitly enumerated type (in contrast to the cardinality based
     // representation via ModelPool
     ModelCombination mModelCombination;
     owlapi::model::IRIList mInterfaces;
+    /// Index of the interface type for each entry of mInterfaces
+    InterfaceTable::InterfaceIdList mInterfaceIds;
 
     // Index of interface mapping and interface index range correspond to the
     // same model instance
@@ -131,6 +105,14 @@ public:
         uint64_t evaluations;
         double timeInS;
         int stopped;
+        /// True if the result has been retrieved from the feasibility cache
+        bool cached;
+        /// True if the result has been obtained by extending the connection
+        /// graph of a feasible sub-pool
+        bool extended;
+        /// True if the pool has been rejected by the structural filter, so
+        /// that no search has been performed
+        bool pruned;
         /**
          * Statistics of the underlying csp search:
          *     fail: number of failed nodes in search tree
@@ -161,11 +143,43 @@ public:
         toString(const std::vector<Connectivity::Statistics>& stats);
     };
 
+    /**
+     * Branching strategy of the search
+     * \see utils::GecodeUtils for the supported selection strategies
+     */
+    struct Branching
+    {
+        Branching();
+
+        std::string variableSelection;
+        std::string valueSelection;
+        /// Seed for the random number generator, 0 to use the hardware
+        /// entropy source
+        unsigned int seed;
+
+        /**
+         * Get the branching as defined by the configuration, i.e.,
+         * connectivity/branching/variable-selection and
+         * connectivity/branching/value-selection
+         */
+        static Branching fromConfiguration();
+
+        /**
+         * Get the branching for a member of a search portfolio: odd members
+         * use connectivity/portfolio/variable-selection (default: RND)
+         * and if connectivity/portfolio/seed is set, then the member's seed
+         * is offset by its index
+         * \param index Index of the member in the portfolio
+         */
+        static Branching forPortfolio(size_t index);
+    };
+
     Connectivity(const ModelPool& modelPool,
                  const OrganizationModelAsk& ask,
                  const owlapi::model::IRI& interfaceBaseClass =
                      vocabulary::OM::resolve("ElectroMechanicalInterface"),
-                 const owlapi::model::IRI& property = vocabulary::OM::has());
+                 const owlapi::model::IRI& property = vocabulary::OM::has(),
+                 const Branching& branching = Branching::fromConfiguration());
 
     /**
      * Search support
@@ -181,7 +195,29 @@ public:
         msConfiguration = configuration;
     }
 
-    qxcfg::Configuration& getConfiguration() { return msConfiguration; }
+    static qxcfg::Configuration& getConfiguration() { return msConfiguration; }
+
+    /**
+     * Get the number of differently branched search engines which run
+     * concurrently for each feasibility check, as set by
+     * connectivity/portfolio/size (default: 1, i.e. no portfolio)
+     */
+    static size_t getPortfolioSize();
+
+    /**
+     * Get the number of threads each search engine uses, as set by
+     * connectivity/search/threads (default: 1, 0 to use all available
+     * cores)
+     */
+    static size_t getNumberOfSearchThreads();
+
+    /**
+     * Check if model pools are checked against necessary conditions before
+     * the search, as set by connectivity/structural-filter/enabled
+     * (default: 1)
+     * \see StructuralFilter
+     */
+    static bool isStructuralFilterEnabled();
 
     /**
      * Create a copy of this space
@@ -227,6 +263,89 @@ public:
                const owlapi::model::IRI& interfaceBaseClass =
                    vocabulary::OM::resolve("ElectroMechanicalInterface"));
 
+    /**
+     * Check whether a model pool can be fully connected
+     * \param modelPool ModelPool to check if all agents can form a single unit
+     * \param ask OrganizationModel to use for information about available
+     * interfaces etc. -- results are cached in its feasibility cache
+     * \param baseGraph that hold the resulting connection graph
+     * \param statistics Statistics of this particular feasibility check
+     * \param timeoutInMs Timeout of the feasibility check, default is 0
+     * \return True if a connection is feasible, false otherwise
+     */
+    static bool
+    isFeasible(const ModelPool& modelPool,
+               const OrganizationModelAsk& ask,
+               graph_analysis::BaseGraph::Ptr& baseGraph,
+               Connectivity::Statistics& statistics,
+               double timeoutInMs = 0,
+               size_t minFeasible = 1,
+               const owlapi::model::IRI& interfaceBaseClass =
+                   vocabulary::OM::resolve("ElectroMechanicalInterface"));
+
+    /**
+     * Check whether a model pool can be fully connected by extending the
+     * known connection graph of a feasible sub-pool
+     *
+     * The added agents are attached one by one to free and compatible
+     * interfaces of the already connected agents. Only if that fails, the
+     * full feasibility check of the combined pool is performed.
+     * \param basePool Feasible sub-pool
+     * \param baseGraph Connection graph of the sub-pool, can be empty if the
+     * sub-pool consists of a single agent
+     * \param addedPool Agents that are added to the sub-pool
+     * \param ask OrganizationModel to use for information about available
+     * interfaces etc. -- results are cached in its feasibility cache
+     * \param graph Resulting connection graph of the combined pool
+     * \param statistics Statistics of this particular feasibility check
+     * \param timeoutInMs Timeout of the (fallback) feasibility check
+     * \return True if a connection is feasible for the combined pool, false
+     * otherwise
+     */
+    static bool isFeasibleExtension(
+        const ModelPool& basePool,
+        const graph_analysis::BaseGraph::Ptr& baseGraph,
+        const ModelPool& addedPool,
+        const OrganizationModelAsk& ask,
+        graph_analysis::BaseGraph::Ptr& graph,
+        Connectivity::Statistics& statistics,
+        double timeoutInMs = 0,
+        size_t minFeasible = 1,
+        const owlapi::model::IRI& interfaceBaseClass =
+            vocabulary::OM::resolve("ElectroMechanicalInterface"));
+
+    /**
+     * Check whether a model pool can be fully connected, reusing the cached
+     * connection graph of a feasible sub-pool which lacks one agent if
+     * available
+     * \see isFeasibleExtension
+     * \return True if a connection is feasible, false otherwise
+     */
+    static bool isFeasibleIncremental(
+        const ModelPool& modelPool,
+        const OrganizationModelAsk& ask,
+        graph_analysis::BaseGraph::Ptr& baseGraph,
+        Connectivity::Statistics& statistics,
+        double timeoutInMs = 0,
+        size_t minFeasible = 1,
+        const owlapi::model::IRI& interfaceBaseClass =
+            vocabulary::OM::resolve("ElectroMechanicalInterface"));
+
+    /**
+     * Get the list of interfaces of a model, where an interface is listed
+     * as often as the model's max cardinality restriction permits
+     * \param ask Ontology to query
+     * \param model Agent model
+     * \param property Property that relates agent and interface
+     * \param interfaceBaseClass The base type for the interfaces that have to
+     * be considered
+     */
+    static owlapi::model::IRIList
+    getInterfaces(owlapi::model::OWLOntologyAsk ask,
+                  const owlapi::model::IRI& model,
+                  const owlapi::model::IRI& property,
+                  const owlapi::model::IRI& interfaceBaseClass);
+
     /**
      * Convert solution to string
      */
@@ -239,31 +358,53 @@ public:
      */
     double computeMerit(Gecode::IntVar x, int idx) const;
 
+protected:
     /**
-     * Return the number of evaluations for the last feasibility check
+     * Check the feasibility of a model pool, without looking up the
+     * feasibility cache, but inserting the result into it
      */
-    static const Connectivity::Statistics& getStatistics()
-    {
-        return msStatistics;
-    }
+    static bool checkFeasibility(const ModelPool& modelPool,
+                                 const OrganizationModelAsk& ask,
+                                 graph_analysis::BaseGraph::Ptr& baseGraph,
+                                 Connectivity::Statistics& statistics,
+                                 double timeoutInMs,
+                                 size_t minFeasible,
+                                 const owlapi::model::IRI& interfaceBaseClass);
 
     /**
-     * Retrieve the connection graph of the last feasibility check
-     * \return connection graph
+     * Try to extend the connection graph of a feasible sub-pool by attaching
+     * each added agent to a free compatible interface
+     * \param graph Extended connection graph if successful
+     * \return True if all added agents could be attached, false otherwise
      */
-    static const graph_analysis::BaseGraph::Ptr& getConnectionGraph()
-    {
-        return msConnectionGraph;
-    }
+    static bool extendConnectionGraph(
+        const ModelPool& basePool,
+        const graph_analysis::BaseGraph::Ptr& baseGraph,
+        const ModelPool& addedPool,
+        const OrganizationModelAsk& ask,
+        const owlapi::model::IRI& interfaceBaseClass,
+        graph_analysis::BaseGraph::Ptr& graph);
 
     /**
-     * Reset / Clear the used query cache
+     * Search for a complete connection
+     * \param connectivity Root space of the search
+     * \param timeoutInMs Timeout of the search, 0 for no timeout
+     * \param minFeasible Minimum number of feasible solutions to find
+     * \param numberOfThreads Number of threads for the search engine
+     * \param mutex Mutex that guards the access to the ontology
+     * \param cancelled Optional flag to cancel the search
+     * \param baseGraph Resulting connection graph
+     * \param statistics Statistics of this search
+     * \return True if a complete connection has been found
      */
-    static void resetQueryCache() { msQueryCache.clear(); }
-
-protected:
-    static Connectivity::Statistics msStatistics;
-    static graph_analysis::BaseGraph::Ptr msConnectionGraph;
+    static bool search(Connectivity* connectivity,
+                       double timeoutInMs,
+                       size_t minFeasible,
+                       size_t numberOfThreads,
+                       boost::recursive_mutex& mutex,
+                       const std::atomic<bool>* cancelled,
+                       graph_analysis::BaseGraph::Ptr& baseGraph,
+                       Connectivity::Statistics& statistics);
 
     // General configuration to control, e.g. the branching behaviour
     static qxcfg::Configuration msConfiguration;
@@ -276,8 +417,6 @@ protected:
         {
         }
     };
-
-    static QueryCache msQueryCache;
 };
 
 } // end namespace algebra
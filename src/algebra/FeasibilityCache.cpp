@@ -0,0 +1,164 @@
+#include "FeasibilityCache.hpp"
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+
+namespace moreorg {
+namespace algebra {
+
+FeasibilityCache::Statistics::Statistics()
+    : hits(0)
+    , misses(0)
+    , evictions(0)
+    , size(0)
+{
+}
+
+std::string FeasibilityCache::Statistics::toString(size_t indent) const
+{
+    std::stringstream ss;
+    std::string hspace(indent, ' ');
+    ss << hspace << "FeasibilityCache:" << std::endl;
+    ss << hspace << "    # hits: " << hits << std::endl;
+    ss << hspace << "    # misses: " << misses << std::endl;
+    ss << hspace << "    # evictions: " << evictions << std::endl;
+    ss << hspace << "    # entries: " << size << std::endl;
+    return ss.str();
+}
+
+FeasibilityCache::FeasibilityCache(size_t maxSize, size_t numberOfShards)
+    : mMaxSize(maxSize)
+    , mMaxSizePerShard(0)
+    , mHits(0)
+    , mMisses(0)
+    , mEvictions(0)
+{
+    if(numberOfShards == 0)
+    {
+        throw std::invalid_argument(
+            "moreorg::algebra::FeasibilityCache: number of shards must be "
+            "greater than 0");
+    }
+
+    if(mMaxSize != 0)
+    {
+        numberOfShards = std::min(numberOfShards, mMaxSize);
+        mMaxSizePerShard = (mMaxSize + numberOfShards - 1) / numberOfShards;
+    }
+
+    for(size_t i = 0; i < numberOfShards; ++i)
+    {
+        mShards.push_back(std::unique_ptr<Shard>(new Shard()));
+    }
+}
+
+FeasibilityCache::Shard& FeasibilityCache::getShard(size_t hash) const
+{
+    // Use the upper bits, since the lower bits select the bucket within the
+    // shard
+    return *mShards[(hash >> 16) % mShards.size()];
+}
+
+bool FeasibilityCache::lookup(const FeasibilityQuery& query,
+                              Result& result,
+                              double timeoutInMs)
+{
+    Key key{query, std::hash<FeasibilityQuery>()(query)};
+    Shard& shard = getShard(key.hash);
+
+    boost::unique_lock<boost::mutex> lock(shard.mutex);
+    auto it = shard.index.find(key);
+    if(it == shard.index.end())
+    {
+        ++mMisses;
+        return false;
+    }
+
+    // A check with a larger timeout (or none) might still complete
+    double stoppedTimeoutInMs = it->second->second.stoppedTimeoutInMs;
+    if(stoppedTimeoutInMs != 0 &&
+       (timeoutInMs == 0 || timeoutInMs > stoppedTimeoutInMs))
+    {
+        ++mMisses;
+        return false;
+    }
+
+    shard.entries.splice(shard.entries.begin(), shard.entries, it->second);
+    result = it->second->second.result;
+    ++mHits;
+    return true;
+}
+
+void FeasibilityCache::insert(const FeasibilityQuery& query,
+                              const Result& result,
+                              double stoppedTimeoutInMs)
+{
+    Key key{query, std::hash<FeasibilityQuery>()(query)};
+    Shard& shard = getShard(key.hash);
+    Entry entry{result, stoppedTimeoutInMs};
+
+    boost::unique_lock<boost::mutex> lock(shard.mutex);
+    auto it = shard.index.find(key);
+    if(it != shard.index.end())
+    {
+        // Keep a completed result, e.g., from a concurrent check
+        if(stoppedTimeoutInMs == 0 ||
+           it->second->second.stoppedTimeoutInMs != 0)
+        {
+            it->second->second = entry;
+        }
+        shard.entries.splice(shard.entries.begin(), shard.entries, it->second);
+        return;
+    }
+
+    if(mMaxSizePerShard != 0 && shard.entries.size() >= mMaxSizePerShard)
+    {
+        shard.index.erase(shard.entries.back().first);
+        shard.entries.pop_back();
+        ++mEvictions;
+    }
+
+    shard.entries.push_front(std::make_pair(key, entry));
+    shard.index[key] = shard.entries.begin();
+}
+
+void FeasibilityCache::clear()
+{
+    for(const std::unique_ptr<Shard>& shard : mShards)
+    {
+        boost::unique_lock<boost::mutex> lock(shard->mutex);
+        shard->index.clear();
+        shard->entries.clear();
+    }
+}
+
+void FeasibilityCache::resetStatistics()
+{
+    mHits = 0;
+    mMisses = 0;
+    mEvictions = 0;
+}
+
+FeasibilityCache::Statistics FeasibilityCache::getStatistics() const
+{
+    Statistics statistics;
+    statistics.hits = mHits;
+    statistics.misses = mMisses;
+    statistics.evictions = mEvictions;
+    statistics.size = size();
+    return statistics;
+}
+
+size_t FeasibilityCache::size() const
+{
+    size_t numberOfEntries = 0;
+    for(const std::unique_ptr<Shard>& shard : mShards)
+    {
+        boost::unique_lock<boost::mutex> lock(shard->mutex);
+        numberOfEntries += shard->entries.size();
+    }
+    return numberOfEntries;
+}
+
+} // end namespace algebra
+} // end namespace moreorg
@@ -0,0 +1,196 @@
+#ifndef ORGANIZATION_MODEL_ALGEBRA_FEASIBILITY_CACHE_HPP
+#define ORGANIZATION_MODEL_ALGEBRA_FEASIBILITY_CACHE_HPP
+
+#include <atomic>
+#include <boost/functional/hash.hpp>
+#include <boost/thread/mutex.hpp>
+#include <list>
+#include <memory>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+#include "../ModelPool.hpp"
+#include "../SharedPtr.hpp"
+#include <graph_analysis/BaseGraph.hpp>
+
+namespace moreorg {
+namespace algebra {
+
+/// Query of a feasibility check: model pool, ontology, interface base class,
+/// minimum number of feasible solutions and revision of the ontology, so that
+/// results are not reused once the ontology has changed
+typedef std::
+    tuple<ModelPool, owlapi::model::IRI, owlapi::model::IRI, size_t, uint64_t>
+        FeasibilityQuery;
+
+} // end namespace algebra
+} // end namespace moreorg
+
+namespace std {
+template <> struct hash<moreorg::algebra::FeasibilityQuery>
+{
+    size_t operator()(const moreorg::algebra::FeasibilityQuery& query) const
+    {
+        size_t seed = 0;
+        for(const moreorg::ModelPool::value_type& v : get<0>(query))
+        {
+            boost::hash_combine(seed, v.first.toString());
+            boost::hash_combine(seed, v.second);
+        }
+        boost::hash_combine(seed, get<1>(query).toString());
+        boost::hash_combine(seed, get<2>(query).toString());
+        boost::hash_combine(seed, get<3>(query));
+        boost::hash_combine(seed, get<4>(query));
+        return seed;
+    }
+};
+} // end namespace std
+
+namespace moreorg {
+namespace algebra {
+
+/**
+ * \class FeasibilityCache
+ * \brief Thread-safe and size bounded cache for the results of connectivity
+ * feasibility checks
+ *
+ * \details
+ * Entries are distributed over a number of shards, each protected by its own
+ * mutex, so that concurrent queries for different model pools do not contend.
+ * Each shard evicts its least recently used entry once it reaches its share of
+ * the maximum size.
+ *
+ * The timeout of a check is not part of the query, since a completed check
+ * yields the same result for any timeout. The result of a check which has been
+ * stopped by its timeout is only reused for checks with the same or a smaller
+ * timeout.
+ */
+class FeasibilityCache
+{
+public:
+    using Ptr = shared_ptr<FeasibilityCache>;
+
+    /// Resulting connection graph and feasibility
+    typedef std::pair<graph_analysis::BaseGraph::Ptr, bool> Result;
+
+    struct Statistics
+    {
+        Statistics();
+
+        uint64_t hits;
+        uint64_t misses;
+        uint64_t evictions;
+        /// Number of currently cached entries
+        size_t size;
+
+        std::string toString(size_t indent = 0) const;
+    };
+
+    /**
+     * Constructor for the cache
+     * \param maxSize Maximum number of entries, 0 for an unbounded cache
+     * \param numberOfShards Number of independently locked partitions
+     */
+    FeasibilityCache(size_t maxSize = 100000, size_t numberOfShards = 16);
+
+    FeasibilityCache(const FeasibilityCache&) = delete;
+    FeasibilityCache& operator=(const FeasibilityCache&) = delete;
+
+    /**
+     * Lookup a query result and mark it as most recently used
+     * \param query Query to lookup
+     * \param result Will be set to the cached result if the query is known
+     * \param timeoutInMs Timeout of the check, 0 for no timeout
+     * \return True if the query has been found, false otherwise -- including
+     * a result that has been stopped by a timeout smaller than the given one
+     */
+    bool lookup(const FeasibilityQuery& query,
+                Result& result,
+                double timeoutInMs = 0);
+
+    /**
+     * Insert or update the result of a query
+     * \param query Query
+     * \param result Result of the feasibility check
+     * \param stoppedTimeoutInMs Timeout which stopped the check before it
+     * completed, 0 if the check completed
+     */
+    void insert(const FeasibilityQuery& query,
+                const Result& result,
+                double stoppedTimeoutInMs = 0);
+
+    /**
+     * Remove all entries -- counters are kept
+     */
+    void clear();
+
+    /**
+     * Reset the hit, miss and eviction counters
+     */
+    void resetStatistics();
+
+    /**
+     * Get the current hit / miss statistics
+     */
+    Statistics getStatistics() const;
+
+    /**
+     * Get the number of currently cached entries
+     */
+    size_t size() const;
+
+    /**
+     * Get the maximum number of entries of this cache, 0 if unbounded
+     */
+    size_t getMaxSize() const { return mMaxSize; }
+
+private:
+    /// Query with its precomputed hash value
+    struct Key
+    {
+        FeasibilityQuery query;
+        size_t hash;
+
+        bool operator==(const Key& other) const
+        {
+            return hash == other.hash && query == other.query;
+        }
+    };
+
+    struct KeyHash
+    {
+        size_t operator()(const Key& key) const { return key.hash; }
+    };
+
+    struct Entry
+    {
+        Result result;
+        /// Timeout which stopped the check, 0 if the check completed
+        double stoppedTimeoutInMs;
+    };
+
+    /// Entries in order of their use, most recently used first
+    typedef std::list<std::pair<Key, Entry>> EntryList;
+
+    struct Shard
+    {
+        mutable boost::mutex mutex;
+        EntryList entries;
+        std::unordered_map<Key, EntryList::iterator, KeyHash> index;
+    };
+
+    Shard& getShard(size_t hash) const;
+
+    size_t mMaxSize;
+    size_t mMaxSizePerShard;
+    std::vector<std::unique_ptr<Shard>> mShards;
+
+    std::atomic<uint64_t> mHits;
+    std::atomic<uint64_t> mMisses;
+    std::atomic<uint64_t> mEvictions;
+};
+
+} // end namespace algebra
+} // end namespace moreorg
+#endif // ORGANIZATION_MODEL_ALGEBRA_FEASIBILITY_CACHE_HPP
@@ -0,0 +1,245 @@
+#include "InterfaceTable.hpp"
+#include "Connectivity.hpp"
+#include <algorithm>
+#include <base-logging/Logging.hpp>
+#include <boost/thread/recursive_mutex.hpp>
+#include <stdexcept>
+
+using namespace owlapi::model;
+
+namespace moreorg {
+namespace algebra {
+
+boost::mutex InterfaceTable::msInstancesMutex;
+std::vector<InterfaceTable::Ptr> InterfaceTable::msInstances;
+
+InterfaceTable::InterfaceTable(const OrganizationModel::Ptr& organizationModel,
+                               const owlapi::model::IRI& interfaceBaseClass,
+                               const owlapi::model::IRI& property)
+    : mpOrganizationModel(organizationModel)
+    , mInterfaceBaseClass(interfaceBaseClass)
+    , mProperty(property)
+    , mRevision(organizationModel ? organizationModel->getRevision() : 0)
+    , mpCompatibilityMatrix(make_shared<CompatibilityMatrix>())
+{
+}
+
+InterfaceTable::Ptr
+InterfaceTable::getInstance(const OrganizationModelAsk& ask,
+                            const owlapi::model::IRI& interfaceBaseClass,
+                            const owlapi::model::IRI& property)
+{
+    return getInstance(
+        ask.getOrganizationModel(), interfaceBaseClass, property);
+}
+
+InterfaceTable::Ptr
+InterfaceTable::getInstance(const OrganizationModel::Ptr& organizationModel,
+                            const owlapi::model::IRI& interfaceBaseClass,
+                            const owlapi::model::IRI& property)
+{
+    boost::unique_lock<boost::mutex> lock(msInstancesMutex);
+    // Drop the tables of organization models which no longer exist
+    msInstances.erase(std::remove_if(msInstances.begin(),
+                                     msInstances.end(),
+                                     [](const Ptr& table) {
+                                         return !table->getOrganizationModel();
+                                     }),
+                      msInstances.end());
+
+    for(const Ptr& table : msInstances)
+    {
+        if(table->getOrganizationModel() == organizationModel &&
+           table->getInterfaceBaseClass() == interfaceBaseClass &&
+           table->getProperty() == property)
+        {
+            return table;
+        }
+    }
+
+    Ptr table = make_shared<InterfaceTable>(organizationModel,
+                                            interfaceBaseClass,
+                                            property);
+    msInstances.push_back(table);
+    return table;
+}
+
+InterfaceTable::InterfaceIdListPtr
+InterfaceTable::getInterfaces(const owlapi::model::IRI& model)
+{
+    OrganizationModel::Ptr organizationModel = getOrganizationModel();
+    if(!organizationModel)
+    {
+        throw std::runtime_error("moreorg::algebra::InterfaceTable::"
+                                 "getInterfaces: organization model has "
+                                 "been deleted");
+    }
+
+    {
+        boost::unique_lock<boost::mutex> lock(mMutex);
+        std::map<IRI, InterfaceIdListPtr>::const_iterator cit =
+            mModelInterfaces.find(model);
+        if(cit != mModelInterfaces.end() &&
+           mRevision == organizationModel->getRevision())
+        {
+            return cit->second;
+        }
+    }
+
+    // Lock order: ontology first, then the table
+    boost::unique_lock<boost::recursive_mutex> ontologyLock(
+        organizationModel->getOntologyMutex());
+    OWLOntologyAsk ask(organizationModel->ontology());
+    IRIList interfaces = Connectivity::getInterfaces(
+        ask, model, mProperty, mInterfaceBaseClass);
+
+    boost::unique_lock<boost::mutex> lock(mMutex);
+    synchronise(ask, organizationModel->getRevision());
+    std::map<IRI, InterfaceIdListPtr>::const_iterator cit =
+        mModelInterfaces.find(model);
+    if(cit != mModelInterfaces.end())
+    {
+        return cit->second;
+    }
+
+    shared_ptr<InterfaceIdList> interfaceIds = make_shared<InterfaceIdList>();
+    for(const IRI& interfaceType : interfaces)
+    {
+        interfaceIds->push_back(registerInterfaceType(ask, interfaceType));
+    }
+    mModelInterfaces[model] = interfaceIds;
+    return interfaceIds;
+}
+
+InterfaceTable::InterfaceId
+InterfaceTable::registerInterfaceType(owlapi::model::OWLOntologyAsk& ask,
+                                      const owlapi::model::IRI& interfaceType)
+{
+    std::map<IRI, InterfaceId>::const_iterator cit =
+        mInterfaceIds.find(interfaceType);
+    if(cit != mInterfaceIds.end())
+    {
+        return cit->second;
+    }
+
+    InterfaceId id = mInterfaceTypes.size();
+    mInterfaceTypes.push_back(interfaceType);
+    mInterfaceIds[interfaceType] = id;
+
+    // Create a new snapshot, existing snapshots remain valid for their users
+    const CompatibilityMatrix& current = *mpCompatibilityMatrix;
+    shared_ptr<CompatibilityMatrix> matrix =
+        make_shared<CompatibilityMatrix>();
+    size_t size = mInterfaceTypes.size();
+    matrix->mSize = size;
+    matrix->mBits.resize(size * size, false);
+    for(size_t a = 0; a < current.size(); ++a)
+    {
+        for(size_t b = 0; b < current.size(); ++b)
+        {
+            matrix->mBits[a * size + b] = current.isCompatible(a, b);
+        }
+    }
+    for(size_t other = 0; other < size; ++other)
+    {
+        const IRI& otherType = mInterfaceTypes[other];
+        matrix->mBits[id * size + other] =
+            isRelated(ask, interfaceType, otherType);
+        matrix->mBits[other * size + id] =
+            isRelated(ask, otherType, interfaceType);
+    }
+    mpCompatibilityMatrix = matrix;
+    return id;
+}
+
+void InterfaceTable::synchronise(owlapi::model::OWLOntologyAsk& ask,
+                                 uint64_t revision)
+{
+    if(mRevision == revision)
+    {
+        return;
+    }
+
+    // Snapshots which have been handed out remain valid for their holders
+    mModelInterfaces.clear();
+
+    shared_ptr<CompatibilityMatrix> matrix =
+        make_shared<CompatibilityMatrix>();
+    size_t size = mInterfaceTypes.size();
+    matrix->mSize = size;
+    matrix->mBits.resize(size * size, false);
+    for(size_t a = 0; a < size; ++a)
+    {
+        for(size_t b = 0; b < size; ++b)
+        {
+            matrix->mBits[a * size + b] =
+                isRelated(ask, mInterfaceTypes[a], mInterfaceTypes[b]);
+        }
+    }
+    mpCompatibilityMatrix = matrix;
+    mRevision = revision;
+}
+
+bool InterfaceTable::isRelated(owlapi::model::OWLOntologyAsk& ask,
+                               const owlapi::model::IRI& i0,
+                               const owlapi::model::IRI& i1)
+{
+    try
+    {
+        return ask.isRelatedTo(i0, vocabulary::OM::compatibleWith(), i1);
+    } catch(const std::invalid_argument& e)
+    {
+        // seems there is not even an individual for this interface type
+        LOG_INFO_S << "No relation found between " << i0 << " and " << i1
+                   << " -- " << e.what();
+    }
+    return false;
+}
+
+const owlapi::model::IRI& InterfaceTable::getInterfaceType(InterfaceId id) const
+{
+    boost::unique_lock<boost::mutex> lock(mMutex);
+    if(id >= mInterfaceTypes.size())
+    {
+        throw std::out_of_range("moreorg::algebra::InterfaceTable::"
+                                "getInterfaceType: unknown interface id");
+    }
+    return mInterfaceTypes[id];
+}
+
+InterfaceTable::CompatibilityMatrix::Ptr
+InterfaceTable::getCompatibilityMatrix()
+{
+    OrganizationModel::Ptr organizationModel = getOrganizationModel();
+    if(!organizationModel)
+    {
+        throw std::runtime_error("moreorg::algebra::InterfaceTable::"
+                                 "getCompatibilityMatrix: organization model "
+                                 "has been deleted");
+    }
+
+    {
+        boost::unique_lock<boost::mutex> lock(mMutex);
+        if(mRevision == organizationModel->getRevision())
+        {
+            return mpCompatibilityMatrix;
+        }
+    }
+
+    // Lock order: ontology first, then the table
+    boost::unique_lock<boost::recursive_mutex> ontologyLock(
+        organizationModel->getOntologyMutex());
+    OWLOntologyAsk ask(organizationModel->ontology());
+    boost::unique_lock<boost::mutex> lock(mMutex);
+    synchronise(ask, organizationModel->getRevision());
+    return mpCompatibilityMatrix;
+}
+
+size_t InterfaceTable::getNumberOfInterfaceTypes() const
+{
+    boost::unique_lock<boost::mutex> lock(mMutex);
+    return mInterfaceTypes.size();
+}
+
+} // end namespace algebra
+} // end namespace moreorg
@@ -0,0 +1,192 @@
+#ifndef ORGANIZATION_MODEL_ALGEBRA_INTERFACE_TABLE_HPP
+#define ORGANIZATION_MODEL_ALGEBRA_INTERFACE_TABLE_HPP
+
+#include <boost/thread/mutex.hpp>
+#include <deque>
+#include <map>
+#include <stdint.h>
+#include <vector>
+
+#include "../OrganizationModelAsk.hpp"
+#include "../SharedPtr.hpp"
+#include "../vocabularies/OM.hpp"
+
+namespace moreorg {
+namespace algebra {
+
+/**
+ * \class InterfaceTable
+ * \brief Per ontology table of the interfaces of agent models and of the
+ * compatibility between interface types
+ *
+ * \details
+ * Interface types are identified by a dense index, so that compatibility
+ * checks reduce to a lookup in a bit matrix. Agent models and interface types
+ * are registered on first use. Since registering a new interface type extends
+ * the matrix, readers operate on immutable snapshots of it, which remain
+ * valid for all interface types registered before the snapshot was taken.
+ *
+ * Once the revision of the organization model changes, the interfaces of the
+ * agent models are queried again and the compatibility matrix is recomputed.
+ * Interface ids remain stable across revisions. Interface lists are handed
+ * out as shared snapshots, so that lists which are still held remain valid
+ * -- but refer to the previous revision -- while the table drops them.
+ */
+class InterfaceTable
+{
+public:
+    typedef shared_ptr<InterfaceTable> Ptr;
+
+    /// Index of an interface type
+    typedef uint32_t InterfaceId;
+    typedef std::vector<InterfaceId> InterfaceIdList;
+    typedef shared_ptr<const InterfaceIdList> InterfaceIdListPtr;
+
+    /**
+     * \class CompatibilityMatrix
+     * \brief Immutable bit matrix, where entry (a,b) is set if interface type
+     * a is compatible with b
+     */
+    class CompatibilityMatrix
+    {
+        friend class InterfaceTable;
+
+    public:
+        typedef shared_ptr<const CompatibilityMatrix> Ptr;
+
+        CompatibilityMatrix()
+            : mSize(0)
+        {
+        }
+
+        /**
+         * Get the number of interface types covered by this matrix
+         */
+        size_t size() const { return mSize; }
+
+        /**
+         * Check if interface type a is compatible with interface type b
+         */
+        bool isCompatible(InterfaceId a, InterfaceId b) const
+        {
+            return mBits[a * mSize + b];
+        }
+
+    private:
+        size_t mSize;
+        std::vector<bool> mBits;
+    };
+
+    /**
+     * Constructor of the table
+     * \param organizationModel Organization model
+     * \param interfaceBaseClass The base type for the interfaces that have to
+     * be considered
+     * \param property Property that relates agent and interface
+     */
+    InterfaceTable(const OrganizationModel::Ptr& organizationModel,
+                   const owlapi::model::IRI& interfaceBaseClass,
+                   const owlapi::model::IRI& property = vocabulary::OM::has());
+
+    InterfaceTable(const InterfaceTable&) = delete;
+    InterfaceTable& operator=(const InterfaceTable&) = delete;
+
+    /**
+     * Get the table which is shared for the ontology of the given ask, the
+     * interface base class and the property
+     */
+    static Ptr
+    getInstance(const OrganizationModelAsk& ask,
+                const owlapi::model::IRI& interfaceBaseClass,
+                const owlapi::model::IRI& property = vocabulary::OM::has());
+
+    /**
+     * Get the table which is shared for the given organization model, the
+     * interface base class and the property
+     */
+    static Ptr
+    getInstance(const OrganizationModel::Ptr& organizationModel,
+                const owlapi::model::IRI& interfaceBaseClass,
+                const owlapi::model::IRI& property = vocabulary::OM::has());
+
+    /**
+     * Get the interfaces of an agent model, where an interface type is listed
+     * as often as the model's max cardinality restriction permits
+     * \return immutable snapshot of the interfaces
+     */
+    InterfaceIdListPtr getInterfaces(const owlapi::model::IRI& model);
+
+    /**
+     * Get the interface type for a given index
+     * \throws std::out_of_range if the index is unknown
+     */
+    const owlapi::model::IRI& getInterfaceType(InterfaceId id) const;
+
+    /**
+     * Get the current compatibility matrix
+     */
+    CompatibilityMatrix::Ptr getCompatibilityMatrix();
+
+    /**
+     * Get the number of registered interface types
+     */
+    size_t getNumberOfInterfaceTypes() const;
+
+    /**
+     * Get the organization model this table has been created for
+     */
+    OrganizationModel::Ptr getOrganizationModel() const
+    {
+        return mpOrganizationModel.lock();
+    }
+
+    const owlapi::model::IRI& getInterfaceBaseClass() const
+    {
+        return mInterfaceBaseClass;
+    }
+
+    const owlapi::model::IRI& getProperty() const { return mProperty; }
+
+private:
+    /**
+     * Drop the interfaces of the agent models and recompute the
+     * compatibility matrix, if the table has been filled for another revision
+     * Requires the ontology and the table to be locked
+     */
+    void synchronise(owlapi::model::OWLOntologyAsk& ask, uint64_t revision);
+
+    /**
+     * Compute whether interface type i0 is compatible with i1
+     */
+    static bool isRelated(owlapi::model::OWLOntologyAsk& ask,
+                          const owlapi::model::IRI& i0,
+                          const owlapi::model::IRI& i1);
+
+    /**
+     * Register an interface type and extend the compatibility matrix
+     * Requires the ontology and the table to be locked
+     */
+    InterfaceId registerInterfaceType(owlapi::model::OWLOntologyAsk& ask,
+                                      const owlapi::model::IRI& interfaceType);
+
+    weak_ptr<OrganizationModel> mpOrganizationModel;
+    owlapi::model::IRI mInterfaceBaseClass;
+    owlapi::model::IRI mProperty;
+
+    /// Guards the access to all members below
+    mutable boost::mutex mMutex;
+    /// Revision of the organization model the table has been filled for
+    uint64_t mRevision;
+    std::map<owlapi::model::IRI, InterfaceIdListPtr> mModelInterfaces;
+    /// Interface types by index -- a deque keeps references valid on growth
+    std::deque<owlapi::model::IRI> mInterfaceTypes;
+    std::map<owlapi::model::IRI, InterfaceId> mInterfaceIds;
+    CompatibilityMatrix::Ptr mpCompatibilityMatrix;
+
+    static boost::mutex msInstancesMutex;
+    static std::vector<Ptr> msInstances;
+};
+
+} // end namespace algebra
+} // end namespace moreorg
+#endif // ORGANIZATION_MODEL_ALGEBRA_INTERFACE_TABLE_HPP
@@ -1,4 +1,5 @@
 #include "ResourceSupportVector.hpp"
+#include <algorithm>
 #include <base-logging/Logging.hpp>
 #include <math.h>
 #include <moreorg/OrganizationModelAsk.hpp>
@@ -189,29 +190,35 @@ std::string ResourceSupportVector::toString(uint32_t indent) const
 ResourceSupportVector ResourceSupportVector::embedClassRelationship(
     const OrganizationModelAsk& ask) const
 {
-    using namespace owlapi::model;
-
     ResourceSupportVector supportVector = *this;
+    base::MatrixXd rows = mSizes;
+    embedClassRelationship(mLabels, rows, ask);
+    supportVector.mSizes = rows.col(0);
+    return supportVector;
+}
 
-    uint32_t max = supportVector.size();
-    std::vector<IRI> labels = supportVector.getLabels();
+void ResourceSupportVector::embedClassRelationship(
+    const owlapi::model::IRIList& labels,
+    base::MatrixXd& rows,
+    const OrganizationModelAsk& ask)
+{
+    uint32_t max = std::min(labels.size(), static_cast<size_t>(rows.rows()));
+    const SubclassClosure::Ptr& subclassClosure = ask.getSubclassClosure();
+    SubclassClosure::ClassIdList ids = subclassClosure->getIds(labels);
+    SubclassClosure::Matrix::Ptr closure = subclassClosure->getMatrix();
     for(uint32_t i = 0; i < max; ++i)
     {
-        IRI i_model = labels[i];
         for(uint32_t a = i + 1; a < max; ++a)
         {
-            IRI a_model = labels[a];
-
-            if(ask.ontology().isSubClassOf(i_model, a_model))
+            if(closure->isSubClassOf(ids[i], ids[a]))
             {
-                supportVector(a) += supportVector(i);
-            } else if(ask.ontology().isSubClassOf(a_model, i_model))
+                rows.row(a) += rows.row(i);
+            } else if(closure->isSubClassOf(ids[a], ids[i]))
             {
-                supportVector(i) += supportVector(a);
+                rows.row(i) += rows.row(a);
             }
         }
     }
-    return supportVector;
 }
 
 void ResourceSupportVector::checkDimensions(const ResourceSupportVector& a,
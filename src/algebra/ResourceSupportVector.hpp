@@ -141,6 +141,11 @@ public:
      */
     size_t size() const { return mSizes.size(); }
 
+    /**
+     * Get the support values of all dimensions
+     */
+    const base::VectorXd& getSizes() const { return mSizes; }
+
     /**
      * Extend the ResourceSupportVector to embed the class relationships in the
      * resource vector, e.g.,
@@ -150,6 +155,18 @@ public:
     ResourceSupportVector
     embedClassRelationship(const OrganizationModelAsk& ask) const;
 
+    /**
+     * Embed the class relationships into the rows of a matrix, where each
+     * row corresponds to a label, i.e., apply the same transformation as
+     * embedClassRelationship to each column of the matrix
+     * \param labels Labels of the rows
+     * \param rows Matrix which will be updated
+     * \param ask Organization model ask
+     */
+    static void embedClassRelationship(const owlapi::model::IRIList& labels,
+                                       base::MatrixXd& rows,
+                                       const OrganizationModelAsk& ask);
+
     /**
      * Scale a ResourceSupportVector by a given factor
      * \param factor scale factor
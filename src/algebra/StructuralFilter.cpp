@@ -0,0 +1,313 @@
+#include "StructuralFilter.hpp"
+#include <algorithm>
+#include <base-logging/Logging.hpp>
+#include <sstream>
+
+using namespace owlapi::model;
+
+namespace moreorg {
+namespace algebra {
+
+boost::mutex StructuralFilter::msInstancesMutex;
+std::vector<StructuralFilter::Ptr> StructuralFilter::msInstances;
+
+StructuralFilter::Statistics::Statistics()
+    : checks(0)
+{
+    std::fill(rejections, rejections + REJECTION_END, 0);
+}
+
+uint64_t StructuralFilter::Statistics::getNumberOfRejections() const
+{
+    uint64_t numberOfRejections = 0;
+    for(size_t i = NONE + 1; i < REJECTION_END; ++i)
+    {
+        numberOfRejections += rejections[i];
+    }
+    return numberOfRejections;
+}
+
+std::string StructuralFilter::Statistics::toString(size_t indent) const
+{
+    std::stringstream ss;
+    std::string hspace(indent, ' ');
+    ss << hspace << "StructuralFilter:" << std::endl;
+    ss << hspace << "    # checks: " << checks << std::endl;
+    ss << hspace << "    # rejections: " << getNumberOfRejections()
+       << std::endl;
+    for(size_t i = NONE + 1; i < REJECTION_END; ++i)
+    {
+        ss << hspace << "        "
+           << StructuralFilter::toString(static_cast<Rejection>(i)) << ": "
+           << rejections[i] << std::endl;
+    }
+    return ss.str();
+}
+
+StructuralFilter::StructuralFilter(
+    const OrganizationModel::Ptr& organizationModel,
+    const owlapi::model::IRI& interfaceBaseClass)
+    : mpOrganizationModel(organizationModel)
+    , mInterfaceBaseClass(interfaceBaseClass)
+    , mpInterfaceTable(
+          InterfaceTable::getInstance(organizationModel, interfaceBaseClass))
+    , mRevision(organizationModel ? organizationModel->getRevision() : 0)
+    , mChecks(0)
+{
+    for(size_t i = 0; i < REJECTION_END; ++i)
+    {
+        mRejections[i] = 0;
+    }
+}
+
+StructuralFilter::Ptr
+StructuralFilter::getInstance(const OrganizationModelAsk& ask,
+                              const owlapi::model::IRI& interfaceBaseClass)
+{
+    OrganizationModel::Ptr organizationModel = ask.getOrganizationModel();
+
+    boost::unique_lock<boost::mutex> lock(msInstancesMutex);
+    // Drop the filters of organization models which no longer exist
+    msInstances.erase(std::remove_if(msInstances.begin(),
+                                     msInstances.end(),
+                                     [](const Ptr& filter) {
+                                         return !filter->getOrganizationModel();
+                                     }),
+                      msInstances.end());
+
+    for(const Ptr& filter : msInstances)
+    {
+        if(filter->getOrganizationModel() == organizationModel &&
+           filter->getInterfaceBaseClass() == interfaceBaseClass)
+        {
+            return filter;
+        }
+    }
+
+    Ptr filter =
+        make_shared<StructuralFilter>(organizationModel, interfaceBaseClass);
+    msInstances.push_back(filter);
+    return filter;
+}
+
+StructuralFilter::Rejection StructuralFilter::check(const ModelPool& modelPool)
+{
+    ++mChecks;
+    Rejection rejection = checkPool(modelPool);
+    if(rejection != NONE)
+    {
+        ++mRejections[rejection];
+        LOG_DEBUG_S << "Rejected " << modelPool.toString() << " -- "
+                    << toString(rejection);
+    }
+    return rejection;
+}
+
+StructuralFilter::Rejection
+StructuralFilter::checkPool(const ModelPool& modelPool)
+{
+    ModelPool pool = modelPool.compact();
+    size_t numberOfAgents = pool.numberOfInstances();
+    if(numberOfAgents < 2)
+    {
+        return NONE;
+    }
+
+    std::vector<IRI> models;
+    std::vector<size_t> counts;
+    std::vector<size_t> numberOfInterfaces;
+    size_t totalNumberOfInterfaces = 0;
+    for(const ModelPool::value_type& v : pool)
+    {
+        InterfaceTable::InterfaceIdListPtr interfaces =
+            mpInterfaceTable->getInterfaces(v.first);
+        if(interfaces->empty())
+        {
+            return NO_INTERFACES;
+        }
+        models.push_back(v.first);
+        counts.push_back(v.second);
+        numberOfInterfaces.push_back(interfaces->size());
+        totalNumberOfInterfaces += v.second * interfaces->size();
+    }
+
+    // Each of the at least n-1 links requires two interfaces
+    size_t requiredNumberOfInterfaces = 2 * (numberOfAgents - 1);
+    if(totalNumberOfInterfaces < requiredNumberOfInterfaces)
+    {
+        return INSUFFICIENT_INTERFACES;
+    }
+
+    size_t numberOfModels = models.size();
+    std::vector<std::vector<bool>> compatible(
+        numberOfModels, std::vector<bool>(numberOfModels, false));
+    for(size_t m0 = 0; m0 < numberOfModels; ++m0)
+    {
+        for(size_t m1 = m0; m1 < numberOfModels; ++m1)
+        {
+            bool isCompatible = areCompatible(models[m0], models[m1]);
+            compatible[m0][m1] = isCompatible;
+            compatible[m1][m0] = isCompatible;
+        }
+    }
+
+    // An agent can be linked at most once to any other agent, so that its
+    // degree is bounded by the number of compatible agents
+    size_t degreeBound = 0;
+    for(size_t m0 = 0; m0 < numberOfModels; ++m0)
+    {
+        size_t partners = 0;
+        for(size_t m1 = 0; m1 < numberOfModels; ++m1)
+        {
+            if(compatible[m0][m1])
+            {
+                partners += counts[m1];
+            }
+        }
+        if(compatible[m0][m0])
+        {
+            // no link to itself
+            partners -= 1;
+        }
+
+        if(partners == 0)
+        {
+            return NO_COMPATIBLE_PARTNER;
+        }
+        degreeBound +=
+            counts[m0] * std::min(numberOfInterfaces[m0], partners);
+    }
+
+    std::vector<bool> visited(numberOfModels, false);
+    std::vector<size_t> stack(1, 0);
+    visited[0] = true;
+    while(!stack.empty())
+    {
+        size_t m0 = stack.back();
+        stack.pop_back();
+        for(size_t m1 = 0; m1 < numberOfModels; ++m1)
+        {
+            if(!visited[m1] && compatible[m0][m1])
+            {
+                visited[m1] = true;
+                stack.push_back(m1);
+            }
+        }
+    }
+    if(std::find(visited.begin(), visited.end(), false) != visited.end())
+    {
+        return DISCONNECTED;
+    }
+
+    if(degreeBound < requiredNumberOfInterfaces)
+    {
+        return DEGREE_BOUND;
+    }
+    return NONE;
+}
+
+bool StructuralFilter::areCompatible(const IRI& model0, const IRI& model1)
+{
+    std::pair<IRI, IRI> key = model0 < model1 ? std::make_pair(model0, model1)
+                                              : std::make_pair(model1, model0);
+    OrganizationModel::Ptr organizationModel = mpOrganizationModel.lock();
+    uint64_t revision =
+        organizationModel ? organizationModel->getRevision() : 0;
+    {
+        boost::unique_lock<boost::mutex> lock(mMutex);
+        // The filter outlives resets of the query cache, so the
+        // compatibility has to be recomputed for a new revision
+        if(mRevision != revision)
+        {
+            mCompatibility.clear();
+            mRevision = revision;
+        }
+        std::map<std::pair<IRI, IRI>, bool>::const_iterator cit =
+            mCompatibility.find(key);
+        if(cit != mCompatibility.end())
+        {
+            return cit->second;
+        }
+    }
+
+    InterfaceTable::InterfaceIdListPtr interfaces0 =
+        mpInterfaceTable->getInterfaces(model0);
+    InterfaceTable::InterfaceIdListPtr interfaces1 =
+        mpInterfaceTable->getInterfaces(model1);
+    InterfaceTable::CompatibilityMatrix::Ptr compatibility =
+        mpInterfaceTable->getCompatibilityMatrix();
+
+    // The direction of the compatibility check depends on the order of
+    // agents in the csp, so either direction permits a link
+    bool compatible = false;
+    for(InterfaceTable::InterfaceId i0 : *interfaces0)
+    {
+        for(InterfaceTable::InterfaceId i1 : *interfaces1)
+        {
+            if(compatibility->isCompatible(i0, i1) ||
+               compatibility->isCompatible(i1, i0))
+            {
+                compatible = true;
+                break;
+            }
+        }
+        if(compatible)
+        {
+            break;
+        }
+    }
+
+    boost::unique_lock<boost::mutex> lock(mMutex);
+    // Do not memorise a result that has been computed for an outdated
+    // revision
+    if(mRevision == revision)
+    {
+        mCompatibility[key] = compatible;
+    }
+    return compatible;
+}
+
+StructuralFilter::Statistics StructuralFilter::getStatistics() const
+{
+    Statistics statistics;
+    statistics.checks = mChecks;
+    for(size_t i = 0; i < REJECTION_END; ++i)
+    {
+        statistics.rejections[i] = mRejections[i];
+    }
+    return statistics;
+}
+
+void StructuralFilter::resetStatistics()
+{
+    mChecks = 0;
+    for(size_t i = 0; i < REJECTION_END; ++i)
+    {
+        mRejections[i] = 0;
+    }
+}
+
+std::string StructuralFilter::toString(Rejection rejection)
+{
+    switch(rejection)
+    {
+        case NONE:
+            return "none";
+        case NO_INTERFACES:
+            return "agent model without interfaces";
+        case INSUFFICIENT_INTERFACES:
+            return "insufficient number of interfaces";
+        case NO_COMPATIBLE_PARTNER:
+            return "agent model without compatible partner";
+        case DISCONNECTED:
+            return "disconnected compatibility graph";
+        case DEGREE_BOUND:
+            return "insufficient degree bound";
+        default:
+            break;
+    }
+    return "unknown";
+}
+
+} // end namespace algebra
+} // end namespace moreorg
@@ -0,0 +1,160 @@
+#ifndef ORGANIZATION_MODEL_ALGEBRA_STRUCTURAL_FILTER_HPP
+#define ORGANIZATION_MODEL_ALGEBRA_STRUCTURAL_FILTER_HPP
+
+#include <atomic>
+#include <boost/thread/mutex.hpp>
+#include <map>
+#include <vector>
+
+#include "../OrganizationModelAsk.hpp"
+#include "../SharedPtr.hpp"
+#include "InterfaceTable.hpp"
+
+namespace moreorg {
+namespace algebra {
+
+/**
+ * \class StructuralFilter
+ * \brief Necessary conditions for the connectivity of a model pool, which
+ * allow to reject infeasible pools without constructing and searching the
+ * connectivity csp
+ *
+ * \details
+ * A feasible connection of n agents is a connected graph with at least n-1
+ * links, each occupying one interface at either end, where an agent is linked
+ * at most once to any other agent. Hence, a model pool is rejected if
+ *     - an agent model has no interface,
+ *     - the overall number of interfaces is below 2(n-1),
+ *     - an agent model has no compatible partner in the pool,
+ *     - the compatibility graph of the agent models is not connected,
+ *     - or the sum of the per-agent degree bounds, i.e., the minimum of the
+ *       number of interfaces and the number of compatible agents, is below
+ *       2(n-1)
+ *
+ * The interfaces of each agent model are taken from the InterfaceTable of
+ * the ontology, the compatibility between agent models is computed once per
+ * ontology and interface base class and shared by all users of the filter.
+ */
+class StructuralFilter
+{
+public:
+    typedef shared_ptr<StructuralFilter> Ptr;
+
+    enum Rejection
+    {
+        NONE = 0,
+        NO_INTERFACES,
+        INSUFFICIENT_INTERFACES,
+        NO_COMPATIBLE_PARTNER,
+        DISCONNECTED,
+        DEGREE_BOUND,
+        REJECTION_END
+    };
+
+    struct Statistics
+    {
+        Statistics();
+
+        /// Number of checked model pools
+        uint64_t checks;
+        /// Number of rejected model pools, i.e. avoided csp runs, per reason
+        uint64_t rejections[REJECTION_END];
+
+        /// Total number of rejected model pools
+        uint64_t getNumberOfRejections() const;
+
+        std::string toString(size_t indent = 0) const;
+    };
+
+    /**
+     * Constructor of the filter
+     * \param organizationModel Organization model
+     * \param interfaceBaseClass The base type for the interfaces that have to
+     * be considered
+     */
+    StructuralFilter(const OrganizationModel::Ptr& organizationModel,
+                     const owlapi::model::IRI& interfaceBaseClass);
+
+    StructuralFilter(const StructuralFilter&) = delete;
+    StructuralFilter& operator=(const StructuralFilter&) = delete;
+
+    /**
+     * Get the filter which is shared for the ontology of the given ask and
+     * the interface base class
+     */
+    static Ptr getInstance(const OrganizationModelAsk& ask,
+                           const owlapi::model::IRI& interfaceBaseClass);
+
+    /**
+     * Check the necessary conditions for the connectivity of a model pool
+     * \return NONE if the pool might be feasible, otherwise the reason for
+     * rejecting it
+     */
+    Rejection check(const ModelPool& modelPool);
+
+    /**
+     * Check if a model pool passes all necessary conditions for its
+     * connectivity
+     */
+    bool isPotentiallyFeasible(const ModelPool& modelPool)
+    {
+        return check(modelPool) == NONE;
+    }
+
+    /**
+     * Get the number of checks and rejections
+     */
+    Statistics getStatistics() const;
+
+    /**
+     * Reset the number of checks and rejections
+     */
+    void resetStatistics();
+
+    /**
+     * Get the organization model this filter has been created for
+     */
+    OrganizationModel::Ptr getOrganizationModel() const
+    {
+        return mpOrganizationModel.lock();
+    }
+
+    const owlapi::model::IRI& getInterfaceBaseClass() const
+    {
+        return mInterfaceBaseClass;
+    }
+
+    static std::string toString(Rejection rejection);
+
+private:
+    /**
+     * Check if two agent models can be linked by at least one pair of
+     * their interfaces
+     */
+    bool areCompatible(const owlapi::model::IRI& model0,
+                       const owlapi::model::IRI& model1);
+
+    Rejection checkPool(const ModelPool& modelPool);
+
+    weak_ptr<OrganizationModel> mpOrganizationModel;
+    owlapi::model::IRI mInterfaceBaseClass;
+    InterfaceTable::Ptr mpInterfaceTable;
+
+    /// Guards the access to the compatibility of agent models
+    boost::mutex mMutex;
+    std::map<std::pair<owlapi::model::IRI, owlapi::model::IRI>, bool>
+        mCompatibility;
+    /// Revision of the organization model the compatibility has been
+    /// computed for
+    uint64_t mRevision;
+
+    std::atomic<uint64_t> mChecks;
+    std::atomic<uint64_t> mRejections[REJECTION_END];
+
+    static boost::mutex msInstancesMutex;
+    static std::vector<Ptr> msInstances;
+};
+
+} // end namespace algebra
+} // end namespace moreorg
+#endif // ORGANIZATION_MODEL_ALGEBRA_STRUCTURAL_FILTER_HPP
@@ -0,0 +1,248 @@
+#include "SubclassClosure.hpp"
+#include "../vocabularies/OM.hpp"
+#include <algorithm>
+#include <base-logging/Logging.hpp>
+#include <boost/thread/recursive_mutex.hpp>
+#include <stdexcept>
+
+using namespace owlapi::model;
+
+namespace moreorg {
+namespace algebra {
+
+boost::mutex SubclassClosure::msInstancesMutex;
+std::vector<SubclassClosure::Ptr> SubclassClosure::msInstances;
+
+SubclassClosure::SubclassClosure(
+    const OrganizationModel::Ptr& organizationModel)
+    : mpOrganizationModel(organizationModel)
+    , mMaterialised(false)
+    , mRevision(0)
+    , mpMatrix(make_shared<Matrix>())
+{
+}
+
+SubclassClosure::Ptr
+SubclassClosure::getInstance(const OrganizationModel::Ptr& organizationModel)
+{
+    boost::unique_lock<boost::mutex> lock(msInstancesMutex);
+    // Drop the closures of organization models which no longer exist
+    msInstances.erase(std::remove_if(msInstances.begin(),
+                                     msInstances.end(),
+                                     [](const Ptr& closure) {
+                                         return !closure
+                                                     ->getOrganizationModel();
+                                     }),
+                      msInstances.end());
+
+    for(const Ptr& closure : msInstances)
+    {
+        if(closure->getOrganizationModel() == organizationModel)
+        {
+            return closure;
+        }
+    }
+
+    Ptr closure = make_shared<SubclassClosure>(organizationModel);
+    msInstances.push_back(closure);
+    return closure;
+}
+
+SubclassClosure::ClassId SubclassClosure::getId(const IRI& klass)
+{
+    IRIList klasses;
+    klasses.push_back(klass);
+    return getIds(klasses).front();
+}
+
+SubclassClosure::ClassIdList SubclassClosure::getIds(const IRIList& klasses)
+{
+    OrganizationModel::Ptr organizationModel = getOrganizationModel();
+    if(!organizationModel)
+    {
+        throw std::runtime_error("moreorg::algebra::SubclassClosure::getIds: "
+                                 "organization model has been deleted");
+    }
+
+    ClassIdList ids;
+    {
+        boost::unique_lock<boost::mutex> lock(mMutex);
+        if(mMaterialised && mRevision == organizationModel->getRevision() &&
+           lookup(klasses, ids))
+        {
+            return ids;
+        }
+    }
+
+    // Lock order: ontology first, then the closure
+    boost::unique_lock<boost::recursive_mutex> ontologyLock(
+        organizationModel->getOntologyMutex());
+    OWLOntologyAsk ask(organizationModel->ontology());
+
+    boost::unique_lock<boost::mutex> lock(mMutex);
+    uint64_t revision = organizationModel->getRevision();
+    if(!mMaterialised || mRevision != revision)
+    {
+        materialise(ask);
+        mRevision = revision;
+    }
+
+    ids.clear();
+    for(const IRI& klass : klasses)
+    {
+        std::map<IRI, ClassId>::const_iterator cit = mClassIds.find(klass);
+        if(cit != mClassIds.end())
+        {
+            ids.push_back(cit->second);
+        } else
+        {
+            ids.push_back(registerClass(ask, klass));
+        }
+    }
+    return ids;
+}
+
+bool SubclassClosure::lookup(const IRIList& klasses, ClassIdList& ids) const
+{
+    ids.clear();
+    ids.reserve(klasses.size());
+    for(const IRI& klass : klasses)
+    {
+        std::map<IRI, ClassId>::const_iterator cit = mClassIds.find(klass);
+        if(cit == mClassIds.end())
+        {
+            return false;
+        }
+        ids.push_back(cit->second);
+    }
+    return true;
+}
+
+void SubclassClosure::materialise(OWLOntologyAsk& ask)
+{
+    IRIList baseClasses;
+    baseClasses.push_back(vocabulary::OM::Resource());
+    baseClasses.push_back(vocabulary::OM::Functionality());
+
+    for(const IRI& baseClass : baseClasses)
+    {
+        IRIList klasses;
+        try
+        {
+            klasses = ask.allSubClassesOf(baseClass, false);
+        } catch(const std::exception& e)
+        {
+            LOG_WARN_S << "moreorg::algebra::SubclassClosure: failed to "
+                       << "retrieve subclasses of " << baseClass << " -- "
+                       << e.what();
+            continue;
+        }
+        klasses.insert(klasses.begin(), baseClass);
+        for(const IRI& klass : klasses)
+        {
+            if(mClassIds.count(klass) == 0)
+            {
+                mClassIds[klass] = mClasses.size();
+                mClasses.push_back(klass);
+            }
+        }
+    }
+
+    shared_ptr<Matrix> matrix = make_shared<Matrix>();
+    size_t size = mClasses.size();
+    matrix->mSize = size;
+    matrix->mBits.resize(size * size, false);
+    for(size_t b = 0; b < size; ++b)
+    {
+        matrix->mBits[b * size + b] = true;
+
+        IRIList subclasses;
+        try
+        {
+            subclasses = ask.allSubClassesOf(mClasses[b], false);
+        } catch(const std::exception& e)
+        {
+            LOG_WARN_S << "moreorg::algebra::SubclassClosure: failed to "
+                       << "retrieve subclasses of " << mClasses[b] << " -- "
+                       << e.what();
+        }
+        for(const IRI& subclass : subclasses)
+        {
+            std::map<IRI, ClassId>::const_iterator cit =
+                mClassIds.find(subclass);
+            if(cit != mClassIds.end())
+            {
+                matrix->mBits[cit->second * size + b] = true;
+            }
+        }
+    }
+    mpMatrix = matrix;
+    mMaterialised = true;
+
+    LOG_DEBUG_S << "moreorg::algebra::SubclassClosure: materialised closure "
+                << "for " << size << " classes";
+}
+
+SubclassClosure::ClassId SubclassClosure::registerClass(OWLOntologyAsk& ask,
+                                                        const IRI& klass)
+{
+    // Query the reasoner before modifying any member, so that a failing query
+    // leaves the closure unchanged
+    size_t size = mClasses.size() + 1;
+    ClassId id = mClasses.size();
+    std::vector<bool> isSubClass(size, false);
+    std::vector<bool> isSuperClass(size, false);
+    for(size_t other = 0; other < mClasses.size(); ++other)
+    {
+        isSubClass[other] = ask.isSubClassOf(klass, mClasses[other]);
+        isSuperClass[other] = ask.isSubClassOf(mClasses[other], klass);
+    }
+
+    // Create a new snapshot, existing snapshots remain valid for their users
+    const Matrix& current = *mpMatrix;
+    shared_ptr<Matrix> matrix = make_shared<Matrix>();
+    matrix->mSize = size;
+    matrix->mBits.resize(size * size, false);
+    for(size_t a = 0; a < current.size(); ++a)
+    {
+        for(size_t b = 0; b < current.size(); ++b)
+        {
+            matrix->mBits[a * size + b] = current.isSubClassOf(a, b);
+        }
+    }
+    for(size_t other = 0; other < mClasses.size(); ++other)
+    {
+        matrix->mBits[id * size + other] = isSubClass[other];
+        matrix->mBits[other * size + id] = isSuperClass[other];
+    }
+    matrix->mBits[id * size + id] = true;
+
+    mClassIds[klass] = id;
+    mClasses.push_back(klass);
+    mpMatrix = matrix;
+    return id;
+}
+
+SubclassClosure::Matrix::Ptr SubclassClosure::getMatrix() const
+{
+    boost::unique_lock<boost::mutex> lock(mMutex);
+    return mpMatrix;
+}
+
+bool SubclassClosure::isSubClassOf(const IRI& subclass, const IRI& superclass)
+{
+    IRIList klasses;
+    klasses.push_back(subclass);
+    klasses.push_back(superclass);
+    ClassIdList ids = getIds(klasses);
+    return getMatrix()->isSubClassOf(ids[0], ids[1]);
+}
+
+size_t SubclassClosure::getNumberOfClasses() const
+{
+    boost::unique_lock<boost::mutex> lock(mMutex);
+    return mClasses.size();
+}
+
+} // end namespace algebra
+} // end namespace moreorg
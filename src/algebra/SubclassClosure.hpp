@@ -0,0 +1,164 @@
+#ifndef ORGANIZATION_MODEL_ALGEBRA_SUBCLASS_CLOSURE_HPP
+#define ORGANIZATION_MODEL_ALGEBRA_SUBCLASS_CLOSURE_HPP
+
+#include <boost/thread/mutex.hpp>
+#include <map>
+#include <owlapi/model/OWLOntologyAsk.hpp>
+#include <stdint.h>
+#include <vector>
+
+#include "../OrganizationModel.hpp"
+#include "../SharedPtr.hpp"
+
+namespace moreorg {
+namespace algebra {
+
+/**
+ * \class SubclassClosure
+ * \brief Per ontology subclass closure over interned class ids
+ *
+ * \details
+ * The closure of all resource and functionality classes is materialised on
+ * first use, so that subclass checks reduce to a lookup in a bit matrix.
+ * Classes outside of this hierarchy are registered when they are first
+ * queried. As for the InterfaceTable, readers operate on immutable snapshots
+ * of the matrix, which cover all classes interned before the snapshot was
+ * taken.
+ *
+ * The closure is materialised again once the revision of the organization
+ * model changes. Class ids remain stable across revisions, but snapshots
+ * which have been retrieved before refer to the previous hierarchy.
+ */
+class SubclassClosure
+{
+public:
+    typedef shared_ptr<SubclassClosure> Ptr;
+
+    /// Index of an interned class
+    typedef uint32_t ClassId;
+    typedef std::vector<ClassId> ClassIdList;
+
+    /**
+     * \class Matrix
+     * \brief Immutable bit matrix, where entry (a,b) is set if class a is a
+     * (reflexive) subclass of class b
+     */
+    class Matrix
+    {
+        friend class SubclassClosure;
+
+    public:
+        typedef shared_ptr<const Matrix> Ptr;
+
+        Matrix()
+            : mSize(0)
+        {
+        }
+
+        /**
+         * Get the number of classes covered by this matrix
+         */
+        size_t size() const { return mSize; }
+
+        /**
+         * Check if class a is a subclass of class b
+         */
+        bool isSubClassOf(ClassId a, ClassId b) const
+        {
+            return mBits[a * mSize + b];
+        }
+
+    private:
+        size_t mSize;
+        std::vector<bool> mBits;
+    };
+
+    /**
+     * Constructor of the closure
+     * \param organizationModel Organization model
+     */
+    SubclassClosure(const OrganizationModel::Ptr& organizationModel);
+
+    SubclassClosure(const SubclassClosure&) = delete;
+    SubclassClosure& operator=(const SubclassClosure&) = delete;
+
+    /**
+     * Get the closure which is shared for the given organization model
+     */
+    static Ptr getInstance(const OrganizationModel::Ptr& organizationModel);
+
+    /**
+     * Get the id of a class, and intern the class if needed
+     */
+    ClassId getId(const owlapi::model::IRI& klass);
+
+    /**
+     * Get the ids of a list of classes, and intern the classes if needed
+     */
+    ClassIdList getIds(const owlapi::model::IRIList& klasses);
+
+    /**
+     * Get the current matrix -- retrieve the matrix only after all required
+     * classes have been interned
+     */
+    Matrix::Ptr getMatrix() const;
+
+    /**
+     * Check if a class is a (reflexive) subclass of another
+     */
+    bool isSubClassOf(const owlapi::model::IRI& subclass,
+                      const owlapi::model::IRI& superclass);
+
+    /**
+     * Get the number of interned classes
+     */
+    size_t getNumberOfClasses() const;
+
+    /**
+     * Get the organization model this closure has been created for
+     */
+    OrganizationModel::Ptr getOrganizationModel() const
+    {
+        return mpOrganizationModel.lock();
+    }
+
+private:
+    /**
+     * Intern the resource and functionality classes and compute the closure
+     * of all interned classes
+     * Requires the ontology and the closure to be locked
+     */
+    void materialise(owlapi::model::OWLOntologyAsk& ask);
+
+    /**
+     * Intern a class which is not part of the materialised hierarchy
+     * Requires the ontology and the closure to be locked
+     */
+    ClassId registerClass(owlapi::model::OWLOntologyAsk& ask,
+                          const owlapi::model::IRI& klass);
+
+    /**
+     * Get the id of the given classes, when all have been interned already
+     * Requires the closure to be locked
+     * \return false if a class still needs to be interned
+     */
+    bool lookup(const owlapi::model::IRIList& klasses, ClassIdList& ids) const;
+
+    weak_ptr<OrganizationModel> mpOrganizationModel;
+
+    /// Guards the access to all members below
+    mutable boost::mutex mMutex;
+    bool mMaterialised;
+    /// Revision of the organization model the closure has been computed for
+    uint64_t mRevision;
+    std::map<owlapi::model::IRI, ClassId> mClassIds;
+    owlapi::model::IRIList mClasses;
+    Matrix::Ptr mpMatrix;
+
+    static boost::mutex msInstancesMutex;
+    static std::vector<Ptr> msInstances;
+};
+
+} // end namespace algebra
+} // end namespace moreorg
+#endif // ORGANIZATION_MODEL_ALGEBRA_SUBCLASS_CLOSURE_HPP
@@ -1,6 +1,8 @@
 #include "Robot.hpp"
 
 #include <base-logging/Logging.hpp>
+#include <cmath>
+#include <limits>
 #include <regex>
 #include <sstream>
 
@@ -18,43 +20,25 @@ using namespace owlapi::model;
 namespace moreorg {
 namespace facades {
 
-std::map<ModelPool, Robot> Robot::msRobots;
-
-const Robot&
-Robot::getInstance(const owlapi::model::IRI& actorModel,
-                   const OrganizationModelAsk& organizationModelAsk)
+Robot Robot::getInstance(const owlapi::model::IRI& actorModel,
+                         const OrganizationModelAsk& organizationModelAsk)
 {
-    ModelPool modelPool;
-    modelPool[actorModel] = 1;
-    return getInstance(modelPool, organizationModelAsk);
+    return Robot(actorModel, organizationModelAsk);
 }
 
-const Robot&
-Robot::getInstance(const ModelPool& modelPool,
-                   const OrganizationModelAsk& organizationModelAsk)
+Robot Robot::getInstance(const ModelPool& modelPool,
+                         const OrganizationModelAsk& organizationModelAsk)
 {
-    std::map<ModelPool, Robot>::const_iterator cit = msRobots.find(modelPool);
-    if(cit != msRobots.end())
-    {
-        return cit->second;
-    } else
+    if(modelPool.numberOfInstances() == 1)
     {
-        if(modelPool.numberOfInstances() == 1)
-        {
-            Robot robot(modelPool.compact().begin()->first,
-                        organizationModelAsk);
-            msRobots[modelPool] = robot;
-        } else
-        {
-            Robot robot(modelPool, organizationModelAsk);
-            msRobots[modelPool] = robot;
-        }
-        return msRobots[modelPool];
+        return Robot(modelPool.compact().begin()->first, organizationModelAsk);
     }
+    return Robot(modelPool, organizationModelAsk);
 }
 
 Robot::Robot()
     : Facade()
+    , mpEntry(make_shared<RobotCache::Entry>())
 {
 }
 
@@ -84,59 +68,40 @@ Robot::Robot(const owlapi::model::IRI& actorModel,
 
     mModelPool[actorModel] = 1;
 
+    mpEntry = organizationAsk().getRobotCache().getAtomicEntry(
+        actorModel,
+        [this, actorModel]() { return createAtomicEntry(actorModel); });
+    const RobotCache::Entry& entry = *mpEntry;
+
     mNominalPowerConsumption =
-        getDoubleValueOrDefault(actorModel,
-                                vocabulary::Robot::nominalPowerConsumption(),
-                                0.0);
-    mMass = getDoubleValueOrDefault(actorModel, vocabulary::Robot::mass(), 0.0);
-    mSupplyVoltage = getDoubleValueOrDefault(actorModel,
-                                             vocabulary::Robot::supplyVoltage(),
-                                             0.0);
+        getValueOrDefault(entry, RobotCache::NOMINAL_POWER_CONSUMPTION, 0.0);
+    mMass = getValueOrDefault(entry, RobotCache::MASS, 0.0);
+    mSupplyVoltage = getValueOrDefault(entry, RobotCache::SUPPLY_VOLTAGE, 0.0);
     mPowerSourceCapacity =
-        getDoubleValueOrDefault(actorModel,
-                                vocabulary::Robot::powerSourceCapacity(),
-                                0.0);
+        getValueOrDefault(entry, RobotCache::POWER_SOURCE_CAPACITY, 0.0);
     // convert from Ah (battery capacity to Ws)
     mEnergyCapacity = mPowerSourceCapacity * mSupplyVoltage * 3600;
 
     mMinAcceleration =
-        getDoubleValueOrDefault(actorModel,
-                                vocabulary::Robot::minAcceleration(),
-                                0.0);
+        getValueOrDefault(entry, RobotCache::MIN_ACCELERATION, 0.0);
     mMaxAcceleration =
-        getDoubleValueOrDefault(actorModel,
-                                vocabulary::Robot::maxAcceleration(),
-                                0.0);
+        getValueOrDefault(entry, RobotCache::MAX_ACCELERATION, 0.0);
     mNominalAcceleration =
-        getDoubleValueOrDefault(actorModel,
-                                vocabulary::Robot::nominalAcceleration(),
-                                0.0);
-
-    mMinVelocity = getDoubleValueOrDefault(actorModel,
-                                           vocabulary::Robot::minVelocity(),
-                                           0.0);
-    mMaxVelocity = getDoubleValueOrDefault(actorModel,
-                                           vocabulary::Robot::maxVelocity(),
-                                           0.0);
+        getValueOrDefault(entry, RobotCache::NOMINAL_ACCELERATION, 0.0);
+
+    mMinVelocity = getValueOrDefault(entry, RobotCache::MIN_VELOCITY, 0.0);
+    mMaxVelocity = getValueOrDefault(entry, RobotCache::MAX_VELOCITY, 0.0);
     mNominalVelocity =
-        getDoubleValueOrDefault(actorModel,
-                                vocabulary::Robot::nominalVelocity(),
-                                0.0);
+        getValueOrDefault(entry, RobotCache::NOMINAL_VELOCITY, 0.0);
 
     mTransportDemand =
-        getDoubleValueOrDefault(actorModel,
-                                vocabulary::Robot::transportDemand(),
-                                1.0);
+        getValueOrDefault(entry, RobotCache::TRANSPORT_DEMAND, 1.0);
     // get cardinality constraint
     mTransportCapacity =
-        getDoubleValueOrDefault(actorModel,
-                                vocabulary::Robot::transportCapacity(),
-                                0.0);
+        getValueOrDefault(entry, RobotCache::TRANSPORT_CAPACITY, 0.0);
 
-    // Custom properties that should be added by domain specific rules
-    mProperties[vocabulary::OM::resolve("loadAreaSize")] = getLoadArea();
-
-    updateManipulationProperties();
+    boost::unique_lock<boost::mutex> lock(entry.mutex);
+    mLoadArea = entry.properties.at(vocabulary::OM::resolve("loadAreaSize"));
 }
 
 Robot::Robot(const ModelPool& modelPool,
@@ -163,86 +128,151 @@ Robot::Robot(const ModelPool& modelPool,
     , mTransportVolume(-1)
     , mLoadArea(-1)
 {
+    mpEntry = organizationAsk().getRobotCache().getCompositeEntry(
+        mModelPool,
+        [this]() { return createCompositeEntry(); });
+    const RobotCache::Entry& entry = *mpEntry;
+
+    mNominalPowerConsumption =
+        entry.values[RobotCache::NOMINAL_POWER_CONSUMPTION];
+    mMass = entry.values[RobotCache::MASS];
+    mSupplyVoltage = entry.values[RobotCache::SUPPLY_VOLTAGE];
+    mPowerSourceCapacity = entry.values[RobotCache::POWER_SOURCE_CAPACITY];
+    mMinAcceleration = entry.values[RobotCache::MIN_ACCELERATION];
+    mMaxAcceleration = entry.values[RobotCache::MAX_ACCELERATION];
+    mNominalAcceleration = entry.values[RobotCache::NOMINAL_ACCELERATION];
+    mMinVelocity = entry.values[RobotCache::MIN_VELOCITY];
+    mMaxVelocity = entry.values[RobotCache::MAX_VELOCITY];
+    mNominalVelocity = entry.values[RobotCache::NOMINAL_VELOCITY];
+    mTransportDemand = entry.values[RobotCache::TRANSPORT_DEMAND];
+    mTransportCapacity = entry.values[RobotCache::TRANSPORT_CAPACITY];
+
+    // derived property
+    mEnergyCapacity = mPowerSourceCapacity * mSupplyVoltage * 3600;
+
+    boost::unique_lock<boost::mutex> lock(entry.mutex);
+    mLoadArea = entry.properties.at(vocabulary::OM::resolve("loadAreaSize"));
+}
+
+RobotCache::EntryPtr
+Robot::createAtomicEntry(const owlapi::model::IRI& actorModel) const
+{
+    RobotCache::EntryPtr entry = make_shared<RobotCache::Entry>();
+    for(size_t i = 0; i < RobotCache::NUMBER_OF_PROPERTIES; ++i)
+    {
+        RobotCache::Property property = static_cast<RobotCache::Property>(i);
+        entry->values[i] =
+            getDoubleValueOrDefault(actorModel,
+                                    RobotCache::getIRI(property),
+                                    std::numeric_limits<double>::quiet_NaN());
+    }
 
+    // Custom properties that should be added by domain specific rules
+    entry->properties[vocabulary::OM::resolve("loadAreaSize")] =
+        getLoadAreaSize(actorModel);
+    updateManipulationProperties(actorModel, entry->properties);
+    return entry;
+}
+
+RobotCache::EntryPtr Robot::createCompositeEntry() const
+{
+    RobotCache::Property weightedSums[] = {
+        RobotCache::NOMINAL_POWER_CONSUMPTION,
+        RobotCache::MASS,
+        RobotCache::TRANSPORT_DEMAND,
+        RobotCache::TRANSPORT_CAPACITY};
+    // optional base mobility and the supply voltage
+    // TODO: check consistency of supply voltage
+    RobotCache::Property maxima[] = {RobotCache::SUPPLY_VOLTAGE,
+                                     RobotCache::MIN_ACCELERATION,
+                                     RobotCache::MAX_ACCELERATION,
+                                     RobotCache::NOMINAL_ACCELERATION,
+                                     RobotCache::MIN_VELOCITY,
+                                     RobotCache::MAX_VELOCITY,
+                                     RobotCache::NOMINAL_VELOCITY};
+
+    RobotCache& cache = organizationAsk().getRobotCache();
+    std::vector<algebra::IRIValueMap> values(RobotCache::NUMBER_OF_PROPERTIES);
+    std::map<owlapi::model::IRI, double> manipulationProperties;
+    // The power source capacity is accounted once per model
+    ModelPool models;
     for(const ModelPool::value_type& pair : mModelPool)
     {
         const owlapi::model::IRI& actorModel = pair.first;
-        size_t modelCount = pair.second;
-        mNominalPowerConsumption +=
-            modelCount * getDoubleValueOrDefault(
-                             actorModel,
-                             vocabulary::Robot::nominalPowerConsumption(),
-                             0.0);
-        mMass +=
-            modelCount *
-            getDoubleValueOrDefault(actorModel, vocabulary::Robot::mass(), 0.0);
-        // TODO: check consistency of supply voltage
-        mSupplyVoltage =
-            std::max(getDoubleValueOrDefault(actorModel,
-                                             vocabulary::Robot::supplyVoltage(),
-                                             0.0),
-                     mSupplyVoltage);
-        mPowerSourceCapacity +=
-            getDoubleValueOrDefault(actorModel,
-                                    vocabulary::Robot::powerSourceCapacity(),
-                                    0.0);
+        models[actorModel] = 1;
 
-        // optional base mobility
-        mMinAcceleration = std::max(
-            mMinAcceleration,
-            getDoubleValueOrDefault(actorModel,
-                                    vocabulary::Robot::minAcceleration(),
-                                    0.0));
-        mMaxAcceleration = std::max(
-            mMaxAcceleration,
-            getDoubleValueOrDefault(actorModel,
-                                    vocabulary::Robot::maxAcceleration(),
-                                    0.0));
-        mNominalAcceleration = std::max(
-            mNominalAcceleration,
-            getDoubleValueOrDefault(actorModel,
-                                    vocabulary::Robot::nominalAcceleration(),
-                                    0.0));
-
-        mMinVelocity =
-            std::max(mMinVelocity,
-                     getDoubleValueOrDefault(actorModel,
-                                             vocabulary::Robot::minVelocity(),
-                                             0.0));
-        mMaxVelocity =
-            std::max(mMaxVelocity,
-                     getDoubleValueOrDefault(actorModel,
-                                             vocabulary::Robot::maxVelocity(),
-                                             0.0));
-        mNominalVelocity = std::max(
-            mNominalVelocity,
-            getDoubleValueOrDefault(actorModel,
-                                    vocabulary::Robot::nominalVelocity(),
-                                    0.0));
+        RobotCache::EntryPtr atomicEntry = cache.getAtomicEntry(
+            actorModel,
+            [this, actorModel]() { return createAtomicEntry(actorModel); });
+        for(size_t i = 0; i < RobotCache::NUMBER_OF_PROPERTIES; ++i)
+        {
+            RobotCache::Property property =
+                static_cast<RobotCache::Property>(i);
+            values[i][actorModel] =
+                getValueOrDefault(*atomicEntry, property, 0.0);
+        }
 
-        mTransportDemand +=
-            modelCount *
-            getDoubleValueOrDefault(actorModel,
-                                    vocabulary::Robot::transportDemand(),
-                                    0.0);
-        // get cardinality constraint
-        mTransportCapacity +=
-            modelCount *
-            getDoubleValueOrDefault(actorModel,
-                                    vocabulary::Robot::transportCapacity(),
-                                    0.0);
+        boost::unique_lock<boost::mutex> lock(atomicEntry->mutex);
+        for(const std::pair<const IRI, double>& p : atomicEntry->properties)
+        {
+            if(vocabulary::OM::resolve("minPickingHeight") == p.first)
+            {
+                updateProperty(manipulationProperties, p.first, p.second, true);
+            } else if(vocabulary::OM::resolve("maxPickingHeight") == p.first ||
+                      vocabulary::OM::resolve("maxPayloadMass") == p.first)
+            {
+                updateProperty(manipulationProperties,
+                               p.first,
+                               p.second,
+                               false);
+            }
+        }
     }
 
-    // derived property
-    mEnergyCapacity = mPowerSourceCapacity * mSupplyVoltage * 3600;
+    RobotCache::EntryPtr entry = make_shared<RobotCache::Entry>();
+    for(RobotCache::Property property : weightedSums)
+    {
+        entry->values[property] =
+            algebra::CompositionFunction::weightedSum(mModelPool,
+                                                      values[property]);
+    }
+    for(RobotCache::Property property : maxima)
+    {
+        entry->values[property] =
+            std::max(0.0,
+                     algebra::CompositionFunction::max(mModelPool,
+                                                       values[property]));
+    }
+    entry->values[RobotCache::POWER_SOURCE_CAPACITY] =
+        algebra::CompositionFunction::weightedSum(
+            models,
+            values[RobotCache::POWER_SOURCE_CAPACITY]);
 
+    // A physical item has always a transport demand (here assuming at least 1
+    // standard unit)
+    entry->values[RobotCache::TRANSPORT_DEMAND] += 1;
     // Assume there is only a single system transporting
-    mTransportCapacity =
-        mTransportCapacity - mModelPool.numberOfInstances() + 1;
+    uint32_t transportCapacity =
+        entry->values[RobotCache::TRANSPORT_CAPACITY];
+    transportCapacity = transportCapacity - mModelPool.numberOfInstances() + 1;
+    entry->values[RobotCache::TRANSPORT_CAPACITY] = transportCapacity;
 
     // Custom properties that should be added by domain specific rules
-    mProperties[vocabulary::OM::resolve("loadAreaSize")] = getLoadArea();
-    updateManipulationProperties();
+    entry->properties = manipulationProperties;
+    entry->properties[vocabulary::OM::resolve("loadAreaSize")] = getLoadArea();
+    return entry;
+}
+
+double Robot::getValueOrDefault(const RobotCache::Entry& entry,
+                                RobotCache::Property property,
+                                double defaultValue)
+{
+    double value = entry.values[property];
+    if(std::isnan(value))
+    {
+        return defaultValue;
+    }
+    return value;
 }
 
 uint32_t Robot::getTransportCapacity(const owlapi::model::IRI& model) const
@@ -336,7 +366,7 @@ double Robot::getLoadArea() const
                 Robot r = Robot::getInstance(actorModel, mOrganizationModelAsk);
                 if(r.hasLoadArea())
                 {
-                    double loadAreaSurface = getLoadAreaSize(actorModel);
+                    double loadAreaSurface = r.getLoadArea();
                     if(r.isMobile() || r.canTrail())
                     {
                         truckAndTrail += modelCount * loadAreaSurface;
@@ -353,51 +383,48 @@ double Robot::getLoadArea() const
     return mLoadArea;
 }
 
-void Robot::updateManipulationProperties()
+void Robot::updateManipulationProperties(
+    const owlapi::model::IRI& actorModel,
+    std::map<owlapi::model::IRI, double>& properties) const
 {
-    for(const ModelPool::value_type& v : mModelPool)
+    // Identify manipulators on the system
+    std::map<IRI, std::map<IRI, double>> manipulators =
+        mOrganizationModelAsk.getPropertyValues(
+            actorModel,
+            vocabulary::OM::resolve("Manipulator"));
+
+    for(const std::map<IRI, std::map<IRI, double>>::value_type& v :
+        manipulators)
     {
-        const owlapi::model::IRI& actorModel = v.first;
-
-        // Identify manipulators on the system
-        std::map<IRI, std::map<IRI, double>> manipulators =
-            mOrganizationModelAsk.getPropertyValues(
-                actorModel,
-                vocabulary::OM::resolve("Manipulator"));
-
-        for(const std::map<IRI, std::map<IRI, double>>::value_type& v :
-            manipulators)
+        const std::map<IRI, double>& manipulatorProperties = v.second;
+        for(const std::pair<const IRI, double>& p : manipulatorProperties)
         {
-            const std::map<IRI, double>& properties = v.second;
-            for(const std::pair<const IRI, double>& p : properties)
+            if(vocabulary::OM::resolve("minPickingHeight") == p.first)
             {
-                if(vocabulary::OM::resolve("minPickingHeight") == p.first)
-                {
-                    updateProperty(p.first, p.second, true);
-                } else if(vocabulary::OM::resolve("maxPickingHeight") ==
-                          p.first)
-                {
-                    updateProperty(p.first, p.second, false);
-                } else if(vocabulary::OM::resolve("maxPayloadMass") == p.first)
-                {
-                    updateProperty(p.first, p.second, false);
-                }
+                updateProperty(properties, p.first, p.second, true);
+            } else if(vocabulary::OM::resolve("maxPickingHeight") == p.first)
+            {
+                updateProperty(properties, p.first, p.second, false);
+            } else if(vocabulary::OM::resolve("maxPayloadMass") == p.first)
+            {
+                updateProperty(properties, p.first, p.second, false);
             }
         }
     }
 }
 
-void Robot::updateProperty(const owlapi::model::IRI& iri,
+void Robot::updateProperty(std::map<owlapi::model::IRI, double>& properties,
+                           const owlapi::model::IRI& iri,
                            double value,
                            bool useMin)
 {
-    double existingValue = mProperties[iri];
+    double existingValue = properties[iri];
     if(useMin)
     {
-        mProperties[iri] = std::min(value, existingValue);
+        properties[iri] = std::min(value, existingValue);
     } else
     {
-        mProperties[iri] = std::max(value, existingValue);
+        properties[iri] = std::max(value, existingValue);
     }
 }
 
@@ -594,20 +621,22 @@ double Robot::getDataPropertyValue(const owlapi::model::IRI& property) const
 
 double Robot::getPropertyValue(const owlapi::model::IRI& property) const
 {
-    std::map<owlapi::model::IRI, double>::const_iterator cit =
-        mProperties.find(property);
-    if(cit != mProperties.end())
     {
-        return cit->second;
-    } else
-    {
-        LOG_INFO_S << "Property '" << property << "' not in cache";
+        boost::unique_lock<boost::mutex> lock(mpEntry->mutex);
+        std::map<owlapi::model::IRI, double>::const_iterator cit =
+            mpEntry->properties.find(property);
+        if(cit != mpEntry->properties.end())
+        {
+            return cit->second;
+        }
     }
+    LOG_INFO_S << "Property '" << property << "' not in cache";
 
     try
     {
         double value = getDataPropertyValue(property);
-        mProperties[property] = value;
+        boost::unique_lock<boost::mutex> lock(mpEntry->mutex);
+        mpEntry->properties[property] = value;
         return value;
     } catch(const std::runtime_error& e)
     {
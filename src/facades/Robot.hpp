@@ -4,6 +4,7 @@
 #include "../Policy.hpp"
 #include "../algebra/CompositionFunction.hpp"
 #include "Facade.hpp"
+#include "RobotCache.hpp"
 
 namespace moreorg {
 class Agent;
@@ -22,11 +23,19 @@ namespace facades {
 class Robot : public Facade
 {
 public:
-    static const Robot& getInstance(const owlapi::model::IRI& actorModel,
-                                    const OrganizationModelAsk& ask);
+    /**
+     * Get the facade for an atomic system -- the property values are shared
+     * via the robot cache of the ask
+     */
+    static Robot getInstance(const owlapi::model::IRI& actorModel,
+                             const OrganizationModelAsk& ask);
 
-    static const Robot& getInstance(const ModelPool& modelPool,
-                                    const OrganizationModelAsk& ask);
+    /**
+     * Get the facade for a system, which is atomic if the model pool
+     * contains a single instance
+     */
+    static Robot getInstance(const ModelPool& modelPool,
+                             const OrganizationModelAsk& ask);
 
     /**
      * Constructor to allow usage in maps
@@ -245,18 +254,40 @@ private:
     /// The available load area volume (for arbitrary components)
     mutable double mLoadArea;
 
-    mutable std::map<owlapi::model::IRI, double> mProperties;
-
-    // Robot cache
-    static std::map<ModelPool, Robot> msRobots;
+    /// Property values, which are shared by all facades for the same system
+    RobotCache::EntryPtr mpEntry;
 
     double getLoadAreaSize(const owlapi::model::IRI& agent) const;
 
-    /// Try to identify all encountered manipulators in the system
-    void updateManipulationProperties();
+    /**
+     * Create the cache entry for an atomic agent model
+     */
+    RobotCache::EntryPtr
+    createAtomicEntry(const owlapi::model::IRI& actorModel) const;
+
+    /**
+     * Create the cache entry for the composite system of this facade from
+     * the entries of its atomic agent models
+     */
+    RobotCache::EntryPtr createCompositeEntry() const;
 
-    void
-    updateProperty(const owlapi::model::IRI& iri, double value, bool useMin);
+    /**
+     * Get the property value of an entry, or the default value if it is not
+     * defined
+     */
+    static double getValueOrDefault(const RobotCache::Entry& entry,
+                                    RobotCache::Property property,
+                                    double defaultValue);
+
+    /// Identify all encountered manipulators of an atomic agent model
+    void updateManipulationProperties(
+        const owlapi::model::IRI& actorModel,
+        std::map<owlapi::model::IRI, double>& properties) const;
+
+    static void updateProperty(std::map<owlapi::model::IRI, double>& properties,
+                               const owlapi::model::IRI& iri,
+                               double value,
+                               bool useMin);
 
     /**
      * Extract the drivedBy AnnotationProperty, if set
@@ -0,0 +1,222 @@
+#include "RobotCache.hpp"
+#include "../vocabularies/Robot.hpp"
+#include <boost/thread/recursive_mutex.hpp>
+#include <limits>
+#include <stdexcept>
+
+namespace moreorg {
+namespace facades {
+
+RobotCache::Entry::Entry()
+    : values(NUMBER_OF_PROPERTIES, std::numeric_limits<double>::quiet_NaN())
+{
+}
+
+RobotCache::RobotCache(const OrganizationModel::Ptr& om)
+    : mpOrganizationModel(om)
+    , mRevision(om ? om->getRevision() : 0)
+{
+}
+
+owlapi::model::IRI RobotCache::getIRI(Property property)
+{
+    switch(property)
+    {
+        case NOMINAL_POWER_CONSUMPTION:
+            return vocabulary::Robot::nominalPowerConsumption();
+        case MASS:
+            return vocabulary::Robot::mass();
+        case SUPPLY_VOLTAGE:
+            return vocabulary::Robot::supplyVoltage();
+        case POWER_SOURCE_CAPACITY:
+            return vocabulary::Robot::powerSourceCapacity();
+        case MIN_ACCELERATION:
+            return vocabulary::Robot::minAcceleration();
+        case MAX_ACCELERATION:
+            return vocabulary::Robot::maxAcceleration();
+        case NOMINAL_ACCELERATION:
+            return vocabulary::Robot::nominalAcceleration();
+        case MIN_VELOCITY:
+            return vocabulary::Robot::minVelocity();
+        case MAX_VELOCITY:
+            return vocabulary::Robot::maxVelocity();
+        case NOMINAL_VELOCITY:
+            return vocabulary::Robot::nominalVelocity();
+        case TRANSPORT_DEMAND:
+            return vocabulary::Robot::transportDemand();
+        case TRANSPORT_CAPACITY:
+            return vocabulary::Robot::transportCapacity();
+        case NUMBER_OF_PROPERTIES:
+            break;
+    }
+    throw std::invalid_argument(
+        "moreorg::facades::RobotCache::getIRI: unknown property");
+}
+
+ModelRegistry& RobotCache::getModelRegistry() const
+{
+    if(!mpOrganizationModel)
+    {
+        throw std::runtime_error("moreorg::facades::RobotCache: organization "
+                                 "model is not set");
+    }
+    return mpOrganizationModel->getModelRegistry();
+}
+
+void RobotCache::synchronise()
+{
+    uint64_t revision = mpOrganizationModel->getRevision();
+    if(mRevision != revision)
+    {
+        mAtomicEntries.clear();
+        mCompositeEntries.clear();
+        mRevision = revision;
+    }
+}
+
+RobotCache::EntryPtr
+RobotCache::getAtomicEntry(const owlapi::model::IRI& model,
+                           const CreateFunction& create)
+{
+    ModelRegistry::Id id = getModelRegistry().getId(model);
+    EntryFuture entry;
+    {
+        boost::unique_lock<boost::mutex> lock(mMutex);
+        synchronise();
+        if(id < mAtomicEntries.size())
+        {
+            entry = mAtomicEntries[id];
+        }
+    }
+    if(entry.valid())
+    {
+        // Wait for a creation which is still ongoing
+        return entry.get();
+    }
+
+    // Lock order: ontology first, then the cache
+    boost::unique_lock<boost::recursive_mutex> ontologyLock(
+        mpOrganizationModel->getOntologyMutex());
+    std::promise<EntryPtr> promise;
+    {
+        boost::unique_lock<boost::mutex> lock(mMutex);
+        synchronise();
+        if(id >= mAtomicEntries.size())
+        {
+            mAtomicEntries.resize(id + 1);
+        }
+        entry = mAtomicEntries[id];
+        if(!entry.valid())
+        {
+            mAtomicEntries[id] = promise.get_future().share();
+        }
+    }
+    if(entry.valid())
+    {
+        // Since creations hold the ontology mutex, this one has completed
+        return entry.get();
+    }
+
+    return createEntry(create, promise, [this, id]() {
+        if(id < mAtomicEntries.size())
+        {
+            mAtomicEntries[id] = EntryFuture();
+        }
+    });
+}
+
+RobotCache::EntryPtr RobotCache::getCompositeEntry(const ModelPool& modelPool,
+                                                   const CreateFunction& create)
+{
+    CompactModelPool key(modelPool, getModelRegistry());
+    EntryFuture entry;
+    {
+        boost::unique_lock<boost::mutex> lock(mMutex);
+        synchronise();
+        std::unordered_map<CompactModelPool, EntryFuture>::const_iterator cit =
+            mCompositeEntries.find(key);
+        if(cit != mCompositeEntries.end())
+        {
+            entry = cit->second;
+        }
+    }
+    if(entry.valid())
+    {
+        // Wait for a creation which is still ongoing
+        return entry.get();
+    }
+
+    // Lock order: ontology first, then the cache
+    boost::unique_lock<boost::recursive_mutex> ontologyLock(
+        mpOrganizationModel->getOntologyMutex());
+    std::promise<EntryPtr> promise;
+    {
+        boost::unique_lock<boost::mutex> lock(mMutex);
+        synchronise();
+        std::pair<std::unordered_map<CompactModelPool, EntryFuture>::iterator,
+                  bool>
+            inserted = mCompositeEntries.emplace(key, EntryFuture());
+        if(inserted.second)
+        {
+            inserted.first->second = promise.get_future().share();
+        } else
+        {
+            entry = inserted.first->second;
+        }
+    }
+    if(entry.valid())
+    {
+        // Since creations hold the ontology mutex, this one has completed
+        return entry.get();
+    }
+
+    return createEntry(create, promise, [this, key]() {
+        mCompositeEntries.erase(key);
+    });
+}
+
+RobotCache::EntryPtr
+RobotCache::createEntry(const CreateFunction& create,
+                        std::promise<EntryPtr>& promise,
+                        const boost::function0<void>& withdraw)
+{
+    try
+    {
+        EntryPtr entry = create();
+        promise.set_value(entry);
+        return entry;
+    } catch(...)
+    {
+        // Allow later requests to retry
+        {
+            boost::unique_lock<boost::mutex> lock(mMutex);
+            withdraw();
+        }
+        promise.set_exception(std::current_exception());
+        throw;
+    }
+}
+
+void RobotCache::clear()
+{
+    boost::unique_lock<boost::mutex> lock(mMutex);
+    mAtomicEntries.clear();
+    mCompositeEntries.clear();
+}
+
+size_t RobotCache::size() const
+{
+    boost::unique_lock<boost::mutex> lock(mMutex);
+    size_t numberOfEntries = mCompositeEntries.size();
+    for(const EntryFuture& entry : mAtomicEntries)
+    {
+        if(entry.valid())
+        {
+            ++numberOfEntries;
+        }
+    }
+    return numberOfEntries;
+}
+
+} // end namespace facades
+} // end namespace moreorg
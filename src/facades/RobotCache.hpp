@@ -0,0 +1,156 @@
+#ifndef ORGANIZATION_MODEL_FACADES_ROBOT_CACHE_HPP
+#define ORGANIZATION_MODEL_FACADES_ROBOT_CACHE_HPP
+
+#include <boost/function.hpp>
+#include <boost/thread/mutex.hpp>
+#include <future>
+#include <map>
+#include <owlapi/model/IRI.hpp>
+#include <unordered_map>
+#include <vector>
+
+#include "../CompactModelPool.hpp"
+#include "../OrganizationModel.hpp"
+#include "../SharedPtr.hpp"
+
+namespace moreorg {
+namespace facades {
+
+/**
+ * \class RobotCache
+ * \brief Property tables of robot facades, which are scoped to an
+ * OrganizationModelAsk
+ *
+ * \details
+ * The property values of atomic agent models are kept in a dense array which
+ * is indexed by the model id of the organization model's registry, while the
+ * values of composite agents are kept by model pool. Entries are computed
+ * once, and only contain values, so that facades can share them without
+ * referring back to the ask. All methods are thread-safe: an entry is created
+ * by the first request while holding the ontology mutex, and concurrent
+ * requests for the same entry wait for this creation. Entries are dropped
+ * once the revision of the organization model changes.
+ */
+class RobotCache
+{
+public:
+    typedef shared_ptr<RobotCache> Ptr;
+
+    /// Properties with a dedicated slot in the property values of an entry
+    enum Property
+    {
+        NOMINAL_POWER_CONSUMPTION = 0,
+        MASS,
+        SUPPLY_VOLTAGE,
+        POWER_SOURCE_CAPACITY,
+        MIN_ACCELERATION,
+        MAX_ACCELERATION,
+        NOMINAL_ACCELERATION,
+        MIN_VELOCITY,
+        MAX_VELOCITY,
+        NOMINAL_VELOCITY,
+        TRANSPORT_DEMAND,
+        TRANSPORT_CAPACITY,
+        NUMBER_OF_PROPERTIES
+    };
+
+    /// Property values indexed by Property
+    typedef std::vector<double> Values;
+
+    struct Entry
+    {
+        Entry();
+
+        /// Property values -- NaN if a value is not defined
+        Values values;
+
+        /// Guards the properties
+        mutable boost::mutex mutex;
+        /// Further property values, e.g., as result of inference rules
+        std::map<owlapi::model::IRI, double> properties;
+    };
+    typedef shared_ptr<Entry> EntryPtr;
+    typedef boost::function0<EntryPtr> CreateFunction;
+    /// An entry is available once its creation has been completed
+    typedef std::shared_future<EntryPtr> EntryFuture;
+
+    /**
+     * Constructor of the cache
+     * \param om Organization model whose model registry is used for indexing
+     */
+    RobotCache(const OrganizationModel::Ptr& om);
+
+    RobotCache(const RobotCache&) = delete;
+    RobotCache& operator=(const RobotCache&) = delete;
+
+    /**
+     * Get the IRI of a property
+     */
+    static owlapi::model::IRI getIRI(Property property);
+
+    /**
+     * Get the entry of an atomic agent model
+     * \param model Agent model
+     * \param create Function to create the entry if it does not exist -- it
+     * is called while holding the ontology mutex, but not the lock of the
+     * cache
+     * \return entry
+     */
+    EntryPtr getAtomicEntry(const owlapi::model::IRI& model,
+                            const CreateFunction& create);
+
+    /**
+     * Get the entry of a composite agent
+     * \param modelPool Model pool of the composite agent
+     * \param create Function to create the entry if it does not exist -- it
+     * is called while holding the ontology mutex, but not the lock of the
+     * cache
+     * \return entry
+     */
+    EntryPtr getCompositeEntry(const ModelPool& modelPool,
+                               const CreateFunction& create);
+
+    /**
+     * Remove all entries -- entries which are in use remain valid
+     */
+    void clear();
+
+    /**
+     * Get the number of cached (atomic and composite) entries
+     */
+    size_t size() const;
+
+private:
+    ModelRegistry& getModelRegistry() const;
+
+    /**
+     * Drop all entries if they have been created for another revision of the
+     * organization model
+     * Requires the cache to be locked
+     */
+    void synchronise();
+
+    /**
+     * Create an entry and publish it through the promise, or withdraw the
+     * promise if the creation fails
+     * Requires the ontology to be locked
+     * \param withdraw Function to remove the pending entry from the cache
+     */
+    EntryPtr createEntry(const CreateFunction& create,
+                         std::promise<EntryPtr>& promise,
+                         const boost::function0<void>& withdraw);
+
+    OrganizationModel::Ptr mpOrganizationModel;
+
+    /// Guards the access to all members below
+    mutable boost::mutex mMutex;
+    /// Revision of the organization model the entries have been created for
+    uint64_t mRevision;
+    /// Entries of atomic agent models by model id
+    std::vector<EntryFuture> mAtomicEntries;
+    std::unordered_map<CompactModelPool, EntryFuture> mCompositeEntries;
+};
+
+} // end namespace facades
+} // end namespace moreorg
+#endif // ORGANIZATION_MODEL_FACADES_ROBOT_CACHE_HPP
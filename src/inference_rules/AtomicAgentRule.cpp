@@ -1,35 +1,27 @@
 #include "AtomicAgentRule.hpp"
 #include "../Agent.hpp"
 #include "../InferenceRule.hpp"
-#include "../facades/Robot.hpp"
 
-#include <muParser.h>
 #include <stdexcept>
 
 namespace moreorg {
 namespace inference_rules {
 
-double AtomicAgentRule::apply(const facades::Robot& robot) const
+void AtomicAgentRule::validate(const ModelPool& agentType) const
 {
-    if(robot.getModelPool().numberOfInstances() > 1)
+    if(agentType.numberOfInstances() > 1)
     {
         throw std::runtime_error(
             "moreorg::inference_rules::AtomicAgentRule::apply"
             " trying to apply AtomicAgentRule to Composite agent" +
-            robot.getModelPool().toString(4));
+            agentType.toString(4));
     }
+}
 
-    mu::Parser muParser;
-    Agent agent(robot.getModelPool());
-    for(const std::pair<const std::string, OPCall>& p : mOPCalls)
-    {
-        const OPCall& opcall = p.second;
-        double value = opcall.evalAtomic(agent, mAsk);
-        muParser.DefineConst(p.first, value);
-    }
-    muParser.SetExpr(mPreparedRule);
-    // muParser.EnableDebugDump(true,true);
-    return muParser.Eval();
+double AtomicAgentRule::evalOPCall(const OPCall& opcall,
+                                   const Agent& agent) const
+{
+    return opcall.evalAtomic(agent, mAsk);
 }
 
 } // end namespace inference_rules
@@ -1,4 +1,3 @@
-
 #ifndef MOREORG_INFERENCE_RULES_ATOMIC_AGENT_RULE_HPP
 #define MOREORG_INFERENCE_RULES_ATOMIC_AGENT_RULE_HPP
 
@@ -12,7 +11,10 @@ class AtomicAgentRule : public InferenceRule
 public:
     using Ptr = shared_ptr<AtomicAgentRule>;
 
-    double apply(const facades::Robot& robot) const override;
+protected:
+    void validate(const ModelPool& agentType) const override;
+
+    double evalOPCall(const OPCall& opcall, const Agent& agent) const override;
 };
 
 } // end namespace inference_rules
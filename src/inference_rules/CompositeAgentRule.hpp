@@ -11,7 +11,10 @@ class CompositeAgentRule : public InferenceRule
 public:
     using Ptr = shared_ptr<CompositeAgentRule>;
 
-    double apply(const facades::Robot& robot) const override;
+protected:
+    void validate(const ModelPool& agentType) const override;
+
+    double evalOPCall(const OPCall& opcall, const Agent& agent) const override;
 };
 
 } // end namespace inference_rules
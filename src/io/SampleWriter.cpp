@@ -0,0 +1,176 @@
+#include "SampleWriter.hpp"
+#include <boost/io/ios_state.hpp>
+#include <cstdint>
+#include <iomanip>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+
+namespace moreorg {
+namespace io {
+
+/**
+ * \class CSVSampleWriter
+ * \brief Write samples as comma separated values
+ * \details Values are written with full precision, while the format of the
+ * stream is restored after each call. Names and labels are quoted if they
+ * contain a separator, a quote or a line break
+ */
+class CSVSampleWriter : public SampleWriter
+{
+public:
+    CSVSampleWriter(std::ostream& out)
+        : mOut(out)
+        , mNumberOfColumns(0)
+        , mLabelled(false)
+    {
+    }
+
+    void writeHeader(const std::vector<std::string>& columns,
+                     bool labelled) override
+    {
+        mNumberOfColumns = columns.size();
+        mLabelled = labelled;
+
+        mOut << "time";
+        if(mLabelled)
+        {
+            mOut << ",label";
+        }
+        for(const std::string& column : columns)
+        {
+            mOut << "," << quote(column);
+        }
+        mOut << "\n";
+    }
+
+    void writeBlock(const SampleBlock& block) override
+    {
+        boost::io::ios_flags_saver flagsSaver(mOut);
+        boost::io::ios_precision_saver precisionSaver(mOut);
+        mOut.unsetf(std::ios_base::floatfield);
+        mOut << std::setprecision(std::numeric_limits<double>::max_digits10);
+
+        for(size_t row = 0; row < block.getNumberOfRows(); ++row)
+        {
+            mOut << block.times[row];
+            if(mLabelled)
+            {
+                mOut << "," << quote(block.labels[row]);
+            }
+            for(size_t column = 0; column < mNumberOfColumns; ++column)
+            {
+                mOut << "," << block.at(column, row);
+            }
+            mOut << "\n";
+        }
+    }
+
+private:
+    /**
+     * Quote a field if required, where quotes are escaped by doubling them
+     */
+    static std::string quote(const std::string& field)
+    {
+        if(field.find_first_of(",\"\r\n") == std::string::npos)
+        {
+            return field;
+        }
+
+        std::string quoted = "\"";
+        for(char c : field)
+        {
+            if(c == '"')
+            {
+                quoted += '"';
+            }
+            quoted += c;
+        }
+        return quoted + "\"";
+    }
+
+    std::ostream& mOut;
+    size_t mNumberOfColumns;
+    bool mLabelled;
+};
+
+/**
+ * \class BinarySampleWriter
+ * \brief Write samples in a columnar binary format
+ * \see SampleWriter::BINARY
+ */
+class BinarySampleWriter : public SampleWriter
+{
+public:
+    BinarySampleWriter(std::ostream& out)
+        : mOut(out)
+        , mLabelled(false)
+    {
+    }
+
+    void writeHeader(const std::vector<std::string>& columns,
+                     bool labelled) override
+    {
+        mLabelled = labelled;
+
+        write<uint32_t>(columns.size());
+        write<uint8_t>(labelled ? 1 : 0);
+        for(const std::string& column : columns)
+        {
+            writeString(column);
+        }
+    }
+
+    void writeBlock(const SampleBlock& block) override
+    {
+        size_t rows = block.getNumberOfRows();
+        write<uint64_t>(rows);
+        for(size_t time : block.times)
+        {
+            write<uint64_t>(time);
+        }
+        if(mLabelled)
+        {
+            for(const std::string& label : block.labels)
+            {
+                writeString(label);
+            }
+        }
+        if(!block.values.empty())
+        {
+            mOut.write(reinterpret_cast<const char*>(block.values.data()),
+                       block.values.size() * sizeof(double));
+        }
+    }
+
+private:
+    template <typename T> void write(T value)
+    {
+        mOut.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    void writeString(const std::string& s)
+    {
+        write<uint32_t>(s.size());
+        mOut.write(s.data(), s.size());
+    }
+
+    std::ostream& mOut;
+    bool mLabelled;
+};
+
+SampleWriter::Ptr SampleWriter::getInstance(Format format, std::ostream& out)
+{
+    switch(format)
+    {
+        case CSV:
+            return make_shared<CSVSampleWriter>(out);
+        case BINARY:
+            return make_shared<BinarySampleWriter>(out);
+    }
+    throw std::invalid_argument(
+        "moreorg::io::SampleWriter::getInstance: unknown format");
+}
+
+} // end namespace io
+} // end namespace moreorg
@@ -0,0 +1,93 @@
+#ifndef ORGANIZATION_MODEL_IO_SAMPLE_WRITER_HPP
+#define ORGANIZATION_MODEL_IO_SAMPLE_WRITER_HPP
+
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include "../SharedPtr.hpp"
+
+namespace moreorg {
+namespace io {
+
+/**
+ * \class SampleBlock
+ * \brief A block of sample rows, which is stored column by column
+ * \details Each row is identified by its time and an optional label, e.g., the
+ * name of the agent the row refers to
+ */
+struct SampleBlock
+{
+    /// Time of each row
+    std::vector<size_t> times;
+    /// Label of each row -- empty if rows are not labelled
+    std::vector<std::string> labels;
+    /// Values in column major order, i.e., values[column*rows + row]
+    std::vector<double> values;
+
+    size_t getNumberOfRows() const { return times.size(); }
+
+    double& at(size_t column, size_t row)
+    {
+        return values[column * times.size() + row];
+    }
+
+    double at(size_t column, size_t row) const
+    {
+        return values[column * times.size() + row];
+    }
+};
+
+/**
+ * \class SampleWriter
+ * \brief Writer to stream sample tables block by block
+ * \details A writer is used by first calling writeHeader once, followed by an
+ * arbitrary number of writeBlock calls
+ */
+class SampleWriter
+{
+public:
+    typedef shared_ptr<SampleWriter> Ptr;
+
+    enum Format {
+        /// Comma separated values, one line per row
+        CSV,
+        /**
+         * Columnar binary format (native byte order):
+         * header: uint32 number of columns, uint8 labelled flag, and for each
+         * column an uint32 name length followed by the name;
+         * each block: uint64 number of rows, uint64 times, labels as uint32
+         * length followed by the label (if labelled), and finally all values
+         * (double) column by column
+         */
+        BINARY
+    };
+
+    virtual ~SampleWriter() {}
+
+    /**
+     * Get a writer for the given format
+     * \param format Output format
+     * \param out Stream to write to, which needs to outlive the writer
+     * \return writer
+     */
+    static Ptr getInstance(Format format, std::ostream& out);
+
+    /**
+     * Write the table header
+     * \param columns Names of the value columns
+     * \param labelled True if the rows carry a label
+     */
+    virtual void writeHeader(const std::vector<std::string>& columns,
+                             bool labelled) = 0;
+
+    /**
+     * Write a block of rows
+     */
+    virtual void writeBlock(const SampleBlock& block) = 0;
+};
+
+} // end namespace io
+} // end namespace moreorg
+#endif // ORGANIZATION_MODEL_IO_SAMPLE_WRITER_HPP
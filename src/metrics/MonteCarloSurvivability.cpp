@@ -0,0 +1,412 @@
+#include "MonteCarloSurvivability.hpp"
+#include "../reasoning/DisjointResourceMatch.hpp"
+#include "../reasoning/ResourceInstanceMatch.hpp"
+#include "../reasoning/ResourceMatch.hpp"
+#include "../utils/Parallel.hpp"
+#include <algorithm>
+#include <base-logging/Logging.hpp>
+#include <boost/functional/hash.hpp>
+#include <boost/math/distributions/normal.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/recursive_mutex.hpp>
+#include <cmath>
+#include <map>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <tuple>
+#include <unordered_map>
+
+using namespace owlapi::model;
+
+namespace moreorg {
+namespace metrics {
+
+namespace {
+
+/// Number of surviving resource instances per model
+typedef std::vector<uint32_t> SurvivorCounts;
+
+/// Resource instances of the same atomic agent and model, which share the
+/// failure probability
+struct ResourceGroup
+{
+    size_t agent;
+    size_t model;
+    uint32_t size;
+    double failureProbability;
+};
+
+/**
+ * Memoised results of the assignment check, shared by all batches of a
+ * computation
+ */
+class SupportCache
+{
+public:
+    SupportCache(const reasoning::ModelBound::List& required,
+                 const std::vector<ResourceInstance::List>& instancesByModel,
+                 const OrganizationModelAsk& ask)
+        : mRequired(required)
+        , mInstancesByModel(instancesByModel)
+        , mAsk(ask)
+    {
+    }
+
+    /**
+     * Check if the surviving instances allow a full assignment of the
+     * requirements
+     */
+    bool isSupported(const SurvivorCounts& counts)
+    {
+        {
+            boost::unique_lock<boost::mutex> lock(mMutex);
+            std::map<SurvivorCounts, bool>::const_iterator cit =
+                mSupported.find(counts);
+            if(cit != mSupported.end())
+            {
+                return cit->second;
+            }
+        }
+
+        // Lock order: ontology first, then the cache
+        boost::unique_lock<boost::recursive_mutex> ontologyLock(
+            mAsk.getOrganizationModel()->getOntologyMutex());
+        boost::unique_lock<boost::mutex> lock(mMutex);
+        std::map<SurvivorCounts, bool>::const_iterator cit =
+            mSupported.find(counts);
+        if(cit != mSupported.end())
+        {
+            return cit->second;
+        }
+
+        ResourceInstance::List survivors;
+        for(size_t model = 0; model < counts.size(); ++model)
+        {
+            const ResourceInstance::List& instances = mInstancesByModel[model];
+            survivors.insert(survivors.end(),
+                             instances.begin(),
+                             instances.begin() + counts[model]);
+        }
+        bool supported = reasoning::DisjointResourceMatch::solve(
+                             mRequired,
+                             survivors,
+                             mAsk)
+                             .numberOfAssignments > 0;
+        mSupported[counts] = supported;
+        return supported;
+    }
+
+private:
+    reasoning::ModelBound::List mRequired;
+    std::vector<ResourceInstance::List> mInstancesByModel;
+    OrganizationModelAsk mAsk;
+
+    boost::mutex mMutex;
+    std::map<SurvivorCounts, bool> mSupported;
+};
+
+} // end anonymous namespace
+
+MonteCarloSurvivability::Result::Result()
+    : numberOfSamples(0)
+    , numberOfSurvivals(0)
+    , probabilityOfSurvival(0)
+    , confidenceLevel(0)
+    , lowerBound(0)
+    , upperBound(0)
+{
+}
+
+std::string MonteCarloSurvivability::Result::toString(size_t indent) const
+{
+    std::string hspace(indent, ' ');
+    std::stringstream ss;
+    ss << hspace << "MonteCarloSurvivability: " << std::endl;
+    ss << hspace << "    samples:                " << numberOfSamples
+       << std::endl;
+    ss << hspace << "    survivals:              " << numberOfSurvivals
+       << std::endl;
+    ss << hspace << "    probabilityOfSurvival:  " << probabilityOfSurvival
+       << std::endl;
+    ss << hspace << "    confidence interval:    [" << lowerBound << ", "
+       << upperBound << "] at " << confidenceLevel;
+    return ss.str();
+}
+
+MonteCarloSurvivability::MonteCarloSurvivability(
+    const OrganizationModelAsk& ask,
+    const ProbabilityDensityFunction::Ptr& defaultPDF,
+    size_t numberOfThreads,
+    size_t batchSize)
+    : mAsk(ask)
+    , mDefaultProbabilityDensityFunction(defaultPDF)
+    , mpProbabilityDensityFunctionTable(
+          ProbabilityDensityFunctionTable::getInstance(
+              ask.getOrganizationModel()))
+    , mNumberOfThreads(numberOfThreads)
+    , mBatchSize(batchSize)
+    , mSeed(0)
+    , mConfidenceLevel(0.95)
+{
+    if(!mDefaultProbabilityDensityFunction)
+    {
+        throw std::invalid_argument(
+            "moreorg::metrics::MonteCarloSurvivability: no default probability "
+            "density function provided");
+    }
+    if(mBatchSize == 0)
+    {
+        throw std::invalid_argument(
+            "moreorg::metrics::MonteCarloSurvivability: batch size must be "
+            "greater than 0");
+    }
+}
+
+void MonteCarloSurvivability::setConfidenceLevel(double confidenceLevel)
+{
+    if(confidenceLevel <= 0 || confidenceLevel >= 1)
+    {
+        throw std::invalid_argument(
+            "moreorg::metrics::MonteCarloSurvivability::setConfidenceLevel: "
+            "confidence level must lie in (0,1)");
+    }
+    mConfidenceLevel = confidenceLevel;
+}
+
+double MonteCarloSurvivability::getFailureProbability(const IRIList& models,
+                                                      double t0,
+                                                      double t1) const
+{
+    for(const IRI& model : models)
+    {
+        if(model.empty())
+        {
+            continue;
+        }
+        ProbabilityDensityFunction::Ptr pdf =
+            mpProbabilityDensityFunctionTable->getProbabilityDensityFunction(
+                model);
+        if(pdf)
+        {
+            return std::min(1., std::max(0., pdf->getConditional(t0, t1)));
+        }
+    }
+    return -1;
+}
+
+MonteCarloSurvivability::Result MonteCarloSurvivability::compute(
+    const std::vector<OWLCardinalityRestriction::Ptr>& required,
+    const Agent& agent,
+    size_t numberOfSamples,
+    double t0,
+    double t1) const
+{
+    return compute(required,
+                   mAsk.getRelated(agent),
+                   numberOfSamples,
+                   t0,
+                   t1);
+}
+
+MonteCarloSurvivability::Result MonteCarloSurvivability::compute(
+    const std::vector<OWLCardinalityRestriction::Ptr>& required,
+    const ResourceInstance::List& available,
+    size_t numberOfSamples,
+    double t0,
+    double t1) const
+{
+    if(required.empty())
+    {
+        throw std::invalid_argument(
+            "moreorg::metrics::MonteCarloSurvivability: set of cardinality "
+            "restriction to define requirements is empty");
+    }
+
+    using namespace moreorg::reasoning;
+    ModelBound::List modelBoundRequired =
+        ResourceInstanceMatch::toModelBoundList(required);
+    if(!ResourceMatch::hasMinRequirements(modelBoundRequired))
+    {
+        throw std::invalid_argument(
+            "moreorg::metrics::MonteCarloSurvivability: model bound requires "
+            "minimum requirements, but none are provided");
+    }
+
+    // Group the resource instances by atomic agent, model and failure
+    // probability
+    std::map<AtomicAgent, size_t> agentIndices;
+    std::map<IRI, size_t> modelIndices;
+    std::vector<ResourceInstance::List> instancesByModel;
+    std::vector<ResourceGroup> groups;
+    std::map<std::tuple<size_t, size_t, double>, size_t> groupIndices;
+    for(const ResourceInstance& instance : available)
+    {
+        size_t agent =
+            agentIndices
+                .insert(std::make_pair(instance.getAtomicAgent(),
+                                       agentIndices.size()))
+                .first->second;
+
+        std::pair<std::map<IRI, size_t>::iterator, bool> modelIndex =
+            modelIndices.insert(
+                std::make_pair(instance.getModel(), modelIndices.size()));
+        size_t model = modelIndex.first->second;
+        if(modelIndex.second)
+        {
+            instancesByModel.push_back(ResourceInstance::List());
+        }
+        instancesByModel[model].push_back(instance);
+
+        double failureProbability = getFailureProbability(
+            {instance.getName(), instance.getModel()},
+            t0,
+            t1);
+        if(failureProbability < 0)
+        {
+            failureProbability = std::min(
+                1.,
+                std::max(0.,
+                         mDefaultProbabilityDensityFunction->getConditional(
+                             t0,
+                             t1)));
+        }
+
+        std::tuple<size_t, size_t, double> key(agent,
+                                               model,
+                                               failureProbability);
+        std::map<std::tuple<size_t, size_t, double>, size_t>::const_iterator
+            cit = groupIndices.find(key);
+        if(cit != groupIndices.end())
+        {
+            ++groups[cit->second].size;
+        } else
+        {
+            groupIndices[key] = groups.size();
+            groups.push_back(
+                ResourceGroup{agent, model, 1, failureProbability});
+        }
+    }
+
+    std::vector<double> agentFailureProbabilities(agentIndices.size(), 0.);
+    for(const std::pair<const AtomicAgent, size_t>& agent : agentIndices)
+    {
+        double failureProbability =
+            getFailureProbability({agent.first.getModel()}, t0, t1);
+        agentFailureProbabilities[agent.second] =
+            failureProbability < 0 ? 0. : failureProbability;
+    }
+
+    SupportCache supportCache(modelBoundRequired, instancesByModel, mAsk);
+
+    Result result;
+    result.numberOfSamples = numberOfSamples;
+    result.confidenceLevel = mConfidenceLevel;
+
+    SurvivorCounts allSurvive(instancesByModel.size());
+    for(size_t model = 0; model < instancesByModel.size(); ++model)
+    {
+        allSurvive[model] = instancesByModel[model].size();
+    }
+    if(numberOfSamples == 0)
+    {
+        return result;
+    }
+    if(!supportCache.isSupported(allSurvive))
+    {
+        LOG_INFO_S << "moreorg::metrics::MonteCarloSurvivability: "
+                   << "requirements are not fulfilled by the available "
+                      "resources";
+        return result;
+    }
+
+    size_t numberOfBatches = (numberOfSamples + mBatchSize - 1) / mBatchSize;
+    std::vector<size_t> survivals(numberOfBatches, 0);
+    utils::Parallel::forEach(
+        numberOfBatches,
+        [&](size_t batch) {
+            uint64_t batchId = batch;
+            std::seed_seq seeds = {static_cast<uint32_t>(mSeed),
+                                   static_cast<uint32_t>(mSeed >> 32),
+                                   static_cast<uint32_t>(batchId),
+                                   static_cast<uint32_t>(batchId >> 32)};
+            std::mt19937_64 generator(seeds);
+            std::uniform_real_distribution<double> uniform(0., 1.);
+            std::vector<std::binomial_distribution<uint32_t>> survivors;
+            for(const ResourceGroup& group : groups)
+            {
+                survivors.push_back(std::binomial_distribution<uint32_t>(
+                    group.size,
+                    1. - group.failureProbability));
+            }
+
+            std::unordered_map<SurvivorCounts,
+                               bool,
+                               boost::hash<SurvivorCounts>>
+                supported;
+            std::vector<bool> agentSurvives(agentFailureProbabilities.size());
+            SurvivorCounts counts(instancesByModel.size());
+
+            size_t first = batch * mBatchSize;
+            size_t last = std::min(first + mBatchSize, numberOfSamples);
+            for(size_t sample = first; sample < last; ++sample)
+            {
+                for(size_t a = 0; a < agentSurvives.size(); ++a)
+                {
+                    agentSurvives[a] = agentFailureProbabilities[a] <= 0 ||
+                                       uniform(generator) >=
+                                           agentFailureProbabilities[a];
+                }
+
+                std::fill(counts.begin(), counts.end(), 0);
+                for(size_t g = 0; g < groups.size(); ++g)
+                {
+                    if(agentSurvives[groups[g].agent])
+                    {
+                        counts[groups[g].model] += survivors[g](generator);
+                    }
+                }
+
+                std::unordered_map<SurvivorCounts,
+                                   bool,
+                                   boost::hash<SurvivorCounts>>::
+                    const_iterator cit = supported.find(counts);
+                if(cit == supported.end())
+                {
+                    cit = supported
+                              .insert(std::make_pair(
+                                  counts,
+                                  supportCache.isSupported(counts)))
+                              .first;
+                }
+                if(cit->second)
+                {
+                    ++survivals[batch];
+                }
+            }
+        },
+        mNumberOfThreads);
+
+    for(size_t batchSurvivals : survivals)
+    {
+        result.numberOfSurvivals += batchSurvivals;
+    }
+
+    // Wilson score interval
+    double n = numberOfSamples;
+    double p = result.numberOfSurvivals / n;
+    double z = boost::math::quantile(boost::math::normal(),
+                                     0.5 + mConfidenceLevel / 2.);
+    double denominator = 1 + z * z / n;
+    double center = (p + z * z / (2 * n)) / denominator;
+    double halfWidth =
+        z * std::sqrt(p * (1 - p) / n + z * z / (4 * n * n)) / denominator;
+
+    result.probabilityOfSurvival = p;
+    result.lowerBound = std::max(0., center - halfWidth);
+    result.upperBound = std::min(1., center + halfWidth);
+    return result;
+}
+
+} // end namespace metrics
+} // end namespace moreorg
@@ -0,0 +1,165 @@
+#ifndef ORGANIZATION_MODEL_METRICS_MONTE_CARLO_SURVIVABILITY_HPP
+#define ORGANIZATION_MODEL_METRICS_MONTE_CARLO_SURVIVABILITY_HPP
+
+#include <owlapi/model/OWLCardinalityRestriction.hpp>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "../Agent.hpp"
+#include "../OrganizationModelAsk.hpp"
+#include "../ResourceInstance.hpp"
+#include "ProbabilityDensityFunction.hpp"
+#include "ProbabilityDensityFunctionTable.hpp"
+#include "pdfs/WeibullPDF.hpp"
+
+namespace moreorg {
+namespace metrics {
+
+/**
+ * \class MonteCarloSurvivability
+ * \brief Estimate the probability of survival of a set of resources by
+ * sampling component failures
+ *
+ * \details
+ * Each sample draws the failure of every atomic agent and every resource
+ * instance within the time interval [t0, t1] and checks whether the surviving
+ * resources still allow a full assignment of the requirements (see
+ * reasoning::DisjointResourceMatch). In contrast to the analytical metrics
+ * (Redundancy, ProbabilityOfFailure) resources which belong to the same atomic
+ * agent fail together when the agent fails.
+ *
+ * The failure probability of a resource instance is the conditional value of
+ * its probability density function -- as for ProbabilityOfFailure. The pdf is
+ * looked up by the name of the instance, then by its model, and the default
+ * pdf is used when neither has a pdf. An atomic agent only fails on its own
+ * if its model has a pdf.
+ *
+ * Samples are drawn in batches which are distributed across the worker
+ * threads. Each batch uses its own random number generator, which is seeded
+ * from the seed and the batch index, so that the result depends only on the
+ * seed, the number of samples and the batch size -- not on the number of
+ * threads. Since resource instances of the same model are interchangeable,
+ * the assignment is checked only once per distinct number of surviving
+ * instances per model.
+ *
+ \verbatim
+ MonteCarloSurvivability survivability(ask);
+ MonteCarloSurvivability::Result result =
+     survivability.compute(required, agent, 1000000, 0, 3600);
+ std::cout << result.toString() << std::endl;
+ \endverbatim
+ */
+class MonteCarloSurvivability
+{
+public:
+    struct Result
+    {
+        Result();
+
+        /// Number of drawn samples
+        size_t numberOfSamples;
+        /// Number of samples where the requirements remained fulfilled
+        size_t numberOfSurvivals;
+        /// Estimated probability of survival
+        double probabilityOfSurvival;
+        /// Confidence level of the interval
+        double confidenceLevel;
+        /// Lower bound of the (Wilson score) confidence interval
+        double lowerBound;
+        /// Upper bound of the (Wilson score) confidence interval
+        double upperBound;
+
+        std::string toString(size_t indent = 0) const;
+    };
+
+    /**
+     * Constructor
+     * \param ask Organization model ask
+     * \param defaultPDF Pdf of resources without an associated pdf
+     * \param numberOfThreads Number of worker threads, 0 to use all available
+     * hardware threads
+     * \param batchSize Number of samples per batch
+     */
+    MonteCarloSurvivability(
+        const OrganizationModelAsk& ask,
+        const ProbabilityDensityFunction::Ptr& defaultPDF =
+            make_shared<pdfs::WeibullPDF>(36000., 1.), // 36000s = 10h
+        size_t numberOfThreads = 0,
+        size_t batchSize = 10000);
+
+    /**
+     * Estimate the probability of survival of a set of resources
+     * \param required Required resources
+     * \param available Available resource instances
+     * \param numberOfSamples Number of samples to draw
+     * \param t0 Start time
+     * \param t1 End time
+     * \return estimated probability of survival and its confidence interval
+     * \throw std::invalid_argument if the requirements are empty or do not
+     * define minimum cardinalities
+     */
+    Result compute(
+        const std::vector<owlapi::model::OWLCardinalityRestriction::Ptr>&
+            required,
+        const ResourceInstance::List& available,
+        size_t numberOfSamples,
+        double t0 = 0,
+        double t1 = 0) const;
+
+    /**
+     * Estimate the probability of survival of an agent
+     * \see compute
+     */
+    Result compute(
+        const std::vector<owlapi::model::OWLCardinalityRestriction::Ptr>&
+            required,
+        const Agent& agent,
+        size_t numberOfSamples,
+        double t0 = 0,
+        double t1 = 0) const;
+
+    /**
+     * Set the seed of the random number generators
+     */
+    void setSeed(uint64_t seed) { mSeed = seed; }
+
+    /**
+     * Get the seed of the random number generators
+     */
+    uint64_t getSeed() const { return mSeed; }
+
+    /**
+     * Set the confidence level of the reported interval
+     * \param confidenceLevel Confidence level in (0,1), e.g., 0.95
+     */
+    void setConfidenceLevel(double confidenceLevel);
+
+    /**
+     * Get the confidence level of the reported interval
+     */
+    double getConfidenceLevel() const { return mConfidenceLevel; }
+
+private:
+    /**
+     * Get the failure probability in [t0,t1] for the pdf of the first of the
+     * given models which has a pdf
+     * \return failure probability, or a negative value if none of the models
+     * has a pdf
+     */
+    double getFailureProbability(const owlapi::model::IRIList& models,
+                                 double t0,
+                                 double t1) const;
+
+    OrganizationModelAsk mAsk;
+    ProbabilityDensityFunction::Ptr mDefaultProbabilityDensityFunction;
+    ProbabilityDensityFunctionTable::Ptr mpProbabilityDensityFunctionTable;
+    size_t mNumberOfThreads;
+    size_t mBatchSize;
+    uint64_t mSeed;
+    double mConfidenceLevel;
+};
+
+} // end namespace metrics
+} // end namespace moreorg
+#endif // ORGANIZATION_MODEL_METRICS_MONTE_CARLO_SURVIVABILITY_HPP
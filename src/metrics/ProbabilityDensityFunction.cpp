@@ -1,6 +1,7 @@
 #include "ProbabilityDensityFunction.hpp"
 
 #include "../vocabularies/OMBase.hpp"
+#include "ProbabilityDensityFunctionTable.hpp"
 #include "pdfs/ConstantPDF.hpp"
 #include "pdfs/ExponentialPDF.hpp"
 #include "pdfs/WeibullPDF.hpp"
@@ -10,40 +11,63 @@ using namespace owlapi::model;
 namespace moreorg {
 namespace metrics {
 
+void ProbabilityDensityFunction::getConditionals(
+    double t0,
+    const std::vector<double>& t1,
+    std::vector<double>& values) const
+{
+    values.resize(t1.size());
+    for(size_t i = 0; i < t1.size(); ++i)
+    {
+        values[i] = getConditional(t0, t1[i]);
+    }
+}
+
 ProbabilityDensityFunction::Ptr ProbabilityDensityFunction::getInstance(
     const OrganizationModelAsk& organizationModelAsk,
     const IRI& qualification)
 {
-    IRIList iriList = organizationModelAsk.ontology().allRelatedInstances(
+    ProbabilityDensityFunctionTable::Ptr table =
+        ProbabilityDensityFunctionTable::getInstance(
+            organizationModelAsk.getOrganizationModel());
+    Ptr pdf = table->getProbabilityDensityFunction(qualification);
+    if(!pdf)
+    {
+        throw std::invalid_argument(
+            "moreorg::metrics::ProbabilityDensityFunction::getInstance no "
+            "related probability density function instance was found for: " +
+            qualification.toString());
+    }
+    return pdf;
+}
+
+ProbabilityDensityFunction::Ptr
+ProbabilityDensityFunction::create(OWLOntologyAsk& ask,
+                                   const IRI& qualification)
+{
+    IRIList iriList = ask.allRelatedInstances(
         qualification,
         vocabulary::OM::has(),
         vocabulary::OMBase::ProbabilityDensityFunction());
     for(const IRI& iri : iriList)
     {
-        if(organizationModelAsk.ontology().isInstanceOf(
-               iri,
-               vocabulary::OMBase::ConstantPDF()))
+        if(ask.isInstanceOf(iri, vocabulary::OMBase::ConstantPDF()))
         {
             OWLAnnotationValue::Ptr annotationValue =
-                organizationModelAsk.ontology().getAnnotationValue(
-                    iriList.front(),
-                    vocabulary::OMBase::p());
+                ask.getAnnotationValue(iriList.front(),
+                                       vocabulary::OMBase::p());
             OWLLiteral::Ptr value = annotationValue->asLiteral();
             // LOG_DEBUG_S << "Retrieved probability of failure for '" <<
             // qualification << ": " << value->getDouble();
             return make_shared<pdfs::ConstantPDF>(value->getDouble());
-        } else if(organizationModelAsk.ontology().isInstanceOf(
-                      iri,
-                      vocabulary::OMBase::WeibullPDF()))
+        } else if(ask.isInstanceOf(iri, vocabulary::OMBase::WeibullPDF()))
         {
             OWLAnnotationValue::Ptr annotationValue_eta =
-                organizationModelAsk.ontology().getAnnotationValue(
-                    iriList.front(),
-                    vocabulary::OMBase::eta());
+                ask.getAnnotationValue(iriList.front(),
+                                       vocabulary::OMBase::eta());
             OWLAnnotationValue::Ptr annotationValue_beta =
-                organizationModelAsk.ontology().getAnnotationValue(
-                    iriList.front(),
-                    vocabulary::OMBase::beta());
+                ask.getAnnotationValue(iriList.front(),
+                                       vocabulary::OMBase::beta());
 
             OWLLiteral::Ptr value_eta = annotationValue_eta->asLiteral();
             OWLLiteral::Ptr value_beta = annotationValue_beta->asLiteral();
@@ -52,14 +76,11 @@ ProbabilityDensityFunction::Ptr ProbabilityDensityFunction::getInstance(
             // qualification << ": " << value->getDouble();
             return make_shared<pdfs::WeibullPDF>(value_eta->getDouble(),
                                                  value_beta->getDouble());
-        } else if(organizationModelAsk.ontology().isInstanceOf(
-                      iri,
-                      vocabulary::OMBase::ExponentialPDF()))
+        } else if(ask.isInstanceOf(iri, vocabulary::OMBase::ExponentialPDF()))
         {
             OWLAnnotationValue::Ptr annotationValue =
-                organizationModelAsk.ontology().getAnnotationValue(
-                    iriList.front(),
-                    vocabulary::OMBase::lambda());
+                ask.getAnnotationValue(iriList.front(),
+                                       vocabulary::OMBase::lambda());
             OWLLiteral::Ptr value = annotationValue->asLiteral();
             // LOG_DEBUG_S << "Retrieved probability of failure for '" <<
             // qualification << ": " << value->getDouble();
@@ -67,14 +88,14 @@ ProbabilityDensityFunction::Ptr ProbabilityDensityFunction::getInstance(
         } else
         {
             throw std::invalid_argument(
-                "moreorg::metrics::ProbabilityDensityFunction::getInstance no "
+                "moreorg::metrics::ProbabilityDensityFunction::create no "
                 "probability density function instance was found for: " +
                 iri.toString() + " and " + qualification.toString());
         }
     }
 
     throw std::invalid_argument(
-        "moreorg::metrics::ProbabilityDensityFunction::getInstance no related "
+        "moreorg::metrics::ProbabilityDensityFunction::create no related "
         "probability density function instance was found for: " +
         qualification.toString());
 }
@@ -5,6 +5,7 @@
 #include "../SharedPtr.hpp"
 #include <math.h>
 #include <stdexcept>
+#include <vector>
 
 namespace moreorg {
 namespace metrics {
@@ -21,8 +22,38 @@ public:
 
     virtual double getConditional(double t0 = 0, double t1 = 0) const = 0;
 
+    /**
+     * Compute the conditional value for a fixed start time and a series of
+     * end times, i.e., values[i] = getConditional(t0, t1[i])
+     * \details The default implementation calls getConditional for each end
+     * time, while the available pdfs provide closed-form kernels
+     * \param t0 Start time
+     * \param t1 End times
+     * \param values Resulting values, resized to the number of end times
+     */
+    virtual void getConditionals(double t0,
+                                 const std::vector<double>& t1,
+                                 std::vector<double>& values) const;
+
+    /**
+     * Get the pdf which is associated with a model
+     * \details The pdf is retrieved from the per ontology table, so that the
+     * ontology is queried only once per model
+     * \see ProbabilityDensityFunctionTable
+     * \throws std::invalid_argument if no pdf is associated with the model
+     */
     static Ptr getInstance(const OrganizationModelAsk& organizationModelAsk,
                            const owlapi::model::IRI& qualification);
+
+    /**
+     * Create the pdf which is associated with a model by querying the ontology
+     * \param ask Ontology to query -- the ontology needs to be locked by the
+     * caller if it is shared between threads
+     * \param qualification Model
+     * \throws std::invalid_argument if no pdf is associated with the model
+     */
+    static Ptr create(owlapi::model::OWLOntologyAsk& ask,
+                      const owlapi::model::IRI& qualification);
 };
 
 } // namespace metrics
@@ -0,0 +1,123 @@
+#include "ProbabilityDensityFunctionTable.hpp"
+#include <algorithm>
+#include <base-logging/Logging.hpp>
+#include <boost/thread/recursive_mutex.hpp>
+#include <stdexcept>
+
+using namespace owlapi::model;
+
+namespace moreorg {
+namespace metrics {
+
+boost::mutex ProbabilityDensityFunctionTable::msInstancesMutex;
+std::vector<ProbabilityDensityFunctionTable::Ptr>
+    ProbabilityDensityFunctionTable::msInstances;
+
+ProbabilityDensityFunctionTable::ProbabilityDensityFunctionTable(
+    const OrganizationModel::Ptr& organizationModel)
+    : mpOrganizationModel(organizationModel)
+    , mRevision(organizationModel ? organizationModel->getRevision() : 0)
+{
+}
+
+ProbabilityDensityFunctionTable::Ptr
+ProbabilityDensityFunctionTable::getInstance(
+    const OrganizationModel::Ptr& organizationModel)
+{
+    boost::unique_lock<boost::mutex> lock(msInstancesMutex);
+    // Drop the tables of organization models which no longer exist
+    msInstances.erase(std::remove_if(msInstances.begin(),
+                                     msInstances.end(),
+                                     [](const Ptr& table) {
+                                         return !table->getOrganizationModel();
+                                     }),
+                      msInstances.end());
+
+    for(const Ptr& table : msInstances)
+    {
+        if(table->getOrganizationModel() == organizationModel)
+        {
+            return table;
+        }
+    }
+
+    Ptr table = make_shared<ProbabilityDensityFunctionTable>(organizationModel);
+    msInstances.push_back(table);
+    return table;
+}
+
+ProbabilityDensityFunction::Ptr
+ProbabilityDensityFunctionTable::getProbabilityDensityFunction(
+    const IRI& qualification)
+{
+    OrganizationModel::Ptr organizationModel = getOrganizationModel();
+    if(!organizationModel)
+    {
+        throw std::runtime_error(
+            "moreorg::metrics::ProbabilityDensityFunctionTable::"
+            "getProbabilityDensityFunction: organization model has been "
+            "deleted");
+    }
+
+    ProbabilityDensityFunction::Ptr pdf;
+    {
+        boost::unique_lock<boost::mutex> lock(mMutex);
+        if(lookup(organizationModel, qualification, pdf))
+        {
+            return pdf;
+        }
+    }
+
+    // Lock order: ontology first, then the table
+    boost::unique_lock<boost::recursive_mutex> ontologyLock(
+        organizationModel->getOntologyMutex());
+    boost::unique_lock<boost::mutex> lock(mMutex);
+    if(lookup(organizationModel, qualification, pdf))
+    {
+        return pdf;
+    }
+
+    try
+    {
+        OWLOntologyAsk ask(organizationModel->ontology());
+        pdf = ProbabilityDensityFunction::create(ask, qualification);
+    } catch(const std::exception& e)
+    {
+        LOG_DEBUG_S << "moreorg::metrics::ProbabilityDensityFunctionTable: "
+                    << "no probability density function for "
+                    << qualification << " -- " << e.what();
+    }
+    mFunctions[qualification] = pdf;
+    return pdf;
+}
+
+size_t ProbabilityDensityFunctionTable::size() const
+{
+    boost::unique_lock<boost::mutex> lock(mMutex);
+    return mFunctions.size();
+}
+
+bool ProbabilityDensityFunctionTable::lookup(
+    const OrganizationModel::Ptr& organizationModel,
+    const IRI& qualification,
+    ProbabilityDensityFunction::Ptr& pdf)
+{
+    uint64_t revision = organizationModel->getRevision();
+    if(mRevision != revision)
+    {
+        mFunctions.clear();
+        mRevision = revision;
+    }
+
+    std::map<IRI, ProbabilityDensityFunction::Ptr>::const_iterator cit =
+        mFunctions.find(qualification);
+    if(cit == mFunctions.end())
+    {
+        return false;
+    }
+    pdf = cit->second;
+    return true;
+}
+
+} // end namespace metrics
+} // end namespace moreorg
@@ -0,0 +1,98 @@
+#ifndef ORGANIZATION_MODEL_METRICS_PROBABILITY_DENSITY_FUNCTION_TABLE_HPP
+#define ORGANIZATION_MODEL_METRICS_PROBABILITY_DENSITY_FUNCTION_TABLE_HPP
+
+#include <boost/thread/mutex.hpp>
+#include <map>
+#include <owlapi/model/IRI.hpp>
+#include <stdint.h>
+#include <vector>
+
+#include "../OrganizationModel.hpp"
+#include "../SharedPtr.hpp"
+#include "ProbabilityDensityFunction.hpp"
+
+namespace moreorg {
+namespace metrics {
+
+/**
+ * \class ProbabilityDensityFunctionTable
+ * \brief Per ontology table of the probability density functions associated
+ * with models
+ *
+ * \details
+ * The pdf of a model is retrieved from the ontology on first request, and all
+ * further requests -- from any metric -- are served from the table. Models
+ * without an associated pdf are recorded as well, so that users can fall back
+ * to a default pdf without querying the ontology again. The table is cleared
+ * when the revision of the organization model changes.
+ */
+class ProbabilityDensityFunctionTable
+{
+public:
+    typedef shared_ptr<ProbabilityDensityFunctionTable> Ptr;
+
+    /**
+     * Constructor of the table
+     * \param organizationModel Organization model
+     */
+    ProbabilityDensityFunctionTable(
+        const OrganizationModel::Ptr& organizationModel);
+
+    ProbabilityDensityFunctionTable(const ProbabilityDensityFunctionTable&) =
+        delete;
+    ProbabilityDensityFunctionTable&
+    operator=(const ProbabilityDensityFunctionTable&) = delete;
+
+    /**
+     * Get the table which is shared for the given organization model
+     */
+    static Ptr getInstance(const OrganizationModel::Ptr& organizationModel);
+
+    /**
+     * Get the pdf which is associated with a model
+     * \param qualification Model
+     * \return pdf, or an empty pointer if no (valid) pdf is associated with
+     * the model, i.e., a default pdf should be used
+     */
+    ProbabilityDensityFunction::Ptr
+    getProbabilityDensityFunction(const owlapi::model::IRI& qualification);
+
+    /**
+     * Get the number of models in the table
+     */
+    size_t size() const;
+
+    /**
+     * Get the organization model this table has been created for
+     */
+    OrganizationModel::Ptr getOrganizationModel() const
+    {
+        return mpOrganizationModel.lock();
+    }
+
+private:
+    /**
+     * Get a table entry, after clearing the table if the revision of the
+     * organization model changed
+     * Requires the table to be locked
+     * \return true if the model is part of the table
+     */
+    bool lookup(const OrganizationModel::Ptr& organizationModel,
+                const owlapi::model::IRI& qualification,
+                ProbabilityDensityFunction::Ptr& pdf);
+
+    weak_ptr<OrganizationModel> mpOrganizationModel;
+
+    /// Guards the access to all members below
+    mutable boost::mutex mMutex;
+    uint64_t mRevision;
+    /// Pdf by model, where an empty pointer marks a model without pdf
+    std::map<owlapi::model::IRI, ProbabilityDensityFunction::Ptr> mFunctions;
+
+    static boost::mutex msInstancesMutex;
+    static std::vector<Ptr> msInstances;
+};
+
+} // end namespace metrics
+} // end namespace moreorg
+#endif // ORGANIZATION_MODEL_METRICS_PROBABILITY_DENSITY_FUNCTION_TABLE_HPP
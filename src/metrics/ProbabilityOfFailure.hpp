@@ -69,6 +69,12 @@ public:
      */
     uint32_t getCardinality() const { return mRequirement.min; }
 
+    /**
+     * Get the redundancy of the model, i.e., how often the required
+     * resources are available
+     */
+    double getRedundancy() const { return mRedundancy; }
+
     /**
      * Increment the redundancy based on addition a single resource of the same
      * type
@@ -1,12 +1,14 @@
 #include "Redundancy.hpp"
 #include "../Agent.hpp"
 #include "../ResourceInstance.hpp"
+#include "../reasoning/DisjointResourceMatch.hpp"
 #include "../reasoning/ResourceInstanceMatch.hpp"
 #include "../reasoning/ResourceMatch.hpp"
 #include "../vocabularies/OM.hpp"
 #include "../vocabularies/OMBase.hpp"
 #include "ModelSurvivability.hpp"
 #include <base-logging/Logging.hpp>
+#include <algorithm>
 #include <math.h>
 #include <vector>
 
@@ -16,13 +18,47 @@ using namespace owlapi::vocabulary;
 namespace moreorg {
 namespace metrics {
 
+namespace {
+
+/**
+ * Conditional probability of survival of a model with redundancy
+ * \see ProbabilityOfFailure::getProbabilityOfSurvivalConditionalWithRedundancy
+ */
+double probabilityOfSurvival(double conditional,
+                             uint32_t cardinality,
+                             double redundancy)
+{
+    double pSerialSystem = pow(1 - conditional, cardinality);
+    return 1 - pow(1 - pSerialSystem, redundancy);
+}
+
+} // end anonymous namespace
+
 Redundancy::Redundancy(const OrganizationModelAsk& organization,
                        const ProbabilityDensityFunction::Ptr& defaultPDF,
                        const owlapi::model::IRI& objectProperty)
 
     : Metric(REDUNDANCY, organization, objectProperty)
     , mDefaultProbabilityDensityFunction(defaultPDF)
+    , mpProbabilityDensityFunctionTable(
+          ProbabilityDensityFunctionTable::getInstance(
+              organization.getOrganizationModel()))
+{
+}
+
+ProbabilityDensityFunction::Ptr
+Redundancy::getProbabilityDensityFunction(const IRI& model) const
 {
+    // Model should have an associated probability of failure if not
+    // failure of parent component which be used (see punning strategy
+    // in owlapi)
+    ProbabilityDensityFunction::Ptr pdf =
+        mpProbabilityDensityFunctionTable->getProbabilityDensityFunction(model);
+    if(!pdf)
+    {
+        return mDefaultProbabilityDensityFunction;
+    }
+    return pdf;
 }
 
 double
@@ -71,6 +107,19 @@ double Redundancy::computeMetric(
     const ResourceInstance::List& availableAgents,
     double t0,
     double t1) const
+{
+    return computeSurvivalCurve(required,
+                                availableAgents,
+                                t0,
+                                std::vector<double>(1, t1))
+        .front();
+}
+
+std::vector<double> Redundancy::computeSurvivalCurve(
+    const std::vector<OWLCardinalityRestriction::Ptr>& required,
+    const ResourceInstance::List& availableAgents,
+    double t0,
+    const std::vector<double>& t1) const
 {
     if(required.empty())
     {
@@ -116,38 +165,15 @@ double Redundancy::computeMetric(
                 << std::endl
                 << "Required: " << ModelBound::toString(modelBoundRequired);
 
-    ResourceInstanceMatch::Solution solution;
-    uint32_t fullModelRedundancy = 0;
-    std::map<ModelBound, ResourceInstance::List> assignments;
-    try
-    {
-        // Check how often a full redundancy of the top level model is given
-        while(true)
-        {
-            solution = ResourceInstanceMatch::solve(modelBoundRequired,
-                                                    available,
-                                                    mOrganizationModelAsk);
-            ++fullModelRedundancy;
-            for(ModelBound model : modelBoundRequired)
-            {
-                ResourceInstance::List currentAssignments =
-                    solution.getAssignments(model.model);
-                assignments[model].insert(std::end(assignments[model]),
-                                          std::begin(currentAssignments),
-                                          std::end(currentAssignments));
-            }
-            // Remove the consumed models from the list of available and try to
-            // repeat solving
-            // throws invalid_argument when model bounds are exceeded
-            available = solution.removeAssignmentsFromList(available);
-            LOG_DEBUG_S << "Solution: " << solution.toString() << std::endl
-                        << "Remaining: "
-                        << ResourceInstance::toString(available);
-        }
-    } catch(const std::exception& e)
-    {
-        LOG_DEBUG_S << "ResourceMatch failed: " << e.what();
-    }
+    // Check how often a full redundancy of the top level model is given
+    DisjointResourceMatch::Result match =
+        DisjointResourceMatch::solve(modelBoundRequired,
+                                     available,
+                                     mOrganizationModelAsk);
+    uint32_t fullModelRedundancy = match.numberOfAssignments;
+    std::map<ModelBound, ResourceInstance::List>& assignments =
+        match.assignments;
+    available = match.remaining;
 
     LOG_INFO_S << "Full model redundancy count is at: " << fullModelRedundancy
                << std::endl
@@ -175,102 +201,98 @@ double Redundancy::computeMetric(
         // Mean probability of failure
         // Probability of component failure
         // default is p=0.5
-        ProbabilityDensityFunction::Ptr probabilityDensityFunction;
-        try
-        {
-            // Model should have an associated probability of failure if not
-            // failure of parent component which be used (see punning strategy
-            // // in owlapi)
-            probabilityDensityFunction =
-                ProbabilityDensityFunction::getInstance(mOrganizationModelAsk,
-                                                        required.model);
-        } catch(const std::exception& e)
-        {
-            probabilityDensityFunction = mDefaultProbabilityDensityFunction;
-        }
+        ProbabilityDensityFunction::Ptr probabilityDensityFunction =
+            getProbabilityDensityFunction(required.model);
 
         // TODO replace logic above to read distribution function + parameters
         // from OM -> then init Distribution function and create PoF object
         ProbabilityOfFailure survivability(required,
                                            assignments[required],
                                            probabilityDensityFunction);
+        LOG_INFO_S << "Probability of survival: " << survivability.toString();
         models.push_back(survivability);
     }
 
+    // Evaluate the pdf of each model for all end times at once
+    std::vector<std::vector<double>> conditionals(models.size());
+    for(size_t m = 0; m < models.size(); ++m)
+    {
+        models[m].getProbabilityDensityFunction()->getConditionals(
+            t0,
+            t1,
+            conditionals[m]);
+    }
+
+    // Models which can be strengthened by each of the remaining resources
+    std::vector<std::vector<bool>> qualifiedModels;
+    for(const ResourceInstance& remaining : available)
+    {
+        std::vector<bool> qualified(models.size(), false);
+        bool hasPossibleMatch = false;
+        for(size_t m = 0; m < models.size(); ++m)
+        {
+            qualified[m] =
+                models[m].getQualification() == remaining.getModel() ||
+                mOrganizationModelAsk.ontology().isSubClassOf(
+                    remaining.getModel(),
+                    models[m].getQualification());
+            hasPossibleMatch = hasPossibleMatch || qualified[m];
+        }
+        if(hasPossibleMatch)
+        {
+            qualifiedModels.push_back(qualified);
+        }
+    }
+
     // Best model fit: redundancy
-    bool updated = false;
-    do
+    // Each remaining resource strengthens the model with the lowest
+    // probability of survival among the models it qualifies for, so that the
+    // assignment depends on the end time
+    std::vector<double> survival(t1.size(), 1.);
+    std::vector<size_t> order(models.size());
+    std::vector<double> probabilities(models.size());
+    std::vector<double> redundancies(models.size());
+    for(size_t t = 0; t < t1.size(); ++t)
     {
-        updated = false;
-        // Sort based on probability of survival -- try to maximize redundancy
-        std::sort(
-            models.begin(),
-            models.end(),
-            [&t0, &t1](const ProbabilityOfFailure& a,
-                       const ProbabilityOfFailure& b) {
-                return a.getProbabilityOfSurvivalConditionalWithRedundancy(t0,
-                                                                           t1) <
-                       b.getProbabilityOfSurvivalConditionalWithRedundancy(t0,
-                                                                           t1);
-            });
-
-        ResourceInstance::List::iterator rit = available.begin();
-        for(; rit != available.end(); ++rit)
+        for(size_t m = 0; m < models.size(); ++m)
         {
-            ResourceInstance& remaining = *rit;
-            bool hasPossibleMatch = false;
+            redundancies[m] = models[m].getRedundancy();
+            probabilities[m] =
+                probabilityOfSurvival(conditionals[m][t],
+                                      models[m].getCardinality(),
+                                      redundancies[m]);
+            order[m] = m;
+        }
+        std::sort(order.begin(),
+                  order.end(),
+                  [&probabilities](size_t a, size_t b) {
+                      return probabilities[a] < probabilities[b];
+                  });
 
-            // Try to fit remaining resources
-            for(ProbabilityOfFailure& survivability : models)
+        for(const std::vector<bool>& qualified : qualifiedModels)
+        {
+            for(size_t m : order)
             {
-                // Check if model can be used to strengthen the survivability
-                if(survivability.getQualification() == remaining.getModel() ||
-                   mOrganizationModelAsk.ontology().isSubClassOf(
-                       remaining.getModel(),
-                       survivability.getQualification()))
+                if(qualified[m])
                 {
-                    hasPossibleMatch = true;
-                    try
-                    {
-                        survivability.addAssignment(remaining);
-                        available.erase(rit);
-                        --rit;
-                        updated = true;
-                        break;
-                    } catch(...)
-                    {
-                        available.erase(rit);
-                        --rit;
-                        break;
-                    }
+                    redundancies[m] += 1.0 / (1.0 * models[m].getCardinality());
+                    break;
                 }
             }
-            if(!hasPossibleMatch)
-            {
-                available.erase(rit);
-                --rit;
-            }
         }
-    } while(updated);
 
-    // Serial model of all subcomponents --> the full system
-    double fullModelSurvival = 1;
-    for(const ProbabilityOfFailure& survivability : models)
-    {
-        LOG_INFO_S << "Probability of survival: " << survivability.toString();
-        LOG_DEBUG_S
-            << "time 0: " << t0 << " time 1: " << t1 << " Survivability: "
-            << survivability.getProbabilityOfSurvivalConditionalWithRedundancy(
-                   t0,
-                   t1)
-            << " , " << survivability.getRequirement().toString();
-
-        fullModelSurvival *=
-            survivability.getProbabilityOfSurvivalConditionalWithRedundancy(t0,
-                                                                            t1);
+        // Serial model of all subcomponents --> the full system
+        for(size_t m : order)
+        {
+            survival[t] *= probabilityOfSurvival(conditionals[m][t],
+                                                 models[m].getCardinality(),
+                                                 redundancies[m]);
+        }
+        LOG_DEBUG_S << "time 0: " << t0 << " time 1: " << t1[t]
+                    << " Survivability: " << survival[t];
     }
 
-    return fullModelSurvival;
+    return survival;
 }
 
 // ProbabilityOfFailure::List getSharedUseMetricModelsList(const
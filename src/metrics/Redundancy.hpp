@@ -3,6 +3,7 @@
 
 #include "../vocabularies/OM.hpp"
 #include "ProbabilityDensityFunction.hpp"
+#include "ProbabilityDensityFunctionTable.hpp"
 #include "ProbabilityOfFailure.hpp"
 #include "pdfs/WeibullPDF.hpp"
 #include <map>
@@ -47,6 +48,26 @@ public:
         double t0 = 0,
         double t1 = 0) const;
 
+    /**
+     * Compute the redundancy (probability of survival) for a series of end
+     * times
+     * \details The assignment of resources and the probability density
+     * functions are computed only once, and the pdfs are evaluated for all end
+     * times at once. The value for each end time equals the result of
+     * computeMetric(required, availableAgents, t0, t1)
+     * \param required Required resources
+     * \param availableAgents Available resources
+     * \param t0 Start time
+     * \param t1 End times, each at or after t0
+     * \return probability of survival for each end time
+     */
+    std::vector<double> computeSurvivalCurve(
+        const std::vector<owlapi::model::OWLCardinalityRestriction::Ptr>&
+            required,
+        const ResourceInstance::List& availableAgents,
+        double t0,
+        const std::vector<double>& t1) const;
+
     double computeSequential(const owlapi::model::IRIList& functions,
                              const ResourceInstance::List& modelPool) const;
     double computeSequential(
@@ -100,7 +121,15 @@ public:
     }
 
 private:
+    /**
+     * Get the pdf of a model, or the default pdf if the model has none
+     */
+    ProbabilityDensityFunction::Ptr
+    getProbabilityDensityFunction(const owlapi::model::IRI& model) const;
+
     ProbabilityDensityFunction::Ptr mDefaultProbabilityDensityFunction;
+    /// Pdfs of the models, shared by all metrics of the same ontology
+    ProbabilityDensityFunctionTable::Ptr mpProbabilityDensityFunctionTable;
 };
 
 } // end namespace metrics
@@ -27,6 +27,22 @@ double ConstantPDF::getConditional(double t0, double t1) const
     return 0;
 }
 
+void ConstantPDF::getConditionals(double t0,
+                                  const std::vector<double>& t1,
+                                  std::vector<double>& values) const
+{
+    size_t size = t1.size();
+    values.resize(size);
+    const double* times = t1.data();
+    double* out = values.data();
+
+    double probabilityOfFailure = t0 >= 0 ? mProbabilityOfFailure : 0;
+    for(size_t i = 0; i < size; ++i)
+    {
+        out[i] = times[i] >= t0 ? probabilityOfFailure : 0.;
+    }
+}
+
 } // end namespace pdfs
 } // end namespace metrics
 } // end namespace moreorg
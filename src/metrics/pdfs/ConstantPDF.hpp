@@ -18,6 +18,10 @@ public:
     double getValue(double t = 0) const override;
 
     double getConditional(double t0 = 0, double t1 = 0) const override;
+
+    void getConditionals(double t0,
+                         const std::vector<double>& t1,
+                         std::vector<double>& values) const override;
 };
 
 } // end namespace pdfs
@@ -32,6 +32,27 @@ double ExponentialPDF::getConditional(double t0, double t1) const
     return 0;
 }
 
+void ExponentialPDF::getConditionals(double t0,
+                                     const std::vector<double>& t1,
+                                     std::vector<double>& values) const
+{
+    size_t size = t1.size();
+    values.assign(size, 0.);
+    if(t0 < 0)
+    {
+        return;
+    }
+
+    const double* times = t1.data();
+    double* out = values.data();
+    double survivalT0 = 1 - getValue(t0);
+    for(size_t i = 0; i < size; ++i)
+    {
+        double value = 1 - exp((-1. * mFailureRate * times[i]));
+        out[i] = times[i] >= t0 ? (1 - value) / survivalT0 : 0.;
+    }
+}
+
 } // end namespace pdfs
 } // end namespace metrics
 } // end namespace moreorg
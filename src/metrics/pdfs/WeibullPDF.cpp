@@ -1,4 +1,5 @@
 #include "WeibullPDF.hpp"
+#include <algorithm>
 
 namespace moreorg {
 namespace metrics {
@@ -47,6 +48,30 @@ double WeibullPDF::getConditional(double t0, double t1) const
     throw std::invalid_argument("t0 and t1 must be >= 0 and t1 >= t0");
 }
 
+void WeibullPDF::getConditionals(double t0,
+                                 const std::vector<double>& t1,
+                                 std::vector<double>& values) const
+{
+    size_t size = t1.size();
+    const double* times = t1.data();
+    if(t0 < 0 || std::find_if(times, times + size, [t0](double t) {
+                     return t < t0;
+                 }) != times + size)
+    {
+        throw std::invalid_argument("t0 and t1 must be >= 0 and t1 >= t0");
+    }
+
+    values.resize(size);
+    double* out = values.data();
+    double valueT0 = getValue(t0);
+    for(size_t i = 0; i < size; ++i)
+    {
+        double value = 1 - exp(-1 * pow(((times[i] - t0_) / mEta), b_));
+        // use non-conditional probability of failure if t1 == t0
+        out[i] = times[i] > t0 ? 1 - ((1 - value) / (1 - valueT0)) : valueT0;
+    }
+}
+
 } // end namespace pdfs
 } // end namespace metrics
 } // end namespace moreorg
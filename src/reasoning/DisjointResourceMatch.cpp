@@ -0,0 +1,251 @@
+#include "DisjointResourceMatch.hpp"
+
+#include <algorithm>
+#include <base-logging/Logging.hpp>
+#include <deque>
+
+using namespace owlapi::model;
+
+namespace moreorg {
+namespace reasoning {
+
+DisjointResourceMatch::Result::Result()
+    : numberOfAssignments(0)
+{
+}
+
+DisjointResourceMatch::DisjointResourceMatch(const ModelBound::List& required,
+                                             const OrganizationModelAsk& ask)
+    : mRequired(required)
+    , mAsk(ask)
+    , mNumberOfColumns(0)
+{
+}
+
+DisjointResourceMatch::Result
+DisjointResourceMatch::solve(const ModelBound::List& required,
+                             const ResourceInstance::List& available,
+                             const OrganizationModelAsk& ask)
+{
+    DisjointResourceMatch matcher(required, ask);
+
+    Result result;
+    result.remaining = available;
+    while(true)
+    {
+        ResourceInstanceMatch::Solution solution;
+        if(!matcher.match(result.remaining, solution))
+        {
+            break;
+        }
+        ++result.numberOfAssignments;
+
+        // A requirement without any assignment terminates the search, as
+        // with repeated calls of ResourceInstanceMatch::solve
+        bool complete = true;
+        for(size_t row = 0; row < required.size(); ++row)
+        {
+            size_t first = row * matcher.mNumberOfColumns;
+            std::vector<bool>::const_iterator begin =
+                matcher.mAssigned.begin() + first;
+            if(std::find(begin, begin + matcher.mNumberOfColumns, true) ==
+               begin + matcher.mNumberOfColumns)
+            {
+                complete = false;
+                break;
+            }
+
+            const ModelBound& model = required[row];
+            ResourceInstance::List assignments =
+                solution.getAssignments(model.model);
+            result.assignments[model].insert(
+                result.assignments[model].end(),
+                assignments.begin(),
+                assignments.end());
+        }
+        if(!complete)
+        {
+            break;
+        }
+
+        result.remaining = solution.removeAssignmentsFromList(result.remaining);
+        LOG_DEBUG_S << "Solution: " << solution.toString() << std::endl
+                    << "Remaining: "
+                    << ResourceInstance::toString(result.remaining);
+    }
+    return result;
+}
+
+bool DisjointResourceMatch::isCompatible(const IRI& availableModel,
+                                         const IRI& requiredModel)
+{
+    if(availableModel == requiredModel)
+    {
+        return true;
+    }
+
+    std::pair<IRI, IRI> key(availableModel, requiredModel);
+    std::map<std::pair<IRI, IRI>, bool>::const_iterator cit =
+        mCompatibility.find(key);
+    if(cit != mCompatibility.end())
+    {
+        return cit->second;
+    }
+
+    bool compatible =
+        mAsk.ontology().isSubClassOf(availableModel, requiredModel);
+    mCompatibility[key] = compatible;
+    return compatible;
+}
+
+bool DisjointResourceMatch::match(const ResourceInstance::List& available,
+                                  ResourceInstanceMatch::Solution& solution)
+{
+    size_t numberOfRows = mRequired.size();
+    mNumberOfColumns = available.size();
+    size_t numberOfCells = numberOfRows * mNumberOfColumns;
+
+    mAllowed.assign(numberOfCells, false);
+    mAssigned.assign(numberOfCells, false);
+    mCellStates.assign(numberOfCells, FREE);
+    for(size_t row = 0; row < numberOfRows; ++row)
+    {
+        const ModelBound& requirement = mRequired[row];
+        if(requirement.max == 0)
+        {
+            continue;
+        }
+        for(size_t column = 0; column < mNumberOfColumns; ++column)
+        {
+            mAllowed[row * mNumberOfColumns + column] = isCompatible(
+                available[column].getModel(), requirement.model);
+        }
+    }
+
+    std::map<ResourceInstance, size_t> groups;
+    mGroups.resize(mNumberOfColumns);
+    for(size_t column = 0; column < mNumberOfColumns; ++column)
+    {
+        mGroups[column] =
+            groups.insert(std::make_pair(available[column], groups.size()))
+                .first->second;
+    }
+    mGroupUsers.assign(groups.size(), -1);
+
+    // Initial full assignment
+    for(size_t row = 0; row < numberOfRows; ++row)
+    {
+        for(uint32_t i = 0; i < mRequired[row].min; ++i)
+        {
+            if(!augment(row))
+            {
+                return false;
+            }
+        }
+    }
+
+    // Fix the cells in order, where a cell is only kept if the assignment
+    // cannot be completed without it
+    for(size_t row = 0; row < numberOfRows; ++row)
+    {
+        for(size_t column = 0; column < mNumberOfColumns; ++column)
+        {
+            size_t cell = row * mNumberOfColumns + column;
+            mCellStates[cell] = FIXED_ZERO;
+            if(!mAssigned[cell])
+            {
+                continue;
+            }
+
+            size_t group = mGroups[column];
+            mAssigned[cell] = false;
+            mGroupUsers[group] = -1;
+            if(!augment(row))
+            {
+                mAssigned[cell] = true;
+                mGroupUsers[group] = cell;
+                mCellStates[cell] = FIXED_ONE;
+            }
+        }
+    }
+
+    for(size_t column = 0; column < mNumberOfColumns; ++column)
+    {
+        for(size_t row = 0; row < numberOfRows; ++row)
+        {
+            if(mAssigned[row * mNumberOfColumns + column])
+            {
+                solution.addAssignment(mRequired[row], available[column]);
+            }
+        }
+    }
+    return true;
+}
+
+bool DisjointResourceMatch::augment(size_t startRow)
+{
+    struct Step
+    {
+        /// Row from which this row has been reached
+        size_t row;
+        /// Cell the previous row takes over
+        size_t cell;
+        /// Cell this row gives up
+        size_t lostCell;
+    };
+
+    size_t numberOfRows = mRequired.size();
+    std::vector<bool> visited(numberOfRows, false);
+    std::vector<Step> steps(numberOfRows);
+    std::deque<size_t> queue;
+    visited[startRow] = true;
+    queue.push_back(startRow);
+
+    while(!queue.empty())
+    {
+        size_t row = queue.front();
+        queue.pop_front();
+
+        for(size_t column = 0; column < mNumberOfColumns; ++column)
+        {
+            size_t cell = row * mNumberOfColumns + column;
+            if(!mAllowed[cell] || mAssigned[cell] ||
+               mCellStates[cell] == FIXED_ZERO)
+            {
+                continue;
+            }
+
+            size_t group = mGroups[column];
+            int user = mGroupUsers[group];
+            if(user < 0)
+            {
+                // Free instance found: apply the path
+                mAssigned[cell] = true;
+                mGroupUsers[group] = cell;
+                while(row != startRow)
+                {
+                    const Step& step = steps[row];
+                    mAssigned[step.lostCell] = false;
+                    mAssigned[step.cell] = true;
+                    mGroupUsers[mGroups[step.cell % mNumberOfColumns]] =
+                        step.cell;
+                    row = step.row;
+                }
+                return true;
+            }
+
+            size_t userRow = user / mNumberOfColumns;
+            if(visited[userRow] || mCellStates[user] == FIXED_ONE)
+            {
+                continue;
+            }
+            visited[userRow] = true;
+            steps[userRow] = Step{row, cell, static_cast<size_t>(user)};
+            queue.push_back(userRow);
+        }
+    }
+    return false;
+}
+
+} // end namespace reasoning
+} // end namespace moreorg
@@ -0,0 +1,114 @@
+#ifndef ORGANIZATION_MODEL_REASONING_DISJOINT_RESOURCE_MATCH_HPP
+#define ORGANIZATION_MODEL_REASONING_DISJOINT_RESOURCE_MATCH_HPP
+
+#include <map>
+#include <owlapi/model/IRI.hpp>
+#include <vector>
+
+#include "../OrganizationModelAsk.hpp"
+#include "../ResourceInstance.hpp"
+#include "ModelBound.hpp"
+#include "ResourceInstanceMatch.hpp"
+
+namespace moreorg {
+namespace reasoning {
+
+/**
+ * \class DisjointResourceMatch
+ * \brief Compute how often a set of model requirements can be fully assigned
+ * with disjoint subsets of the available resource instances
+ *
+ * \details
+ * The assignment of a single round is a bipartite b-matching between the
+ * requirements and the resource instances, where an instance can be assigned
+ * to a requirement if its model is the required model or a subclass of it.
+ * Each round yields the same assignment as ResourceInstanceMatch::solve, i.e.
+ * the lexicographically smallest assignment in the order of requirements and
+ * instances. It is computed from an initial matching by augmenting paths,
+ * so that all rounds are performed in a single solve without a constraint
+ * search, and compatibility is checked only once per pair of models.
+ *
+ \verbatim
+ ModelBound::List required = ResourceInstanceMatch::toModelBoundList(r);
+ DisjointResourceMatch::Result result =
+     DisjointResourceMatch::solve(required, ask.getRelated(agent), ask);
+ std::cout << result.numberOfAssignments << std::endl;
+ \endverbatim
+ */
+class DisjointResourceMatch
+{
+public:
+    struct Result
+    {
+        Result();
+
+        /// Number of disjoint full assignments
+        uint32_t numberOfAssignments;
+        /// Resource instances assigned to each requirement over all full
+        /// assignments
+        std::map<ModelBound, ResourceInstance::List> assignments;
+        /// Resource instances which are not part of a full assignment
+        ResourceInstance::List remaining;
+    };
+
+    /**
+     * Repeatedly assign the available resource instances to the requirements
+     * until no further full assignment can be found
+     * \param required Required models
+     * \param available Available resource instances
+     * \param ask Organization model ask to check model compatibility
+     * \return result with the number of disjoint full assignments
+     */
+    static Result solve(const ModelBound::List& required,
+                        const ResourceInstance::List& available,
+                        const OrganizationModelAsk& ask);
+
+private:
+    DisjointResourceMatch(const ModelBound::List& required,
+                          const OrganizationModelAsk& ask);
+
+    /// State of a cell of the assignment matrix
+    enum CellState { FREE, FIXED_ZERO, FIXED_ONE };
+
+    /**
+     * Check if an available model can be assigned to a required model
+     */
+    bool isCompatible(const owlapi::model::IRI& availableModel,
+                      const owlapi::model::IRI& requiredModel);
+
+    /**
+     * Compute the lexicographically smallest full assignment
+     * \return true if a full assignment exists, false otherwise
+     */
+    bool match(const ResourceInstance::List& available,
+               ResourceInstanceMatch::Solution& solution);
+
+    /**
+     * Try to assign one more resource instance to the requirement of the
+     * given row, by rerouting the assignments of unfixed cells
+     * \return true if an augmenting path has been found
+     */
+    bool augment(size_t row);
+
+    ModelBound::List mRequired;
+    OrganizationModelAsk mAsk;
+    std::map<std::pair<owlapi::model::IRI, owlapi::model::IRI>, bool>
+        mCompatibility;
+
+    // State of the current round
+    size_t mNumberOfColumns;
+    /// Cells are stored row by row, i.e., cell(row, column) =
+    /// row*mNumberOfColumns + column
+    std::vector<bool> mAllowed;
+    std::vector<bool> mAssigned;
+    std::vector<CellState> mCellStates;
+    /// Instances which compare equal can only be assigned once, so they share
+    /// a group
+    std::vector<size_t> mGroups;
+    /// Cell which uses a group, or -1 if the group is unused
+    std::vector<int> mGroupUsers;
+};
+
+} // end namespace reasoning
+} // end namespace moreorg
+#endif // ORGANIZATION_MODEL_REASONING_DISJOINT_RESOURCE_MATCH_HPP
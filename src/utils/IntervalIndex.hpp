@@ -0,0 +1,175 @@
+#ifndef ORGANIZATION_MODEL_UTILS_INTERVAL_INDEX_HPP
+#define ORGANIZATION_MODEL_UTILS_INTERVAL_INDEX_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+namespace moreorg {
+namespace utils {
+
+/**
+ * \class IntervalIndex
+ * \brief Static index of closed intervals [from, to] for stabbing queries
+ *
+ * \details
+ * Intervals are kept in an array sorted by their start, which is interpreted
+ * as an implicit balanced search tree: the middle element of a range is the
+ * root of the range, and each node stores the maximum end of its subtree.
+ * Hence, a query visits O(log n + k) nodes for k results, while memory is
+ * proportional to the number of intervals.
+ */
+template <typename T> class IntervalIndex
+{
+public:
+    typedef std::vector<T> List;
+
+    IntervalIndex()
+        : mBuilt(true)
+    {
+    }
+
+    /**
+     * Add an interval -- the index needs to be rebuilt before the next query
+     * \param from Start of the interval
+     * \param to End of the interval (inclusive)
+     * \param value Value associated with the interval
+     */
+    void add(size_t from, size_t to, const T& value)
+    {
+        if(to < from)
+        {
+            throw std::invalid_argument("moreorg::utils::IntervalIndex::add: "
+                                        "interval end lies before its start");
+        }
+        mIntervals.push_back(Interval{from, to, mIntervals.size(), value});
+        mBuilt = false;
+    }
+
+    /**
+     * Build the index after adding the intervals
+     */
+    void build()
+    {
+        std::sort(mIntervals.begin(),
+                  mIntervals.end(),
+                  [](const Interval& a, const Interval& b) {
+                      return a.from < b.from ||
+                             (a.from == b.from && a.position < b.position);
+                  });
+        mMaxTo.resize(mIntervals.size());
+        updateMaxTo(0, mIntervals.size());
+        mBuilt = true;
+    }
+
+    /**
+     * Get the values of all intervals which contain the given time
+     * \return values in the order the intervals have been added
+     */
+    List at(size_t time) const
+    {
+        if(!mBuilt)
+        {
+            throw std::runtime_error("moreorg::utils::IntervalIndex::at: "
+                                     "index has not been built");
+        }
+
+        std::vector<const Interval*> intervals;
+        collect(0, mIntervals.size(), time, intervals);
+        std::sort(intervals.begin(),
+                  intervals.end(),
+                  [](const Interval* a, const Interval* b) {
+                      return a->position < b->position;
+                  });
+
+        List values;
+        values.reserve(intervals.size());
+        for(const Interval* interval : intervals)
+        {
+            values.push_back(interval->value);
+        }
+        return values;
+    }
+
+    /**
+     * Get the number of intervals
+     */
+    size_t size() const { return mIntervals.size(); }
+
+    /**
+     * Remove all intervals
+     */
+    void clear()
+    {
+        mIntervals.clear();
+        mMaxTo.clear();
+        mBuilt = true;
+    }
+
+private:
+    struct Interval
+    {
+        size_t from;
+        size_t to;
+        /// Position in order of insertion
+        size_t position;
+        T value;
+    };
+
+    /**
+     * Compute the maximum end of the subtree rooted in the middle of [lo,hi)
+     * \return maximum end
+     */
+    size_t updateMaxTo(size_t lo, size_t hi)
+    {
+        if(lo >= hi)
+        {
+            return 0;
+        }
+        size_t mid = lo + (hi - lo) / 2;
+        mMaxTo[mid] = std::max(mIntervals[mid].to,
+                               std::max(updateMaxTo(lo, mid),
+                                        updateMaxTo(mid + 1, hi)));
+        return mMaxTo[mid];
+    }
+
+    void collect(size_t lo,
+                 size_t hi,
+                 size_t time,
+                 std::vector<const Interval*>& intervals) const
+    {
+        if(lo >= hi)
+        {
+            return;
+        }
+        size_t mid = lo + (hi - lo) / 2;
+        if(mMaxTo[mid] < time)
+        {
+            // no interval of this subtree reaches time
+            return;
+        }
+        collect(lo, mid, time, intervals);
+
+        const Interval& interval = mIntervals[mid];
+        if(interval.from > time)
+        {
+            // all intervals in the right subtree start after time
+            return;
+        }
+        if(interval.to >= time)
+        {
+            intervals.push_back(&interval);
+        }
+        collect(mid + 1, hi, time, intervals);
+    }
+
+    std::vector<Interval> mIntervals;
+    /// Maximum end of the subtree, which is rooted at the same position
+    std::vector<size_t> mMaxTo;
+    bool mBuilt;
+};
+
+} // end namespace utils
+} // end namespace moreorg
+#endif // ORGANIZATION_MODEL_UTILS_INTERVAL_INDEX_HPP
@@ -0,0 +1,157 @@
+#include <base/Time.hpp>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <unordered_set>
+
+#include "../Algebra.hpp"
+#include "../CompactModelPool.hpp"
+#include "../ModelPool.hpp"
+#include "../ModelRegistry.hpp"
+
+using namespace moreorg;
+
+// Compare the IRI keyed ModelPool with the id based CompactModelPool for the
+// operations which dominate the combination loops:
+// hashing, subset checks and bounding
+//
+// Usage: moreorg-bm-modelpool [number of models] [number of pools] [epochs]
+
+namespace {
+
+template <typename F> double measure(size_t epochs, F f)
+{
+    base::Time start = base::Time::now();
+    for(size_t e = 0; e < epochs; ++e)
+    {
+        f();
+    }
+    return (base::Time::now() - start).toSeconds();
+}
+
+void report(const std::string& operation, double mapBased, double idBased)
+{
+    std::cout << operation << ": ModelPool " << mapBased
+              << " s, CompactModelPool " << idBased << " s, speedup "
+              << (idBased > 0 ? mapBased / idBased : 0) << std::endl;
+}
+
+} // end anonymous namespace
+
+int main(int argc, char** argv)
+{
+    size_t numberOfModels = argc > 1 ? atoi(argv[1]) : 10;
+    size_t numberOfPools = argc > 2 ? atoi(argv[2]) : 1000;
+    size_t epochs = argc > 3 ? atoi(argv[3]) : 10;
+
+    std::cout << "# models: " << numberOfModels
+              << ", # pools: " << numberOfPools << ", # epochs: " << epochs
+              << std::endl;
+
+    std::mt19937 rng(0);
+    std::uniform_int_distribution<size_t> cardinality(0, 5);
+
+    ModelRegistry registry;
+    ModelPool::List pools;
+    CompactModelPool::List compactPools;
+    for(size_t p = 0; p < numberOfPools; ++p)
+    {
+        ModelPool pool;
+        for(size_t m = 0; m < numberOfModels; ++m)
+        {
+            size_t count = cardinality(rng);
+            if(count > 0)
+            {
+                pool["http://www.rock-robotics.org/2014/01/om-schema#Model" +
+                     std::to_string(m)] = count;
+            }
+        }
+        pools.push_back(pool);
+        compactPools.push_back(CompactModelPool(pool, registry));
+    }
+
+    ModelPool bound;
+    for(size_t m = 0; m < numberOfModels; ++m)
+    {
+        bound["http://www.rock-robotics.org/2014/01/om-schema#Model" +
+              std::to_string(m)] = 3;
+    }
+    CompactModelPool compactBound(bound, registry);
+
+    size_t checksum = 0;
+
+    double mapHash = measure(epochs, [&]() {
+        for(const ModelPool& pool : pools)
+        {
+            checksum += std::hash<ModelPool>()(pool);
+        }
+    });
+    double idHash = measure(epochs, [&]() {
+        for(const CompactModelPool& pool : compactPools)
+        {
+            checksum += std::hash<CompactModelPool>()(pool);
+        }
+    });
+    report("hash", mapHash, idHash);
+
+    double mapSubset = measure(epochs, [&]() {
+        for(size_t i = 1; i < pools.size(); ++i)
+        {
+            checksum += Algebra::isSubset(pools[i - 1], pools[i]);
+        }
+    });
+    double idSubset = measure(epochs, [&]() {
+        for(size_t i = 1; i < compactPools.size(); ++i)
+        {
+            checksum += CompactModelPool::isSubset(compactPools[i - 1],
+                                                   compactPools[i]);
+        }
+    });
+    report("isSubset", mapSubset, idSubset);
+
+    double mapBound = measure(epochs, [&]() {
+        for(const ModelPool& pool : pools)
+        {
+            checksum += pool.isWithinUpperBound(bound);
+            checksum += pool.applyUpperBound(bound).size();
+        }
+    });
+    double idBound = measure(epochs, [&]() {
+        for(const CompactModelPool& pool : compactPools)
+        {
+            checksum += pool.isWithinUpperBound(compactBound);
+            checksum += pool.applyUpperBound(compactBound).size();
+        }
+    });
+    report("upper bound", mapBound, idBound);
+
+    double mapMax = measure(epochs, [&]() {
+        for(size_t i = 1; i < pools.size(); ++i)
+        {
+            checksum += Algebra::max(pools[i - 1], pools[i]).size();
+        }
+    });
+    double idMax = measure(epochs, [&]() {
+        for(size_t i = 1; i < compactPools.size(); ++i)
+        {
+            checksum +=
+                CompactModelPool::max(compactPools[i - 1], compactPools[i])
+                    .size();
+        }
+    });
+    report("max", mapMax, idMax);
+
+    double mapLookup = measure(epochs, [&]() {
+        std::unordered_set<ModelPool> lookup(pools.begin(), pools.end());
+        checksum += lookup.size();
+    });
+    double idLookup = measure(epochs, [&]() {
+        std::unordered_set<CompactModelPool> lookup(compactPools.begin(),
+                                                    compactPools.end());
+        checksum += lookup.size();
+    });
+    report("unordered_set insertion", mapLookup, idLookup);
+
+    std::cout << "checksum: " << checksum << std::endl;
+    return 0;
+}
@@ -1,6 +1,9 @@
 #include "OrganizationStructureGeneration.hpp"
+#include "Parallel.hpp"
+#include <algorithm>
 #include <numeric/Combinatorics.hpp>
 #include <numeric/LimitedCombination.hpp>
+#include <stdexcept>
 
 using namespace numeric;
 
@@ -129,6 +132,11 @@ CoalitionStructureGeneration::CoalitionStructureGeneration(
     : mAgents(agents)
     , mCoalitionValueFunction(coalitionValueFunction)
     , mCoalitionStructureValueFunction(coalitionStructureValueFunction)
+    , mCurrentBestCoalitionStructureValue(0)
+    , mCurrentSolutionQuality(0)
+    , mGlobalUpperBound(std::numeric_limits<double>::max())
+    , mStopRequested(false)
+    , mNumberOfThreads(1)
 {
     reset();
 }
@@ -137,18 +145,32 @@ void CoalitionStructureGeneration::prepare()
 {
     using namespace numeric;
     ModelPool modelPool = AtomicAgent::getModelPool(mAgents);
-    LimitedCombination<owlapi::model::IRI> combinations(modelPool,
-                                                        mAgents.size(),
-                                                        MAX);
-    do
+    if(mCoalitionValues.empty())
     {
+        // Coalition ids use a mixed radix with one digit per model, where the
+        // digit is the number of agents of this model in the coalition
+        size_t numberOfCoalitionIds = 1;
+        for(const ModelPool::value_type& entry : modelPool)
+        {
+            mCoalitionIdStrides[entry.first] = numberOfCoalitionIds;
+            numberOfCoalitionIds *= entry.second + 1;
+        }
+        mCoalitionValues.assign(numberOfCoalitionIds, 0.0);
 
-        ModelCombination coalition = combinations.current();
-        ModelPool m(coalition);
-        AtomicAgent::List agents = AtomicAgent::toList(m);
-
-        mAgentCoalitionMap[coalition.size()].insert(agents);
-    } while(combinations.next());
+        LimitedCombination<owlapi::model::IRI> combinations(modelPool,
+                                                            mAgents.size(),
+                                                            MAX);
+        do
+        {
+            ModelCombination coalition = combinations.current();
+            ModelPool m(coalition);
+            AtomicAgent::List agents = AtomicAgent::toList(m);
+
+            mAgentCoalitionMap[coalition.size()].insert(agents);
+            mCoalitionValues[getCoalitionId(m)] =
+                mCoalitionValueFunction(agents);
+        } while(combinations.next());
+    }
 
     // Compute bounds for coalitions a given size, e.g.
     // coalition of size 1: max 100, min 10, average 50
@@ -164,7 +186,8 @@ void CoalitionStructureGeneration::prepare()
         for(; cit != coalitions.end(); ++cit)
         {
             const Coalition& coalition = *cit;
-            double value = mCoalitionValueFunction(coalition);
+            double value = getCoalitionValue(
+                getCoalitionId(AtomicAgent::getModelPool(coalition)));
 
             LOG_DEBUG_S << "Coalition value: " << value;
 
@@ -212,6 +235,30 @@ void CoalitionStructureGeneration::prepare()
         prune(mIntegerPartitionBoundsMap);
 }
 
+size_t CoalitionStructureGeneration::getCoalitionId(
+    const ModelPool& coalition) const
+{
+    size_t coalitionId = 0;
+    for(const ModelPool::value_type& entry : coalition)
+    {
+        std::map<owlapi::model::IRI, size_t>::const_iterator cit =
+            mCoalitionIdStrides.find(entry.first);
+        if(cit == mCoalitionIdStrides.end())
+        {
+            if(entry.second == 0)
+            {
+                continue;
+            }
+            throw std::invalid_argument(
+                "moreorg::utils::CoalitionStructureGeneration::getCoalitionId:"
+                " model '" +
+                entry.first.toString() + "' is not part of the agent list");
+        }
+        coalitionId += cit->second * entry.second;
+    }
+    return coalitionId;
+}
+
 double
 CoalitionStructureGeneration::bestLowerBound(const CoalitionBoundMap& boundMap)
 {
@@ -351,6 +398,7 @@ void CoalitionStructureGeneration::reset()
     mCurrentBestCoalitionStructure = CoalitionStructure();
     mCurrentBestCoalitionStructureValue = 0;
     mGlobalUpperBound = std::numeric_limits<double>::max();
+    mStopRequested = false;
     prepare();
 }
 
@@ -359,67 +407,77 @@ CoalitionStructure CoalitionStructureGeneration::findBest(double quality)
     IntegerPartitionBoundsMap boundMap = prune(mIntegerPartitionBoundsMap);
     mGlobalUpperBound = bestUpperBound(boundMap);
 
-    //// prune space where a partitions upper bound is smaller than global lower
-    ///bound
-    // CoalitionBoundMap boundMap = prune(mCoalitionBoundMap);
-    while(true)
-    {
-        LOG_INFO_S << "Select currently best integer partition";
-        IntegerPartition partition;
-        try
-        {
-            partition = selectIntegerPartition(boundMap, mGlobalUpperBound);
-        } catch(const std::runtime_error& e)
-        {
-            LOG_DEBUG_S << "No better partition found";
-            break;
-        }
-
-        LOG_INFO_S << "Compute best coalition structure for this subspace: "
-                   << IntegerPartitioning::toString(partition);
-        {
-            boost::unique_lock<boost::mutex> lock(mStatisticsMutex);
-            mStatistics.searchedIntegerPartitions.push_back(partition);
-        }
-        bool improvedResult = searchSubspace(partition,
-                                             0,
-                                             0,
-                                             mAgents,
-                                             CoalitionStructure(),
-                                             quality);
-
-        // No improvement of the results
-        if(!improvedResult)
-        {
-            boundMap.erase(partition);
-            mGlobalUpperBound = bestUpperBound(boundMap);
-        } else
-        {
-            if(currentBestSolutionQuality() <= quality)
+    // Subspaces are handed out in the order of selection, so that the most
+    // promising subspaces establish a good incumbent early on; boundMap holds
+    // the subspaces which have not been completed yet and is guarded by
+    // boundMapMutex
+    std::vector<IntegerPartition> partitions =
+        selectIntegerPartitions(boundMap);
+    boost::mutex boundMapMutex;
+    Parallel::forEach(
+        partitions.size(),
+        [this, quality, &partitions, &boundMap, &boundMapMutex](size_t i) {
+            const IntegerPartition& partition = partitions[i];
+            if(mStopRequested || currentBestSolutionQuality() <= quality)
             {
-                LOG_INFO_S << "Good enough coalition found: "
-                           << currentBestSolution() << ", value "
-                           << currentBestSolutionValue();
-                break;
+                return;
             }
 
-            Bounds bounds(currentBestSolutionValue());
-            boundMap[partition] = bounds;
+            // A subspace cannot contain a better coalition structure if its
+            // upper bound does not exceed the incumbent
+            double upperBound =
+                mIntegerPartitionBoundsMap.at(partition).maximum;
+            if(upperBound <= currentBestSolutionValue())
+            {
+                LOG_DEBUG_S << "Removing partition: "
+                            << IntegerPartitioning::toString(partition)
+                            << " -- max: " << upperBound
+                            << " <= best: " << currentBestSolutionValue();
+                {
+                    boost::unique_lock<boost::mutex> lock(mStatisticsMutex);
+                    mStatistics.prunedIntegerPartitions.push_back(partition);
+                }
+                boost::unique_lock<boost::mutex> lock(boundMapMutex);
+                boundMap.erase(partition);
+                mGlobalUpperBound = bestUpperBound(boundMap);
+                return;
+            }
 
-            LOG_DEBUG_S << "Best coalition found so far: "
-                        << currentBestSolution() << ", " << bounds;
+            LOG_INFO_S << "Compute best coalition structure for this subspace: "
+                       << IntegerPartitioning::toString(partition);
+            {
+                boost::unique_lock<boost::mutex> lock(mStatisticsMutex);
+                mStatistics.searchedIntegerPartitions.push_back(partition);
+            }
+            bool improvedResult = searchSubspace(partition,
+                                                 0,
+                                                 0,
+                                                 mAgents,
+                                                 CoalitionStructure(),
+                                                 1.0,
+                                                 quality);
+            if(improvedResult)
+            {
+                LOG_DEBUG_S << "Best coalition found so far: "
+                            << currentBestSolution() << ", "
+                            << currentBestSolutionValue();
+            }
 
-            // TODO: pick the next one for evaluation and repeat until satified
-            // with the solution
-            boundMap = prune(boundMap);
-            mGlobalUpperBound = bestUpperBound(boundMap);
-            boundMap.erase(partition);
-        }
+            // An interrupted search leaves the subspace open, so that the
+            // global upper bound remains valid
+            if(!mStopRequested)
+            {
+                boost::unique_lock<boost::mutex> lock(boundMapMutex);
+                boundMap.erase(partition);
+                mGlobalUpperBound = bestUpperBound(boundMap);
+            }
+        },
+        mNumberOfThreads);
 
-        if(boundMap.empty())
-        {
-            break;
-        }
+    if(currentBestSolutionQuality() <= quality)
+    {
+        LOG_INFO_S << "Good enough coalition found: " << currentBestSolution()
+                   << ", value " << currentBestSolutionValue();
     }
     mCompletionTime = base::Time::now();
 
@@ -432,11 +490,17 @@ void CoalitionStructureGeneration::anytimeSearch(double quality)
 {
     mStartTime = base::Time::now();
     mCompletionTime = base::Time();
+    mStopRequested = false;
     mThread =
         boost::thread(&CoalitionStructureGeneration::findBest, this, quality);
 }
 
-void CoalitionStructureGeneration::stopSearch() { mThread.interrupt(); }
+void CoalitionStructureGeneration::stopSearch()
+{
+    // Workers check the request, since the search threads cannot be
+    // interrupted safely while subspaces are searched concurrently
+    mStopRequested = true;
+}
 
 CoalitionStructure CoalitionStructureGeneration::currentBestSolution() const
 {
@@ -446,7 +510,6 @@ CoalitionStructure CoalitionStructureGeneration::currentBestSolution() const
 
 double CoalitionStructureGeneration::currentBestSolutionValue() const
 {
-    boost::unique_lock<boost::mutex> lock(mSolutionMutex);
     return mCurrentBestCoalitionStructureValue;
 }
 
@@ -455,42 +518,41 @@ double CoalitionStructureGeneration::currentBestSolutionQuality() const
     return mGlobalUpperBound / currentBestSolutionValue();
 }
 
-IntegerPartition CoalitionStructureGeneration::selectIntegerPartition(
-    const CoalitionStructureGeneration::IntegerPartitionBoundsMap& boundMap,
-    double maximumBound) const
+std::vector<IntegerPartition>
+CoalitionStructureGeneration::selectIntegerPartitions(
+    const CoalitionStructureGeneration::IntegerPartitionBoundsMap& boundMap)
+    const
 {
     // heuristic one
     // pick space with highest upper bound
+    std::vector<IntegerPartition> partitions;
     IntegerPartitionBoundsMap::const_iterator it = boundMap.begin();
-    double value = 0.0;
-    double average = 0.0;
-    IntegerPartition partition;
     for(; it != boundMap.end(); ++it)
     {
-        LOG_INFO_S << "Current: " << IntegerPartitioning::toString(partition)
-                   << ", current value " << value;
         LOG_INFO_S << "Check: " << IntegerPartitioning::toString(it->first)
                    << ", max value " << it->second.maximum << ", min value "
                    << it->second.minimum << ", avg value "
                    << it->second.average;
-        // Use average as tiebreaker
-        if(it->second.maximum > value ||
-           (it->second.maximum == value && it->second.average > average))
+        if(it->second.maximum > 0.0)
         {
-            partition = it->first;
-            value = it->second.maximum;
-            average = it->second.average;
+            partitions.push_back(it->first);
         }
     }
-    if(value == 0.0)
-    {
-        throw std::runtime_error(
-            "CoalitionStructureGeneration::selectIntegerPartition: No integer "
-            "partition found greater than the given maximum bound");
-    } else
-    {
-        return partition;
-    }
+
+    // Use average as tiebreaker
+    std::stable_sort(partitions.begin(),
+                     partitions.end(),
+                     [&boundMap](const IntegerPartition& a,
+                                 const IntegerPartition& b) {
+                         const Bounds& boundsA = boundMap.at(a);
+                         const Bounds& boundsB = boundMap.at(b);
+                         if(boundsA.maximum != boundsB.maximum)
+                         {
+                             return boundsA.maximum > boundsB.maximum;
+                         }
+                         return boundsA.average > boundsB.average;
+                     });
+    return partitions;
 
     // when optimality shall be traded
     // consider betaStar > 1, where betaStar = 1.05 "means that the solution
@@ -518,6 +580,7 @@ bool CoalitionStructureGeneration::searchSubspace(
     size_t alpha,
     const AtomicAgent::List& agents,
     const CoalitionStructure& currentStructure,
+    double currentStructurePotential,
     double betaStar)
 {
     bool improvedResult = false;
@@ -547,7 +610,8 @@ bool CoalitionStructureGeneration::searchSubspace(
 
     // Compute upper bound of subspace, so that we can stop computation when
     // this maximum has been reached
-    double upperBoundOfSubspace = mIntegerPartitionBoundsMap[partition].maximum;
+    double upperBoundOfSubspace =
+        mIntegerPartitionBoundsMap.at(partition).maximum;
     LOG_DEBUG_S << indent << " upperBound of subspace "
                 << IntegerPartitioning::toString(partition) << ": "
                 << upperBoundOfSubspace;
@@ -559,9 +623,16 @@ bool CoalitionStructureGeneration::searchSubspace(
                                                         EXACT);
     do
     {
+        if(mStopRequested)
+        {
+            LOG_DEBUG_S << indent << " search has been stopped";
+            return improvedResult;
+        }
+
         ModelCombination coalition = combinations.current();
         // translate to index
         ModelPool m(coalition);
+        size_t coalitionId = getCoalitionId(m);
 
         // m_k represent the an array of indices
         std::vector<int> m_k;
@@ -630,27 +701,20 @@ bool CoalitionStructureGeneration::searchSubspace(
             } else
             {
                 LOG_DEBUG_S << indent << " computing subspace potential";
-                // Estimate the potential of this subspace using
-                // know value for the already found coalitions
+                // Estimate the potential of this subspace using the
+                // memoised values of the already found coalitions
                 // and existing upper bounds for the coalitions still
                 // to look at
-                double subspacePotentialValue = 1.0;
-
-                // Estimate value of current (partial) coalition structure
-                for(size_t i = 0; i < coalitionStructure.size(); ++i)
-                {
-                    double valueOfCoalition =
-                        mCoalitionValueFunction(coalitionStructure[i]);
-                    subspacePotentialValue =
-                        std::min(valueOfCoalition, subspacePotentialValue);
-                    LOG_DEBUG_S << indent
-                                << " coalition: " << coalitionStructure[i]
-                                << std::endl
-                                << indent << "     value: " << valueOfCoalition
-                                << std::endl
-                                << indent << "     current subspace potential: "
-                                << subspacePotentialValue << std::endl;
-                }
+                double valueOfCoalition = getCoalitionValue(coalitionId);
+                double structurePotentialValue =
+                    std::min(valueOfCoalition, currentStructurePotential);
+                LOG_DEBUG_S << indent << " coalition: " << coalition
+                            << std::endl
+                            << indent << "     value: " << valueOfCoalition
+                            << std::endl
+                            << indent << "     current structure potential: "
+                            << structurePotentialValue << std::endl;
+                double subspacePotentialValue = structurePotentialValue;
 
                 // Estimate value for the rest of the partition based on the
                 // bounds computed on coalition sizes, i.e. looking at the
@@ -658,7 +722,7 @@ bool CoalitionStructureGeneration::searchSubspace(
                 for(size_t i = coalitionStructure.size(); i < partition.size();
                     ++i)
                 {
-                    double max_s = mCoalitionBoundMap[partition[i]].maximum;
+                    double max_s = mCoalitionBoundMap.at(partition[i]).maximum;
                     LOG_DEBUG_S << indent << " potential for coalition size: "
                                 << partition[i] << ": " << max_s;
                     subspacePotentialValue =
@@ -680,6 +744,7 @@ bool CoalitionStructureGeneration::searchSubspace(
                                       m_k[0],
                                       remainingAgents,
                                       coalitionStructure,
+                                      structurePotentialValue,
                                       betaStar))
                     {
                         improvedResult = true;
@@ -2,6 +2,7 @@
 #define ORGANIZATION_MODEL_UTILS_ORGANIZATION_STRUCTURE_GENERATION_HPP
 
 #include "../Agent.hpp"
+#include <atomic>
 #include <base-logging/Logging.hpp>
 #include <base/Time.hpp>
 #include <boost/function.hpp>
@@ -41,6 +42,13 @@ std::ostream& operator<<(std::ostream& os, const Bounds& bounds);
  * The adaption allows to account for a use of model pools and looking at the
  * identification coalition functions that have a boolean as characteristic
  * value (1.0 or 0.0) and thus represent an activation
+ *
+ * Since agents of the same model are interchangeable, a coalition is
+ * identified by its model pool: the value of each coalition is computed once
+ * during preparation and stored in a flat table, which is indexed by the
+ * coalition id (see getCoalitionId). The integer partition subspaces are
+ * searched concurrently (see setNumberOfThreads), where all workers prune
+ * against the same incumbent solution.
  */
 class CoalitionStructureGeneration
 {
@@ -68,6 +76,11 @@ private:
     using AgentCoalitionMap = std::map<size_t, std::set<Coalition>>;
     AgentCoalitionMap mAgentCoalitionMap;
 
+    /// Offset of a single agent of a model within the coalition id
+    std::map<owlapi::model::IRI, size_t> mCoalitionIdStrides;
+    /// Value of each coalition, indexed by the coalition id
+    std::vector<double> mCoalitionValues;
+
     using CoalitionBoundMap = std::map<size_t, Bounds>;
     CoalitionBoundMap mCoalitionBoundMap;
 
@@ -83,9 +96,12 @@ private:
     base::Time mStartTime;
     base::Time mCompletionTime;
     CoalitionStructure mCurrentBestCoalitionStructure;
-    double mCurrentBestCoalitionStructureValue;
+    /// Value of the incumbent, which is written while holding mSolutionMutex
+    std::atomic<double> mCurrentBestCoalitionStructureValue;
     double mCurrentSolutionQuality;
-    double mGlobalUpperBound;
+    std::atomic<double> mGlobalUpperBound;
+    std::atomic<bool> mStopRequested;
+    size_t mNumberOfThreads;
 
     /**
      * Compute the integer partitions and the agent coalition map for coalition
@@ -93,6 +109,22 @@ private:
      */
     void prepare();
 
+    /**
+     * Get the id of a coalition, i.e., its index in the coalition value table
+     * \param coalition Model pool of the coalition
+     * \return coalition id
+     */
+    size_t getCoalitionId(const ModelPool& coalition) const;
+
+    /**
+     * Get the (memoised) value of a coalition
+     * \param coalitionId Id of the coalition, \see getCoalitionId
+     */
+    double getCoalitionValue(size_t coalitionId) const
+    {
+        return mCoalitionValues[coalitionId];
+    }
+
     double bestLowerBound(const CoalitionBoundMap& boundMap);
     double bestLowerBound(const IntegerPartitionBoundsMap& boundMap);
     double bestUpperBound(const IntegerPartitionBoundsMap& boundMap);
@@ -102,9 +134,12 @@ private:
     IntegerPartitionBoundsMap prune(const IntegerPartitionBoundsMap& boundsMap);
     CoalitionBoundMap prune(const CoalitionBoundMap& boundMap);
 
-    numeric::IntegerPartition
-    selectIntegerPartition(const IntegerPartitionBoundsMap& boundMap,
-                           double maximumBound) const;
+    /**
+     * Get the integer partitions in the order they should be searched in
+     * \return partitions with a positive upper bound
+     */
+    std::vector<numeric::IntegerPartition>
+    selectIntegerPartitions(const IntegerPartitionBoundsMap& boundMap) const;
 
     /**
      * Search a subspace
@@ -115,6 +150,8 @@ private:
      * \param agents list of agents that have to be considered for appending to
      * the existing coalition structure
      * \param currentStructure the already constructed coalition structure
+     * \param currentStructurePotential the potential value of the already
+     * constructed coalition structure
      * \param bestStar Quality of the solution, i.e. 1.05 means 95% percent of
      * the optimal solution \return true if this subspace contained a better
      * solution than already existed
@@ -124,6 +161,7 @@ private:
                         size_t alpha,
                         const AtomicAgent::List& agents,
                         const CoalitionStructure& currentStructure,
+                        double currentStructurePotential,
                         double betaStar);
 
     bool updateCurrentBestCoalitionStructure(
@@ -204,6 +242,23 @@ public:
     static std::string toString(const CoalitionStructure& c);
 
     Statistics getStatistics() const;
+
+    /**
+     * Set the number of threads which search integer partition subspaces
+     * concurrently
+     * \param numberOfThreads Number of threads, 1 for a serial search, 0 to
+     * use all available hardware threads; for more than one thread the
+     * coalition structure value function has to be thread-safe
+     */
+    void setNumberOfThreads(size_t numberOfThreads)
+    {
+        mNumberOfThreads = numberOfThreads;
+    }
+
+    /**
+     * Get the number of threads which search integer partition subspaces
+     */
+    size_t getNumberOfThreads() const { return mNumberOfThreads; }
 };
 
 } // end namespace utils
@@ -0,0 +1,74 @@
+#include "Parallel.hpp"
+#include <algorithm>
+#include <atomic>
+#include <boost/thread.hpp>
+#include <exception>
+
+namespace moreorg {
+namespace utils {
+
+size_t Parallel::getNumberOfThreads(size_t numberOfThreads)
+{
+    if(numberOfThreads == 0)
+    {
+        numberOfThreads = boost::thread::hardware_concurrency();
+    }
+    return std::max(numberOfThreads, static_cast<size_t>(1));
+}
+
+void Parallel::forEach(size_t numberOfItems,
+                       const IndexFunction& f,
+                       size_t numberOfThreads)
+{
+    size_t workers =
+        std::min(getNumberOfThreads(numberOfThreads), numberOfItems);
+    if(workers <= 1)
+    {
+        for(size_t i = 0; i < numberOfItems; ++i)
+        {
+            f(i);
+        }
+        return;
+    }
+
+    std::atomic<size_t> nextItem(0);
+    std::atomic<bool> failed(false);
+    std::exception_ptr firstException;
+    boost::mutex exceptionMutex;
+
+    auto work = [&]() {
+        size_t i = 0;
+        while(!failed && (i = nextItem++) < numberOfItems)
+        {
+            try
+            {
+                f(i);
+            } catch(...)
+            {
+                boost::unique_lock<boost::mutex> lock(exceptionMutex);
+                if(!failed)
+                {
+                    firstException = std::current_exception();
+                    failed = true;
+                }
+            }
+        }
+    };
+
+    boost::thread_group threads;
+    for(size_t w = 1; w < workers; ++w)
+    {
+        threads.create_thread(work);
+    }
+    // The calling thread contributes as a worker as well
+    work();
+    threads.join_all();
+
+    if(firstException)
+    {
+        std::rethrow_exception(firstException);
+    }
+}
+
+} // end namespace utils
+} // end namespace moreorg
@@ -0,0 +1,47 @@
+#ifndef ORGANIZATION_MODEL_UTILS_PARALLEL_HPP
+#define ORGANIZATION_MODEL_UTILS_PARALLEL_HPP
+
+#include <boost/function.hpp>
+#include <cstddef>
+
+namespace moreorg {
+namespace utils {
+
+/**
+ * \class Parallel
+ * \brief Distribute a set of independent work items across a number of worker
+ * threads
+ */
+class Parallel
+{
+public:
+    using IndexFunction = boost::function1<void, size_t>;
+
+    /**
+     * Resolve the number of worker threads
+     * \param numberOfThreads Requested number of threads, 0 will be resolved
+     * to the number of available hardware threads
+     * \return effective number of worker threads (at least 1)
+     */
+    static size_t getNumberOfThreads(size_t numberOfThreads);
+
+    /**
+     * Apply a function to all indexes in [0, numberOfItems)
+     *
+     * Items are handed out one by one, so that items with a largely varying
+     * cost do not stall the other workers. If numberOfThreads resolves to 1,
+     * all items will be processed in the calling thread.
+     * \param numberOfItems Number of items to process
+     * \param f Function to call for each item index
+     * \param numberOfThreads Number of worker threads, \see getNumberOfThreads
+     * \throw the first exception thrown by any of the function calls -- all
+     * remaining items will be skipped in this case
+     */
+    static void forEach(size_t numberOfItems,
+                        const IndexFunction& f,
+                        size_t numberOfThreads = 0);
+};
+
+} // end namespace utils
+} // end namespace moreorg
+#endif // ORGANIZATION_MODEL_UTILS_PARALLEL_HPP
@@ -5,8 +5,13 @@
 #include <moreorg/Algebra.hpp>
 #include <moreorg/OrganizationModel.hpp>
 #include <moreorg/OrganizationModelAsk.hpp>
+#include <moreorg/algebra/CompositionFunction.hpp>
 #include <moreorg/algebra/Connectivity.hpp>
+#include <moreorg/algebra/InterfaceTable.hpp>
+#include <moreorg/algebra/StructuralFilter.hpp>
+#include <moreorg/algebra/SubclassClosure.hpp>
 #include <moreorg/vocabularies/OM.hpp>
+#include <owlapi/model/OWLOntologyTell.hpp>
 
 using namespace moreorg;
 using namespace moreorg::algebra;
@@ -130,6 +135,11 @@ BOOST_AUTO_TEST_CASE(resource_support)
         ResourceSupportVector e_supportVector =
             supportVector.embedClassRelationship(ask);
         BOOST_TEST_MESSAGE("Test: " << e_supportVector.toString());
+        BOOST_REQUIRE_MESSAGE(e_supportVector(0) == 1 &&
+                                  e_supportVector(1) == 3 &&
+                                  e_supportVector(2) == 1,
+                              "Actor accumulates Sherpa and CREX: "
+                                  << e_supportVector.toString());
     }
     //{
     //    IRI system = OM::resolve("Sherpa");
@@ -147,6 +157,60 @@ BOOST_AUTO_TEST_CASE(resource_support)
     //}
 }
 
+BOOST_AUTO_TEST_CASE(subclass_closure)
+{
+    using namespace owlapi::model;
+    using namespace moreorg::vocabulary;
+
+    OrganizationModel::Ptr om(
+        new OrganizationModel(getRootDir() + "/test/data/om-schema-v0.7.owl"));
+    OrganizationModelAsk ask(om);
+
+    SubclassClosure::Ptr closure = ask.getSubclassClosure();
+    BOOST_REQUIRE_MESSAGE(closure == SubclassClosure::getInstance(om),
+                          "Closure should be shared for the same ontology");
+
+    IRIList klasses;
+    klasses.push_back(OM::resolve("Sherpa"));
+    klasses.push_back(OM::resolve("CREX"));
+    klasses.push_back(OM::resolve("Actor"));
+    klasses.push_back(OM::resolve("Payload"));
+    klasses.push_back(OM::resolve("Agent"));
+    klasses.push_back(OM::resolve("StereoImageProvider"));
+    klasses.push_back(OM::Functionality());
+
+    SubclassClosure::ClassIdList ids = closure->getIds(klasses);
+    SubclassClosure::Matrix::Ptr matrix = closure->getMatrix();
+    BOOST_REQUIRE_EQUAL(matrix->size(), closure->getNumberOfClasses());
+    for(size_t a = 0; a < klasses.size(); ++a)
+    {
+        for(size_t b = 0; b < klasses.size(); ++b)
+        {
+            bool isSubClass = klasses[a] == klasses[b] ||
+                              ask.ontology().isSubClassOf(klasses[a],
+                                                          klasses[b]);
+            BOOST_REQUIRE_MESSAGE(matrix->isSubClassOf(ids[a], ids[b]) ==
+                                      isSubClass,
+                                  "Subclass relation of " << klasses[a]
+                                                          << " and "
+                                                          << klasses[b]);
+        }
+    }
+
+    BOOST_REQUIRE_MESSAGE(
+        closure->isSubClassOf(OM::resolve("Sherpa"), OM::resolve("Actor")),
+        "Sherpa is a subclass of Actor");
+
+    om->resetQueryCache();
+    BOOST_REQUIRE_MESSAGE(closure->getIds(klasses) == ids,
+                          "Class ids should remain stable across revisions");
+    BOOST_REQUIRE_MESSAGE(closure->getMatrix() != matrix,
+                          "Closure should be recomputed for a new revision");
+    BOOST_REQUIRE_MESSAGE(
+        closure->getMatrix()->isSubClassOf(ids[0], ids[2]),
+        "Sherpa is a subclass of Actor after recomputing the closure");
+}
+
 BOOST_AUTO_TEST_CASE(resource_support_vector)
 {
     {
@@ -212,6 +276,30 @@ BOOST_AUTO_TEST_CASE(resource_support_vector)
     }
 }
 
+BOOST_AUTO_TEST_CASE(composition_function)
+{
+    ModelPool modelPool;
+    modelPool["http://model#a"] = 1;
+    modelPool["http://model#b"] = 2;
+
+    IRIValueMap valueMap;
+    valueMap["http://model#a"] = 0;
+    valueMap["http://model#b"] = 0;
+    BOOST_REQUIRE_EQUAL(CompositionFunction::max(modelPool, valueMap), 0);
+    BOOST_REQUIRE_EQUAL(CompositionFunction::min(modelPool, valueMap), 0);
+
+    valueMap["http://model#a"] = -2;
+    valueMap["http://model#b"] = -1;
+    BOOST_REQUIRE_EQUAL(CompositionFunction::max(modelPool, valueMap), -1);
+    BOOST_REQUIRE_EQUAL(CompositionFunction::min(modelPool, valueMap), -2);
+    BOOST_REQUIRE_EQUAL(CompositionFunction::weightedSum(modelPool, valueMap),
+                        -4);
+
+    valueMap.erase("http://model#b");
+    BOOST_REQUIRE_THROW(CompositionFunction::max(modelPool, valueMap),
+                        std::invalid_argument);
+}
+
 BOOST_AUTO_TEST_CASE(composition)
 {
     ModelPool empty;
@@ -525,8 +613,9 @@ BOOST_FIXTURE_TEST_SUITE(connectivity, ConnectivityFixture)
         // passive: 3x3
 
         graph_analysis::BaseGraph::Ptr baseGraph;
-        bool feasible =
-            Connectivity::isFeasible(modelPool, ask, baseGraph, 60000);
+        Connectivity::Statistics statistics;
+        bool feasible = Connectivity::isFeasible(
+            modelPool, ask, baseGraph, statistics, 60000);
         if(baseGraph)
         {
             graph_analysis::io::GraphIO::write(
@@ -535,7 +624,7 @@ BOOST_FIXTURE_TEST_SUITE(connectivity, ConnectivityFixture)
                 baseGraph);
         }
         BOOST_TEST_MESSAGE(
-            "Evaluation done: " << Connectivity::getStatistics().toString());
+            "Evaluation done: " << statistics.toString());
         BOOST_REQUIRE_MESSAGE(feasible, "ModelPool: " << modelPool.toString());
     }
 
@@ -603,6 +692,383 @@ BOOST_FIXTURE_TEST_SUITE(connectivity, ConnectivityFixture)
         }
     }
 
+    BOOST_AUTO_TEST_CASE(portfolio)
+    {
+        // Restore the global configuration for subsequent tests, even if a
+        // check fails
+        struct ConfigurationGuard
+        {
+            qxcfg::Configuration configuration =
+                Connectivity::getConfiguration();
+            ~ConfigurationGuard()
+            {
+                Connectivity::setConfiguration(configuration);
+            }
+        } guard;
+
+        Connectivity::setConfiguration(qxcfg::Configuration(
+            getRootDir() + "/test/data/om-configuration-portfolio.xml"));
+        BOOST_REQUIRE_MESSAGE(Connectivity::getPortfolioSize() == 4,
+                              "Portfolio size is configured");
+
+        ModelPool feasiblePool;
+        feasiblePool[vocabulary::OM::resolve("Sherpa")] = 2;
+        feasiblePool[vocabulary::OM::resolve("Payload")] = 2;
+
+        Connectivity::Statistics statistics;
+        graph_analysis::BaseGraph::Ptr baseGraph;
+        BOOST_REQUIRE_MESSAGE(Connectivity::isFeasible(feasiblePool,
+                                                       ask,
+                                                       baseGraph,
+                                                       statistics,
+                                                       30000),
+                              "ModelPool: " << feasiblePool.toString() << " "
+                                            << statistics.toString());
+
+        // The structural filter rejects this pool without any search
+        ModelPool infeasiblePool;
+        infeasiblePool[vocabulary::OM::resolve("CREX")] = 2;
+        Connectivity::Statistics filteredStatistics;
+        BOOST_REQUIRE_MESSAGE(!Connectivity::isFeasible(infeasiblePool,
+                                                        ask,
+                                                        baseGraph,
+                                                        filteredStatistics,
+                                                        30000),
+                              "ModelPool: " << infeasiblePool.toString());
+        BOOST_REQUIRE_MESSAGE(filteredStatistics.pruned,
+                              "ModelPool: " << infeasiblePool.toString() << " "
+                                            << filteredStatistics.toString());
+
+        // This pool passes the structural filter, but a single Sherpa
+        // provides only two active interfaces for the three passive CREX
+        // interfaces, so that the portfolio has to prove the infeasibility
+        ModelPool searchedPool;
+        searchedPool[vocabulary::OM::resolve("Sherpa")] = 1;
+        searchedPool[vocabulary::OM::resolve("CREX")] = 3;
+        Connectivity::Statistics searchStatistics;
+        BOOST_REQUIRE_MESSAGE(!Connectivity::isFeasible(searchedPool,
+                                                        ask,
+                                                        baseGraph,
+                                                        searchStatistics,
+                                                        30000),
+                              "ModelPool: " << searchedPool.toString());
+        BOOST_REQUIRE_MESSAGE(!searchStatistics.pruned &&
+                                  !searchStatistics.cached &&
+                                  searchStatistics.stopped == 0,
+                              "Portfolio search completed for "
+                                  << searchedPool.toString() << " "
+                                  << searchStatistics.toString());
+    }
+
+    BOOST_AUTO_TEST_CASE(feasibility_cache)
+    {
+        ModelPool modelPool;
+        modelPool[vocabulary::OM::resolve("Sherpa")] = 2;
+        modelPool[vocabulary::OM::resolve("Payload")] = 2;
+
+        FeasibilityCache::Ptr cache = make_shared<FeasibilityCache>(2, 1);
+        ask.setFeasibilityCache(cache);
+
+        graph_analysis::BaseGraph::Ptr baseGraph;
+        Connectivity::Statistics statistics;
+        bool feasible = Connectivity::isFeasible(
+            modelPool, ask, baseGraph, statistics, 30000);
+        BOOST_REQUIRE_MESSAGE(!statistics.cached,
+                              "First check should not be cached");
+
+        OrganizationModelAsk askCopy = ask;
+        bool cachedFeasible = Connectivity::isFeasible(
+            modelPool, askCopy, baseGraph, statistics, 30000);
+        BOOST_REQUIRE_MESSAGE(statistics.cached,
+                              "Second check should be served by the cache");
+        BOOST_REQUIRE_MESSAGE(feasible == cachedFeasible,
+                              "Cached result should match the computed one");
+
+        FeasibilityCache::Statistics cacheStatistics = cache->getStatistics();
+        BOOST_REQUIRE_MESSAGE(cacheStatistics.hits == 1 &&
+                                  cacheStatistics.misses == 1,
+                              "Cache statistics: "
+                                  << cacheStatistics.toString());
+
+        for(size_t i = 1; i <= 3; ++i)
+        {
+            ModelPool payloads;
+            payloads[vocabulary::OM::resolve("Payload")] = i + 1;
+            Connectivity::isFeasible(payloads, ask);
+        }
+        cacheStatistics = cache->getStatistics();
+        BOOST_REQUIRE_MESSAGE(cacheStatistics.size == 2 &&
+                                  cacheStatistics.evictions == 2,
+                              "Cache should be bounded: "
+                                  << cacheStatistics.toString());
+
+        // Results are not reused for a new revision of the ontology -- the
+        // first check re-inserts the evicted result
+        Connectivity::isFeasible(modelPool, ask, baseGraph, statistics, 30000);
+        Connectivity::isFeasible(modelPool, ask, baseGraph, statistics, 30000);
+        BOOST_REQUIRE_MESSAGE(statistics.cached,
+                              "Check should be served by the cache");
+        ask.getOrganizationModel()->resetQueryCache();
+        Connectivity::isFeasible(modelPool, ask, baseGraph, statistics, 30000);
+        BOOST_REQUIRE_MESSAGE(!statistics.cached,
+                              "Check should not be cached for a new revision");
+    }
+
+    BOOST_AUTO_TEST_CASE(incremental_feasibility)
+    {
+        ask.setFeasibilityCache(make_shared<FeasibilityCache>());
+
+        ModelPool basePool;
+        basePool[vocabulary::OM::resolve("Sherpa")] = 2;
+        basePool[vocabulary::OM::resolve("Payload")] = 1;
+
+        ModelPool addedPool;
+        addedPool[vocabulary::OM::resolve("Payload")] = 1;
+
+        graph_analysis::BaseGraph::Ptr baseGraph;
+        Connectivity::Statistics statistics;
+        BOOST_REQUIRE_MESSAGE(Connectivity::isFeasible(
+                                  basePool, ask, baseGraph, statistics, 30000),
+                              "ModelPool: " << basePool.toString());
+
+        graph_analysis::BaseGraph::Ptr graph;
+        bool feasible = Connectivity::isFeasibleExtension(
+            basePool, baseGraph, addedPool, ask, graph, statistics, 30000);
+        BOOST_REQUIRE_MESSAGE(feasible && statistics.extended,
+                              "Extension should be feasible without search: "
+                                  << statistics.toString());
+        BOOST_REQUIRE_MESSAGE(graph && graph->isConnected() &&
+                                  graph->getAllVertices().size() == 4,
+                              "Extended graph should connect all agents");
+
+        // The extended pool can be extended again via the cached sub-pool
+        ModelPool modelPool = Algebra::sum(basePool, addedPool).toModelPool();
+        modelPool[vocabulary::OM::resolve("Payload")] += 1;
+        bool incrementalFeasible = Connectivity::isFeasibleIncremental(
+            modelPool, ask, graph, statistics, 30000);
+        BOOST_REQUIRE_MESSAGE(incrementalFeasible && statistics.extended,
+                              "Incremental check should reuse the sub-pool: "
+                                  << statistics.toString());
+
+        ask.setFeasibilityCache(make_shared<FeasibilityCache>());
+        bool fullFeasible = Connectivity::isFeasible(
+            modelPool, ask, graph, statistics, 30000);
+        BOOST_REQUIRE_MESSAGE(fullFeasible == incrementalFeasible,
+                              "Incremental and full check should agree");
+    }
+
+    BOOST_AUTO_TEST_CASE(asymmetric_extension)
+    {
+        // InterfaceA is compatible with InterfaceC and InterfaceB with
+        // InterfaceA, but not vice versa
+        OrganizationModel::Ptr om(new OrganizationModel(
+            getRootDir() + "/test/data/om-asymmetric-interfaces.owl"));
+        OrganizationModelAsk asymmetricAsk(om);
+
+        owlapi::model::IRI robotA = vocabulary::OM::resolve("RobotA");
+        owlapi::model::IRI robotB = vocabulary::OM::resolve("RobotB");
+        owlapi::model::IRI robotC = vocabulary::OM::resolve("RobotC");
+        std::vector<std::pair<owlapi::model::IRI, owlapi::model::IRI>>
+            extensions = {{robotA, robotB},
+                          {robotB, robotA},
+                          {robotA, robotC},
+                          {robotC, robotA}};
+        for(const std::pair<owlapi::model::IRI, owlapi::model::IRI>& e :
+            extensions)
+        {
+            ModelPool basePool;
+            basePool[e.first] = 1;
+            ModelPool addedPool;
+            addedPool[e.second] = 1;
+
+            asymmetricAsk.setFeasibilityCache(
+                make_shared<FeasibilityCache>());
+            graph_analysis::BaseGraph::Ptr baseGraph;
+            graph_analysis::BaseGraph::Ptr graph;
+            Connectivity::Statistics statistics;
+            bool extensionFeasible =
+                Connectivity::isFeasibleExtension(basePool,
+                                                  baseGraph,
+                                                  addedPool,
+                                                  asymmetricAsk,
+                                                  graph,
+                                                  statistics,
+                                                  30000);
+
+            asymmetricAsk.setFeasibilityCache(
+                make_shared<FeasibilityCache>());
+            ModelPool modelPool =
+                Algebra::sum(basePool, addedPool).toModelPool();
+            bool feasible = Connectivity::isFeasible(
+                modelPool, asymmetricAsk, graph, statistics, 30000);
+            BOOST_REQUIRE_MESSAGE(extensionFeasible == feasible,
+                                  "Extension and full check should agree for "
+                                      << modelPool.toString());
+            BOOST_REQUIRE_MESSAGE(feasible == (e.first == robotC ||
+                                               e.second == robotC),
+                                  "ModelPool: " << modelPool.toString());
+        }
+
+        // The link requires the orientation of the csp, i.e. InterfaceA to
+        // InterfaceC, so the extension does not need to search
+        ModelPool basePool;
+        basePool[robotC] = 1;
+        ModelPool addedPool;
+        addedPool[robotA] = 1;
+        asymmetricAsk.setFeasibilityCache(make_shared<FeasibilityCache>());
+        graph_analysis::BaseGraph::Ptr graph;
+        Connectivity::Statistics statistics;
+        BOOST_REQUIRE_MESSAGE(
+            Connectivity::isFeasibleExtension(basePool,
+                                              graph_analysis::BaseGraph::Ptr(),
+                                              addedPool,
+                                              asymmetricAsk,
+                                              graph,
+                                              statistics,
+                                              30000) &&
+                statistics.extended,
+            "Extension should be feasible without search: "
+                << statistics.toString());
+    }
+
+    BOOST_AUTO_TEST_CASE(interface_table)
+    {
+        owlapi::model::IRI interfaceBaseClass =
+            vocabulary::OM::resolve("ElectroMechanicalInterface");
+        InterfaceTable::Ptr table =
+            InterfaceTable::getInstance(ask, interfaceBaseClass);
+        BOOST_REQUIRE_MESSAGE(
+            table == InterfaceTable::getInstance(ask, interfaceBaseClass),
+            "Table should be shared for the same ontology");
+
+        InterfaceTable::InterfaceIdListPtr sherpaInterfaces =
+            table->getInterfaces(vocabulary::OM::resolve("Sherpa"));
+        InterfaceTable::InterfaceIdListPtr payloadInterfaces =
+            table->getInterfaces(vocabulary::OM::resolve("Payload"));
+        BOOST_REQUIRE_MESSAGE(!sherpaInterfaces->empty() &&
+                                  !payloadInterfaces->empty(),
+                              "Agents should have interfaces");
+
+        InterfaceTable::CompatibilityMatrix::Ptr matrix =
+            table->getCompatibilityMatrix();
+        BOOST_REQUIRE_EQUAL(matrix->size(), table->getNumberOfInterfaceTypes());
+        for(size_t a = 0; a < matrix->size(); ++a)
+        {
+            for(size_t b = 0; b < matrix->size(); ++b)
+            {
+                const owlapi::model::IRI& ifModel0 = table->getInterfaceType(a);
+                const owlapi::model::IRI& ifModel1 = table->getInterfaceType(b);
+                bool compatible = false;
+                try
+                {
+                    compatible = ask.ontology().isRelatedTo(
+                        ifModel0, vocabulary::OM::compatibleWith(), ifModel1);
+                } catch(const std::invalid_argument&)
+                {
+                    // no individual for this interface type
+                }
+                BOOST_REQUIRE_MESSAGE(matrix->isCompatible(a, b) == compatible,
+                                      "Compatibility of " << ifModel0 << " and "
+                                                          << ifModel1);
+            }
+        }
+
+        ask.getOrganizationModel()->resetQueryCache();
+        InterfaceTable::InterfaceIdListPtr recomputedSherpaInterfaces =
+            table->getInterfaces(vocabulary::OM::resolve("Sherpa"));
+        BOOST_REQUIRE_MESSAGE(
+            *recomputedSherpaInterfaces == *sherpaInterfaces,
+            "Interface ids should remain stable across revisions");
+        // The table does not retain the interfaces of previous revisions,
+        // while snapshots remain valid for their holders
+        BOOST_REQUIRE_MESSAGE(recomputedSherpaInterfaces != sherpaInterfaces &&
+                                  sherpaInterfaces.use_count() == 1,
+                              "Previous snapshot should be released");
+        InterfaceTable::CompatibilityMatrix::Ptr recomputed =
+            table->getCompatibilityMatrix();
+        BOOST_REQUIRE_MESSAGE(recomputed != matrix,
+                              "Matrix should be recomputed for a new revision");
+        for(size_t a = 0; a < matrix->size(); ++a)
+        {
+            for(size_t b = 0; b < matrix->size(); ++b)
+            {
+                BOOST_REQUIRE_EQUAL(recomputed->isCompatible(a, b),
+                                    matrix->isCompatible(a, b));
+            }
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(structural_filter)
+    {
+        ask.setFeasibilityCache(make_shared<FeasibilityCache>());
+        StructuralFilter::Ptr filter = StructuralFilter::getInstance(
+            ask, vocabulary::OM::resolve("ElectroMechanicalInterface"));
+        filter->resetStatistics();
+
+        ModelPool crex;
+        crex[vocabulary::OM::resolve("CREX")] = 10;
+        BOOST_REQUIRE_MESSAGE(filter->check(crex) ==
+                                  StructuralFilter::INSUFFICIENT_INTERFACES,
+                              "ModelPool: " << crex.toString());
+
+        Connectivity::Statistics statistics;
+        graph_analysis::BaseGraph::Ptr baseGraph;
+        bool feasible =
+            Connectivity::isFeasible(crex, ask, baseGraph, statistics, 30000);
+        BOOST_REQUIRE_MESSAGE(!feasible && statistics.pruned,
+                              "Infeasible pool should be rejected without "
+                              "search: "
+                                  << statistics.toString());
+
+        ModelPool modelPool;
+        modelPool[vocabulary::OM::resolve("Sherpa")] = 2;
+        modelPool[vocabulary::OM::resolve("Payload")] = 2;
+        BOOST_REQUIRE_MESSAGE(filter->isPotentiallyFeasible(modelPool),
+                              "ModelPool: " << modelPool.toString());
+        feasible = Connectivity::isFeasible(
+            modelPool, ask, baseGraph, statistics, 30000);
+        BOOST_REQUIRE_MESSAGE(feasible && !statistics.pruned,
+                              "ModelPool: " << modelPool.toString());
+
+        StructuralFilter::Statistics filterStatistics =
+            filter->getStatistics();
+        BOOST_REQUIRE_MESSAGE(filterStatistics.checks == 4 &&
+                                  filterStatistics.getNumberOfRejections() ==
+                                      2,
+                              "Filter statistics: "
+                                  << filterStatistics.toString());
+    }
+
+    BOOST_AUTO_TEST_CASE(structural_filter_revision)
+    {
+        OrganizationModel::Ptr om(new OrganizationModel(
+            getRootDir() + "/test/data/om-multiple-interfaces.owl"));
+        OrganizationModelAsk multipleInterfacesAsk(om);
+        StructuralFilter::Ptr filter = StructuralFilter::getInstance(
+            multipleInterfacesAsk,
+            vocabulary::OM::resolve("ElectroMechanicalInterface"));
+
+        ModelPool modelPool;
+        modelPool[vocabulary::OM::resolve("RobotB")] = 1;
+        modelPool[vocabulary::OM::resolve("RobotC")] = 1;
+        BOOST_REQUIRE_MESSAGE(filter->check(modelPool) ==
+                                  StructuralFilter::NO_COMPATIBLE_PARTNER,
+                              "ModelPool: " << modelPool.toString());
+
+        owlapi::model::OWLOntologyTell tell(om->ontology());
+        tell.relatedTo(vocabulary::OM::resolve("InterfaceB"),
+                       vocabulary::OM::compatibleWith(),
+                       vocabulary::OM::resolve("InterfaceC"));
+        om->ontology()->refresh();
+        om->resetQueryCache();
+
+        BOOST_REQUIRE_MESSAGE(filter->check(modelPool) ==
+                                  StructuralFilter::NONE,
+                              "Compatibility should be recomputed for a new "
+                              "revision: "
+                                  << modelPool.toString());
+    }
+
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_CASE(subset_superset)
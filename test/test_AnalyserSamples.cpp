@@ -0,0 +1,219 @@
+#include "AnalyserFixture.hpp"
+#include <algorithm>
+#include <boost/test/unit_test.hpp>
+#include <iomanip>
+#include <limits>
+#include <moreorg/utils/IntervalIndex.hpp>
+#include <sstream>
+
+/**
+ * Read a value in native byte order, as written by the binary SampleWriter
+ */
+template <typename T> T read(std::istream& in)
+{
+    T value;
+    in.read(reinterpret_cast<char*>(&value), sizeof(T));
+    BOOST_REQUIRE_MESSAGE(in.good(), "Unexpected end of binary export");
+    return value;
+}
+
+BOOST_AUTO_TEST_SUITE(analyser_samples)
+
+BOOST_AUTO_TEST_CASE(interval_index)
+{
+    typedef std::pair<size_t, size_t> Interval;
+    std::vector<Interval> intervals;
+    for(size_t i = 0; i < 200; ++i)
+    {
+        size_t from = (i * 37) % 101;
+        intervals.push_back(Interval(from, from + (i * 13) % 29));
+    }
+
+    utils::IntervalIndex<size_t> index;
+    for(size_t i = 0; i < intervals.size(); ++i)
+    {
+        index.add(intervals[i].first, intervals[i].second, i);
+    }
+    BOOST_REQUIRE_THROW(index.at(0), std::runtime_error);
+    index.build();
+    BOOST_REQUIRE_EQUAL(index.size(), intervals.size());
+
+    for(size_t time = 0; time < 140; ++time)
+    {
+        std::vector<size_t> expected;
+        for(size_t i = 0; i < intervals.size(); ++i)
+        {
+            if(intervals[i].first <= time && time <= intervals[i].second)
+            {
+                expected.push_back(i);
+            }
+        }
+        BOOST_REQUIRE_MESSAGE(index.at(time) == expected,
+                              "Intervals containing time " << time);
+    }
+
+    BOOST_REQUIRE_THROW(index.add(2, 1, 0), std::invalid_argument);
+    index.clear();
+    BOOST_REQUIRE(index.at(0).empty());
+}
+
+BOOST_FIXTURE_TEST_CASE(sample_index, AnalyserFixture)
+{
+    StatusSample::ConstRawPtrList samples = analyser->statusSamplesAt(30);
+    BOOST_REQUIRE_MESSAGE(samples.size() == 2,
+                          "Expected 2 samples at time 30, got "
+                              << samples.size());
+    BOOST_REQUIRE(samples[0]->getAgent() == agents[0]);
+    BOOST_REQUIRE(samples[0]->getFromTime() == 26);
+    BOOST_REQUIRE(samples[1]->getAgent() == agents[1]);
+
+    BOOST_REQUIRE(analyser->statusSamplesAt(0).size() == 2);
+    BOOST_REQUIRE(analyser->statusSamplesAt(75).size() == 2);
+    BOOST_REQUIRE(analyser->statusSamplesAt(101).empty());
+
+    RequirementSample::ConstRawPtrList requirements =
+        analyser->requirementSamplesAt(25);
+    BOOST_REQUIRE_MESSAGE(requirements.size() == 2,
+                          "Expected 2 requirements at time 25, got "
+                              << requirements.size());
+    BOOST_REQUIRE(requirements[0]->getToTime() == 25);
+    BOOST_REQUIRE(requirements[1]->getToTime() == 100);
+    BOOST_REQUIRE(analyser->requirementSamplesAt(1000).empty());
+
+    for(const AtomicAgent& atomicAgent : atomicAgents)
+    {
+        const StatusSample::ConstRawPtrList& agentSamples =
+            analyser->statusSamplesFor(atomicAgent);
+        BOOST_REQUIRE(!agentSamples.empty());
+        for(size_t i = 1; i < agentSamples.size(); ++i)
+        {
+            BOOST_REQUIRE(agentSamples[i - 1]->getFromTime() <=
+                          agentSamples[i]->getFromTime());
+        }
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE(export_samples, AnalyserFixture)
+{
+    analyser->setSampleColumnsA(
+        {Analyser::A_EnergyReductionAbsolute,
+         Analyser::A_EnergyAvailableRelative});
+    analyser->setSampleColumnsO({Analyser::O_EnergyAvailableMinRelative});
+
+    std::stringstream csv;
+    io::SampleWriter::Ptr writer =
+        io::SampleWriter::getInstance(io::SampleWriter::CSV, csv);
+    analyser->exportSamplesO(*writer, 0, 100, 4, 16);
+
+    std::string line;
+    std::getline(csv, line);
+    BOOST_REQUIRE_MESSAGE(line == "time,EnergyAvailableMinRelative",
+                          "Unexpected header: " << line);
+    for(size_t time = 0; time <= 100; ++time)
+    {
+        BOOST_REQUIRE(std::getline(csv, line));
+        std::stringstream expected;
+        expected << std::setprecision(std::numeric_limits<double>::max_digits10)
+                 << time << "," << analyser->getSampleO(time)[0];
+        BOOST_REQUIRE_MESSAGE(line == expected.str(),
+                              "Expected '" << expected.str() << "', got '"
+                                           << line << "'");
+    }
+    BOOST_REQUIRE(!std::getline(csv, line));
+
+    std::stringstream binary;
+    writer = io::SampleWriter::getInstance(io::SampleWriter::BINARY, binary);
+    analyser->exportSamplesA(*writer, 0, 100, 4, 16);
+
+    auto readString = [&binary]() {
+        std::string s(read<uint32_t>(binary), ' ');
+        binary.read(&s[0], s.size());
+        return s;
+    };
+
+    BOOST_REQUIRE_EQUAL(read<uint32_t>(binary), 2u);
+    BOOST_REQUIRE_MESSAGE(read<uint8_t>(binary) == 1, "Rows are labelled");
+    BOOST_REQUIRE_EQUAL(readString(), "EnergyReductionAbsolute");
+    BOOST_REQUIRE_EQUAL(readString(), "EnergyAvailableRelative");
+
+    for(size_t blockTime = 0; blockTime <= 100; blockTime += 16)
+    {
+        size_t lastTime = std::min<size_t>(blockTime + 15, 100);
+        std::vector<size_t> times;
+        std::vector<Agent> rowAgents;
+        for(size_t time = blockTime; time <= lastTime; ++time)
+        {
+            for(const Agent& agent : analyser->getCoalitionStructure(time))
+            {
+                times.push_back(time);
+                rowAgents.push_back(agent);
+            }
+        }
+
+        size_t rows = read<uint64_t>(binary);
+        BOOST_REQUIRE_EQUAL(rows, times.size());
+        for(size_t row = 0; row < rows; ++row)
+        {
+            BOOST_REQUIRE_EQUAL(read<uint64_t>(binary), times[row]);
+        }
+        for(size_t row = 0; row < rows; ++row)
+        {
+            std::string label;
+            for(const AtomicAgent& atomicAgent :
+                rowAgents[row].getAtomicAgents())
+            {
+                label += (label.empty() ? "" : "+") + atomicAgent.getName();
+            }
+            BOOST_REQUIRE_EQUAL(readString(), label);
+        }
+
+        std::vector<std::vector<double>> expected;
+        for(size_t row = 0; row < rows; ++row)
+        {
+            expected.push_back(
+                analyser->getSampleA(times[row], rowAgents[row]));
+        }
+        for(size_t column = 0; column < 2; ++column)
+        {
+            for(size_t row = 0; row < rows; ++row)
+            {
+                double value = read<double>(binary);
+                BOOST_REQUIRE_MESSAGE(value == expected[row][column],
+                                      "Column " << column << " at time "
+                                                << times[row] << ": expected "
+                                                << expected[row][column]
+                                                << ", got " << value);
+            }
+        }
+    }
+    BOOST_REQUIRE(binary.peek() == std::char_traits<char>::eof());
+}
+
+BOOST_AUTO_TEST_CASE(csv_writer)
+{
+    std::stringstream csv;
+    csv << std::fixed << std::setprecision(3);
+
+    io::SampleWriter::Ptr writer =
+        io::SampleWriter::getInstance(io::SampleWriter::CSV, csv);
+    writer->writeHeader({"a", "b,c"}, true);
+
+    io::SampleBlock block;
+    block.times = {0, 1};
+    block.labels = {"x", "y,\"z\""};
+    block.values = {0.5, -1.25, 2, 0.1};
+    writer->writeBlock(block);
+
+    std::stringstream expected;
+    expected << std::setprecision(std::numeric_limits<double>::max_digits10)
+             << "time,label,a,\"b,c\"\n"
+             << "0,x,0.5,2\n"
+             << "1,\"y,\"\"z\"\"\",-1.25," << 0.1 << "\n";
+    BOOST_REQUIRE_EQUAL(csv.str(), expected.str());
+
+    BOOST_REQUIRE_MESSAGE(csv.precision() == 3 &&
+                              (csv.flags() & std::ios_base::fixed),
+                          "Format of the stream should be restored");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -370,6 +370,82 @@ BOOST_AUTO_TEST_CASE(resource_instance_matching)
     }
 }
 
+BOOST_AUTO_TEST_CASE(disjoint_resource_instance_matching)
+{
+    using namespace moreorg::reasoning;
+
+    OrganizationModel::Ptr om = make_shared<OrganizationModel>(
+        getRootDir() + "/test/data/om-project-transterra.owl");
+    OrganizationModelAsk ask(om);
+
+    IRI sherpa = moreorg::vocabulary::OM::resolve("Sherpa");
+    IRI move_to = moreorg::vocabulary::OM::resolve("MoveTo");
+
+    Agent agent;
+    for(size_t i = 0; i < 3; ++i)
+    {
+        agent.add(AtomicAgent(i, sherpa));
+    }
+
+    std::vector<OWLCardinalityRestriction::Ptr> required =
+        ask.ontology().getCardinalityRestrictions(move_to);
+    ModelBound::List requiredModelBound =
+        ResourceInstanceMatch::toModelBoundList(required);
+    ResourceInstance::List available = ask.getRelated(agent);
+
+    // Reference: repeatedly solve and remove the assigned instances
+    uint32_t expectedCount = 0;
+    std::map<ModelBound, ResourceInstance::List> expectedAssignments;
+    ResourceInstance::List remaining = available;
+    try
+    {
+        while(true)
+        {
+            ResourceInstanceMatch::Solution solution =
+                ResourceInstanceMatch::solve(requiredModelBound,
+                                             remaining,
+                                             ask);
+            ++expectedCount;
+            for(const ModelBound& model : requiredModelBound)
+            {
+                ResourceInstance::List assignments =
+                    solution.getAssignments(model.model);
+                expectedAssignments[model].insert(
+                    expectedAssignments[model].end(),
+                    assignments.begin(),
+                    assignments.end());
+            }
+            remaining = solution.removeAssignmentsFromList(remaining);
+        }
+    } catch(const std::exception& e)
+    {
+    }
+
+    DisjointResourceMatch::Result result =
+        DisjointResourceMatch::solve(requiredModelBound, available, ask);
+    BOOST_REQUIRE_MESSAGE(result.numberOfAssignments == expectedCount,
+                          "Expected " << expectedCount
+                                      << " full assignments, got "
+                                      << result.numberOfAssignments);
+    BOOST_REQUIRE(expectedCount >= 1);
+    BOOST_REQUIRE(result.remaining.size() == remaining.size());
+    for(size_t i = 0; i < remaining.size(); ++i)
+    {
+        BOOST_REQUIRE(result.remaining[i].getName() ==
+                      remaining[i].getName());
+    }
+    for(const ModelBound& model : requiredModelBound)
+    {
+        const ResourceInstance::List& assignments = result.assignments[model];
+        const ResourceInstance::List& expected = expectedAssignments[model];
+        BOOST_REQUIRE(assignments.size() == expected.size());
+        for(size_t i = 0; i < expected.size(); ++i)
+        {
+            BOOST_REQUIRE(assignments[i].getName() == expected[i].getName());
+        }
+    }
+}
+
 BOOST_AUTO_TEST_CASE(performance_three_sherpa)
 {
     OWLOntology::Ptr ontology = io::OWLOntologyIO::fromFile(
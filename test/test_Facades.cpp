@@ -1,9 +1,12 @@
 #include "test_utils.hpp"
+#include <atomic>
 #include <boost/test/unit_test.hpp>
 #include <moreorg/OrganizationModelAsk.hpp>
 #include <moreorg/facades/Robot.hpp>
+#include <moreorg/facades/RobotCache.hpp>
 #include <moreorg/policies/DistributionPolicy.hpp>
 #include <moreorg/policies/SelectionPolicy.hpp>
+#include <moreorg/utils/Parallel.hpp>
 #include <moreorg/vocabularies/OM.hpp>
 #include <moreorg/vocabularies/Robot.hpp>
 
@@ -298,4 +301,104 @@ BOOST_AUTO_TEST_CASE(derived_property)
     }
 }
 
+BOOST_AUTO_TEST_CASE(robot_cache)
+{
+    using namespace owlapi::model;
+
+    OrganizationModel::Ptr om(new OrganizationModel(getOMSchema()));
+    IRI sherpa = vocabulary::OM::resolve("Sherpa");
+    IRI payload = vocabulary::OM::resolve("Payload");
+
+    ModelPool modelPool;
+    modelPool[sherpa] = 2;
+    modelPool[payload] = 3;
+
+    OrganizationModelAsk ask(om, modelPool, true);
+    moreorg::facades::Robot sherpaRobot =
+        moreorg::facades::Robot::getInstance(sherpa, ask);
+    moreorg::facades::Robot payloadRobot =
+        moreorg::facades::Robot::getInstance(payload, ask);
+    moreorg::facades::Robot robot =
+        moreorg::facades::Robot::getInstance(modelPool, ask);
+    size_t numberOfEntries = ask.getRobotCache().size();
+    BOOST_REQUIRE_MESSAGE(numberOfEntries >= 3,
+                          "Cache contains atomic and composite entries");
+    moreorg::facades::Robot::getInstance(modelPool, ask);
+    BOOST_REQUIRE_MESSAGE(ask.getRobotCache().size() == numberOfEntries,
+                          "Cached entry is reused");
+
+    BOOST_REQUIRE_CLOSE(robot.getMass(),
+                        2 * sherpaRobot.getMass() + 3 * payloadRobot.getMass(),
+                        1e-6);
+    BOOST_REQUIRE_CLOSE(robot.getNominalVelocity(),
+                        std::max(sherpaRobot.getNominalVelocity(),
+                                 payloadRobot.getNominalVelocity()),
+                        1e-6);
+
+    // Concurrent access results in the same values
+    std::vector<double> masses(16);
+    OrganizationModelAsk askCopy(om, modelPool, true);
+    moreorg::utils::Parallel::forEach(
+        masses.size(),
+        [&masses, &askCopy, &modelPool](size_t i) {
+            masses[i] =
+                moreorg::facades::Robot::getInstance(modelPool, askCopy)
+                    .getMass();
+        },
+        4);
+    for(double mass : masses)
+    {
+        BOOST_REQUIRE_CLOSE(mass, robot.getMass(), 1e-6);
+    }
+
+    // The cache is scoped to the ask and shared between copies
+    BOOST_REQUIRE(askCopy.getRobotCache().size() >= 3);
+    OrganizationModelAsk sharingAsk = ask;
+    BOOST_REQUIRE(&sharingAsk.getRobotCache() == &ask.getRobotCache());
+    BOOST_REQUIRE(&askCopy.getRobotCache() != &ask.getRobotCache());
+
+    // Concurrent misses create an entry only once, and a failed creation can
+    // be retried
+    moreorg::facades::RobotCache cache(om);
+    std::atomic<size_t> creations(0);
+    std::vector<moreorg::facades::RobotCache::EntryPtr> entries(16);
+    moreorg::utils::Parallel::forEach(
+        entries.size(),
+        [&cache, &creations, &entries, &sherpa](size_t i) {
+            entries[i] = cache.getAtomicEntry(sherpa, [&creations]() {
+                ++creations;
+                return make_shared<moreorg::facades::RobotCache::Entry>();
+            });
+        },
+        4);
+    BOOST_REQUIRE_EQUAL(creations.load(), 1u);
+    for(const moreorg::facades::RobotCache::EntryPtr& entry : entries)
+    {
+        BOOST_REQUIRE(entry == entries.front());
+    }
+
+    BOOST_REQUIRE_THROW(
+        cache.getCompositeEntry(
+            modelPool,
+            []() -> moreorg::facades::RobotCache::EntryPtr {
+                throw std::runtime_error("creation failed");
+            }),
+        std::runtime_error);
+    BOOST_REQUIRE(cache.getCompositeEntry(modelPool, []() {
+        return make_shared<moreorg::facades::RobotCache::Entry>();
+    }));
+    BOOST_REQUIRE_EQUAL(cache.size(), 2u);
+
+    // Entries are recreated for a new revision of the organization model
+    om->resetQueryCache();
+    moreorg::facades::RobotCache::EntryPtr entry =
+        cache.getAtomicEntry(sherpa, [&creations]() {
+            ++creations;
+            return make_shared<moreorg::facades::RobotCache::Entry>();
+        });
+    BOOST_REQUIRE_EQUAL(creations.load(), 2u);
+    BOOST_REQUIRE(entry != entries.front());
+    BOOST_REQUIRE_EQUAL(cache.size(), 1u);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -137,6 +137,45 @@ BOOST_FIXTURE_TEST_CASE(energy, HeuristicsFixture)
     }
 }
 
+BOOST_FIXTURE_TEST_CASE(sample_estimates, HeuristicsFixture)
+{
+    Heuristics::SampleEstimates estimates =
+        heuristics->computeEstimates(statusSamples);
+    BOOST_REQUIRE(estimates.size() == statusSamples.size());
+
+    for(size_t id = 0; id < statusSamples.size(); ++id)
+    {
+        const StatusSample* s = &statusSamples[id];
+        BOOST_REQUIRE_CLOSE(estimates.travelTime[id],
+                            heuristics->travelTime(s),
+                            1E-06);
+        BOOST_REQUIRE_CLOSE(estimates.waitTime[id],
+                            heuristics->waitTime(s),
+                            1E-06);
+        BOOST_REQUIRE_CLOSE(estimates.energyConsumption[id],
+                            heuristics->getEnergyConsumption(s),
+                            1E-06);
+
+        for(const AtomicAgent& aa : s->getAgent().getAtomicAgents())
+        {
+            double energyReduction =
+                heuristics->getEnergyReductionAbsolute(s,
+                                                       aa,
+                                                       s->getFromTime(),
+                                                       s->getToTime());
+            BOOST_REQUIRE_CLOSE(
+                estimates.getEnergyReduction(id, aa.getModel()),
+                energyReduction,
+                1E-06);
+        }
+    }
+
+    // Estimates are indexed by id, and thus remain valid for a copy
+    StatusSample::List copiedSamples = statusSamples;
+    BOOST_REQUIRE(heuristics->computeEstimates(copiedSamples).travelTime ==
+                  estimates.travelTime);
+}
+
 BOOST_FIXTURE_TEST_CASE(reconfiguration_cost, HeuristicsFixture)
 {
     AtomicAgent::List availableAgents(atomicAgents.begin(), atomicAgents.end());
@@ -96,6 +96,51 @@ BOOST_AUTO_TEST_CASE(infer_energyCapacity_composite)
                               << value << " expected >480");
 }
 
+BOOST_AUTO_TEST_CASE(infer_batch)
+{
+    OrganizationModel::Ptr om = make_shared<OrganizationModel>(getOMSchema());
+    IRI sherpa = vocabulary::OM::resolve("Sherpa");
+    IRI payload = vocabulary::OM::resolve("Payload");
+    IRI crex = vocabulary::OM::resolve("CREX");
+
+    ModelPool modelPool;
+    modelPool[sherpa] = 2;
+    modelPool[payload] = 2;
+    modelPool[crex] = 1;
+    OrganizationModelAsk ask(om, modelPool, true);
+
+    InferenceRule::Ptr r = InferenceRule::loadPropertyAtomicAgentRule(
+        vocabulary::OM::resolve("energyCapacity"),
+        ask);
+
+    ModelPool::List agentTypes;
+    for(const IRI& model : {sherpa, payload, crex, sherpa})
+    {
+        ModelPool agentType;
+        agentType[model] = 1;
+        agentTypes.push_back(agentType);
+    }
+
+    std::vector<double> values = r->applyAll(agentTypes);
+    BOOST_REQUIRE_EQUAL(values.size(), agentTypes.size());
+    for(size_t i = 0; i < agentTypes.size(); ++i)
+    {
+        facades::Robot robot = facades::Robot::getInstance(agentTypes[i], ask);
+        double value = r->apply(robot);
+        BOOST_REQUIRE_MESSAGE(values[i] == value,
+                              "Batch evaluation for "
+                                  << agentTypes[i].toString() << ": "
+                                  << values[i] << " expected " << value);
+    }
+    BOOST_REQUIRE_MESSAGE(values[0] == 480,
+                          "Sherpa has energyCapacity of " << values[0]
+                                                          << " expected 480");
+
+    ModelPool::List compositeAgentTypes;
+    compositeAgentTypes.push_back(modelPool);
+    BOOST_REQUIRE_THROW(r->applyAll(compositeAgentTypes), std::runtime_error);
+}
+
 BOOST_AUTO_TEST_CASE(infer_energyCapacity)
 {
     OrganizationModel::Ptr om = make_shared<OrganizationModel>(getOMSchema());
@@ -53,10 +53,12 @@ BOOST_AUTO_TEST_CASE(list)
     for(size_t i = 0; i < epochs; ++i)
     {
         BaseGraph::Ptr baseGraph;
+        algebra::Connectivity::Statistics statistics;
         bool feasible = algebra::Connectivity::isFeasible(
             modelPool,
             ask,
             baseGraph,
+            statistics,
             0,
             minFeasible,
             moreorg::vocabulary::OM::resolve("MechanicalInterface"));
@@ -71,7 +73,7 @@ BOOST_AUTO_TEST_CASE(list)
 
             graph_analysis::io::GraphIO::write(ss.str(), baseGraph);
         }
-        BOOST_TEST_MESSAGE(algebra::Connectivity::getStatistics().toString());
+        BOOST_TEST_MESSAGE(statistics.toString());
         usleep(200);
     }
 }
@@ -98,10 +100,12 @@ BOOST_AUTO_TEST_CASE(icaps)
     for(size_t i = 0; i < epochs; ++i)
     {
         BaseGraph::Ptr baseGraph;
+        algebra::Connectivity::Statistics statistics;
         bool feasible = algebra::Connectivity::isFeasible(
             modelPool,
             ask,
             baseGraph,
+            statistics,
             0,
             minFeasible,
             moreorg::vocabulary::OM::resolve("MechanicalInterface"));
@@ -116,7 +120,7 @@ BOOST_AUTO_TEST_CASE(icaps)
 
             graph_analysis::io::GraphIO::write(ss.str(), baseGraph);
         }
-        BOOST_TEST_MESSAGE(algebra::Connectivity::getStatistics().toString());
+        BOOST_TEST_MESSAGE(statistics.toString());
         usleep(200);
     }
 }
@@ -3,9 +3,13 @@
 
 #include <moreorg/Agent.hpp>
 #include <moreorg/OrganizationModel.hpp>
+#include <moreorg/metrics/MonteCarloSurvivability.hpp>
+#include <moreorg/metrics/ProbabilityDensityFunctionTable.hpp>
 #include <moreorg/metrics/ProbabilityOfFailure.hpp>
 #include <moreorg/metrics/Redundancy.hpp>
 #include <moreorg/metrics/pdfs/ConstantPDF.hpp>
+#include <moreorg/metrics/pdfs/ExponentialPDF.hpp>
+#include <moreorg/metrics/pdfs/WeibullPDF.hpp>
 #include <moreorg/reasoning/ModelBound.hpp>
 #include <moreorg/vocabularies/OM.hpp>
 #include <moreorg/vocabularies/OMBase.hpp>
@@ -66,6 +70,7 @@ struct RedundancyFixture
         tell.relatedTo(agent_c, has, IRI("http://klass/base#class_c_0"));
 
         om->ontology()->refresh();
+        om->resetQueryCache();
     }
 
     IRI has;
@@ -363,6 +368,172 @@ BOOST_AUTO_TEST_CASE(probability_density_function)
         << weibull_pdf_ptr->getConditional());
 }
 
+BOOST_AUTO_TEST_CASE(probability_density_function_table)
+{
+    using namespace metrics;
+    std::string filename =
+        getRootDir() + "/test/data/om-project-transterra.owl";
+    OrganizationModel::Ptr om = make_shared<OrganizationModel>(filename);
+
+    ProbabilityDensityFunctionTable::Ptr table =
+        ProbabilityDensityFunctionTable::getInstance(om);
+    BOOST_REQUIRE_MESSAGE(table ==
+                              ProbabilityDensityFunctionTable::getInstance(om),
+                          "Table is shared per organization model");
+
+    IRI camera("http://www.rock-robotics.org/2015/12/robots/"
+               "Sherpa#Sherpa_Camera_Front");
+    ProbabilityDensityFunction::Ptr pdf =
+        table->getProbabilityDensityFunction(camera);
+    BOOST_REQUIRE_MESSAGE(pdf, "Probability density function is available");
+    BOOST_REQUIRE_MESSAGE(table->getProbabilityDensityFunction(camera) == pdf,
+                          "Probability density function is cached");
+
+    OrganizationModelAsk ask(om);
+    BOOST_REQUIRE(ProbabilityDensityFunction::getInstance(ask, camera) == pdf);
+
+    IRI unknown("http://klass/base#unknown");
+    BOOST_REQUIRE_MESSAGE(!table->getProbabilityDensityFunction(unknown),
+                          "Model without pdf is marked");
+    BOOST_REQUIRE(table->size() == 2);
+    BOOST_REQUIRE_THROW(ProbabilityDensityFunction::getInstance(ask, unknown),
+                        std::invalid_argument);
+
+    om->resetQueryCache();
+    BOOST_REQUIRE_MESSAGE(table->getProbabilityDensityFunction(camera) != pdf,
+                          "Table is cleared after a change of the revision");
+    BOOST_REQUIRE(table->size() == 1);
+}
+
+BOOST_AUTO_TEST_CASE(probability_density_function_conditionals)
+{
+    using namespace metrics;
+    std::vector<ProbabilityDensityFunction::Ptr> pdfs = {
+        make_shared<pdfs::ConstantPDF>(0.3),
+        make_shared<pdfs::ExponentialPDF>(1E-04),
+        make_shared<pdfs::WeibullPDF>(36000., 1.5)};
+
+    double t0 = 100.;
+    std::vector<double> t1;
+    for(size_t i = 0; i < 200; ++i)
+    {
+        t1.push_back(t0 + i * 500.);
+    }
+
+    for(const ProbabilityDensityFunction::Ptr& pdf : pdfs)
+    {
+        std::vector<double> values;
+        pdf->getConditionals(t0, t1, values);
+        BOOST_REQUIRE(values.size() == t1.size());
+        for(size_t i = 0; i < t1.size(); ++i)
+        {
+            BOOST_REQUIRE_CLOSE(values[i],
+                                pdf->getConditional(t0, t1[i]),
+                                1E-10);
+        }
+    }
+
+    std::vector<double> values;
+    BOOST_REQUIRE_THROW(pdfs.back()->getConditionals(t0, {0., t0}, values),
+                        std::invalid_argument);
+}
+
+BOOST_FIXTURE_TEST_CASE(survival_curve, RedundancyFixture)
+{
+    using namespace metrics;
+    // query =1.has.A and =1.has.C
+    std::vector<OWLCardinalityRestriction::Ptr> query;
+    query.push_back(make_shared<OWLObjectExactCardinality>(property, 1, a));
+    query.push_back(make_shared<OWLObjectExactCardinality>(property, 1, c));
+
+    Agent agent;
+    AtomicAgent a0(0, agent_a);
+    AtomicAgent b0(0, agent_b);
+    AtomicAgent c0(0, agent_c);
+    AtomicAgent c1(1, agent_c);
+    agent.add(a0);
+    agent.add(b0);
+    agent.add(c0);
+    agent.add(c1);
+
+    OrganizationModelAsk ask(om);
+    ResourceInstance::List available = ask.getRelated(agent);
+    Redundancy redundancy(ask, make_shared<pdfs::WeibullPDF>(36000., 1.), has);
+
+    std::vector<double> times;
+    for(size_t i = 0; i <= 20; ++i)
+    {
+        times.push_back(i * 3600.);
+    }
+    std::vector<double> curve =
+        redundancy.computeSurvivalCurve(query, available, 0., times);
+    BOOST_REQUIRE(curve.size() == times.size());
+    for(size_t i = 0; i < times.size(); ++i)
+    {
+        double value = redundancy.computeMetric(query, available, 0., times[i]);
+        BOOST_REQUIRE_CLOSE(curve[i], value, 1E-10);
+        if(i > 0)
+        {
+            BOOST_REQUIRE_MESSAGE(curve[i] <= curve[i - 1],
+                                  "Survival does not increase over time");
+        }
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE(monte_carlo_survivability, RedundancyFixture)
+{
+    using namespace metrics;
+    // query =1.has.A
+    std::vector<OWLCardinalityRestriction::Ptr> query;
+    query.push_back(make_shared<OWLObjectExactCardinality>(property, 1, a));
+
+    // available: A, B and C, where B and C are subclasses of A
+    Agent agent;
+    agent.add(AtomicAgent(0, agent_a));
+    agent.add(AtomicAgent(0, agent_b));
+    agent.add(AtomicAgent(0, agent_c));
+
+    OrganizationModelAsk ask(om);
+    MonteCarloSurvivability survivability(ask,
+                                          make_shared<pdfs::ConstantPDF>(0.5),
+                                          4,
+                                          1000);
+    MonteCarloSurvivability::Result result =
+        survivability.compute(query, agent, 100000);
+    BOOST_TEST_MESSAGE(result.toString());
+
+    // Parallel system of three components: 1 - 0.5^3
+    double expected = 0.875;
+    BOOST_REQUIRE(result.numberOfSamples == 100000);
+    BOOST_REQUIRE_MESSAGE(result.lowerBound <= expected &&
+                              expected <= result.upperBound,
+                          "Confidence interval contains " << expected << ": "
+                                                          << result.toString());
+    BOOST_REQUIRE_SMALL(result.probabilityOfSurvival - expected, 0.01);
+
+    MonteCarloSurvivability serial(ask,
+                                   make_shared<pdfs::ConstantPDF>(0.5),
+                                   1,
+                                   1000);
+    BOOST_REQUIRE_MESSAGE(
+        serial.compute(query, agent, 100000).numberOfSurvivals ==
+            result.numberOfSurvivals,
+        "Result does not depend on the number of threads");
+
+    serial.setSeed(42);
+    BOOST_REQUIRE_MESSAGE(
+        serial.compute(query, agent, 100000).numberOfSurvivals ==
+            serial.compute(query, agent, 100000).numberOfSurvivals,
+        "Result is reproducible for a given seed");
+
+    // query =4.has.A cannot be fulfilled
+    std::vector<OWLCardinalityRestriction::Ptr> unfulfilled;
+    unfulfilled.push_back(
+        make_shared<OWLObjectExactCardinality>(property, 4, a));
+    BOOST_REQUIRE(
+        survivability.compute(unfulfilled, agent, 1000).numberOfSurvivals == 0);
+}
+
 BOOST_FIXTURE_TEST_CASE(probability_of_failure, RedundancyFixture)
 {
     using namespace metrics;
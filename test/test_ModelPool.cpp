@@ -1,7 +1,11 @@
+#include <algorithm>
 #include <boost/test/unit_test.hpp>
 #include <moreorg/Algebra.hpp>
+#include <moreorg/CompactModelPool.hpp>
 #include <moreorg/ModelPool.hpp>
+#include <moreorg/ModelPoolCombinationIterator.hpp>
 #include <moreorg/ModelPoolIterator.hpp>
+#include <moreorg/utils/Parallel.hpp>
 #include <moreorg/vocabularies/OM.hpp>
 
 using namespace moreorg;
@@ -105,6 +109,88 @@ BOOST_AUTO_TEST_CASE(iterator)
     }
 }
 
+BOOST_AUTO_TEST_CASE(combination_iterator)
+{
+    ModelPool bound;
+    bound["a"] = 2;
+    bound["b"] = 1;
+    bound["c"] = 3;
+    bound["d"] = 0;
+
+    {
+        // 3*2*4 - 1 (empty combination)
+        ModelPoolCombinationIterator iterator(bound);
+        BOOST_REQUIRE_EQUAL(iterator.numberOfCombinations(), 23);
+
+        ModelPool::Set combinations;
+        size_t lastSize = 0;
+        while(iterator.next())
+        {
+            const ModelPool& pool = iterator.current();
+            BOOST_TEST_MESSAGE(pool.toString());
+            BOOST_REQUIRE_MESSAGE(pool.count("d") == 0,
+                                  "Zero cardinalities are not part of a "
+                                  "combination");
+            BOOST_REQUIRE_EQUAL(pool.numberOfInstances(), iterator.getSize());
+            BOOST_REQUIRE_MESSAGE(lastSize <= iterator.getSize(),
+                                  "Combinations are ordered by size");
+            lastSize = iterator.getSize();
+            BOOST_REQUIRE_MESSAGE(combinations.insert(pool).second,
+                                  "Combination " << pool.toString()
+                                                 << " is unique");
+        }
+        BOOST_REQUIRE_EQUAL(combinations.size(), 23);
+        BOOST_REQUIRE_MESSAGE(combinations == bound.allCombinations(),
+                              "Same combinations as allCombinations");
+    }
+
+    {
+        ModelPoolCombinationIterator iterator(bound, 2);
+        ModelPool::Set combinations;
+        while(iterator.next())
+        {
+            combinations.insert(iterator.current());
+        }
+        // size 1: 3, size 2: a2, ab, ac, bc, c2
+        BOOST_REQUIRE_EQUAL(combinations.size(), 8);
+        BOOST_REQUIRE_EQUAL(iterator.numberOfCombinations(), 8);
+        BOOST_REQUIRE_MESSAGE(combinations == bound.allCombinations(2),
+                              "Same bounded combinations as allCombinations");
+    }
+
+    {
+        // Resume from a cursor and consume in chunks
+        ModelPoolCombinationIterator iterator(bound);
+        ModelPool::List expected;
+        while(iterator.next())
+        {
+            expected.push_back(iterator.current());
+        }
+
+        iterator.reset();
+        for(size_t i = 0; i < 5; ++i)
+        {
+            BOOST_REQUIRE(iterator.next());
+        }
+        ModelPoolCombinationIterator::Cursor cursor = iterator.getCursor();
+
+        ModelPoolCombinationIterator resumed(bound);
+        resumed.setCursor(cursor);
+        BOOST_REQUIRE_MESSAGE(resumed.current() == expected[4],
+                              "Resumed iterator at the stored position");
+
+        ModelPool::List all(expected.begin(), expected.begin() + 5);
+        ModelPool::List chunk;
+        while(resumed.nextChunk(chunk, 4))
+        {
+            BOOST_REQUIRE(chunk.size() <= 4);
+            all.insert(all.end(), chunk.begin(), chunk.end());
+        }
+        BOOST_REQUIRE_MESSAGE(all == expected,
+                              "Chunked iteration yields the canonical order");
+    }
+}
+
 BOOST_AUTO_TEST_CASE(apply_upper_bound)
 {
     using namespace owlapi::vocabulary;
@@ -161,4 +247,75 @@ BOOST_AUTO_TEST_CASE(apply_upper_bound)
     }
 }
 
+BOOST_AUTO_TEST_CASE(compact_model_pool)
+{
+    ModelRegistry registry;
+
+    ModelPool a;
+    a["http://model#a"] = 1;
+    a["http://model#b"] = 4;
+
+    ModelPool b;
+    b["http://model#a"] = 2;
+    b["http://model#b"] = 4;
+    b["http://model#c"] = 1;
+
+    CompactModelPool compactA(a, registry);
+    CompactModelPool compactB(b, registry);
+
+    BOOST_REQUIRE_MESSAGE(registry.size() == 3,
+                          "Registry contains 3 models, but was "
+                              << registry.size());
+    BOOST_REQUIRE_MESSAGE(compactA.toModelPool(registry) == a,
+                          "Conversion is lossless");
+
+    // Concurrent lookups and registrations agree on the ids
+    std::vector<ModelRegistry::Id> ids(64);
+    utils::Parallel::forEach(
+        ids.size(),
+        [&registry, &ids](size_t i) {
+            registry.getId("http://model#" + std::to_string(i % 8));
+            ids[i] = registry.getId("http://model#a");
+        },
+        4);
+    ModelRegistry::Id idA = 0;
+    BOOST_REQUIRE(registry.findId("http://model#a", idA));
+    BOOST_REQUIRE(std::count(ids.begin(), ids.end(), idA) == 64);
+    BOOST_REQUIRE_MESSAGE(registry.size() == 11,
+                          "Registry contains 11 models, but was "
+                              << registry.size());
+    BOOST_REQUIRE_MESSAGE(compactA.numberOfInstances() ==
+                              a.numberOfInstances(),
+                          "Number of instances matches");
+
+    BOOST_REQUIRE_MESSAGE(CompactModelPool::isSubset(compactA, compactB) ==
+                              Algebra::isSubset(a, b),
+                          "Subset check matches");
+    BOOST_REQUIRE_MESSAGE(CompactModelPool::isSubset(compactB, compactA) ==
+                              Algebra::isSubset(b, a),
+                          "Superset check matches");
+    BOOST_REQUIRE_MESSAGE(
+        CompactModelPool::max(compactA, compactB).toModelPool(registry) ==
+            Algebra::max(a, b),
+        "Max matches");
+    BOOST_REQUIRE_MESSAGE(
+        CompactModelPool::min(compactA, compactB).toModelPool(registry) ==
+            Algebra::min(a, b),
+        "Min matches");
+    BOOST_REQUIRE_MESSAGE(
+        compactB.applyUpperBound(compactA).toModelPool(registry) ==
+            b.applyUpperBound(a),
+        "Upper bound matches");
+    BOOST_REQUIRE_MESSAGE(compactB.isWithinUpperBound(compactA) ==
+                              b.isWithinUpperBound(a),
+                          "Upper bound check matches");
+
+    CompactModelPool other(b, registry);
+    BOOST_REQUIRE_MESSAGE(other == compactB && other.hash() == compactB.hash(),
+                          "Equal pools have equal hashes");
+    other.setResourceCount(registry.getId("http://model#c"), 0);
+    BOOST_REQUIRE_MESSAGE(other.compact().size() == 2,
+                          "Compact removes zero cardinalities");
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -1,13 +1,17 @@
 #include "test_utils.hpp"
 #include <boost/test/unit_test.hpp>
 
+#include <moreorg/FunctionalityMappingCache.hpp>
 #include <moreorg/OrganizationModel.hpp>
 #include <moreorg/OrganizationModelAsk.hpp>
+#include <moreorg/QueryCache.hpp>
 #include <moreorg/exporter/PDDLExporter.hpp>
 #include <moreorg/metrics/Redundancy.hpp>
+#include <moreorg/utils/Parallel.hpp>
 #include <moreorg/vocabularies/OM.hpp>
 #include <numeric/Combinatorics.hpp>
 #include <owlapi/io/OWLOntologyIO.hpp>
+#include <owlapi/model/OWLOntologyTell.hpp>
 
 using namespace moreorg;
 using namespace moreorg::vocabulary;
@@ -79,6 +83,168 @@ BOOST_AUTO_TEST_CASE(function_combination_mapping)
                           "Saturation bound loaded" << fmLoaded.toString());
 }
 
+BOOST_AUTO_TEST_CASE(functionality_mapping_cache)
+{
+    using namespace owlapi::model;
+
+    ModelPool items;
+    items[OM::resolve("Sherpa")] = 2;
+    items[OM::resolve("CREX")] = 1;
+
+    ModelPool bound;
+    bound[OM::resolve("Sherpa")] = 1;
+    bound[OM::resolve("CREX")] = 1;
+
+    IRIList functionalities;
+    functionalities.push_back(OM::resolve("TransportProvider"));
+    functionalities.push_back(OM::resolve("ImageProvider"));
+
+    FunctionalityMapping fm(items, functionalities, bound);
+    ModelPool sherpa;
+    sherpa[OM::resolve("Sherpa")] = 1;
+    fm.add(sherpa, functionalities);
+    fm.add(bound, OM::resolve("ImageProvider"));
+
+    FunctionalityMappingCache cache(
+        "/tmp/test-moreorg-functionality-mapping-cache");
+    FunctionalityMappingCache::Key key;
+    key.ontology = IRI("http://www.rock-robotics.org/2014/01/om-schema");
+    key.contentHash = 42;
+    key.modelPool = items;
+    cache.store(key, fm);
+
+    FunctionalityMapping fmLoaded;
+    BOOST_REQUIRE_MESSAGE(cache.load(key, fmLoaded),
+                          "Mapping loaded from " << cache.getFilename(key));
+    BOOST_REQUIRE_MESSAGE(fmLoaded.getModelPool() == items,
+                          "Loaded model has all resources "
+                              << fmLoaded.toString());
+    BOOST_REQUIRE_MESSAGE(fmLoaded.getFunctionalSaturationBound() == bound,
+                          "Saturation bound loaded " << fmLoaded.toString());
+    BOOST_REQUIRE_MESSAGE(fmLoaded.getCache() == fm.getCache(),
+                          "Loaded mapping " << fmLoaded.toString()
+                                            << " expected " << fm.toString());
+
+    FunctionalityMappingCache::Key otherKey = key;
+    otherKey.contentHash = 43;
+    BOOST_REQUIRE_MESSAGE(!cache.load(otherKey, fmLoaded),
+                          "Mapping for different ontology content not loaded");
+
+    otherKey = key;
+    otherKey.applyFunctionalSaturationBound = true;
+    BOOST_REQUIRE_MESSAGE(
+        !FunctionalityMappingCache::read(cache.getFilename(key),
+                                         otherKey,
+                                         fmLoaded),
+        "Stale cache file is not reused");
+}
+
+BOOST_AUTO_TEST_CASE(content_hash)
+{
+    OrganizationModel::Ptr om = make_shared<OrganizationModel>(getOMSchema());
+    BOOST_REQUIRE_MESSAGE(om->getContentHash() != 0,
+                          "Loaded ontology has a content hash");
+    BOOST_REQUIRE_MESSAGE(!om->isModified(),
+                          "Loaded ontology is not modified");
+
+    OrganizationModel::Ptr copy = make_shared<OrganizationModel>(om->copy());
+    BOOST_REQUIRE_MESSAGE(copy->getContentHash() == 0 && copy->isModified(),
+                          "Copy is not identified with the loaded ontology");
+
+    OrganizationModelAsk ask(om, ModelPool(), false);
+    uint64_t ontologyContentHash = ask.getOntologyContentHash();
+    om->resetQueryCache();
+    BOOST_REQUIRE_MESSAGE(ask.getOntologyContentHash() != ontologyContentHash,
+                          "Content hash depends on the revision");
+
+    owlapi::model::OWLOntologyTell tell(om->ontology());
+    tell.klass(owlapi::model::IRI("http://klass/base#class"));
+    BOOST_REQUIRE_MESSAGE(om->isModified(),
+                          "Ontology is modified after adding a class");
+}
+
+BOOST_AUTO_TEST_CASE(query_cache)
+{
+    ModelRegistry::Ptr registry = make_shared<ModelRegistry>();
+    QueryCache cache(registry, 0 /*unbounded*/, 4);
+
+    Resource::Set resources;
+    resources.insert(Resource(OM::resolve("StereoImageProvider")));
+
+    ModelPool modelPool;
+    modelPool[OM::resolve("Sherpa")] = 2;
+    modelPool[OM::resolve("Payload")] = 1;
+
+    ModelPool::List structure;
+    structure.push_back(modelPool);
+
+    BOOST_REQUIRE_MESSAGE(!cache.getCachedResult(modelPool, resources).second,
+                          "Empty cache should not contain result");
+    cache.cacheResult(modelPool, resources, structure);
+
+    std::pair<ModelPool::List, bool> result =
+        cache.getCachedResult(modelPool, resources);
+    BOOST_REQUIRE_MESSAGE(result.second && result.first == structure,
+                          "Cached result should be retrieved");
+
+    QueryCache::Statistics statistics = cache.getStatistics();
+    BOOST_REQUIRE_MESSAGE(statistics.hits == 1 && statistics.misses == 1 &&
+                              statistics.size == 1 && statistics.bytes > 0,
+                          "Cache statistics: " << statistics.toString());
+
+    // Concurrent access
+    utils::Parallel::forEach(
+        64,
+        [&cache, &resources](size_t i) {
+            ModelPool pool;
+            pool[OM::resolve("Payload")] = i + 1;
+            cache.cacheResult(pool, resources, ModelPool::List(1, pool));
+            std::pair<ModelPool::List, bool> result =
+                cache.getCachedResult(pool, resources);
+            if(!result.second || result.first.front() != pool)
+            {
+                throw std::runtime_error("cached result missing");
+            }
+        },
+        4);
+    statistics = cache.getStatistics();
+    BOOST_REQUIRE_MESSAGE(statistics.size == 65 && statistics.evictions == 0,
+                          "Unbounded cache: " << statistics.toString());
+
+    cache.clear();
+    statistics = cache.getStatistics();
+    BOOST_REQUIRE_MESSAGE(statistics.size == 0 && statistics.bytes == 0 &&
+                              statistics.hits == 65,
+                          "Cleared cache: " << statistics.toString());
+
+    // A pool which has been interned once serves as the same key
+    CompactModelPool compactModelPool(modelPool, cache.getModelRegistry());
+    cache.cacheResult(compactModelPool, resources, structure);
+    result = cache.getCachedResult(modelPool, resources);
+    BOOST_REQUIRE_MESSAGE(result.second && result.first == structure,
+                          "Result cached for an interned pool is retrieved");
+
+    // The memory budget bounds the number of entries
+    QueryCache boundedCache(registry, 4096, 1);
+    for(size_t i = 0; i < 100; ++i)
+    {
+        ModelPool pool;
+        pool[OM::resolve("Payload")] = i + 1;
+        boundedCache.cacheResult(pool, resources, ModelPool::List(1, pool));
+    }
+    statistics = boundedCache.getStatistics();
+    BOOST_REQUIRE_MESSAGE(statistics.bytes <= 4096 &&
+                              statistics.evictions > 0 &&
+                              statistics.size + statistics.evictions == 100,
+                          "Bounded cache: " << statistics.toString());
+
+    ModelPool lastPool;
+    lastPool[OM::resolve("Payload")] = 100;
+    BOOST_REQUIRE_MESSAGE(
+        boundedCache.getCachedResult(lastPool, resources).second,
+        "Most recently used entry should be retained");
+}
+
 BOOST_AUTO_TEST_CASE(resource_support)
 {
     using namespace owlapi::vocabulary;
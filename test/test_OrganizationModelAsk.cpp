@@ -6,6 +6,7 @@
 #include <moreorg/PropertyConstraintSolver.hpp>
 #include <moreorg/Resource.hpp>
 #include <moreorg/reasoning/ResourceMatch.hpp>
+#include <moreorg/utils/Parallel.hpp>
 #include <moreorg/vocabularies/OM.hpp>
 
 #include <moreorg/Agent.hpp>
@@ -118,6 +119,47 @@ BOOST_AUTO_TEST_CASE(recursive_resolution)
     }
 }
 
+BOOST_AUTO_TEST_CASE(shared_instances)
+{
+    OrganizationModel::Ptr om = make_shared<OrganizationModel>(getOMSchema());
+
+    ModelPool modelPool;
+    modelPool[OM::resolve("Sherpa")] = 1;
+    modelPool[OM::resolve("Payload")] = 2;
+
+    std::vector<OrganizationModelAsk::Ptr> asks(8);
+    utils::Parallel::forEach(
+        asks.size(),
+        [&asks, &om, &modelPool](size_t i) {
+            asks[i] = OrganizationModelAsk::getInstance(om, modelPool, true);
+        },
+        4);
+    for(const OrganizationModelAsk::Ptr& ask : asks)
+    {
+        BOOST_REQUIRE_MESSAGE(ask && ask == asks.front(),
+                              "Concurrent requests share one instance");
+    }
+    ModelPool preparedPool = asks.front()->getModelPool();
+
+    OrganizationModelAsk::Ptr unbounded =
+        OrganizationModelAsk::getInstance(om, modelPool, false);
+    BOOST_REQUIRE_MESSAGE(unbounded != asks.front(),
+                          "Options are part of the registry key");
+    BOOST_REQUIRE(OrganizationModelAsk::getNumberOfInstances() >= 2);
+
+    BOOST_REQUIRE_MESSAGE(OrganizationModelAsk::evictInstances(om) == 2,
+                          "Both instances are evicted");
+    OrganizationModelAsk::Ptr ask =
+        OrganizationModelAsk::getInstance(om, modelPool, true);
+    BOOST_REQUIRE_MESSAGE(ask != asks.front(),
+                          "Instance is recreated after eviction");
+    BOOST_REQUIRE_MESSAGE(asks.front()->getModelPool() == preparedPool,
+                          "Evicted instances remain valid");
+
+    BOOST_REQUIRE(OrganizationModelAsk::evictInstances() >= 1);
+    BOOST_REQUIRE(OrganizationModelAsk::getNumberOfInstances() == 0);
+}
+
 BOOST_AUTO_TEST_CASE(functional_saturation)
 {
     using namespace owlapi::vocabulary;
@@ -367,6 +409,106 @@ BOOST_AUTO_TEST_CASE(functional_saturation)
     }
 }
 
+BOOST_AUTO_TEST_CASE(functional_saturation_bounds)
+{
+    using namespace owlapi::vocabulary;
+    using namespace owlapi::model;
+
+    OrganizationModel::Ptr om(new OrganizationModel(getOMSchema()));
+
+    IRI sherpa = OM::resolve("Sherpa");
+    IRI payloadCamera = OM::resolve("PayloadCamera");
+
+    ModelPool modelPool;
+    modelPool[sherpa] = 2;
+    modelPool[payloadCamera] = 3;
+
+    OrganizationModelAsk ask(om, modelPool, true);
+
+    std::map<IRI, ModelPool> bounds = ask.getFunctionalSaturationBounds();
+    BOOST_REQUIRE_MESSAGE(bounds.size() == ask.getFunctionalities().size(),
+                          "Bounds for all functionalities");
+    for(const std::pair<const IRI, ModelPool>& pair : bounds)
+    {
+        BOOST_REQUIRE_MESSAGE(pair.second.size() ==
+                                  ask.getModelPool().size(),
+                              "Bounds for all models of '" << pair.first
+                                                           << "'");
+        for(const ModelPool::value_type& bound : pair.second)
+        {
+            uint32_t expected =
+                ask.getFunctionalSaturationBound(pair.first, bound.first);
+            BOOST_REQUIRE_MESSAGE(bound.second == expected,
+                                  "Bound of '" << bound.first << "' for '"
+                                               << pair.first << "': expected "
+                                               << expected << " was "
+                                               << bound.second);
+        }
+    }
+
+    IRI stereoImageProvider = OM::resolve("StereoImageProvider");
+    BOOST_REQUIRE(bounds.at(stereoImageProvider).at(sherpa) == 1);
+    BOOST_REQUIRE(bounds.at(stereoImageProvider).at(payloadCamera) == 2);
+
+    // Bounds are recomputed once the ontology has changed
+    om->resetQueryCache();
+    std::map<IRI, ModelPool> recomputed = ask.getFunctionalSaturationBounds();
+    BOOST_REQUIRE_MESSAGE(recomputed == bounds,
+                          "Recomputed bounds are identical");
+}
+
+BOOST_AUTO_TEST_CASE(batch_support_type)
+{
+    OrganizationModel::Ptr om(new OrganizationModel(getOMSchema()));
+
+    IRI sherpa = OM::resolve("Sherpa");
+    IRI crex = OM::resolve("CREX");
+    IRI payload = OM::resolve("Payload");
+    IRI payloadCamera = OM::resolve("PayloadCamera");
+
+    ModelPool bound;
+    bound[sherpa] = 1;
+    bound[crex] = 2;
+    bound[payload] = 1;
+    bound[payloadCamera] = 2;
+
+    ModelPool::List modelPools;
+    for(const ModelPool& modelPool : bound.allCombinations())
+    {
+        modelPools.push_back(modelPool);
+    }
+
+    OrganizationModelAsk ask(om);
+    std::vector<Functionality::Set> functionalitySets(3);
+    functionalitySets[0].insert(
+        Functionality(OM::resolve("StereoImageProvider")));
+    functionalitySets[1].insert(Functionality(OM::resolve("EmiPowerProvider")));
+    functionalitySets[2] = functionalitySets[0];
+    functionalitySets[2].insert(
+        Functionality(OM::resolve("LocationImageProvider")));
+    functionalitySets[2].insert(
+        Functionality(OM::resolve("EmiPowerProvider")));
+
+    for(const Functionality::Set& functionalities : functionalitySets)
+    {
+        std::vector<algebra::SupportType> supportTypes =
+            ask.getSupportTypes(functionalities, modelPools);
+        BOOST_REQUIRE_EQUAL(supportTypes.size(), modelPools.size());
+        for(size_t i = 0; i < modelPools.size(); ++i)
+        {
+            algebra::SupportType supportType =
+                ask.getSupportType(functionalities, modelPools[i]);
+            BOOST_REQUIRE_MESSAGE(
+                supportTypes[i] == supportType,
+                "Support of " << modelPools[i].toString() << " for "
+                              << Resource::toString(functionalities) << ": "
+                              << algebra::SupportTypeTxt[supportTypes[i]]
+                              << " expected "
+                              << algebra::SupportTypeTxt[supportType]);
+        }
+    }
+}
+
 BOOST_AUTO_TEST_CASE(functional_saturation_with_property_constraints)
 {
     using namespace owlapi::vocabulary;
@@ -941,10 +1083,36 @@ BOOST_AUTO_TEST_CASE(related_resources)
 
     IRI sherpa = moreorg::vocabulary::OM::resolve("Sherpa");
 
+    // Memoised results must not be shared between different queries
+    ResourceInstance::PtrList relatedWithoutFunctionalities =
+        ask.getRelated(sherpa,
+                       moreorg::vocabulary::OM::Resource(),
+                       moreorg::vocabulary::OM::has(),
+                       false);
+
     ResourceInstance::PtrList related = ask.getRelated(sherpa);
     size_t numberOfRelatedResources = related.size();
     BOOST_REQUIRE_MESSAGE(numberOfRelatedResources > 0,
                           "Sherpa has associated resources");
+    BOOST_REQUIRE_MESSAGE(numberOfRelatedResources >=
+                              relatedWithoutFunctionalities.size(),
+                          "Functionalities extend the related resources");
+    for(size_t i = 0; i < numberOfRelatedResources; ++i)
+    {
+        if(i < relatedWithoutFunctionalities.size())
+        {
+            BOOST_REQUIRE_EQUAL(related[i]->getName(),
+                                relatedWithoutFunctionalities[i]->getName());
+        } else
+        {
+            BOOST_REQUIRE_MESSAGE(
+                ask.ontology().isSubClassOf(
+                    related[i]->getModel(),
+                    moreorg::vocabulary::OM::Functionality()),
+                "Additional resource is a functionality: "
+                    << related[i]->toString());
+        }
+    }
     for(const ResourceInstance::Ptr& ri : related)
     {
         BOOST_TEST_MESSAGE("Related resource: " << ri->toString());
@@ -966,4 +1134,72 @@ BOOST_AUTO_TEST_CASE(related_resources)
                                                      4));
 }
 
+BOOST_AUTO_TEST_CASE(parallel_functionality_mapping)
+{
+    // Expose the uncached computation of the functionality mapping
+    class TestAsk : public OrganizationModelAsk
+    {
+    public:
+        TestAsk(const OrganizationModel::Ptr& om)
+            : OrganizationModelAsk(om)
+        {
+        }
+
+        using OrganizationModelAsk::computeUnboundedFunctionalityMapping;
+    };
+
+    OrganizationModel::Ptr om = make_shared<OrganizationModel>(getOMSchema());
+    ModelPool modelPool;
+    modelPool[OM::resolve("Sherpa")] = 1;
+    modelPool[OM::resolve("CREX")] = 2;
+    modelPool[OM::resolve("Payload")] = 2;
+
+    TestAsk ask(om);
+    IRIList functionalities = ask.getFunctionalities();
+
+    FunctionalityMapping serial =
+        ask.computeUnboundedFunctionalityMapping(modelPool, functionalities);
+
+    ask.setNumberOfThreads(4);
+    FunctionalityMapping parallel =
+        ask.computeUnboundedFunctionalityMapping(modelPool, functionalities);
+
+    BOOST_REQUIRE_MESSAGE(serial.getCache() == parallel.getCache(),
+                          "Parallel computation yields the serial mapping:"
+                              << std::endl
+                              << "serial: " << serial.toString(4) << std::endl
+                              << "parallel: " << parallel.toString(4));
+    BOOST_REQUIRE_MESSAGE(serial.getSupportedFunctionalities() ==
+                              parallel.getSupportedFunctionalities(),
+                          "Parallel computation yields the same supported "
+                          "functionalities");
+}
+
+BOOST_AUTO_TEST_CASE(shared_core)
+{
+    OrganizationModel::Ptr om = make_shared<OrganizationModel>(getOMSchema());
+    ModelPool modelPool;
+    modelPool[OM::resolve("Sherpa")] = 1;
+    modelPool[OM::resolve("Payload")] = 2;
+
+    OrganizationModelAsk ask(om, modelPool, true);
+    OrganizationModelAsk copy = ask;
+    BOOST_REQUIRE_MESSAGE(&copy.getFunctionalityMapping() ==
+                              &ask.getFunctionalityMapping(),
+                          "Copies share the functionality mapping");
+    BOOST_REQUIRE_MESSAGE(&copy.getRobotCache() == &ask.getRobotCache(),
+                          "Copies share the robot cache");
+
+    copy.setNumberOfThreads(4);
+    BOOST_REQUIRE_MESSAGE(ask.getNumberOfThreads() == 1,
+                          "Modifying a copy does not affect the original");
+    BOOST_REQUIRE_MESSAGE(&copy.getFunctionalityMapping() !=
+                              &ask.getFunctionalityMapping(),
+                          "Modified copy has its own core");
+    BOOST_REQUIRE(copy.getFunctionalityMapping().getCache() ==
+                  ask.getFunctionalityMapping().getCache());
+    BOOST_REQUIRE_MESSAGE(&copy.getRobotCache() == &ask.getRobotCache(),
+                          "Modified copy still shares the robot cache");
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,70 @@
+#include <atomic>
+#include <boost/test/unit_test.hpp>
+#include <moreorg/utils/OrganizationStructureGeneration.hpp>
+#include <moreorg/vocabularies/OM.hpp>
+
+using namespace moreorg;
+using namespace moreorg::utils;
+using namespace moreorg::vocabulary;
+
+BOOST_AUTO_TEST_SUITE(organization_structure_generation)
+
+BOOST_AUTO_TEST_CASE(memoised_parallel_search)
+{
+    ModelPool modelPool;
+    modelPool[OM::resolve("Sherpa")] = 2;
+    modelPool[OM::resolve("CREX")] = 2;
+    AtomicAgent::List agents = AtomicAgent::toList(modelPool);
+
+    // A coalition is active if it contains both models
+    std::atomic<size_t> evaluations(0);
+    auto coalitionValue = [&evaluations](const AtomicAgent::List& coalition) {
+        ++evaluations;
+        return AtomicAgent::getModelPool(coalition).size() == 2 ? 1.0 : 0.0;
+    };
+    auto structureValue = [](const std::vector<AtomicAgent::List>& structure) {
+        for(const AtomicAgent::List& coalition : structure)
+        {
+            if(AtomicAgent::getModelPool(coalition).size() != 2)
+            {
+                return 0.0;
+            }
+        }
+        return 1.0;
+    };
+
+    for(size_t numberOfThreads : {1, 4})
+    {
+        evaluations = 0;
+        CoalitionStructureGeneration csg(agents,
+                                         coalitionValue,
+                                         structureValue);
+        csg.setNumberOfThreads(numberOfThreads);
+        // (2+1)*(2+1) - 1 distinct non-empty coalitions
+        BOOST_REQUIRE_MESSAGE(evaluations == 8,
+                              "Each coalition is evaluated once, but was "
+                              "evaluated "
+                                  << evaluations << " times");
+
+        CoalitionStructure solution = csg.findBest(1.0);
+        BOOST_REQUIRE_MESSAGE(evaluations == 8,
+                              "Search uses the memoised coalition values");
+        BOOST_REQUIRE_MESSAGE(structureValue(solution) == 1.0,
+                              "Optimal structure found with "
+                                  << numberOfThreads << " threads: "
+                                  << CoalitionStructureGeneration::toString(
+                                         solution));
+        BOOST_REQUIRE(csg.currentBestSolutionValue() == 1.0);
+        BOOST_REQUIRE(csg.currentBestSolutionQuality() <= 1.0);
+        BOOST_REQUIRE(csg.anytimeSearchCompleted());
+
+        size_t numberOfAgents = 0;
+        for(const AtomicAgent::List& coalition : solution)
+        {
+            numberOfAgents += coalition.size();
+        }
+        BOOST_REQUIRE(numberOfAgents == agents.size());
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()